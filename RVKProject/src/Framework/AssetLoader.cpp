@@ -0,0 +1,191 @@
+#include "Framework/AssetLoader.h"
+#include "Framework/MeshCooker.h"
+#include "Framework/MeshOptimizer.h"
+#include "Framework/MeshSimplifier.h"
+#include "Framework/MeshletBuilder.h"
+#include "Framework/Vulkan/RVKDevice.h"
+
+namespace RVK {
+	AssetLoader* AssetLoader::s_assetLoader = nullptr;
+
+	namespace {
+		double Milliseconds(std::chrono::high_resolution_clock::duration duration) {
+			return std::chrono::duration<double, std::milli>(duration).count();
+		}
+	}  // namespace
+
+	AssetLoader::AssetLoader() {
+		if (s_assetLoader) {
+			VK_CORE_CRITICAL("AssetLoader already initialized");
+		}
+		s_assetLoader = this;
+
+		// the stages inside a load use ParallelFor as well, a few loads at once are enough
+		u32 workerCount = std::clamp(std::thread::hardware_concurrency() / 2, 1u, 4u);
+		m_workers.reserve(workerCount);
+		for (u32 i = 0; i < workerCount; i++) {
+			m_workers.emplace_back(&AssetLoader::WorkerLoop, this);
+		}
+	}
+
+	AssetLoader::~AssetLoader() {
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_stop = true;
+			m_queue.clear();
+		}
+		m_wakeUp.notify_all();
+		for (auto& worker : m_workers) {
+			worker.join();
+		}
+
+		if (s_assetLoader == this) {
+			s_assetLoader = nullptr;
+		}
+	}
+
+	std::shared_ptr<ModelAsset> AssetLoader::LoadModel(const std::string& path, MeshImporter importer, VertexFormat vertexFormat) {
+		auto asset = std::make_shared<ModelAsset>(path, importer, vertexFormat);
+		asset->m_requestTime = ModelAsset::Clock::now();
+		m_pendingCount++;
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_queue.push_back(asset);
+		}
+		m_wakeUp.notify_one();
+		return asset;
+	}
+
+	void AssetLoader::WorkerLoop() {
+		while (true) {
+			std::shared_ptr<ModelAsset> asset;
+			{
+				std::unique_lock<std::mutex> lock(m_mutex);
+				m_wakeUp.wait(lock, [this]() { return m_stop || !m_queue.empty(); });
+				if (m_stop) {
+					return;
+				}
+				asset = std::move(m_queue.front());
+				m_queue.pop_front();
+			}
+
+			LoadOnWorker(*asset);
+
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_loaded.push_back(std::move(asset));
+		}
+	}
+
+	void AssetLoader::LoadOnWorker(ModelAsset& asset) {
+		auto start = ModelAsset::Clock::now();
+		asset.m_loadTimes.queued = Milliseconds(start - asset.m_requestTime);
+		asset.m_state = ModelAsset::State::Loading;
+
+		std::string sourcePath = ENGINE_DIR + asset.m_path;
+		MeshImporter importer = MeshModel::ResolveImporter(asset.m_path, asset.m_importer);
+		std::string cookedPath = MeshCooker::GetCookedPath(sourcePath, importer, asset.m_vertexFormat);
+
+		try {
+			// same stages as MeshModel::CreateMeshModelFromFile, the textures are only named in the cooked file
+			if (!MeshCooker::IsUpToDate(sourcePath, cookedPath, importer, asset.m_vertexFormat)) {
+				MeshModel::AssimpBuilder builder{};
+				builder.cpuOnly = true;
+				MeshModel::Import(builder, sourcePath, importer);
+				MeshOptimizer::Optimize(builder);
+				MeshSimplifier::GenerateLods(builder);
+				MeshletBuilder::Build(builder);
+				asset.m_cooked = MeshCooker::Cook(builder, sourcePath, cookedPath, importer, asset.m_vertexFormat);
+			}
+
+			auto cookedMesh = std::make_unique<CookedMesh>();
+			if (cookedMesh->Open(cookedPath)) {
+				// the main thread only creates the images and records the copies
+				auto textureStart = ModelAsset::Clock::now();
+				asset.m_textures = MeshModel::DecodeTextures(*cookedMesh);
+				asset.m_loadTimes.textures = Milliseconds(ModelAsset::Clock::now() - textureStart);
+				asset.m_cookedMesh = std::move(cookedMesh);
+			}
+		}
+		catch (const std::exception& e) {
+			VK_CORE_WARN("Failed to load {0}: {1}", asset.m_path, e.what());
+			asset.m_state = ModelAsset::State::Failed;
+		}
+
+		asset.m_loadTimes.cpu = Milliseconds(ModelAsset::Clock::now() - start);
+	}
+
+	void AssetLoader::CreateModel(ModelAsset& asset) {
+		asset.m_uploadTime = ModelAsset::Clock::now();
+		if (asset.m_cookedMesh) {
+			asset.m_model = std::make_shared<MeshModel>(*asset.m_cookedMesh, std::move(asset.m_textures));
+			asset.m_cookedMesh.reset();
+			asset.m_textures.clear();
+		}
+		else {
+			VK_CORE_WARN("{0} could not be cooked, importing it on the main thread", asset.m_path);
+			asset.m_model = MeshModel::CreateMeshModelFromFile(asset.m_path, asset.m_importer, asset.m_vertexFormat);
+		}
+		asset.m_state = ModelAsset::State::Uploading;
+	}
+
+	void AssetLoader::Update() {
+		auto now = ModelAsset::Clock::now();
+		auto finish = [&](ModelAsset& asset) {
+			ModelAsset::LoadTimes& times = asset.m_loadTimes;
+			times.upload = Milliseconds(now - asset.m_uploadTime);
+			times.total = Milliseconds(now - asset.m_requestTime);
+			asset.m_state = ModelAsset::State::Resident;
+			m_pendingCount--;
+			VK_CORE_INFO("Loaded {0} in {1:.1f} ms (queued {2:.1f}, cpu {3:.1f} of which textures {4:.1f}, upload {5:.1f}{6})",
+				asset.m_path, times.total, times.queued, times.cpu, times.textures, times.upload, asset.m_cooked ? ", cooked" : "");
+		};
+
+		std::erase_if(m_uploading, [&](const std::shared_ptr<ModelAsset>& asset) {
+			if (!RVKDevice::s_rvkDevice->IsUploadComplete(asset->m_upload)) {
+				return false;
+			}
+			finish(*asset);
+			return true;
+		});
+
+		std::vector<std::shared_ptr<ModelAsset>> created;
+		while (Milliseconds(ModelAsset::Clock::now() - now) < UPLOAD_BUDGET_MS || created.empty()) {
+			std::shared_ptr<ModelAsset> asset;
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				if (m_loaded.empty()) {
+					break;
+				}
+				asset = std::move(m_loaded.front());
+				m_loaded.pop_front();
+			}
+
+			if (asset->m_state == ModelAsset::State::Failed) {
+				m_pendingCount--;
+				continue;
+			}
+
+			if (created.empty()) {
+				RVKDevice::s_rvkDevice->BeginUploadBatch();
+			}
+			CreateModel(*asset);
+			created.push_back(std::move(asset));
+		}
+
+		if (created.empty()) {
+			return;
+		}
+
+		u64 upload = RVKDevice::s_rvkDevice->EndUploadBatch();
+		now = ModelAsset::Clock::now();
+		for (auto& asset : created) {
+			asset->m_upload = upload;
+			if (upload == 0) {
+				finish(*asset);
+			}
+			else {
+				m_uploading.push_back(std::move(asset));
+			}
+		}
+	}
+}  // namespace RVK
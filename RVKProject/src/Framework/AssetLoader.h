@@ -0,0 +1,109 @@
+#pragma once
+
+#include "Framework/MeshCooker.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace RVK {
+	// A model the AssetLoader is working on. Handed out right away, the model shows up once the GPU has it.
+	class ModelAsset {
+	public:
+		enum class State : u32 {
+			Queued,
+			Loading,
+			Uploading,
+			Resident,
+			Failed,
+		};
+
+		// milliseconds, measured from the LoadModel call
+		struct LoadTimes {
+			double queued = 0.0;
+			double cpu = 0.0;
+			// part of cpu, every texture of the model on all threads
+			double textures = 0.0;
+			double upload = 0.0;
+			double total = 0.0;
+		};
+
+		ModelAsset(const std::string& path, MeshImporter importer, VertexFormat vertexFormat)
+			: m_path(path), m_importer(importer), m_vertexFormat(vertexFormat) {}
+
+		NO_COPY(ModelAsset)
+
+		const std::string& GetPath() const { return m_path; }
+		MeshImporter GetImporter() const { return m_importer; }
+		VertexFormat GetVertexFormat() const { return m_vertexFormat; }
+		State GetState() const { return m_state; }
+		bool IsResident() const { return m_state == State::Resident; }
+		// nullptr until resident
+		const std::shared_ptr<MeshModel>& GetModel() const { return m_model; }
+		const LoadTimes& GetLoadTimes() const { return m_loadTimes; }
+
+	private:
+		friend class AssetLoader;
+		using Clock = std::chrono::high_resolution_clock;
+
+		std::string m_path;
+		MeshImporter m_importer;
+		VertexFormat m_vertexFormat;
+		// written by the workers before the asset is handed back, read by the main thread after
+		std::atomic<State> m_state{ State::Queued };
+		std::unique_ptr<CookedMesh> m_cookedMesh;
+		MeshModel::TextureImages m_textures;
+		bool m_cooked = false;
+
+		std::shared_ptr<MeshModel> m_model;
+		u64 m_upload = 0;
+		Clock::time_point m_requestTime;
+		Clock::time_point m_uploadTime;
+		LoadTimes m_loadTimes;
+	};
+
+	// Imports and cooks models on a few worker threads. The main thread only creates the GPU objects,
+	// their uploads go out in one batch per frame and nobody waits for them.
+	class AssetLoader {
+	public:
+		static AssetLoader* s_assetLoader;
+
+	public:
+		AssetLoader();
+		~AssetLoader();
+
+		NO_COPY(AssetLoader)
+		NO_MOVE(AssetLoader)
+
+		// always starts a new load, ResourceManager shares them
+		std::shared_ptr<ModelAsset> LoadModel(
+			const std::string& path,
+			MeshImporter importer = MeshImporter::Auto,
+			VertexFormat vertexFormat = VertexFormat::Full);
+
+		// main thread, once per frame outside of command buffer recording
+		void Update();
+		u32 GetPendingCount() const { return m_pendingCount; }
+
+	private:
+		// GPU work of one frame stops after this, one asset always goes through
+		static constexpr double UPLOAD_BUDGET_MS = 4.0;
+
+		void WorkerLoop();
+		void LoadOnWorker(ModelAsset& asset);
+		void CreateModel(ModelAsset& asset);
+
+		std::vector<std::thread> m_workers;
+		std::mutex m_mutex;
+		std::condition_variable m_wakeUp;
+		std::deque<std::shared_ptr<ModelAsset>> m_queue;
+		// done on the CPU, waiting for the main thread
+		std::deque<std::shared_ptr<ModelAsset>> m_loaded;
+		bool m_stop = false;
+
+		// main thread only
+		std::vector<std::shared_ptr<ModelAsset>> m_uploading;
+		u32 m_pendingCount = 0;
+	};
+}  // namespace RVK
@@ -0,0 +1,360 @@
+#include "Framework/Benchmark.h"
+#include "Framework/Component.h"
+#include "Framework/Entity.h"
+#include "Framework/JobSystem.h"
+#include "Framework/MeshModel.h"
+#include "Framework/SceneSerializer.h"
+#include "Framework/Texture.h"
+#include "Framework/TransformBatch.h"
+#include "Framework/Vulkan/RVKDevice.h"
+
+#ifdef _WIN32
+	#include <psapi.h>
+#else
+	#include <sys/resource.h>
+#endif
+
+#include <filesystem>
+#include <random>
+
+namespace RVK {
+	namespace {
+		constexpr u32 IMPORT_RUNS = 5;
+		constexpr u32 TEXTURE_UPLOAD_RUNS = 20;
+		constexpr u32 TRANSFORM_RUNS = 50;
+		constexpr u32 DEFAULT_TRANSFORM_COUNT = 10000;
+		constexpr u32 SCENE_LOAD_RUNS = 5;
+		struct ImportRun {
+			const char* model;
+			const char* importer;
+		};
+
+		// every fast path against Assimp on the same file
+		const std::array<ImportRun, 6> IMPORT_RUNS_TO_COMPARE = { {
+			{ "models/Helicopter.fbx", "assimp" },
+			{ "models/Helicopter.fbx", "ufbx" },
+			{ "models/TwoMale.fbx", "assimp" },
+			{ "models/TwoMale.fbx", "ufbx" },
+			{ "models/Male.obj", "assimp" },
+			{ "models/Male.obj", "obj" },
+		} };
+	}  // namespace
+
+	bool Benchmark::IsRequested(int argc, char** argv) {
+		return argc > 1 && std::string(argv[1]).rfind("--bench", 0) == 0;
+	}
+
+	int Benchmark::Run(int argc, char** argv) {
+		std::string mode = argv[1];
+		if (mode == "--bench") {
+			return RunImportComparison(argv[0]);
+		}
+		if (mode == "--bench-import" && argc > 3) {
+			return RunImport(argv[2], argv[3]);
+		}
+		if (mode == "--bench-texture" && argc > 2) {
+			return RunTextureUpload(argv[2]);
+		}
+		if (mode == "--bench-transforms") {
+			return RunTransformUpdate(argc > 2 ? static_cast<u32>(std::stoul(argv[2])) : DEFAULT_TRANSFORM_COUNT);
+		}
+		if (mode == "--bench-scene") {
+			return RunSceneLoad(argc > 2 ? static_cast<u32>(std::stoul(argv[2])) : 0);
+		}
+
+		std::cerr << "usage: --bench | --bench-import <assimp|ufbx|obj> <file> | --bench-texture <file> | --bench-transforms [count]"
+			" | --bench-scene [count]\n";
+		return EXIT_FAILURE;
+	}
+
+	int Benchmark::RunImportComparison(const char* executable) {
+		std::cout << "importer  model                      best ms   avg ms   peak MB\n";
+		int result = EXIT_SUCCESS;
+		for (const ImportRun& run : IMPORT_RUNS_TO_COMPARE) {
+			std::string command = std::string("\"") + executable + "\" --bench-import " + run.importer + " " + run.model;
+#ifdef _WIN32
+			// cmd strips the outer quotes of the whole line
+			command = "\"" + command + "\"";
+#endif
+			if (std::system(command.c_str()) != 0) {
+				result = EXIT_FAILURE;
+			}
+		}
+		return result;
+	}
+
+	int Benchmark::RunImport(const std::string& importerName, const std::string& filepath) {
+		MeshImporter importer;
+		if (importerName == "assimp") {
+			importer = MeshImporter::Assimp;
+		}
+		else if (importerName == "ufbx") {
+			importer = MeshImporter::Ufbx;
+		}
+		else if (importerName == "obj") {
+			importer = MeshImporter::Obj;
+		}
+		else {
+			std::cerr << "unknown importer " << importerName << '\n';
+			return EXIT_FAILURE;
+		}
+
+		// the per mesh logging would end up in the timings
+		Log::GetCoreLogger()->set_level(spdlog::level::warn);
+
+		u64 baseMemory = GetPeakMemory();
+		double bestTime = std::numeric_limits<double>::max();
+		double totalTime = 0.0;
+		size_t vertexCount = 0;
+
+		try {
+			for (u32 run = 0; run < IMPORT_RUNS; run++) {
+				auto start = std::chrono::high_resolution_clock::now();
+				{
+					MeshModel::AssimpBuilder builder{};
+					builder.cpuOnly = true;
+					MeshModel::Import(builder, ENGINE_DIR + filepath, importer);
+					vertexCount = builder.vertices.size();
+				}
+				double time = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+				bestTime = std::min(bestTime, time);
+				totalTime += time;
+			}
+		}
+		catch (const std::exception& e) {
+			std::cerr << e.what() << '\n';
+			return EXIT_FAILURE;
+		}
+
+		double peakMegabytes = static_cast<double>(GetPeakMemory() - baseMemory) / (1024.0 * 1024.0);
+		std::printf("%-9s %-26s %8.2f %8.2f %9.2f   (%zu vertices)\n", importerName.c_str(), filepath.c_str(),
+			bestTime, totalTime / IMPORT_RUNS, peakMegabytes, vertexCount);
+		return EXIT_SUCCESS;
+	}
+
+	int Benchmark::RunTextureUpload(const std::string& filepath) {
+		Texture::Image image;
+		if (!Texture::Decode(ENGINE_DIR + filepath, true, image)) {
+			std::cerr << "couldn't decode " << filepath << '\n';
+			return EXIT_FAILURE;
+		}
+
+		// the per texture logging would end up in the timings
+		Log::GetCoreLogger()->set_level(spdlog::level::warn);
+
+		int result = EXIT_SUCCESS;
+		{
+			// the device needs a surface to pick a GPU that can present, like the app's
+			RVKWindow window{ 64, 64, "RVK Texture Benchmark" };
+			auto device = RVKDevice::s_rvkDevice;
+
+			std::cout << "path      texture                    best ms   avg ms\n";
+			for (bool hostCopy : { false, true }) {
+				const char* name = hostCopy ? "host" : "staging";
+				device->SetHostImageCopyEnabled(hostCopy);
+				if (hostCopy && !device->GetHostImageCopyUsage(VK_FORMAT_R8G8B8A8_SRGB,
+					VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT)) {
+					std::printf("%-9s %-26s not supported by %s\n", name, filepath.c_str(), device->m_properties.deviceName);
+					continue;
+				}
+
+				double bestTime = std::numeric_limits<double>::max();
+				double totalTime = 0.0;
+				for (u32 run = 0; run < TEXTURE_UPLOAD_RUNS; run++) {
+					auto start = std::chrono::high_resolution_clock::now();
+					{
+						Texture texture;
+						if (!texture.Init(image, Texture::USE_SRGB)) {
+							result = EXIT_FAILURE;
+						}
+						// until the texture could be sampled
+						vkDeviceWaitIdle(device->GetDevice());
+						std::chrono::duration<double, std::milli> time = std::chrono::high_resolution_clock::now() - start;
+						bestTime = std::min(bestTime, time.count());
+						totalTime += time.count();
+					}
+					device->FlushDeletionQueue();
+				}
+				std::printf("%-9s %-26s %8.2f %8.2f   (%dx%d)\n", name, filepath.c_str(), bestTime,
+					totalTime / TEXTURE_UPLOAD_RUNS, image.width, image.height);
+			}
+
+			device->SetHostImageCopyEnabled(true);
+			// the device goes before the window it was created with
+			device = nullptr;
+			RVKDevice::s_rvkDevice = nullptr;
+		}
+		return result;
+	}
+
+	int Benchmark::RunTransformUpdate(u32 count) {
+		if (count == 0) {
+			std::cerr << "nothing to update\n";
+			return EXIT_FAILURE;
+		}
+
+		// a quarter are roots, every other entity hangs off one of the quarter before it
+		struct Input {
+			glm::vec3 position;
+			glm::vec3 rotation;
+			glm::quat quaternion;
+			glm::vec3 scale;
+			u32 parent;
+		};
+		std::mt19937 random{ 1 };
+		std::uniform_real_distribution<float> angle(-glm::pi<float>(), glm::pi<float>());
+		std::uniform_real_distribution<float> offset(-10.0f, 10.0f);
+		std::uniform_real_distribution<float> scale(0.5f, 2.0f);
+		u32 levelSize = std::max(1u, count / 4);
+		std::vector<Input> inputs(count);
+		for (u32 i = 0; i < count; i++) {
+			Input& input = inputs[i];
+			input.position = { offset(random), offset(random), offset(random) };
+			input.rotation = { angle(random), angle(random), angle(random) };
+			input.quaternion = Components::Transform::EulerToQuat(input.rotation);
+			input.scale = { scale(random), scale(random), scale(random) };
+			input.parent = i < levelSize ? TransformBatch::NO_PARENT : i - levelSize;
+		}
+
+		std::vector<glm::mat4> world(count), normal(count);
+		std::cout << "path             entities   best ns    avg ns   (per entity, everything changed)\n";
+		auto measure = [&](const char* name, auto&& update) {
+			double bestTime = std::numeric_limits<double>::max();
+			double totalTime = 0.0;
+			for (u32 run = 0; run < TRANSFORM_RUNS; run++) {
+				auto start = std::chrono::high_resolution_clock::now();
+				update();
+				double time = std::chrono::duration<double, std::nano>(std::chrono::high_resolution_clock::now() - start).count() / count;
+				bestTime = std::min(bestTime, time);
+				totalTime += time;
+			}
+			std::printf("%-16s %8u %9.2f %9.2f\n", name, count, bestTime, totalTime / TRANSFORM_RUNS);
+		};
+
+		// what every entity paid before the hierarchy, the Euler matrix chain and the local normal matrix
+		measure("euler matrices", [&]() {
+			for (u32 i = 0; i < count; i++) {
+				const Input& input = inputs[i];
+				glm::mat4 local = glm::translate(glm::mat4(1.0f), input.position) *
+					glm::rotate(glm::mat4(1.0f), input.rotation.z, glm::vec3(0.0f, 0.0f, 1.0f)) *
+					glm::rotate(glm::mat4(1.0f), input.rotation.x, glm::vec3(1.0f, 0.0f, 0.0f)) *
+					glm::rotate(glm::mat4(1.0f), input.rotation.y, glm::vec3(0.0f, 1.0f, 0.0f)) *
+					glm::scale(glm::mat4(1.0f), input.scale);
+				glm::mat3 localNormal = glm::mat3_cast(glm::quat(input.rotation)) *
+					glm::mat3(glm::scale(glm::mat4(1.0f), 1.0f / input.scale));
+				bool root = input.parent == TransformBatch::NO_PARENT;
+				world[i] = root ? local : world[input.parent] * local;
+				normal[i] = glm::mat4(root ? localNormal : glm::mat3(normal[input.parent]) * localNormal);
+			}
+		});
+
+		// Scene::UpdateTransform one entity at a time
+		std::vector<Components::Transform> transforms(count);
+		measure("per entity", [&]() {
+			for (u32 i = 0; i < count; i++) {
+				const Input& input = inputs[i];
+				Components::Transform& transform = transforms[i];
+				transform.SetPosition(input.position);
+				transform.SetRotation(input.quaternion);
+				transform.SetScale(input.scale);
+				transform.UpdateLocalMatrix();
+				bool root = input.parent == TransformBatch::NO_PARENT;
+				world[i] = root ? transform.GetLocalMatrix() : world[input.parent] * transform.GetLocalMatrix();
+				normal[i] = glm::mat4(glm::transpose(glm::inverse(glm::mat3(world[i]))));
+			}
+		});
+
+		// filling the batch is part of what Scene pays for it
+		TransformBatch batch;
+		auto runBatch = [&](TransformBatch::Kernel kernel, bool parallel) {
+			batch.Clear();
+			for (u32 i = 0; i < count; i++) {
+				if (i % levelSize == 0) {
+					batch.NextLevel();
+				}
+				batch.Add(inputs[i].position, inputs[i].quaternion, inputs[i].scale, inputs[i].parent);
+			}
+			batch.Update(kernel, parallel);
+		};
+		for (auto kernel : { TransformBatch::Kernel::Scalar, TransformBatch::Kernel::SSE, TransformBatch::Kernel::AVX2 }) {
+			std::string name = std::string("batch ") + TransformBatch::GetKernelName(kernel);
+			if (!TransformBatch::IsSupported(kernel)) {
+				std::printf("%-16s not supported\n", name.c_str());
+				continue;
+			}
+			measure(name.c_str(), [&]() { runBatch(kernel, false); });
+		}
+		std::string name = std::string("batch ") + TransformBatch::GetKernelName(TransformBatch::GetBestKernel()) + " mt";
+		measure(name.c_str(), [&]() { runBatch(TransformBatch::GetBestKernel(), true); });
+		return EXIT_SUCCESS;
+	}
+
+	int Benchmark::RunSceneLoad(u32 count) {
+		// the loader's ParallelFor runs on it like in the app
+		JobSystem jobSystem;
+		const std::string filepath = "bench.rvkscene";
+		std::vector<u32> counts = count > 0 ? std::vector<u32>{ count } : std::vector<u32>{ 10000, 100000 };
+
+		std::cout << "entities   build ms    save ms    load ms   file KB   (load is the best of " << SCENE_LOAD_RUNS << ")\n";
+		for (u32 entityCount : counts) {
+			// the way LoadGameObjects builds one, a named entity with a Transform each, a quarter of them roots
+			// hanging the rest off the quarter before, every eighth a light. Models need the renderer.
+			auto start = std::chrono::high_resolution_clock::now();
+			auto scene = std::make_unique<Scene>();
+			std::vector<entt::entity> entities(entityCount);
+			u32 levelSize = std::max(1u, entityCount / 4);
+			for (u32 i = 0; i < entityCount; i++) {
+				Entity entity = scene->CreateEntity("Entity " + std::to_string(i));
+				entity.AddComponent<Components::Transform>(glm::vec3(static_cast<float>(i % 100), 0.0f, static_cast<float>(i / 100)));
+				if (i >= levelSize) {
+					scene->SetParent(entity.GetEntityID(), entities[i - levelSize]);
+				}
+				if (i % 8 == 0) {
+					entity.AddComponent<Components::PointLight>(glm::vec3(1.0f, 0.5f, 0.25f));
+				}
+				entities[i] = entity.GetEntityID();
+			}
+			double buildTime = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+			start = std::chrono::high_resolution_clock::now();
+			if (!SceneSerializer::Save(*scene, filepath)) {
+				std::cerr << "could not write " << filepath << "\n";
+				return EXIT_FAILURE;
+			}
+			double saveTime = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+			double loadTime = std::numeric_limits<double>::max();
+			for (u32 run = 0; run < SCENE_LOAD_RUNS; run++) {
+				start = std::chrono::high_resolution_clock::now();
+				std::unique_ptr<Scene> loaded = SceneSerializer::Load(filepath);
+				double time = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+				if (!loaded) {
+					std::cerr << "could not load " << filepath << "\n";
+					return EXIT_FAILURE;
+				}
+				loadTime = std::min(loadTime, time);
+			}
+
+			std::error_code error;
+			u64 fileSize = std::filesystem::file_size(filepath, error);
+			std::filesystem::remove(filepath, error);
+			std::printf("%8u %10.2f %10.2f %10.2f %9llu\n", entityCount, buildTime, saveTime, loadTime, fileSize / 1024);
+		}
+		return EXIT_SUCCESS;
+	}
+
+	u64 Benchmark::GetPeakMemory() {
+#ifdef _WIN32
+		PROCESS_MEMORY_COUNTERS counters{};
+		if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+			return static_cast<u64>(counters.PeakWorkingSetSize);
+		}
+		return 0;
+#else
+		rusage usage{};
+		getrusage(RUSAGE_SELF, &usage);
+		// kilobytes on Linux
+		return static_cast<u64>(usage.ru_maxrss) * 1024;
+#endif
+	}
+}  // namespace RVK
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "Framework/Utils.h"
+
+namespace RVK {
+	// Command line benchmarks, run instead of the app.
+	//   --bench                                  compares the fast importers against Assimp
+	//   --bench-import <assimp|ufbx|obj> <file>  times one importer on one file
+	//   --bench-texture <file>                   times the staging and the host image copy upload of one texture
+	//   --bench-transforms [count]               per entity cost of the transform update paths
+	//   --bench-scene [count]                    builds a scene, saves and loads its snapshot, 10k and 100k entities by default
+	class Benchmark {
+	public:
+		static bool IsRequested(int argc, char** argv);
+		static int Run(int argc, char** argv);
+
+	private:
+		// every import runs in its own process, so the peak memory of one doesn't hide the other
+		static int RunImportComparison(const char* executable);
+		static int RunImport(const std::string& importerName, const std::string& filepath);
+		static int RunTextureUpload(const std::string& filepath);
+		static int RunTransformUpdate(u32 count);
+		static int RunSceneLoad(u32 count);
+		static u64 GetPeakMemory();
+	};
+}  // namespace RVK
@@ -1,5 +1,7 @@
 #include "Framework/Camera.h"
 
+#include <glm/gtc/matrix_transform.hpp>
+
 namespace RVK {
 	SceneCamera::SceneCamera() {
 		SetPerspectiveProjection(glm::radians(50.f), m_aspect, 0.1f, 100.f);
@@ -29,6 +31,11 @@ namespace RVK {
 		m_projectionMatrix = glm::perspective(fovy, aspect, zNear, zFar);
 	}
 
+	glm::mat4 SceneCamera::GetJitteredProjection() const {
+		// shift in clip space, scaled by w so it stays the same in NDC for every depth
+		return glm::translate(glm::mat4{ 1.f }, glm::vec3(m_jitter, 0.f)) * m_projectionMatrix;
+	}
+
 	//void SceneCamera::SetViewDirection(glm::vec3 position, glm::vec3 direction, glm::vec3 up) {
 	//	const glm::vec3 w{ glm::normalize(direction) };
 	//	const glm::vec3 u{ glm::normalize(glm::cross(w, up)) };
@@ -16,8 +16,11 @@ namespace RVK {
 		void SetViewTarget(
 			glm::vec3 position, glm::vec3 target, glm::vec3 up = glm::vec3{ 0.f, 1.f, 0.f });
 		void SetViewYXZ(glm::vec3 position, glm::vec3 rotation);
+		// sub pixel offset in NDC the scene is rendered with, for temporal upscaling
+		void SetJitter(glm::vec2 jitter) { m_jitter = jitter; }
 
 		const glm::mat4& GetProjection() const { return m_projectionMatrix; }
+		glm::mat4 GetJitteredProjection() const;
 		const glm::mat4& GetView() const { return m_viewMatrix; }
 		const glm::mat4& GetInverseView() const { return m_inverseViewMatrix; }
 		const glm::vec3 GetPosition() const { return glm::vec3(m_viewMatrix[3]); }
@@ -26,6 +29,7 @@ namespace RVK {
 		glm::mat4 m_projectionMatrix{ 1.f };
 		glm::mat4 m_viewMatrix{ 1.f };
 		glm::mat4 m_inverseViewMatrix{ 1.f };
+		glm::vec2 m_jitter{ 0.f };
 
 		float m_aspect = 1280.0f / 720.0f;
 	};
@@ -5,70 +5,148 @@
 #include <glm/gtx/quaternion.hpp>
 
 #include <PxPhysicsAPI.h>
+#include <EnTT/entt.hpp>
 
 #include "Framework/Utils.h"
 #include "Framework/MeshModel.h"
+#include "Framework/ResourceManager.h"
 #include "Framework/Camera.h"
+#include "Framework/StringId.h"
 
 
+namespace RVK {
+	class Scene;
+}
+
 namespace RVK::Components {
+	// the name the entity was created with, Scene::FindEntity looks it up
 	struct Tag {
-		std::string tag;
+		StringId tag;
 
 		Tag() = default;
 		Tag(const Tag&) = default;
-		Tag(const std::string& tag)
+		Tag(StringId tag)
 			: tag(tag) {}
 	};
 
+	// Local position, rotation and scale relative to the parent, the entity's WorldTransform is built from it.
+	// Setters mark it dirty, Scene::UpdateTransforms rebuilds the local matrix and the world matrices below it.
 	struct Transform {
-		glm::vec3 position = { 0.0f, 0.0f, 0.0f };
-		glm::vec3 rotation = { 0.0f, 0.0f, 0.0f };
-		glm::vec3 scale = { 1.0f, 1.0f, 1.0f };
-
 		Transform() = default;
 		Transform(const Transform&) = default;
 		Transform(const glm::vec3& pos)
-			: position(pos) {}
+			: m_position(pos) {}
+		// rot is Euler angles in radians, applied in Y, X, Z order
 		Transform(const glm::vec3& pos, const glm::vec3& rot, const glm::vec3& sca)
-			: position(pos), rotation(rot), scale(sca) {}
-
-		glm::mat4 GetTransform() const {
-			return glm::translate(glm::mat4(1.0f), position)*
-				glm::rotate(glm::mat4(1.0f), rotation.z, glm::vec3(0.0f, 0.0f, 1.0f))*
-				glm::rotate(glm::mat4(1.0f), rotation.x, glm::vec3(1.0f, 0.0f, 0.0f))*
-				glm::rotate(glm::mat4(1.0f), rotation.y, glm::vec3(0.0f, 1.0f, 0.0f))*
-				glm::scale(glm::mat4(1.0f), scale);
+			: m_position(pos), m_rotation(EulerToQuat(rot)), m_scale(sca) {}
+
+		const glm::vec3& GetPosition() const { return m_position; }
+		const glm::quat& GetRotation() const { return m_rotation; }
+		const glm::vec3& GetScale() const { return m_scale; }
+
+		void SetPosition(const glm::vec3& pos) { m_position = pos; m_dirty = true; }
+		void SetRotation(const glm::quat& rot) { m_rotation = rot; m_dirty = true; }
+		void SetRotation(const glm::vec3& euler) { SetRotation(EulerToQuat(euler)); }
+		void SetScale(const glm::vec3& sca) { m_scale = sca; m_dirty = true; }
+		void Translate(const glm::vec3& pos) { SetPosition(m_position + pos); }
+		void Rotate(const glm::quat& rot) { SetRotation(glm::normalize(rot * m_rotation)); }
+
+		bool IsDirty() const { return m_dirty; }
+		// translation * rotation * scale, as of the last update
+		const glm::mat4& GetLocalMatrix() const { return m_localMatrix; }
+		// rebuilds the local matrix if something changed, returns whether it did
+		bool UpdateLocalMatrix() {
+			if (!m_dirty) {
+				return false;
+			}
+			m_localMatrix = glm::mat4_cast(m_rotation);
+			m_localMatrix[0] *= m_scale.x;
+			m_localMatrix[1] *= m_scale.y;
+			m_localMatrix[2] *= m_scale.z;
+			m_localMatrix[3] = glm::vec4(m_position, 1.0f);
+			m_dirty = false;
+			return true;
 		}
 
-		glm::mat3 NormalMatrix() const {
-			return glm::mat3_cast(glm::quat(rotation)) * (glm::mat3)glm::scale(glm::mat4(1.0f), 1.0f / scale);
+		entt::entity GetParent() const { return m_parent; }
+		const std::vector<entt::entity>& GetChildren() const { return m_children; }
+
+		// the same order the Euler angles were applied in before the rotation became a quaternion
+		static glm::quat EulerToQuat(const glm::vec3& euler) {
+			return glm::angleAxis(euler.z, glm::vec3(0.0f, 0.0f, 1.0f)) *
+				glm::angleAxis(euler.x, glm::vec3(1.0f, 0.0f, 0.0f)) *
+				glm::angleAxis(euler.y, glm::vec3(0.0f, 1.0f, 0.0f));
 		}
 
-		void Translate(const glm::vec3& pos) { position += pos; }
+	private:
+		friend class RVK::Scene;
+
+		glm::vec3 m_position = { 0.0f, 0.0f, 0.0f };
+		glm::quat m_rotation = { 1.0f, 0.0f, 0.0f, 0.0f };
+		glm::vec3 m_scale = { 1.0f, 1.0f, 1.0f };
+		glm::mat4 m_localMatrix{ 1.0f };
+		bool m_dirty = true;
+
+		// set through Scene::SetParent, which keeps both sides in sync
+		entt::entity m_parent{ entt::null };
+		std::vector<entt::entity> m_children;
+	};
+
+	// Written by Scene::UpdateTransforms for every entity with a Transform, read by the renderers as is.
+	// A pool of its own, so the matrices of all entities sit next to each other.
+	struct WorldTransform {
+		// parent world * local
+		glm::mat4 matrix{ 1.0f };
+		glm::mat4 normalMatrix{ 1.0f };
+		// matrix * the Model offset, what the meshes are drawn with, matrix for entities without a Model
+		glm::mat4 meshMatrix{ 1.0f };
+		glm::mat4 meshNormalMatrix{ 1.0f };
 	};
 
 	struct Model {
+		// empty until the asset is resident, see IsResident
 		std::shared_ptr<MeshModel> model;
+		std::shared_ptr<ModelAsset> asset;
 		Transform offset{ glm::vec3(0.0f) };
+		// picked by EntityRenderSystem::Update every frame
+		u32 lod = 0;
+		MeshletDrawList visibleMeshlets;
 
 		Model() = default;
 		Model(const Model&) = default;
 		Model(const std::string& path)
-			: model(MeshModel::CreateMeshModelFromFile(path)) {}
+			: Model(path, MeshImporter::Auto) {}
+		// shared with every other entity using the file, loaded in the background when there is a ResourceManager
+		Model(const std::string& path, MeshImporter importer, VertexFormat vertexFormat = VertexFormat::Full) {
+			if (ResourceManager::s_resourceManager) {
+				asset = ResourceManager::s_resourceManager->GetModel(path, importer, vertexFormat);
+			}
+			else {
+				model = MeshModel::CreateMeshModelFromFile(path, importer, vertexFormat);
+			}
+		}
+		// picks up the model once the loader is done with it
+		bool IsResident() {
+			if (model == nullptr && asset && asset->IsResident()) {
+				model = asset->GetModel();
+			}
+			return model != nullptr;
+		}
 		void SetOffsetPosition(const glm::vec3& pos) {
-			offset.position = pos;
+			offset.SetPosition(pos);
 		}
 		void SetOffsetRotation(const glm::vec3& rot) {
-			offset.rotation = rot;
+			offset.SetRotation(rot);
 		}
 		void SetOffetScale(const glm::vec3& scale) {
-			offset.scale = scale;
+			offset.SetScale(scale);
 		}
 	};
 
 	struct Camera {
 		SceneCamera camera;
+		// yaw, pitch and roll of the view for SetViewYXZ, the Transform gets the matching rotation
+		glm::vec3 rotation{ 0.0f };
 		bool currentCamera = false;
 		bool fixedAspectRatio = false;
 
@@ -1,7 +1,12 @@
 #include "Framework/Entity.h"
 
 namespace RVK {
-	Entity::Entity(entt::entity entity, Scene* scene, std::string_view name) : m_entity(entity), m_scene(scene), m_name(name){}
+	Entity::Entity(entt::entity entity, Scene* scene) : m_entity(entity), m_scene(scene){}
+
+	StringId Entity::GetName() {
+		const auto* tag = m_scene->m_entityRoot.try_get<Components::Tag>(m_entity);
+		return tag ? tag->tag : StringId();
+	}
 
 	void Entity::Move(const glm::vec3& translation) {
 		m_position += translation;
@@ -10,4 +15,17 @@ namespace RVK {
 	void Entity::MoveTo(const glm::vec3& position) {
 		m_position = position;
 	}
+
+	bool Entity::SetParent(Entity parent) {
+		return m_scene->SetParent(m_entity, parent.m_entity);
+	}
+
+	Entity Entity::GetParent() {
+		entt::entity parent = GetComponent<Components::Transform>().GetParent();
+		return parent == entt::null ? Entity{} : Entity(parent, m_scene);
+	}
+
+	const std::vector<entt::entity>& Entity::GetChildren() {
+		return GetComponent<Components::Transform>().GetChildren();
+	}
 }
\ No newline at end of file
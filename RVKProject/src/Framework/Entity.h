@@ -6,13 +6,21 @@ namespace RVK {
 	class Entity {
 	public:
 		Entity() = default;
-		Entity(entt::entity entity, Scene* scene, std::string_view name = "Empty Entity");
+		Entity(entt::entity entity, Scene* scene);
 		Entity(const Entity& other) = default;
 
 		void Move(const glm::vec3& translation);
 		void MoveTo(const glm::vec3& position);
 
 		entt::entity GetEntityID() { return m_entity; }
+		// from its Tag, invalid without one
+		StringId GetName();
+		explicit operator bool() const { return m_entity != entt::null && m_scene; }
+
+		// both need a Transform, an empty Entity detaches
+		bool SetParent(Entity parent);
+		Entity GetParent();
+		const std::vector<entt::entity>& GetChildren();
 
 		template<typename T, typename... Args>
 		T& AddComponent(Args&&... args){
@@ -37,9 +45,6 @@ namespace RVK {
 	private:
 		entt::entity m_entity{ entt::null };
 		Scene* m_scene = nullptr;
-		//const Entity* m_parent;
-		//std::vector<std::shared_ptr<Entity>> m_children;
-		std::string_view m_name;
 		glm::vec3 m_position{0.f, 0.f, 0.f};
 		bool m_isVisible = true;
 	};
@@ -0,0 +1,209 @@
+#include "Framework/JobSystem.h"
+
+namespace RVK {
+	JobSystem* JobSystem::s_jobSystem = nullptr;
+
+	namespace {
+		constexpr u32 NO_WORKER = ~0u;
+
+		// the queue a thread pushes to, threads that aren't workers use the shared one
+		thread_local u32 t_workerIndex = NO_WORKER;
+
+		// every thread hands out its jobs from a ring, a slot is only reused JOB_POOL_SIZE jobs later
+		struct JobPool {
+			std::unique_ptr<Job[]> jobs;
+			u32 next = 0;
+		};
+		thread_local JobPool t_jobPool;
+	}  // namespace
+
+	bool JobQueue::Push(Job* job) {
+		s64 bottom = m_bottom.load(std::memory_order_relaxed);
+		s64 top = m_top.load(std::memory_order_acquire);
+		if (bottom - top >= CAPACITY) {
+			return false;
+		}
+		m_jobs[bottom & MASK].store(job, std::memory_order_relaxed);
+		// the job has to be there before a thief can see the new bottom
+		std::atomic_thread_fence(std::memory_order_release);
+		m_bottom.store(bottom + 1, std::memory_order_relaxed);
+		return true;
+	}
+
+	Job* JobQueue::Pop() {
+		s64 bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+		m_bottom.store(bottom, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		s64 top = m_top.load(std::memory_order_relaxed);
+		if (top > bottom) {
+			m_bottom.store(bottom + 1, std::memory_order_relaxed);
+			return nullptr;
+		}
+
+		Job* job = m_jobs[bottom & MASK].load(std::memory_order_relaxed);
+		if (top == bottom) {
+			// the last one, the thieves may be after it too
+			if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+				job = nullptr;
+			}
+			m_bottom.store(bottom + 1, std::memory_order_relaxed);
+		}
+		return job;
+	}
+
+	Job* JobQueue::Steal() {
+		s64 top = m_top.load(std::memory_order_acquire);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		s64 bottom = m_bottom.load(std::memory_order_acquire);
+		if (top >= bottom) {
+			return nullptr;
+		}
+
+		Job* job = m_jobs[top & MASK].load(std::memory_order_relaxed);
+		if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+			return nullptr;
+		}
+		return job;
+	}
+
+	JobSystem::JobSystem() {
+		if (s_jobSystem) {
+			VK_CORE_CRITICAL("JobSystem already initialized");
+		}
+		s_jobSystem = this;
+
+		u32 workerCount = std::max(1u, std::thread::hardware_concurrency());
+		m_queues.reserve(workerCount);
+		for (u32 i = 0; i < workerCount; i++) {
+			m_queues.push_back(std::make_unique<JobQueue>());
+		}
+		t_workerIndex = 0;
+
+		m_workers.reserve(workerCount - 1);
+		for (u32 i = 1; i < workerCount; i++) {
+			m_workers.emplace_back(&JobSystem::WorkerLoop, this, i);
+		}
+		VK_CORE_INFO("JobSystem started with {0} workers", workerCount);
+	}
+
+	JobSystem::~JobSystem() {
+		m_stop = true;
+		{
+			std::lock_guard<std::mutex> lock(m_sleepMutex);
+			m_wakeUp.notify_all();
+		}
+		for (auto& worker : m_workers) {
+			worker.join();
+		}
+		t_workerIndex = NO_WORKER;
+
+		if (s_jobSystem == this) {
+			s_jobSystem = nullptr;
+		}
+	}
+
+	Job* JobSystem::AllocateJob() {
+		if (!t_jobPool.jobs) {
+			t_jobPool.jobs = std::make_unique<Job[]>(JOB_POOL_SIZE);
+		}
+		return &t_jobPool.jobs[t_jobPool.next++ & (JOB_POOL_SIZE - 1)];
+	}
+
+	void JobSystem::Submit(Job* job) {
+		// counted before it can be taken, so the count never drops below zero
+		m_queuedCount.fetch_add(1);
+		u32 worker = t_workerIndex;
+		if (worker != NO_WORKER) {
+			if (!m_queues[worker]->Push(job)) {
+				m_queuedCount.fetch_sub(1);
+				Execute(job);
+				return;
+			}
+		}
+		else {
+			std::lock_guard<std::mutex> lock(m_sharedMutex);
+			m_sharedQueue.push_back(job);
+			m_sharedCount.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		// a sleeping worker counted itself before it checked for jobs, so one of the two sees the other
+		if (m_sleepingCount.load() > 0) {
+			std::lock_guard<std::mutex> lock(m_sleepMutex);
+			m_wakeUp.notify_one();
+		}
+	}
+
+	Job* JobSystem::FindJob() {
+		u32 worker = t_workerIndex;
+		Job* job = worker != NO_WORKER ? m_queues[worker]->Pop() : nullptr;
+
+		if (!job && m_sharedCount.load(std::memory_order_relaxed) > 0) {
+			std::lock_guard<std::mutex> lock(m_sharedMutex);
+			if (!m_sharedQueue.empty()) {
+				job = m_sharedQueue.front();
+				m_sharedQueue.pop_front();
+				m_sharedCount.fetch_sub(1, std::memory_order_relaxed);
+			}
+		}
+
+		// starting after our own queue, so the thieves don't all line up at the same one
+		u32 queueCount = GetWorkerCount();
+		u32 start = worker != NO_WORKER ? worker + 1 : 0;
+		for (u32 i = 0; !job && i < queueCount; i++) {
+			u32 victim = (start + i) % queueCount;
+			if (victim != worker) {
+				job = m_queues[victim]->Steal();
+			}
+		}
+
+		if (job) {
+			m_queuedCount.fetch_sub(1);
+		}
+		return job;
+	}
+
+	void JobSystem::Execute(Job* job) {
+		// the slot may be reused as soon as the counter drops
+		JobCounter* counter = job->counter;
+		job->function(*job);
+		counter->fetch_sub(1, std::memory_order_release);
+	}
+
+	bool JobSystem::RunOne() {
+		if (Job* job = FindJob()) {
+			Execute(job);
+			return true;
+		}
+		return false;
+	}
+
+	void JobSystem::Wait(const JobCounter& counter) {
+		while (counter.load(std::memory_order_acquire) != 0) {
+			if (!RunOne()) {
+				std::this_thread::yield();
+			}
+		}
+	}
+
+	void JobSystem::WorkerLoop(u32 index) {
+		t_workerIndex = index;
+		u32 idle = 0;
+		while (!m_stop) {
+			if (RunOne()) {
+				idle = 0;
+				continue;
+			}
+			// queued jobs can be missed while another thread is in the middle of taking them
+			if (++idle < SPIN_COUNT || m_queuedCount.load() > 0) {
+				std::this_thread::yield();
+				continue;
+			}
+
+			std::unique_lock<std::mutex> lock(m_sleepMutex);
+			m_sleepingCount.fetch_add(1);
+			m_wakeUp.wait(lock, [this]() { return m_stop || m_queuedCount.load() > 0; });
+			m_sleepingCount.fetch_sub(1);
+			idle = 0;
+		}
+	}
+}  // namespace RVK
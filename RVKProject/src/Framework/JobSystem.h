@@ -0,0 +1,140 @@
+#pragma once
+
+#include "Framework/Utils.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace RVK {
+	// Schedule counts it up, every finished job down, done at zero
+	using JobCounter = std::atomic<u32>;
+
+	struct Job {
+		static constexpr size_t DATA_SIZE = 48;
+
+		void (*function)(Job& job);
+		JobCounter* counter;
+		// the callable, copied in by Schedule
+		alignas(8) std::byte data[DATA_SIZE];
+	};
+
+	// Chase-Lev deque. The owning worker pushes and pops at the bottom, the others steal from the top,
+	// which only takes a compare and swap when they race for the last job.
+	class JobQueue {
+	public:
+		static constexpr s64 CAPACITY = 4096;
+
+		// owner only, false if full
+		bool Push(Job* job);
+		// owner only, the newest job
+		Job* Pop();
+		// any thread, the oldest job, nullptr if empty or another thread got it first
+		Job* Steal();
+
+	private:
+		static constexpr s64 MASK = CAPACITY - 1;
+
+		// on their own cache lines, the owner writes one and the thieves the other
+		alignas(64) std::atomic<s64> m_top{ 0 };
+		alignas(64) std::atomic<s64> m_bottom{ 0 };
+		std::array<std::atomic<Job*>, CAPACITY> m_jobs{};
+	};
+
+	// Work stealing thread pool with a queue per worker and one worker per hardware thread. The thread that
+	// creates it is worker 0 and only works while it waits. Other threads, like the asset loader's, queue
+	// their jobs in a shared queue but steal and help all the same.
+	class JobSystem {
+	public:
+		static JobSystem* s_jobSystem;
+
+	public:
+		JobSystem();
+		~JobSystem();
+
+		NO_COPY(JobSystem)
+		NO_MOVE(JobSystem)
+
+		// fn is copied into the job, so it has to be small and trivially copyable, capture by reference.
+		// A thread shouldn't have more than JOB_POOL_SIZE of its jobs in flight.
+		template<typename Fn>
+		void Schedule(JobCounter& counter, Fn&& fn);
+		// runs queued jobs until the counter is zero, so waiting inside a job doesn't take a worker away
+		void Wait(const JobCounter& counter);
+		// runs one queued job if there is one, for threads waiting on something else
+		bool RunOne();
+
+		// fn(i) for every i in [0, count), items are handed out one at a time and the calling thread helps
+		template<typename Fn>
+		void ParallelFor(u32 count, Fn&& fn);
+
+		u32 GetWorkerCount() const { return static_cast<u32>(m_queues.size()); }
+
+	private:
+		static constexpr u32 JOB_POOL_SIZE = 4096;
+		// tries before an idle worker goes to sleep
+		static constexpr u32 SPIN_COUNT = 64;
+
+		Job* AllocateJob();
+		void Submit(Job* job);
+		Job* FindJob();
+		void Execute(Job* job);
+		void WorkerLoop(u32 index);
+
+		std::vector<std::unique_ptr<JobQueue>> m_queues;
+		std::vector<std::thread> m_workers;
+
+		std::mutex m_sharedMutex;
+		std::deque<Job*> m_sharedQueue;
+		std::atomic<u32> m_sharedCount{ 0 };
+
+		// jobs in any of the queues, the workers sleep while there are none
+		std::atomic<u32> m_queuedCount{ 0 };
+		std::atomic<u32> m_sleepingCount{ 0 };
+		std::mutex m_sleepMutex;
+		std::condition_variable m_wakeUp;
+		std::atomic<bool> m_stop{ false };
+	};
+
+	template<typename Fn>
+	void JobSystem::Schedule(JobCounter& counter, Fn&& fn) {
+		using Function = std::decay_t<Fn>;
+		static_assert(sizeof(Function) <= Job::DATA_SIZE && alignof(Function) <= 8, "capture less or by reference");
+		static_assert(std::is_trivially_copyable_v<Function> && std::is_trivially_destructible_v<Function>,
+			"jobs are copied around as plain bytes");
+
+		Job* job = AllocateJob();
+		new (job->data) Function(std::forward<Fn>(fn));
+		job->function = [](Job& job) {
+			(*std::launder(reinterpret_cast<Function*>(job.data)))();
+		};
+		job->counter = &counter;
+		counter.fetch_add(1, std::memory_order_relaxed);
+		Submit(job);
+	}
+
+	template<typename Fn>
+	void JobSystem::ParallelFor(u32 count, Fn&& fn) {
+		u32 jobCount = std::min(count, GetWorkerCount());
+		if (jobCount <= 1) {
+			for (u32 i = 0; i < count; i++) {
+				fn(i);
+			}
+			return;
+		}
+
+		std::atomic<u32> next{ 0 };
+		JobCounter counter{ 0 };
+		auto work = [&next, &fn, count]() {
+			for (u32 i = next++; i < count; i = next++) {
+				fn(i);
+			}
+		};
+		for (u32 i = 1; i < jobCount; i++) {
+			Schedule(counter, work);
+		}
+		work();
+		Wait(counter);
+	}
+}  // namespace RVK
@@ -0,0 +1,92 @@
+#include "Framework/MappedFile.h"
+
+#ifndef _WIN32
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+namespace RVK {
+	MappedFile::~MappedFile() {
+		Close();
+	}
+
+	bool MappedFile::Open(const std::string& filepath) {
+		Close();
+
+#ifdef _WIN32
+		m_file = CreateFileA(filepath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+			FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+		if (m_file == INVALID_HANDLE_VALUE) {
+			return false;
+		}
+
+		LARGE_INTEGER size;
+		if (!GetFileSizeEx(m_file, &size) || size.QuadPart == 0) {
+			Close();
+			return false;
+		}
+		m_size = static_cast<size_t>(size.QuadPart);
+
+		m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (!m_mapping) {
+			Close();
+			return false;
+		}
+
+		m_data = static_cast<const u8*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+#else
+		m_file = open(filepath.c_str(), O_RDONLY);
+		if (m_file < 0) {
+			return false;
+		}
+
+		struct stat info;
+		if (fstat(m_file, &info) != 0 || info.st_size == 0) {
+			Close();
+			return false;
+		}
+		m_size = static_cast<size_t>(info.st_size);
+
+		void* data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, m_file, 0);
+		if (data != MAP_FAILED) {
+			// everything gets read front to back once
+			madvise(data, m_size, MADV_SEQUENTIAL);
+			m_data = static_cast<const u8*>(data);
+		}
+#endif
+
+		if (!m_data) {
+			Close();
+			return false;
+		}
+		return true;
+	}
+
+	void MappedFile::Close() {
+#ifdef _WIN32
+		if (m_data) {
+			UnmapViewOfFile(m_data);
+		}
+		if (m_mapping) {
+			CloseHandle(m_mapping);
+			m_mapping = nullptr;
+		}
+		if (m_file != INVALID_HANDLE_VALUE) {
+			CloseHandle(m_file);
+			m_file = INVALID_HANDLE_VALUE;
+		}
+#else
+		if (m_data) {
+			munmap(const_cast<u8*>(m_data), m_size);
+		}
+		if (m_file >= 0) {
+			close(m_file);
+			m_file = -1;
+		}
+#endif
+		m_data = nullptr;
+		m_size = 0;
+	}
+}  // namespace RVK
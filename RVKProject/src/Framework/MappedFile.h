@@ -0,0 +1,31 @@
+#pragma once
+
+#include "Framework/Utils.h"
+
+namespace RVK {
+	// Read only view of a whole file through the OS page cache, nothing is copied on open.
+	class MappedFile {
+	public:
+		MappedFile() = default;
+		~MappedFile();
+
+		NO_COPY(MappedFile)
+
+		bool Open(const std::string& filepath);
+		void Close();
+
+		bool IsOpen() const { return m_data != nullptr; }
+		const u8* GetData() const { return m_data; }
+		size_t GetSize() const { return m_size; }
+
+	private:
+		const u8* m_data = nullptr;
+		size_t m_size = 0;
+#ifdef _WIN32
+		HANDLE m_file = INVALID_HANDLE_VALUE;
+		HANDLE m_mapping = nullptr;
+#else
+		int m_file = -1;
+#endif
+	};
+}  // namespace RVK
@@ -26,7 +26,8 @@ namespace RVK {
             HAS_METALLIC_MAP = GLSL_HAS_METALLIC_MAP,
             HAS_ROUGHNESS_METALLIC_MAP = GLSL_HAS_ROUGHNESS_METALLIC_MAP,
             HAS_EMISSIVE_COLOR = GLSL_HAS_EMISSIVE_COLOR,
-            HAS_EMISSIVE_MAP = GLSL_HAS_EMISSIVE_MAP
+            HAS_EMISSIVE_MAP = GLSL_HAS_EMISSIVE_MAP,
+            HAS_DIFFUSE_ATLAS = GLSL_HAS_DIFFUSE_ATLAS
         };
 
 		struct PBRMaterial {
@@ -49,8 +50,12 @@ namespace RVK {
             float spare2{ 0.0f }; // padding
             float spare3{ 0.0f }; // padding
 
-            // byte 64 to 128
-            glm::vec4 spare4[4];
+            // byte 64 to 79
+            // xy scale, zw offset into the atlas page, with HAS_DIFFUSE_ATLAS
+            glm::vec4 diffuseUVTransform{ 1.0f, 1.0f, 0.0f, 0.0f };
+
+            // byte 80 to 128
+            glm::vec4 spare4[3];
 		};
         
         //struct PBRMaterial {
@@ -0,0 +1,228 @@
+#include "Framework/MeshCooker.h"
+#include "Framework/TextureAtlas.h"
+
+#include <filesystem>
+#include <fstream>
+
+namespace RVK {
+	namespace {
+		bool GetSourceStamp(const std::string& sourcePath, u64& size, s64& time) {
+			std::error_code error;
+			size = static_cast<u64>(std::filesystem::file_size(sourcePath, error));
+			if (error) {
+				return false;
+			}
+			time = static_cast<s64>(std::filesystem::last_write_time(sourcePath, error).time_since_epoch().count());
+			return !error;
+		}
+
+		u64 AlignBlob(u64 offset) {
+			return (offset + 15) & ~u64(15);
+		}
+	}  // namespace
+
+	bool CookedMesh::Open(const std::string& filepath) {
+		m_header = nullptr;
+		if (!m_file.Open(filepath)) {
+			return false;
+		}
+
+		u64 fileSize = m_file.GetSize();
+		if (fileSize < sizeof(CookedMeshHeader)) {
+			m_file.Close();
+			return false;
+		}
+
+		auto header = reinterpret_cast<const CookedMeshHeader*>(m_file.GetData());
+		auto fits = [fileSize](u64 offset, u64 size) { return offset <= fileSize && size <= fileSize - offset; };
+		bool valid = header->magic == MeshCooker::MAGIC &&
+			header->version == MeshCooker::VERSION &&
+			header->vertexFormat < static_cast<u32>(VertexFormat::Count) &&
+			header->vertexStride == MeshCooker::GetVertexStride(static_cast<VertexFormat>(header->vertexFormat)) &&
+			fits(header->vertexOffset, u64(header->vertexCount) * header->vertexStride) &&
+			(header->vertexFormat != static_cast<u32>(VertexFormat::Full) ||
+				fits(header->positionOffset, u64(header->vertexCount) * sizeof(glm::vec3))) &&
+			fits(header->indexOffset, u64(header->indexCount) * sizeof(u32)) &&
+			fits(header->meshOffset, u64(header->meshCount) * sizeof(CookedSubmesh)) &&
+			fits(header->materialOffset, u64(header->materialCount) * sizeof(CookedMaterial)) &&
+			fits(header->meshletOffset, u64(header->meshletCount) * sizeof(Meshlet)) &&
+			fits(header->stringOffset, header->stringSize);
+		if (!valid) {
+			VK_CORE_WARN("Cooked mesh {0} is corrupt or outdated", filepath);
+			m_file.Close();
+			return false;
+		}
+
+		m_header = header;
+		return true;
+	}
+
+	std::string CookedMesh::GetString(u32 offset, u32 length) const {
+		if (u64(offset) + length > m_header->stringSize) {
+			return {};
+		}
+		return std::string(Get<char>(m_header->stringOffset + offset), length);
+	}
+
+	u32 MeshCooker::GetVertexStride(VertexFormat vertexFormat) {
+		return vertexFormat == VertexFormat::Compressed ? sizeof(CompressedVertex) : sizeof(Vertex);
+	}
+
+	bool MeshCooker::IsUpToDate(const std::string& sourcePath, const std::string& cookedPath,
+		MeshImporter importer, VertexFormat vertexFormat) {
+		std::ifstream file(cookedPath, std::ios::binary);
+		if (!file) {
+			return false;
+		}
+
+		CookedMeshHeader header{};
+		if (!file.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+			return false;
+		}
+
+		u64 sourceSize;
+		s64 sourceTime;
+		if (!GetSourceStamp(sourcePath, sourceSize, sourceTime)) {
+			// source is gone, whatever was cooked is all there is
+			return header.magic == MAGIC && header.version == VERSION;
+		}
+
+		return header.magic == MAGIC &&
+			header.version == VERSION &&
+			header.vertexFormat == static_cast<u32>(vertexFormat) &&
+			header.importer == static_cast<u32>(importer) &&
+			header.sourceSize == sourceSize &&
+			header.sourceTime == sourceTime;
+	}
+
+	bool MeshCooker::Cook(const MeshModel::AssimpBuilder& builder, const std::string& sourcePath,
+		const std::string& cookedPath, MeshImporter importer, VertexFormat vertexFormat) {
+		CookedMeshHeader header{};
+		header.magic = MAGIC;
+		header.version = VERSION;
+		if (!GetSourceStamp(sourcePath, header.sourceSize, header.sourceTime)) {
+			return false;
+		}
+
+		header.vertexFormat = static_cast<u32>(vertexFormat);
+		header.vertexStride = GetVertexStride(vertexFormat);
+		header.vertexCount = static_cast<u32>(builder.vertices.size());
+		header.indexCount = static_cast<u32>(builder.indices.size());
+		header.meshCount = static_cast<u32>(builder.meshes.size());
+		header.materialCount = static_cast<u32>(builder.materials.size());
+		header.meshletCount = static_cast<u32>(builder.meshlets.size());
+		header.importer = static_cast<u32>(importer);
+		header.boundsMin = builder.boundsMin;
+		header.boundsMax = builder.boundsMax;
+
+		// same bounds the loader builds the decode matrix from
+		std::vector<glm::vec3> positions;
+		std::vector<CompressedVertex> compressedVertices;
+		if (vertexFormat == VertexFormat::Compressed) {
+			compressedVertices.resize(builder.vertices.size());
+			for (size_t i = 0; i < builder.vertices.size(); i++) {
+				compressedVertices[i] = CompressedVertex::Encode(builder.vertices[i], builder.boundsMin, builder.boundsMax);
+			}
+		}
+		else {
+			positions.resize(builder.vertices.size());
+			for (size_t i = 0; i < builder.vertices.size(); i++) {
+				positions[i] = builder.vertices[i].position;
+			}
+		}
+
+		std::vector<CookedSubmesh> meshes(builder.meshes.size());
+		for (size_t i = 0; i < builder.meshes.size(); i++) {
+			const Mesh& mesh = builder.meshes[i];
+			meshes[i] = { mesh.firstIndex, mesh.firstVertex, mesh.indexCount, mesh.vertexCount, mesh.materialIndex, mesh.lodCount };
+			std::copy(mesh.lods.begin(), mesh.lods.end(), meshes[i].lods);
+			meshes[i].firstMeshlet = mesh.firstMeshlet;
+			meshes[i].meshletCount = mesh.meshletCount;
+		}
+
+		// the diffuse map is the only one the shaders sample, so the only one with a UV rect
+		std::vector<TextureAtlas::Source> diffuseMaps;
+		for (const Material& material : builder.materials) {
+			if (const auto& texture = material.m_materialTextures[Material::DIFFUSE_MAP_INDEX]) {
+				diffuseMaps.push_back({ texture->GetFilename(), texture->IsSRGB() });
+			}
+		}
+		// same flip as MeshModel::DecodeTextures
+		TextureAtlas::Placements placements = TextureAtlas::Pack(diffuseMaps, sourcePath, true);
+
+		std::string strings;
+		std::vector<CookedMaterial> materials(builder.materials.size());
+		for (size_t i = 0; i < builder.materials.size(); i++) {
+			const Material& material = builder.materials[i];
+			materials[i].pbrMaterial = material.m_PBRMaterial;
+			for (u32 t = 0; t < Material::NUM_TEXTURES; t++) {
+				CookedMaterial::TextureRef& ref = materials[i].textures[t];
+				ref = {};
+				if (const auto& texture = material.m_materialTextures[t]) {
+					std::string path = texture->GetFilename();
+					auto placement = placements.find(path);
+					if (t == Material::DIFFUSE_MAP_INDEX && placement != placements.end()) {
+						path = placement->second.page;
+						materials[i].pbrMaterial.features |= Material::HAS_DIFFUSE_ATLAS;
+						materials[i].pbrMaterial.diffuseUVTransform = placement->second.uvTransform;
+					}
+					ref.pathOffset = static_cast<u32>(strings.size());
+					ref.pathLength = static_cast<u32>(path.size());
+					ref.sRGB = texture->IsSRGB() ? 1 : 0;
+					strings += path;
+				}
+			}
+		}
+
+		// written next to the final file and renamed, so a crash never leaves half a mesh behind
+		std::string tempPath = cookedPath + ".tmp";
+		{
+			std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+			if (!file) {
+				return false;
+			}
+
+			u64 offset = sizeof(CookedMeshHeader);
+			auto writeBlob = [&](const void* data, u64 size) {
+				u64 aligned = AlignBlob(offset);
+				static constexpr char padding[16]{};
+				file.write(padding, static_cast<std::streamsize>(aligned - offset));
+				file.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+				offset = aligned + size;
+				return aligned;
+			};
+
+			file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+			if (vertexFormat == VertexFormat::Compressed) {
+				header.vertexOffset = writeBlob(compressedVertices.data(), compressedVertices.size() * sizeof(CompressedVertex));
+			}
+			else {
+				header.vertexOffset = writeBlob(builder.vertices.data(), builder.vertices.size() * sizeof(Vertex));
+				header.positionOffset = writeBlob(positions.data(), positions.size() * sizeof(glm::vec3));
+			}
+			header.indexOffset = writeBlob(builder.indices.data(), builder.indices.size() * sizeof(u32));
+			header.meshOffset = writeBlob(meshes.data(), meshes.size() * sizeof(CookedSubmesh));
+			header.materialOffset = writeBlob(materials.data(), materials.size() * sizeof(CookedMaterial));
+			header.meshletOffset = writeBlob(builder.meshlets.data(), builder.meshlets.size() * sizeof(Meshlet));
+			header.stringOffset = writeBlob(strings.data(), strings.size());
+			header.stringSize = strings.size();
+
+			file.seekp(0);
+			file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+			if (!file) {
+				return false;
+			}
+		}
+
+		std::error_code error;
+		std::filesystem::rename(tempPath, cookedPath, error);
+		if (error) {
+			std::filesystem::remove(tempPath, error);
+			return false;
+		}
+
+		VK_CORE_INFO("Cooked {0}: {1} vertices ({2} bytes each), {3} indices, {4} meshes", cookedPath,
+			header.vertexCount, header.vertexStride, header.indexCount, header.meshCount);
+		return true;
+	}
+}  // namespace RVK
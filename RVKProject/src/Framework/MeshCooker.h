@@ -0,0 +1,108 @@
+#pragma once
+
+#include "Framework/MeshModel.h"
+#include "Framework/MappedFile.h"
+
+namespace RVK {
+	// .rvkmesh layout: header, then 16 byte aligned blobs at the offsets stored in the header.
+	// Every blob has the exact layout the GPU buffers use, so loading is a copy into staging memory.
+	// Compressed vertices have no position blob, the depth prepass reads them from the vertex blob.
+	struct CookedMeshHeader {
+		u32 magic;
+		u32 version;
+		// the source the file was cooked from, it gets cooked again when these don't match
+		u64 sourceSize;
+		s64 sourceTime;
+
+		u32 vertexStride;
+		u32 vertexCount;
+		u32 indexCount;
+		u32 meshCount;
+		u32 materialCount;
+		u32 meshletCount;
+		// MeshImporter that produced the data
+		u32 importer;
+		// VertexFormat of the vertex blob
+		u32 vertexFormat;
+
+		glm::vec3 boundsMin;
+		float spare1;
+		glm::vec3 boundsMax;
+		float spare2;
+
+		u64 vertexOffset;
+		u64 positionOffset;
+		u64 indexOffset;
+		u64 meshOffset;
+		u64 materialOffset;
+		u64 meshletOffset;
+		u64 stringOffset;
+		u64 stringSize;
+	};
+
+	struct CookedSubmesh {
+		u32 firstIndex;
+		u32 firstVertex;
+		u32 indexCount;
+		u32 vertexCount;
+		u32 materialIndex;
+		u32 lodCount;
+		MeshLod lods[MAX_MESH_LODS - 1];
+		u32 firstMeshlet;
+		u32 meshletCount;
+	};
+
+	struct CookedMaterial {
+		struct TextureRef {
+			// into the string table, length 0 means no texture
+			u32 pathOffset;
+			u32 pathLength;
+			u32 sRGB;
+			u32 spare;
+		};
+
+		Material::PBRMaterial pbrMaterial;
+		TextureRef textures[Material::NUM_TEXTURES];
+	};
+
+	class CookedMesh {
+	public:
+		bool Open(const std::string& filepath);
+
+		const CookedMeshHeader& GetHeader() const { return *m_header; }
+		const Vertex* GetVertices() const { return Get<Vertex>(m_header->vertexOffset); }
+		const CompressedVertex* GetCompressedVertices() const { return Get<CompressedVertex>(m_header->vertexOffset); }
+		const glm::vec3* GetPositions() const { return Get<glm::vec3>(m_header->positionOffset); }
+		const u32* GetIndices() const { return Get<u32>(m_header->indexOffset); }
+		const CookedSubmesh* GetMeshes() const { return Get<CookedSubmesh>(m_header->meshOffset); }
+		const CookedMaterial* GetMaterials() const { return Get<CookedMaterial>(m_header->materialOffset); }
+		const Meshlet* GetMeshlets() const { return Get<Meshlet>(m_header->meshletOffset); }
+		std::string GetString(u32 offset, u32 length) const;
+
+	private:
+		template<typename T>
+		const T* Get(u64 offset) const { return reinterpret_cast<const T*>(m_file.GetData() + offset); }
+
+		MappedFile m_file;
+		const CookedMeshHeader* m_header = nullptr;
+	};
+
+	class MeshCooker {
+	public:
+		static constexpr u32 MAGIC = 0x4D4B5652; // "RVKM"
+		static constexpr u32 VERSION = 7;
+
+		// one file per resolved importer and vertex format, so loading the same source both ways doesn't
+		// have the two cook over each other every time
+		static std::string GetCookedPath(const std::string& sourcePath, MeshImporter importer, VertexFormat vertexFormat) {
+			return sourcePath + "." + std::to_string(static_cast<u32>(importer)) + "." +
+				std::to_string(static_cast<u32>(vertexFormat)) + ".rvkmesh";
+		}
+		static u32 GetVertexStride(VertexFormat vertexFormat);
+		// false if the cooked file is missing, from an older version, a different source, importer or vertex format
+		static bool IsUpToDate(const std::string& sourcePath, const std::string& cookedPath,
+			MeshImporter importer, VertexFormat vertexFormat);
+		static bool Cook(const MeshModel::AssimpBuilder& builder, const std::string& sourcePath,
+			const std::string& cookedPath, MeshImporter importer, VertexFormat vertexFormat);
+	};
+}  // namespace RVK
@@ -1,34 +1,127 @@
 #include "Framework/MeshModel.h"
+#include "Framework/MeshCooker.h"
+#include "Framework/MeshOptimizer.h"
+#include "Framework/MeshSimplifier.h"
+#include "Framework/MeshletBuilder.h"
+#include "Framework/TextureStreamer.h"
 #include "Framework/Vulkan/RVKDevice.h"
 #include "Framework/Vulkan/MaterialDescriptor.h"
 
-#define GLM_ENABLE_EXPERIMENTAL
-#include <glm/gtx/hash.hpp>
-
-namespace std {
-	template <>
-	struct hash<RVK::Vertex> {
-		size_t operator()(RVK::Vertex const& vertex) const {
-			size_t seed = 0;
-			HashCombine(seed, vertex.position, vertex.color, vertex.normal, vertex.uv);
-			return seed;
-		}
-	};
-}  // namespace std
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/packing.hpp>
 
 namespace RVK {
-	MeshModel::MeshModel(const MeshModel::AssimpBuilder& builder) {
+	MeshModel::MeshModel(const MeshModel::AssimpBuilder& builder, VertexFormat vertexFormat)
+		: m_boundsMin{ builder.boundsMin }, m_boundsMax{ builder.boundsMax }, m_vertexFormat{ vertexFormat } {
+		u32 vertexCount = static_cast<u32>(builder.vertices.size());
+
 		CopyMeshes(builder.meshes);
-		CreateVertexBuffers(builder.vertices);
-		CreateIndexBuffers(builder.indices);
+		FindLodErrors();
+		m_meshletCuller.SetMeshlets(builder.meshlets.data(), static_cast<u32>(builder.meshlets.size()));
+		FindAlphaTestedMeshes([&](u32 i) { return builder.vertices[i].color.a; });
+		if (m_vertexFormat == VertexFormat::Compressed) {
+			std::vector<CompressedVertex> vertices(vertexCount);
+			for (u32 i = 0; i < vertexCount; i++) {
+				vertices[i] = CompressedVertex::Encode(builder.vertices[i], m_boundsMin, m_boundsMax);
+			}
+			CreateGeometry(vertices.data(), sizeof(CompressedVertex), vertexCount, nullptr,
+				builder.indices.data(), static_cast<u32>(builder.indices.size()));
+		}
+		else {
+			std::vector<glm::vec3> positions(vertexCount);
+			for (u32 i = 0; i < vertexCount; i++) {
+				positions[i] = builder.vertices[i].position;
+			}
+			CreateGeometry(builder.vertices.data(), sizeof(Vertex), vertexCount, positions.data(),
+				builder.indices.data(), static_cast<u32>(builder.indices.size()));
+		}
+		SetPositionDecode();
+	}
+
+	// the blobs go from the mapped file straight into the staging buffers
+	MeshModel::MeshModel(const CookedMesh& cookedMesh, TextureImages&& decodedTextures) {
+		const CookedMeshHeader& header = cookedMesh.GetHeader();
+		m_boundsMin = header.boundsMin;
+		m_boundsMax = header.boundsMax;
+		m_vertexFormat = static_cast<VertexFormat>(header.vertexFormat);
+
+		LoadCookedMeshes(cookedMesh, decodedTextures);
+		FindLodErrors();
+		m_meshletCuller.SetMeshlets(cookedMesh.GetMeshlets(), header.meshletCount);
+		if (m_vertexFormat == VertexFormat::Compressed) {
+			const CompressedVertex* vertices = cookedMesh.GetCompressedVertices();
+			FindAlphaTestedMeshes([vertices](u32 i) { return vertices[i].GetAlpha(); });
+			CreateGeometry(vertices, sizeof(CompressedVertex), header.vertexCount, nullptr,
+				cookedMesh.GetIndices(), header.indexCount);
+		}
+		else {
+			const Vertex* vertices = cookedMesh.GetVertices();
+			FindAlphaTestedMeshes([vertices](u32 i) { return vertices[i].color.a; });
+			CreateGeometry(vertices, sizeof(Vertex), header.vertexCount, cookedMesh.GetPositions(),
+				cookedMesh.GetIndices(), header.indexCount);
+		}
+		SetPositionDecode();
+	}
+
+	MeshModel::~MeshModel() {
+		if (m_arena) {
+			RVKDevice::s_rvkDevice->DeferDestroy([arena = m_arena, geometry = m_geometry]() { arena->Free(geometry); });
+		}
 	}
 
-	MeshModel::~MeshModel() {}
+	std::unique_ptr<MeshModel> MeshModel::CreateMeshModelFromFile(const std::string& filepath, MeshImporter importer, VertexFormat vertexFormat) {
+		std::string sourcePath = ENGINE_DIR + filepath;
+		importer = ResolveImporter(filepath, importer);
+		std::string cookedPath = MeshCooker::GetCookedPath(sourcePath, importer, vertexFormat);
 
-	std::unique_ptr<MeshModel> MeshModel::CreateMeshModelFromFile(const std::string& filepath) {
+		if (MeshCooker::IsUpToDate(sourcePath, cookedPath, importer, vertexFormat)) {
+			CookedMesh cookedMesh;
+			if (cookedMesh.Open(cookedPath)) {
+				return std::make_unique<MeshModel>(cookedMesh);
+			}
+		}
+
+		// the reordering is paid once, the cooked file keeps the optimized order
 		AssimpBuilder builder{};
-		builder.LoadMeshModel(ENGINE_DIR + filepath);
-		return std::make_unique<MeshModel>(builder);
+		Import(builder, sourcePath, importer);
+		MeshOptimizer::Optimize(builder);
+		MeshSimplifier::GenerateLods(builder);
+		MeshletBuilder::Build(builder);
+		if (!MeshCooker::Cook(builder, sourcePath, cookedPath, importer, vertexFormat)) {
+			VK_CORE_WARN("Failed to cook {0}, it will be imported again next time", sourcePath);
+		}
+		return std::make_unique<MeshModel>(builder, vertexFormat);
+	}
+
+	MeshImporter MeshModel::ResolveImporter(const std::string& filepath, MeshImporter importer) {
+		if (importer != MeshImporter::Auto) {
+			return importer;
+		}
+
+		std::string extension = filepath.substr(std::min(filepath.find_last_of('.'), filepath.size()));
+		std::transform(extension.begin(), extension.end(), extension.begin(),
+			[](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+		if (extension == ".fbx") {
+			return MeshImporter::Ufbx;
+		}
+		if (extension == ".obj") {
+			return MeshImporter::Obj;
+		}
+		return MeshImporter::Assimp;
+	}
+
+	void MeshModel::Import(AssimpBuilder& builder, const std::string& filepath, MeshImporter importer) {
+		switch (importer) {
+		case MeshImporter::Ufbx:
+			builder.LoadMeshModelUfbx(filepath);
+			break;
+		case MeshImporter::Obj:
+			builder.LoadMeshModelObj(filepath);
+			break;
+		default:
+			builder.LoadMeshModel(filepath);
+			break;
+		}
 	}
 
 	void MeshModel::CopyMeshes(std::vector<Mesh> const& meshes) {
@@ -37,59 +130,197 @@ namespace RVK {
 		}
 	}
 
-	void MeshModel::CreateVertexBuffers(const std::vector<Vertex>& vertices) {
-		m_vertexCount = static_cast<u32>(vertices.size());
-		VK_ASSERT(m_vertexCount >= 3, "Vertex count must be at least 3");
-		VkDeviceSize bufferSize = sizeof(vertices[0]) * m_vertexCount;
-		u32 vertexSize = sizeof(vertices[0]);
+	MeshModel::TextureImages MeshModel::DecodeTextures(const CookedMesh& cookedMesh) {
+		const CookedMeshHeader& header = cookedMesh.GetHeader();
+		std::vector<std::string> paths;
+		std::unordered_set<std::string> seen;
+		for (u32 i = 0; i < header.materialCount; i++) {
+			for (const CookedMaterial::TextureRef& ref : cookedMesh.GetMaterials()[i].textures) {
+				if (ref.pathLength) {
+					std::string path = cookedMesh.GetString(ref.pathOffset, ref.pathLength);
+					if (seen.insert(path).second) {
+						paths.push_back(std::move(path));
+					}
+				}
+			}
+		}
+
+		// cooked textures come back without pixels, the streamer reads their mips later
+		std::vector<Texture::Image> images;
+		Texture::DecodeAll(paths, true, images, true);
+
+		TextureImages textures;
+		for (auto& image : images) {
+			std::string path = image.fileName;
+			textures.emplace(std::move(path), std::move(image));
+		}
+		return textures;
+	}
+
+	void MeshModel::LoadCookedMeshes(const CookedMesh& cookedMesh, TextureImages& decodedTextures) {
+		const CookedMeshHeader& header = cookedMesh.GetHeader();
+		if (decodedTextures.empty()) {
+			decodedTextures = DecodeTextures(cookedMesh);
+		}
 
-		RVKBuffer stagingBuffer{
-			vertexSize,
-			m_vertexCount,
-			VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+		// materials share textures the same way the importer does, one load per file
+		std::unordered_map<std::string, std::shared_ptr<Texture>> textures;
+		// stands in for missing files, the material then renders as if it had no such map
+		std::shared_ptr<Texture> fallback;
+		static constexpr std::array<u32, Material::NUM_TEXTURES> TEXTURE_FEATURES = {
+			Material::HAS_DIFFUSE_MAP | Material::HAS_DIFFUSE_ATLAS,
+			Material::HAS_NORMAL_MAP,
+			Material::HAS_ROUGHNESS_MAP,
+			Material::HAS_METALLIC_MAP,
+			Material::HAS_ROUGHNESS_METALLIC_MAP,
+			Material::HAS_EMISSIVE_MAP,
 		};
+		std::vector<Material> materials(header.materialCount);
+		for (u32 i = 0; i < header.materialCount; i++) {
+			const CookedMaterial& cookedMaterial = cookedMesh.GetMaterials()[i];
+			materials[i].m_PBRMaterial = cookedMaterial.pbrMaterial;
+
+			for (u32 t = 0; t < Material::NUM_TEXTURES; t++) {
+				const CookedMaterial::TextureRef& ref = cookedMaterial.textures[t];
+				if (!ref.pathLength) {
+					continue;
+				}
 
-		stagingBuffer.Map();
-		stagingBuffer.WriteToBuffer((void*)vertices.data());
+				std::string path = cookedMesh.GetString(ref.pathOffset, ref.pathLength);
+				auto& texture = textures[path];
+				if (!texture) {
+					texture = std::make_shared<Texture>();
+					auto decoded = decodedTextures.find(path);
+					bool loaded = decoded != decodedTextures.end() ? texture->Init(decoded->second, ref.sRGB != 0)
+						: texture->Init(path, ref.sRGB != 0);
+					if (!loaded) {
+						VK_CORE_WARN("MeshModel: texture '{0}' not found, using the checker texture", path);
+						if (!fallback) {
+							fallback = std::make_shared<Texture>();
+							fallback->Init("../models/checker.png", Texture::USE_SRGB);
+						}
+						texture = fallback;
+					}
+				}
+				if (texture == fallback) {
+					materials[i].m_PBRMaterial.features &= ~TEXTURE_FEATURES[t];
+				}
+				materials[i].m_materialTextures[t] = texture;
+			}
+			// one set per material, textures packed into one atlas page share the image in it
+			materials[i].m_materialDescriptor = std::make_shared<MaterialDescriptor>(materials[i], materials[i].m_materialTextures);
+		}
+
+		m_meshesMap.resize(header.meshCount);
+		for (u32 i = 0; i < header.meshCount; i++) {
+			const CookedSubmesh& cookedSubmesh = cookedMesh.GetMeshes()[i];
+			Mesh& mesh = m_meshesMap[i];
+			mesh.firstIndex = cookedSubmesh.firstIndex;
+			mesh.firstVertex = cookedSubmesh.firstVertex;
+			mesh.indexCount = cookedSubmesh.indexCount;
+			mesh.vertexCount = cookedSubmesh.vertexCount;
+			mesh.materialIndex = cookedSubmesh.materialIndex;
+			mesh.lodCount = std::clamp(cookedSubmesh.lodCount, 1u, MAX_MESH_LODS);
+			std::copy(std::begin(cookedSubmesh.lods), std::end(cookedSubmesh.lods), mesh.lods.begin());
+			for (u32 lod = 1; lod < mesh.lodCount; lod++) {
+				if (u64(mesh.lods[lod - 1].firstIndex) + mesh.lods[lod - 1].indexCount > header.indexCount) {
+					mesh.lodCount = lod;
+					break;
+				}
+			}
+			if (u64(cookedSubmesh.firstMeshlet) + cookedSubmesh.meshletCount <= header.meshletCount) {
+				mesh.firstMeshlet = cookedSubmesh.firstMeshlet;
+				mesh.meshletCount = cookedSubmesh.meshletCount;
+			}
+			if (mesh.materialIndex < materials.size()) {
+				mesh.material = materials[mesh.materialIndex];
+			}
+		}
+	}
 
-		m_vertexBuffer = std::make_unique<RVKBuffer>(
-			vertexSize,
-			m_vertexCount,
-			VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+	void MeshModel::FindLodErrors() {
+		m_lodCount = 1;
+		for (const auto& mesh : m_meshesMap) {
+			m_lodCount = std::max(m_lodCount, mesh.lodCount);
+		}
 
-		RVKDevice::s_rvkDevice->CopyBuffer(stagingBuffer.GetBuffer(), m_vertexBuffer->GetBuffer(), bufferSize);
+		// a submesh out of levels keeps drawing its last one, its error counts for the rest
+		m_lodErrors.fill(0.0f);
+		for (u32 lod = 1; lod < m_lodCount; lod++) {
+			for (const auto& mesh : m_meshesMap) {
+				m_lodErrors[lod] = std::max(m_lodErrors[lod], mesh.GetLod(lod).error);
+			}
+		}
 	}
 
-	void MeshModel::CreateIndexBuffers(const std::vector<u32>& indices) {
-		m_indexCount = static_cast<u32>(indices.size());
-		m_hasIndexBuffer = m_indexCount > 0;
+	void MeshModel::FindAlphaTestedMeshes(const std::function<float(u32)>& vertexAlpha) {
+		// same test as simple_shader.frag: the diffuse map times the diffuse color, or the vertex color
+		for (auto& mesh : m_meshesMap) {
+			const Material& material = mesh.material;
+			const auto& diffuseMap = material.m_materialTextures[Material::DIFFUSE_MAP_INDEX];
+			if ((material.m_PBRMaterial.features & Material::HAS_DIFFUSE_MAP) && diffuseMap) {
+				mesh.alphaTest = diffuseMap->GetMinAlpha() * material.m_PBRMaterial.diffuseColor.a < 0.5f;
+			}
+			else {
+				mesh.alphaTest = false;
+				for (u32 i = mesh.firstVertex; i < mesh.firstVertex + mesh.vertexCount; i++) {
+					if (vertexAlpha(i) < 0.5f) {
+						mesh.alphaTest = true;
+						break;
+					}
+				}
+			}
+			m_hasAlphaTestedMeshes |= mesh.alphaTest;
+		}
+	}
 
-		if (!m_hasIndexBuffer) {
+	void MeshModel::RequestTextureMips(float screenSize) const {
+		if (!TextureStreamer::s_textureStreamer) {
 			return;
 		}
+		for (const auto& mesh : m_meshesMap) {
+			for (const auto& texture : mesh.material.m_materialTextures) {
+				if (texture && texture->IsStreamed()) {
+					TextureStreamer::s_textureStreamer->Request(*texture, screenSize);
+				}
+			}
+		}
+	}
 
-		VkDeviceSize bufferSize = sizeof(indices[0]) * m_indexCount;
-		u32 indexSize = sizeof(indices[0]);
+	MeshModel::MemoryUsage MeshModel::GetMemoryUsage() const {
+		MemoryUsage usage{};
+		usage.cpuBytes = sizeof(MeshModel) + m_meshesMap.size() * sizeof(Mesh) + m_meshletCuller.GetMemorySize();
 
-		RVKBuffer stagingBuffer{
-			indexSize,
-			m_indexCount,
-			VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-		};
+		u64 vertexSize = m_vertexFormat == VertexFormat::Compressed ? sizeof(CompressedVertex) : sizeof(Vertex) + sizeof(glm::vec3);
+		usage.gpuBytes = vertexSize * m_geometry.vertexCount + m_geometry.GetIndexSize() * m_geometry.indexCount;
 
-		stagingBuffer.Map();
-		stagingBuffer.WriteToBuffer((void*)indices.data());
+		std::unordered_set<const Texture*> textures;
+		for (const auto& mesh : m_meshesMap) {
+			for (const auto& texture : mesh.material.m_materialTextures) {
+				if (texture && textures.insert(texture.get()).second) {
+					usage.gpuBytes += texture->GetMemorySize();
+				}
+			}
+		}
+		return usage;
+	}
 
-		m_indexBuffer = std::make_unique<RVKBuffer>(
-			indexSize,
-			m_indexCount,
-			VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+	void MeshModel::SetPositionDecode() {
+		if (m_vertexFormat == VertexFormat::Compressed) {
+			m_positionDecode = glm::translate(glm::mat4(1.0f), m_boundsMin) * glm::scale(glm::mat4(1.0f), m_boundsMax - m_boundsMin);
+		}
+		else {
+			m_positionDecode = glm::mat4(1.0f);
+		}
+	}
 
-		RVKDevice::s_rvkDevice->CopyBuffer(stagingBuffer.GetBuffer(), m_indexBuffer->GetBuffer(), bufferSize);
+	void MeshModel::CreateGeometry(const void* vertices, u32 vertexSize, u32 vertexCount, const glm::vec3* positions,
+		const u32* indices, u32 indexCount) {
+		VK_ASSERT(vertexCount >= 3, "Vertex count must be at least 3");
+		m_hasIndexBuffer = indexCount > 0;
+
+		m_arena = RVKGeometryArena::s_geometryArena;
+		m_geometry = m_arena->Allocate(m_vertexFormat, vertexSize, vertices, positions, vertexCount, indices, indexCount);
 	}
 
 	void MeshModel::BindDescriptors(const FrameInfo& frameInfo, const VkPipelineLayout& pipelineLayout, Mesh& mesh) {
@@ -97,6 +328,7 @@ namespace RVK {
 		mesh.material.m_materialBuffer->WriteToBuffer(&mesh.material.m_PBRMaterial);
 		mesh.material.m_materialBuffer->Flush();
 
+		mesh.material.m_materialDescriptor->Refresh();
 		const VkDescriptorSet& materialDescriptorSet = mesh.material.m_materialDescriptor->GetDescriptorSet();
 
 		std::vector<VkDescriptorSet> descriptorSets = { frameInfo.globalDescriptorSet, materialDescriptorSet };
@@ -116,28 +348,90 @@ namespace RVK {
 			sizeof(Material::PBRMaterial), &mesh.material.m_PBRMaterial);
 	}
 
-	void MeshModel::Draw(const FrameInfo& frameInfo, const VkPipelineLayout& pipelineLayout) {
-		for (auto& mesh : m_meshesMap) {
-			BindDescriptors(frameInfo, pipelineLayout, mesh);
-			DrawMesh(frameInfo.commandBuffer, mesh);
+	void MeshModel::Draw(const FrameInfo& frameInfo, const VkPipelineLayout& pipelineLayout, u32 lod, const MeshletDrawList* visible) {
+		// submeshes of one material share its set, cooked models bind it once for all of them in a row
+		const MaterialDescriptor* boundMaterial = nullptr;
+		for (u32 i = 0; i < m_meshesMap.size(); i++) {
+			if (m_meshesMap[i].material.m_materialDescriptor.get() != boundMaterial) {
+				BindDescriptors(frameInfo, pipelineLayout, m_meshesMap[i]);
+				boundMaterial = m_meshesMap[i].material.m_materialDescriptor.get();
+			}
+			DrawSubmesh(frameInfo.commandBuffer, i, lod, visible);
 		}
 	}
 
-	void MeshModel::DrawMesh(VkCommandBuffer commandBuffer, Mesh mesh) {
+	void MeshModel::DrawSubmesh(VkCommandBuffer commandBuffer, u32 meshIndex, u32 lod, const MeshletDrawList* visible) {
+		const Mesh& mesh = m_meshesMap[meshIndex];
+		if (lod > 0 || !m_hasIndexBuffer || !visible || visible->meshOffsets.size() != m_meshesMap.size() + 1) {
+			DrawMesh(commandBuffer, mesh, lod);
+			return;
+		}
+
+		for (u32 r = visible->meshOffsets[meshIndex]; r < visible->meshOffsets[meshIndex + 1]; r++) {
+			const IndexRange& range = visible->ranges[r];
+			vkCmdDrawIndexed(commandBuffer, range.indexCount, 1, m_geometry.firstIndex + range.firstIndex,
+				static_cast<s32>(m_geometry.baseVertex + mesh.firstVertex), 0);
+		}
+	}
+
+	void MeshModel::CullMeshlets(const MeshletCullView& view, MeshletDrawList& drawList) const {
+		drawList.Clear();
+		drawList.meshOffsets.reserve(m_meshesMap.size() + 1);
+		for (const auto& mesh : m_meshesMap) {
+			drawList.meshOffsets.push_back(static_cast<u32>(drawList.ranges.size()));
+			if (mesh.meshletCount == 0) {
+				// nothing to cull with, the whole mesh is one range
+				drawList.ranges.push_back({ mesh.firstIndex, mesh.indexCount });
+				continue;
+			}
+
+			// the inside of alpha tested meshes shows through the holes
+			MeshletCullView meshView = view;
+			meshView.backfaceCulling &= !mesh.alphaTest;
+			drawList.visibleMeshlets += m_meshletCuller.Cull(meshView, mesh.firstMeshlet, mesh.meshletCount, drawList.ranges);
+			drawList.totalMeshlets += mesh.meshletCount;
+		}
+		drawList.meshOffsets.push_back(static_cast<u32>(drawList.ranges.size()));
+	}
+
+	void MeshModel::DrawMesh(VkCommandBuffer commandBuffer, const Mesh& mesh, u32 lod) {
 		if (m_hasIndexBuffer) {
-			vkCmdDrawIndexed(commandBuffer, mesh.indexCount, 1, mesh.firstIndex, mesh.firstVertex, 0);
+			MeshLod meshLod = mesh.GetLod(lod);
+			vkCmdDrawIndexed(commandBuffer, meshLod.indexCount, 1, m_geometry.firstIndex + meshLod.firstIndex,
+				static_cast<s32>(m_geometry.baseVertex + mesh.firstVertex), 0);
 		}
 		else {
-			vkCmdDraw(commandBuffer, mesh.vertexCount, 1, mesh.firstVertex, 0);
+			vkCmdDraw(commandBuffer, mesh.vertexCount, 1, m_geometry.baseVertex + mesh.firstVertex, 0);
 		}
 	}
-	void MeshModel::Bind(const FrameInfo& frameInfo, const VkPipelineLayout& pipelineLayout) {
-		VkBuffer buffers[] = { m_vertexBuffer->GetBuffer() };
-		VkDeviceSize offsets[] = { 0 };
-		vkCmdBindVertexBuffers(frameInfo.commandBuffer, 0, 1, buffers, offsets);
+	void MeshModel::Bind(VkCommandBuffer commandBuffer) {
+		m_arena->Bind(commandBuffer, m_geometry.binding);
+	}
 
-		if (m_hasIndexBuffer) {
-			vkCmdBindIndexBuffer(frameInfo.commandBuffer, m_indexBuffer->GetBuffer(), 0, VK_INDEX_TYPE_UINT32);
+	void MeshModel::BindPositions(VkCommandBuffer commandBuffer) {
+		// compressed positions are read out of the full vertices with the wider stride
+		m_arena->BindPositions(commandBuffer, m_geometry.binding);
+	}
+
+	void MeshModel::DrawOpaque(VkCommandBuffer commandBuffer, u32 lod, const MeshletDrawList* visible) {
+		for (u32 i = 0; i < m_meshesMap.size(); i++) {
+			if (!m_meshesMap[i].alphaTest) {
+				DrawSubmesh(commandBuffer, i, lod, visible);
+			}
+		}
+	}
+
+	void MeshModel::DrawAlphaTested(const FrameInfo& frameInfo, const VkPipelineLayout& pipelineLayout, u32 lod, const MeshletDrawList* visible) {
+		const MaterialDescriptor* boundMaterial = nullptr;
+		for (u32 i = 0; i < m_meshesMap.size(); i++) {
+			if (!m_meshesMap[i].alphaTest) {
+				continue;
+			}
+			if (m_meshesMap[i].material.m_materialDescriptor.get() != boundMaterial) {
+				BindDescriptors(frameInfo, pipelineLayout, m_meshesMap[i]);
+				boundMaterial = m_meshesMap[i].material.m_materialDescriptor.get();
+			}
+			DrawSubmesh(frameInfo.commandBuffer, i, lod, visible);
 		}
 	}
 
@@ -160,6 +454,75 @@ namespace RVK {
 		return attributeDescriptions;
 	}
 
+	std::vector<VkVertexInputBindingDescription> Vertex::GetPositionBindingDescriptions() {
+		std::vector<VkVertexInputBindingDescription> bindingDescriptions(1);
+		bindingDescriptions[0].binding = 0;
+		bindingDescriptions[0].stride = sizeof(glm::vec3);
+		bindingDescriptions[0].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+		return bindingDescriptions;
+	}
+
+	std::vector<VkVertexInputAttributeDescription> Vertex::GetPositionAttributeDescriptions() {
+		return { { 0, 0, VK_FORMAT_R32G32B32_SFLOAT, 0 } };
+	}
+
+	CompressedVertex CompressedVertex::Encode(const Vertex& vertex, const glm::vec3& boundsMin, const glm::vec3& boundsMax) {
+		CompressedVertex compressed{};
+
+		glm::vec3 extent = boundsMax - boundsMin;
+		for (u32 i = 0; i < 3; i++) {
+			float t = extent[i] > 0.0f ? (vertex.position[i] - boundsMin[i]) / extent[i] : 0.0f;
+			compressed.position[i] = static_cast<u16>(std::round(glm::clamp(t, 0.0f, 1.0f) * 65535.0f));
+		}
+
+		// project onto the octahedron, the lower half folds over the diagonals
+		glm::vec3 normal = vertex.normal;
+		float length = std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+		glm::vec2 octahedral = length > 0.0f ? glm::vec2(normal.x, normal.y) / length : glm::vec2(0.0f);
+		if (normal.z < 0.0f) {
+			glm::vec2 signs{ octahedral.x >= 0.0f ? 1.0f : -1.0f, octahedral.y >= 0.0f ? 1.0f : -1.0f };
+			octahedral = (1.0f - glm::abs(glm::vec2(octahedral.y, octahedral.x))) * signs;
+		}
+		for (u32 i = 0; i < 2; i++) {
+			compressed.normal[i] = static_cast<s16>(std::round(glm::clamp(octahedral[i], -1.0f, 1.0f) * 32767.0f));
+		}
+
+		compressed.uv[0] = glm::packHalf1x16(vertex.uv.x);
+		compressed.uv[1] = glm::packHalf1x16(vertex.uv.y);
+
+		// 8 bits in linear space band badly in the darks
+		glm::vec3 color = glm::pow(glm::clamp(glm::vec3(vertex.color), 0.0f, 1.0f), glm::vec3(1.0f / 2.2f));
+		for (u32 i = 0; i < 3; i++) {
+			compressed.color[i] = static_cast<u8>(std::round(color[i] * 255.0f));
+		}
+		compressed.color[3] = static_cast<u8>(std::round(glm::clamp(vertex.color.a, 0.0f, 1.0f) * 255.0f));
+		return compressed;
+	}
+
+	std::vector<VkVertexInputBindingDescription> CompressedVertex::GetBindingDescriptions() {
+		std::vector<VkVertexInputBindingDescription> bindingDescriptions(1);
+		bindingDescriptions[0].binding = 0;
+		bindingDescriptions[0].stride = sizeof(CompressedVertex);
+		bindingDescriptions[0].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+		return bindingDescriptions;
+	}
+
+	// same locations as Vertex, the shaders decode the normal and color when COMPRESSED_VERTEX is set
+	std::vector<VkVertexInputAttributeDescription> CompressedVertex::GetAttributeDescriptions() {
+		std::vector<VkVertexInputAttributeDescription> attributeDescriptions{};
+
+		attributeDescriptions.push_back({ 0, 0, VK_FORMAT_R16G16B16A16_UNORM, offsetof(CompressedVertex, position) });
+		attributeDescriptions.push_back({ 1, 0, VK_FORMAT_R8G8B8A8_UNORM, offsetof(CompressedVertex, color) });
+		attributeDescriptions.push_back({ 2, 0, VK_FORMAT_R16G16_SNORM, offsetof(CompressedVertex, normal) });
+		attributeDescriptions.push_back({ 3, 0, VK_FORMAT_R16G16_SFLOAT, offsetof(CompressedVertex, uv) });
+
+		return attributeDescriptions;
+	}
+
+	std::vector<VkVertexInputAttributeDescription> CompressedVertex::GetPositionAttributeDescriptions() {
+		return { { 0, 0, VK_FORMAT_R16G16B16A16_UNORM, offsetof(CompressedVertex, position) } };
+	}
+
 	void MeshModel::AssimpBuilder::LoadMeshModel(const std::string& filepath) {
 		// Import model "scene"
 		Assimp::Importer importer;
@@ -175,6 +538,20 @@ namespace RVK {
 
 		// Load in all our meshes
 		LoadNode(scene->mRootNode, scene);
+		ComputeBounds();
+	}
+
+	void MeshModel::AssimpBuilder::ComputeBounds() {
+		if (vertices.empty()) {
+			boundsMin = boundsMax = glm::vec3{ 0.0f };
+			return;
+		}
+
+		boundsMin = boundsMax = vertices[0].position;
+		for (const auto& vertex : vertices) {
+			boundsMin = glm::min(boundsMin, vertex.position);
+			boundsMax = glm::max(boundsMax, vertex.position);
+		}
 	}
 
 	void MeshModel::AssimpBuilder::LoadMaterials(const aiScene* scene) {
@@ -255,14 +632,10 @@ namespace RVK {
 
 	void MeshModel::AssimpBuilder::LoadMap(const aiMaterial* fbxMaterial, aiTextureType textureType, int materialIndex) {
 		Material& material = materials[materialIndex];
-		Material::PBRMaterial& pbrMaterial = material.m_PBRMaterial;
-		Material::MaterialTextures& tmpTextures = material.m_materialTextures;
 		
 		u32 textureCount = fbxMaterial->GetTextureCount(textureType);
 		if (!textureCount) {
-			auto texture = LoadTexture("../models/checker.png", Texture::USE_SRGB);
-			tmpTextures[Material::DIFFUSE_MAP_INDEX] = texture;
-			pbrMaterial.diffuseColor.a = 0.0f;
+			AssignDiffuseMap(material, "");
 			return;
 		}
 
@@ -274,12 +647,7 @@ namespace RVK {
 			switch (textureType) {
 				// LoadTexture is inside switch statement for sRGB and UNORM
 			case aiTextureType_DIFFUSE: {
-				auto texture = LoadTexture(filepath, Texture::USE_SRGB);
-				if (texture) {
-					//textures.push_back(texture);
-					tmpTextures[Material::DIFFUSE_MAP_INDEX] = texture;
-					pbrMaterial.features |= Material::HAS_DIFFUSE_MAP;
-				}
+				AssignDiffuseMap(material, filepath);
 				break;
 			}
 			default: {
@@ -289,7 +657,34 @@ namespace RVK {
 		}
 	}
 
+	// an empty filepath means the material has no diffuse map
+	void MeshModel::AssimpBuilder::AssignDiffuseMap(Material& material, const std::string& filepath) {
+		Material::PBRMaterial& pbrMaterial = material.m_PBRMaterial;
+		Material::MaterialTextures& tmpTextures = material.m_materialTextures;
+
+		if (filepath.empty()) {
+			auto texture = LoadTexture("../models/checker.png", Texture::USE_SRGB);
+			tmpTextures[Material::DIFFUSE_MAP_INDEX] = texture;
+			pbrMaterial.diffuseColor.a = 0.0f;
+			return;
+		}
+
+		auto texture = LoadTexture(filepath, Texture::USE_SRGB);
+		if (texture) {
+			tmpTextures[Material::DIFFUSE_MAP_INDEX] = texture;
+			pbrMaterial.features |= Material::HAS_DIFFUSE_MAP;
+		}
+	}
+
 	std::shared_ptr<Texture> MeshModel::AssimpBuilder::LoadTexture(std::string const& filepath, bool useSRGB) {
+		// only the path and color space, enough for the cooker to reference it
+		if (cpuOnly) {
+			auto texture = std::make_shared<Texture>();
+			texture->SetFilename(filepath);
+			texture->SetSRGB(useSRGB);
+			return texture;
+		}
+
 		std::shared_ptr<Texture> tmpTexture;
 		bool loadSucess = false;
 
@@ -341,6 +736,7 @@ namespace RVK {
 		indices.resize(numIndicesBefore + numIndices);
 
 		Mesh& mesh = meshes[meshIndex];
+		mesh.materialIndex = aimesh->mMaterialIndex;
 		mesh.firstVertex = static_cast<u32>(numVerticesBefore);
 		mesh.firstIndex = static_cast<u32>(numIndicesBefore);
 		mesh.vertexCount = numVertices;
@@ -409,7 +805,9 @@ namespace RVK {
 		}
 		if (materialIndex != -1) {
 			mesh.material = materials[materialIndex];
-			mesh.material.m_materialDescriptor = std::make_shared<MaterialDescriptor>(mesh.material, mesh.material.m_materialTextures);
+			if (!cpuOnly) {
+				mesh.material.m_materialDescriptor = std::make_shared<MaterialDescriptor>(mesh.material, mesh.material.m_materialTextures);
+			}
 		}
 
 		VK_CORE_INFO("material assigned (Assimp): material index {0}", materialIndex);
@@ -2,8 +2,10 @@
 
 #include "Framework/Vulkan/VKUtils.h"
 #include "Framework/Vulkan/RVKBuffer.h"
+#include "Framework/Vulkan/RVKGeometryArena.h"
 #include "Framework/Materials.h"
 #include "Framework/Texture.h"
+#include "Framework/Meshlets.h"
 
 #include <assimp/Importer.hpp>
 #include <assimp/postprocess.h>
@@ -11,7 +13,20 @@
 
 #include "ufbx/ufbx.h"
 
+#ifndef GLM_ENABLE_EXPERIMENTAL
+#define GLM_ENABLE_EXPERIMENTAL
+#endif
+#include <glm/gtx/hash.hpp>
+
 namespace RVK {
+	enum class VertexFormat : u32 {
+		// Vertex, 48 bytes, plus a separate float position stream for the depth prepass
+		Full = 0,
+		// CompressedVertex, 20 bytes, the depth prepass reads the positions out of it
+		Compressed,
+		Count
+	};
+
 	struct Vertex {
 		glm::vec3 position{};
 		glm::vec4 color{};
@@ -20,6 +35,9 @@ namespace RVK {
 
 		static std::vector<VkVertexInputBindingDescription> GetBindingDescriptions();
 		static std::vector<VkVertexInputAttributeDescription> GetAttributeDescriptions();
+		// position only stream used by the depth prepass
+		static std::vector<VkVertexInputBindingDescription> GetPositionBindingDescriptions();
+		static std::vector<VkVertexInputAttributeDescription> GetPositionAttributeDescriptions();
 
 		bool operator==(const Vertex& other) const {
 			return position == other.position && color == other.color && normal == other.normal &&
@@ -27,6 +45,46 @@ namespace RVK {
 		}
 	};
 
+	// Quantized at cook time. Positions are 16 bit unorm within the model bounds and get expanded
+	// by the matrix from MeshModel::GetPositionDecode, so shaders read them like float positions.
+	struct CompressedVertex {
+		u16 position[4];  // w is unused
+		s16 normal[2];    // octahedral
+		u16 uv[2];        // half floats
+		u8 color[4];      // rgb gamma 2.2 encoded, alpha linear
+
+		static CompressedVertex Encode(const Vertex& vertex, const glm::vec3& boundsMin, const glm::vec3& boundsMax);
+		float GetAlpha() const { return color[3] / 255.0f; }
+
+		static std::vector<VkVertexInputBindingDescription> GetBindingDescriptions();
+		static std::vector<VkVertexInputAttributeDescription> GetAttributeDescriptions();
+		static std::vector<VkVertexInputAttributeDescription> GetPositionAttributeDescriptions();
+	};
+	static_assert(sizeof(CompressedVertex) == 20);
+}  // namespace RVK
+
+namespace std {
+	template <>
+	struct hash<RVK::Vertex> {
+		size_t operator()(RVK::Vertex const& vertex) const {
+			size_t seed = 0;
+			HashCombine(seed, vertex.position, vertex.color, vertex.normal, vertex.uv);
+			return seed;
+		}
+	};
+}  // namespace std
+
+namespace RVK {
+	// levels per submesh, the full mesh included
+	static constexpr u32 MAX_MESH_LODS = 4;
+
+	struct MeshLod {
+		u32 firstIndex;
+		u32 indexCount;
+		// distance to the full mesh in model units
+		float error;
+	};
+
 	struct Mesh
 	{
 		u32 firstIndex;
@@ -34,7 +92,23 @@ namespace RVK {
 		u32 indexCount;
 		u32 vertexCount;
 		//u32 instanceCount;
+		// into the builder's materials
+		u32 materialIndex = ~0u;
 		Material material;
+		// alpha < 0.5 is discarded somewhere on the mesh
+		bool alphaTest = false;
+		// the simplified levels, they share the vertices with the full mesh
+		std::array<MeshLod, MAX_MESH_LODS - 1> lods{};
+		u32 lodCount = 1;
+		// into the model's meshlets, they cover the full mesh only
+		u32 firstMeshlet = 0;
+		u32 meshletCount = 0;
+
+		// lod 0 is the full mesh, levels past the last one the mesh has clamp to it
+		MeshLod GetLod(u32 lod) const {
+			lod = std::min(lod, lodCount - 1);
+			return lod == 0 ? MeshLod{ firstIndex, indexCount, 0.0f } : lods[lod - 1];
+		}
 		//VkDescriptorSet samplerDescriptorSet;
 
 
@@ -49,6 +123,16 @@ namespace RVK {
 		//void CreateIndexBuffers(const std::vector<u32>& indices);
 	};
 
+	class CookedMesh;
+
+	enum class MeshImporter : u32 {
+		// ufbx for .fbx, the OBJ loader for .obj, Assimp for everything else
+		Auto = 0,
+		Assimp,
+		Ufbx,
+		Obj
+	};
+
 	class MeshModel {
 	public:
 		struct AssimpBuilder {
@@ -56,6 +140,11 @@ namespace RVK {
 			std::vector<u32> indices{};
 			std::vector<Mesh> meshes{};
 			std::vector<Material> materials{};
+			std::vector<Meshlet> meshlets{};
+			glm::vec3 boundsMin{ 0.0f };
+			glm::vec3 boundsMax{ 0.0f };
+			// textures are named but not loaded and there are no descriptors, so no device is needed
+			bool cpuOnly = false;
 			//std::vector<std::shared_ptr<Texture>> textures;
 			//std::vector<VkDescriptorSet> samplerDescriptorSets;
 
@@ -67,34 +156,107 @@ namespace RVK {
 			void LoadMap(const aiMaterial* fbxMaterial, aiTextureType textureType, int materialIndex);
 			std::shared_ptr<Texture> LoadTexture(std::string const& filepath, bool useSRGB);
 			void AssignMaterial(Mesh& submesh, int const materialIndex);
+			void AssignDiffuseMap(Material& material, const std::string& filepath);
+			void ComputeBounds();
+
+			// same output as LoadMeshModel, meshes are triangulated and deduplicated in parallel
+			void LoadMeshModelUfbx(const std::string& filepath);
+			void LoadMaterialsUfbx(const ufbx_scene* scene);
+
+			// chunks of the file are parsed in parallel, vertices are deduplicated per mesh
+			void LoadMeshModelObj(const std::string& filepath);
+			std::unordered_map<std::string, u32> LoadMaterialsObj(const std::string& filepath);
+		};
+
+		struct MemoryUsage {
+			u64 cpuBytes = 0;
+			u64 gpuBytes = 0;
 		};
 
-		MeshModel(const MeshModel::AssimpBuilder& builder);
+		MeshModel(const MeshModel::AssimpBuilder& builder, VertexFormat vertexFormat = VertexFormat::Full);
+		// the pixels or cooked mips of every texture the cooked materials reference, by path
+		using TextureImages = std::unordered_map<std::string, Texture::Image>;
+
+		// textures missing from decodedTextures are decoded on the calling thread's ParallelFor
+		MeshModel(const CookedMesh& cookedMesh, TextureImages&& decodedTextures = {});
 		~MeshModel();
 
 		NO_COPY(MeshModel)
 
-		static std::unique_ptr<MeshModel> CreateMeshModelFromFile(const std::string& filepath);
+		// loads the cooked .rvkmesh next to the source, cooking it first if the source changed
+		static std::unique_ptr<MeshModel> CreateMeshModelFromFile(
+			const std::string& filepath,
+			MeshImporter importer = MeshImporter::Auto,
+			VertexFormat vertexFormat = VertexFormat::Full);
+		static MeshImporter ResolveImporter(const std::string& filepath, MeshImporter importer);
+		// the decode half of the texture loads, runs on any thread, textures get cooked for streaming
+		static TextureImages DecodeTextures(const CookedMesh& cookedMesh);
+		static void Import(AssimpBuilder& builder, const std::string& filepath, MeshImporter importer);
+
+		// binds the arena buffers, skip it when the last model drawn had the same GetGeometryBinding
+		void Bind(VkCommandBuffer commandBuffer);
+		// without a draw list, or past lod 0, every submesh is drawn whole
+		void Draw(const FrameInfo& frameInfo, const VkPipelineLayout& pipelineLayout, u32 lod = 0, const MeshletDrawList* visible = nullptr);
+		void DrawMesh(VkCommandBuffer commandBuffer, const Mesh& mesh, u32 lod = 0);
+
+		// depth prepass, has to draw the same lod and meshlets as the main pass
+		void BindPositions(VkCommandBuffer commandBuffer);
+		void DrawOpaque(VkCommandBuffer commandBuffer, u32 lod = 0, const MeshletDrawList* visible = nullptr);
+		void DrawAlphaTested(const FrameInfo& frameInfo, const VkPipelineLayout& pipelineLayout, u32 lod = 0, const MeshletDrawList* visible = nullptr);
+
+		bool HasMeshlets() const { return !m_meshletCuller.IsEmpty(); }
+		u32 GetMeshletCount() const { return m_meshletCuller.GetCount(); }
+		// view in model space of the uncompressed positions
+		void CullMeshlets(const MeshletCullView& view, MeshletDrawList& drawList) const;
+		bool HasAlphaTestedMeshes() const { return m_hasAlphaTestedMeshes; }
 
-		void Bind(const FrameInfo& frameInfo, const VkPipelineLayout& pipelineLayout);
-		void Draw(const FrameInfo& frameInfo, const VkPipelineLayout& pipelineLayout);
-		void DrawMesh(VkCommandBuffer commandBuffer, Mesh mesh);
+		u32 GetLodCount() const { return m_lodCount; }
+		// the largest error of any submesh at that level, in model units
+		float GetLodError(u32 lod) const { return m_lodErrors[std::min(lod, m_lodCount - 1)]; }
+
+		const glm::vec3& GetBoundsMin() const { return m_boundsMin; }
+		const glm::vec3& GetBoundsMax() const { return m_boundsMax; }
+		VertexFormat GetVertexFormat() const { return m_vertexFormat; }
+		// models with the same binding draw without rebinding buffers in between
+		const RVKGeometryArena::Binding& GetGeometryBinding() const { return m_geometry.binding; }
+		// goes after the model matrix, expands compressed positions to model space
+		const glm::mat4& GetPositionDecode() const { return m_positionDecode; }
+		// buffers and textures on the GPU, submeshes and meshlet bounds on the CPU, shared textures count once
+		MemoryUsage GetMemoryUsage() const;
+		// screenSize is how many pixels the model spans, every streamed texture it uses asks for its mips
+		void RequestTextureMips(float screenSize) const;
 
 	private:
 		std::vector<Mesh> m_meshesMap{};
 
-		std::unique_ptr<RVKBuffer> m_vertexBuffer;
-		u32 m_vertexCount;
+		// placed in the scene wide arena, freed through the deletion queue
+		std::shared_ptr<RVKGeometryArena> m_arena;
+		RVKGeometryArena::Allocation m_geometry{};
+		VertexFormat m_vertexFormat = VertexFormat::Full;
+		glm::mat4 m_positionDecode{ 1.0f };
+		bool m_hasAlphaTestedMeshes = false;
 
 		bool m_hasIndexBuffer = false;
-		std::unique_ptr<RVKBuffer> m_indexBuffer;
-		u32 m_indexCount;
+
+		glm::vec3 m_boundsMin{ 0.0f };
+		glm::vec3 m_boundsMax{ 0.0f };
+
+		std::array<float, MAX_MESH_LODS> m_lodErrors{};
+		u32 m_lodCount = 1;
+
+		MeshletCuller m_meshletCuller;
 
 	private:
 		void CopyMeshes(std::vector<Mesh> const& meshes);
+		void LoadCookedMeshes(const CookedMesh& cookedMesh, TextureImages& decodedTextures);
+		void FindAlphaTestedMeshes(const std::function<float(u32)>& vertexAlpha);
+		void SetPositionDecode();
+		void FindLodErrors();
+		void DrawSubmesh(VkCommandBuffer commandBuffer, u32 meshIndex, u32 lod, const MeshletDrawList* visible);
 
-		void CreateVertexBuffers(const std::vector<Vertex>& vertices);
-		void CreateIndexBuffers(const std::vector<u32>& indices);
+		// positions only for VertexFormat::Full
+		void CreateGeometry(const void* vertices, u32 vertexSize, u32 vertexCount, const glm::vec3* positions,
+			const u32* indices, u32 indexCount);
 
 		void BindDescriptors(const FrameInfo& frameInfo, const VkPipelineLayout& pipelineLayout, Mesh& mesh);
 		void PushConstantsPbr(const FrameInfo& frameInfo, const VkPipelineLayout& pipelineLayout, const Mesh& mesh);
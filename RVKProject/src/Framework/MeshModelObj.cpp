@@ -0,0 +1,490 @@
+#include "Framework/MeshModel.h"
+#include "Framework/MappedFile.h"
+#include "Framework/Parallel.h"
+#include "Framework/Vulkan/MaterialDescriptor.h"
+
+#include <charconv>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+namespace RVK {
+	namespace {
+		constexpr u32 NO_INDEX = ~0u;
+		constexpr s32 MISSING = std::numeric_limits<s32>::min();
+		// lines per chunk don't matter much, there just have to be enough chunks to balance the threads
+		constexpr size_t MIN_CHUNK_SIZE = 256 * 1024;
+
+		enum RelativeBits : u8 {
+			RELATIVE_POSITION = 1,
+			RELATIVE_UV = 2,
+			RELATIVE_NORMAL = 4
+		};
+
+		// index as written in the file, negative ones are resolved against the chunk's own counts
+		// first and get the chunk base added after all chunks are parsed
+		struct ObjCorner {
+			s32 position;
+			s32 uv;
+			s32 normal;
+			u8 relative;
+		};
+
+		struct ObjMaterialSwitch {
+			// first triangle that uses the material
+			u32 triangle;
+			std::string name;
+		};
+
+		struct ObjChunk {
+			std::vector<glm::vec3> positions;
+			std::vector<glm::vec4> colors;
+			std::vector<glm::vec3> normals;
+			std::vector<glm::vec2> uvs;
+			// three per triangle, polygons are fanned while parsing
+			std::vector<ObjCorner> corners;
+			std::vector<ObjMaterialSwitch> materialSwitches;
+			std::vector<std::string> materialLibraries;
+			bool hasColors = false;
+		};
+
+		struct ObjResolvedCorner {
+			u32 position;
+			u32 uv;
+			u32 normal;
+		};
+
+		struct ObjGroup {
+			u32 materialIndex;
+			std::vector<ObjResolvedCorner> corners;
+			std::vector<Vertex> vertices;
+			std::vector<u32> indices;
+		};
+
+		class LineParser {
+		public:
+			LineParser(const char* begin, const char* end) : m_cursor{ begin }, m_end{ end } {}
+
+			void SkipSpaces() {
+				while (m_cursor < m_end && (*m_cursor == ' ' || *m_cursor == '\t' || *m_cursor == '\r')) {
+					m_cursor++;
+				}
+			}
+
+			std::string_view Token() {
+				SkipSpaces();
+				const char* start = m_cursor;
+				while (m_cursor < m_end && *m_cursor != ' ' && *m_cursor != '\t' && *m_cursor != '\r') {
+					m_cursor++;
+				}
+				return { start, static_cast<size_t>(m_cursor - start) };
+			}
+
+			std::string_view Rest() {
+				SkipSpaces();
+				const char* last = m_end;
+				while (last > m_cursor && (last[-1] == ' ' || last[-1] == '\t' || last[-1] == '\r')) {
+					last--;
+				}
+				return { m_cursor, static_cast<size_t>(last - m_cursor) };
+			}
+
+			bool Float(float& value) {
+				SkipSpaces();
+				auto result = std::from_chars(m_cursor, m_end, value);
+				if (result.ec != std::errc{}) {
+					return false;
+				}
+				m_cursor = result.ptr;
+				return true;
+			}
+
+			bool Int(s32& value) {
+				auto result = std::from_chars(m_cursor, m_end, value);
+				if (result.ec != std::errc{}) {
+					return false;
+				}
+				m_cursor = result.ptr;
+				return true;
+			}
+
+			bool Skip(char c) {
+				if (m_cursor < m_end && *m_cursor == c) {
+					m_cursor++;
+					return true;
+				}
+				return false;
+			}
+
+		private:
+			const char* m_cursor;
+			const char* m_end;
+		};
+
+		// position[/uv][/normal], 1 based, negative counts back from the last element
+		bool ParseCorner(LineParser& parser, const ObjChunk& chunk, ObjCorner& corner) {
+			corner = { MISSING, MISSING, MISSING, 0 };
+
+			auto resolve = [&corner](s32 index, size_t localCount, s32& out, u8 relativeBit) {
+				if (index > 0) {
+					out = index - 1;
+				}
+				else if (index < 0) {
+					out = static_cast<s32>(localCount) + index;
+					corner.relative |= relativeBit;
+				}
+			};
+
+			parser.SkipSpaces();
+			s32 index;
+			if (!parser.Int(index)) {
+				return false;
+			}
+			resolve(index, chunk.positions.size(), corner.position, RELATIVE_POSITION);
+
+			if (parser.Skip('/')) {
+				if (parser.Int(index)) {
+					resolve(index, chunk.uvs.size(), corner.uv, RELATIVE_UV);
+				}
+				if (parser.Skip('/') && parser.Int(index)) {
+					resolve(index, chunk.normals.size(), corner.normal, RELATIVE_NORMAL);
+				}
+			}
+			return true;
+		}
+
+		void ParseChunk(const char* begin, const char* end, ObjChunk& chunk) {
+			std::vector<ObjCorner> polygon;
+
+			const char* line = begin;
+			while (line < end) {
+				const char* lineEnd = static_cast<const char*>(std::memchr(line, '\n', end - line));
+				if (!lineEnd) {
+					lineEnd = end;
+				}
+
+				LineParser parser{ line, lineEnd };
+				std::string_view keyword = parser.Token();
+				if (keyword == "v") {
+					glm::vec3 position{ 0.0f };
+					parser.Float(position.x);
+					parser.Float(position.y);
+					parser.Float(position.z);
+					chunk.positions.push_back(position);
+
+					// vertex colors are an extension: v x y z r g b
+					glm::vec4 color{ 1.0f };
+					glm::vec3 rgb;
+					if (parser.Float(rgb.r) && parser.Float(rgb.g) && parser.Float(rgb.b)) {
+						color = glm::vec4(rgb, 1.0f);
+						chunk.hasColors = true;
+					}
+					chunk.colors.push_back(color);
+				}
+				else if (keyword == "vt") {
+					glm::vec2 uv{ 0.0f };
+					parser.Float(uv.x);
+					parser.Float(uv.y);
+					chunk.uvs.push_back(uv);
+				}
+				else if (keyword == "vn") {
+					glm::vec3 normal{ 0.0f };
+					parser.Float(normal.x);
+					parser.Float(normal.y);
+					parser.Float(normal.z);
+					chunk.normals.push_back(normal);
+				}
+				else if (keyword == "f") {
+					polygon.clear();
+					ObjCorner corner;
+					while (ParseCorner(parser, chunk, corner)) {
+						polygon.push_back(corner);
+					}
+					for (size_t i = 2; i < polygon.size(); i++) {
+						chunk.corners.push_back(polygon[0]);
+						chunk.corners.push_back(polygon[i - 1]);
+						chunk.corners.push_back(polygon[i]);
+					}
+				}
+				else if (keyword == "usemtl") {
+					chunk.materialSwitches.push_back({ static_cast<u32>(chunk.corners.size() / 3), std::string(parser.Rest()) });
+				}
+				else if (keyword == "mtllib") {
+					chunk.materialLibraries.emplace_back(parser.Rest());
+				}
+
+				line = lineEnd + 1;
+			}
+		}
+
+		// open addressing with linear probing, the table stores indices into the group's vertices
+		void DeduplicateGroup(ObjGroup& group, const std::vector<Vertex>& corners) {
+			size_t capacity = 16;
+			while (capacity < corners.size() * 2) {
+				capacity <<= 1;
+			}
+			const size_t mask = capacity - 1;
+			std::vector<u32> table(capacity, NO_INDEX);
+			std::hash<Vertex> hasher{};
+
+			group.vertices.reserve(corners.size() / 2);
+			group.indices.resize(corners.size());
+			for (size_t i = 0; i < corners.size(); i++) {
+				const Vertex& vertex = corners[i];
+				size_t slot = hasher(vertex) & mask;
+				while (table[slot] != NO_INDEX && !(group.vertices[table[slot]] == vertex)) {
+					slot = (slot + 1) & mask;
+				}
+
+				if (table[slot] == NO_INDEX) {
+					table[slot] = static_cast<u32>(group.vertices.size());
+					group.vertices.push_back(vertex);
+				}
+				group.indices[i] = table[slot];
+			}
+		}
+	}  // namespace
+
+	void MeshModel::AssimpBuilder::LoadMeshModelObj(const std::string& filepath) {
+		MappedFile file;
+		if (!file.Open(filepath)) {
+			throw std::runtime_error("Failed to load model! (" + filepath + ")");
+		}
+
+		// split at line ends into a few chunks per thread
+		const char* data = reinterpret_cast<const char*>(file.GetData());
+		const char* dataEnd = data + file.GetSize();
+		size_t chunkCount = std::max<size_t>(1, std::min<size_t>(
+			std::max(1u, std::thread::hardware_concurrency()) * 4, file.GetSize() / MIN_CHUNK_SIZE));
+		std::vector<const char*> chunkStarts{ data };
+		for (size_t i = 1; i < chunkCount; i++) {
+			const char* split = std::max(chunkStarts.back(), data + file.GetSize() * i / chunkCount);
+			const char* lineEnd = static_cast<const char*>(std::memchr(split, '\n', dataEnd - split));
+			if (!lineEnd) {
+				break;
+			}
+			chunkStarts.push_back(lineEnd + 1);
+		}
+		chunkStarts.push_back(dataEnd);
+
+		std::vector<ObjChunk> chunks(chunkStarts.size() - 1);
+		ParallelFor(static_cast<u32>(chunks.size()), [&](u32 i) {
+			ParseChunk(chunkStarts[i], chunkStarts[i + 1], chunks[i]);
+		});
+
+		// shared attribute streams, the chunk bases resolve the relative indices
+		std::vector<glm::vec3> positions;
+		std::vector<glm::vec4> colors;
+		std::vector<glm::vec3> normals;
+		std::vector<glm::vec2> uvs;
+		std::vector<std::array<s64, 3>> chunkBases(chunks.size());
+		bool hasColors = false;
+		for (size_t i = 0; i < chunks.size(); i++) {
+			ObjChunk& chunk = chunks[i];
+			chunkBases[i] = { static_cast<s64>(positions.size()), static_cast<s64>(uvs.size()), static_cast<s64>(normals.size()) };
+			positions.insert(positions.end(), chunk.positions.begin(), chunk.positions.end());
+			colors.insert(colors.end(), chunk.colors.begin(), chunk.colors.end());
+			normals.insert(normals.end(), chunk.normals.begin(), chunk.normals.end());
+			uvs.insert(uvs.end(), chunk.uvs.begin(), chunk.uvs.end());
+			hasColors |= chunk.hasColors;
+		}
+
+		std::unordered_map<std::string, u32> materialIndices;
+		for (const ObjChunk& chunk : chunks) {
+			for (const std::string& library : chunk.materialLibraries) {
+				auto libraryPath = std::filesystem::path(filepath).parent_path() / library;
+				materialIndices.merge(LoadMaterialsObj(libraryPath.string()));
+			}
+		}
+
+		// faces before any usemtl or with an unknown material get Assimp's default material
+		u32 defaultMaterial = NO_INDEX;
+		auto findMaterial = [&](const std::string& name) {
+			auto it = materialIndices.find(name);
+			if (it != materialIndices.end()) {
+				return it->second;
+			}
+			if (defaultMaterial == NO_INDEX) {
+				defaultMaterial = static_cast<u32>(materials.size());
+				Material& material = materials.emplace_back();
+				material.m_PBRMaterial.diffuseColor = glm::vec4(0.6f, 0.6f, 0.6f, 1.0f);
+				material.m_PBRMaterial.roughness = 0.1f;
+				material.m_PBRMaterial.metallic = 0.886f;
+				AssignDiffuseMap(material, "");
+			}
+			return defaultMaterial;
+		};
+
+		// one mesh per material, in order of first use
+		std::vector<ObjGroup> groups;
+		std::unordered_map<u32, size_t> groupOfMaterial;
+		auto findGroup = [&](const std::string& materialName) {
+			u32 materialIndex = findMaterial(materialName);
+			auto [it, inserted] = groupOfMaterial.try_emplace(materialIndex, groups.size());
+			if (inserted) {
+				groups.push_back({ materialIndex });
+			}
+			return it->second;
+		};
+		auto resolveIndex = [](s32 index, bool relative, s64 base, size_t count) {
+			if (index == MISSING) {
+				return NO_INDEX;
+			}
+			s64 resolved = relative ? base + index : index;
+			return resolved >= 0 && resolved < static_cast<s64>(count) ? static_cast<u32>(resolved) : NO_INDEX;
+		};
+
+		// the material carries over from one chunk to the next
+		size_t currentGroup = NO_INDEX;
+		for (size_t c = 0; c < chunks.size(); c++) {
+			const ObjChunk& chunk = chunks[c];
+			size_t nextSwitch = 0;
+			size_t triangleCount = chunk.corners.size() / 3;
+			for (size_t triangle = 0; triangle < triangleCount; triangle++) {
+				while (nextSwitch < chunk.materialSwitches.size() && chunk.materialSwitches[nextSwitch].triangle <= triangle) {
+					currentGroup = findGroup(chunk.materialSwitches[nextSwitch].name);
+					nextSwitch++;
+				}
+				if (currentGroup == NO_INDEX) {
+					currentGroup = findGroup("");
+				}
+
+				for (size_t corner = triangle * 3; corner < triangle * 3 + 3; corner++) {
+					const ObjCorner& objCorner = chunk.corners[corner];
+					groups[currentGroup].corners.push_back({
+						resolveIndex(objCorner.position, objCorner.relative & RELATIVE_POSITION, chunkBases[c][0], positions.size()),
+						resolveIndex(objCorner.uv, objCorner.relative & RELATIVE_UV, chunkBases[c][1], uvs.size()),
+						resolveIndex(objCorner.normal, objCorner.relative & RELATIVE_NORMAL, chunkBases[c][2], normals.size()) });
+				}
+			}
+		}
+
+		ParallelFor(static_cast<u32>(groups.size()), [&](u32 g) {
+			ObjGroup& group = groups[g];
+			const glm::vec4& diffuseColor = materials[group.materialIndex].m_PBRMaterial.diffuseColor;
+
+			std::vector<Vertex> corners(group.corners.size());
+			for (size_t i = 0; i + 2 < group.corners.size(); i += 3) {
+				// missing normals get the face normal, like aiProcess_GenNormals
+				glm::vec3 faceNormal{ 0.0f };
+				const ObjResolvedCorner* triangle = &group.corners[i];
+				if (triangle[0].normal == NO_INDEX || triangle[1].normal == NO_INDEX || triangle[2].normal == NO_INDEX) {
+					auto position = [&](u32 k) { return triangle[k].position != NO_INDEX ? positions[triangle[k].position] : glm::vec3{ 0.0f }; };
+					glm::vec3 cross = glm::cross(position(1) - position(0), position(2) - position(0));
+					float length = glm::length(cross);
+					faceNormal = length > 0.0f ? cross / length : glm::vec3{ 0.0f, 1.0f, 0.0f };
+				}
+
+				for (u32 k = 0; k < 3; k++) {
+					const ObjResolvedCorner& corner = triangle[k];
+					Vertex& vertex = corners[i + k];
+					vertex.position = corner.position != NO_INDEX ? positions[corner.position] : glm::vec3{ 0.0f };
+					vertex.normal = corner.normal != NO_INDEX ? normals[corner.normal] : faceNormal;
+					vertex.uv = corner.uv != NO_INDEX ? uvs[corner.uv] : glm::vec2{ 0.0f };
+
+					// same as the Assimp path: linearized vertex color times the diffuse color
+					if (hasColors && corner.position != NO_INDEX) {
+						const glm::vec4& color = colors[corner.position];
+						vertex.color = glm::vec4(glm::pow(glm::vec3(color), glm::vec3(2.2f)), color.a) * diffuseColor;
+					}
+					else {
+						vertex.color = diffuseColor;
+					}
+				}
+			}
+
+			DeduplicateGroup(group, corners);
+		});
+
+		meshes.clear();
+		meshes.resize(groups.size());
+		for (size_t g = 0; g < groups.size(); g++) {
+			ObjGroup& group = groups[g];
+			Mesh& mesh = meshes[g];
+			mesh.firstVertex = static_cast<u32>(vertices.size());
+			mesh.firstIndex = static_cast<u32>(indices.size());
+			mesh.vertexCount = static_cast<u32>(group.vertices.size());
+			mesh.indexCount = static_cast<u32>(group.indices.size());
+			mesh.materialIndex = group.materialIndex;
+
+			vertices.insert(vertices.end(), group.vertices.begin(), group.vertices.end());
+			indices.insert(indices.end(), group.indices.begin(), group.indices.end());
+
+			mesh.material = materials[mesh.materialIndex];
+			if (!cpuOnly) {
+				mesh.material.m_materialDescriptor = std::make_shared<MaterialDescriptor>(mesh.material, mesh.material.m_materialTextures);
+			}
+
+			VK_CORE_INFO("mesh loaded (OBJ): {0} vertices, {1} indices, material index {2}",
+				mesh.vertexCount, mesh.indexCount, mesh.materialIndex);
+		}
+
+		ComputeBounds();
+	}
+
+	std::unordered_map<std::string, u32> MeshModel::AssimpBuilder::LoadMaterialsObj(const std::string& filepath) {
+		std::unordered_map<std::string, u32> materialIndices;
+		std::ifstream file(filepath);
+		if (!file) {
+			VK_CORE_WARN("OBJ material library {0} not found", filepath);
+			return materialIndices;
+		}
+
+		// the map is assigned once the whole material is read, it depends on the diffuse alpha
+		bool hasMaterial = false;
+		std::string diffuseMap;
+		auto finishMaterial = [&]() {
+			if (hasMaterial) {
+				AssignDiffuseMap(materials.back(), diffuseMap);
+			}
+			diffuseMap.clear();
+		};
+
+		std::string line;
+		while (std::getline(file, line)) {
+			LineParser parser{ line.data(), line.data() + line.size() };
+			std::string_view keyword = parser.Token();
+			if (keyword == "newmtl") {
+				finishMaterial();
+				materialIndices[std::string(parser.Rest())] = static_cast<u32>(materials.size());
+				Material& material = materials.emplace_back();
+				// the defaults LoadProperties falls back to
+				material.m_PBRMaterial.roughness = 0.1f;
+				material.m_PBRMaterial.metallic = 0.886f;
+				hasMaterial = true;
+				continue;
+			}
+			if (!hasMaterial) {
+				continue;
+			}
+
+			Material::PBRMaterial& pbrMaterial = materials.back().m_PBRMaterial;
+			if (keyword == "Kd") {
+				parser.Float(pbrMaterial.diffuseColor.r);
+				parser.Float(pbrMaterial.diffuseColor.g);
+				parser.Float(pbrMaterial.diffuseColor.b);
+			}
+			else if (keyword == "Ke") {
+				parser.Float(pbrMaterial.emissiveColor.r);
+				parser.Float(pbrMaterial.emissiveColor.g);
+				parser.Float(pbrMaterial.emissiveColor.b);
+			}
+			else if (keyword == "Pr") {
+				parser.Float(pbrMaterial.roughness);
+			}
+			else if (keyword == "Pm") {
+				parser.Float(pbrMaterial.metallic);
+			}
+			else if (keyword == "map_Kd") {
+				// options before the file name aren't supported, the name is the last token
+				std::string_view rest = parser.Rest();
+				size_t space = rest.find_last_of(" \t");
+				std::string_view name = space == std::string_view::npos ? rest : rest.substr(space + 1);
+				diffuseMap = "../models/" + std::string(name);
+			}
+		}
+
+		finishMaterial();
+		return materialIndices;
+	}
+}  // namespace RVK
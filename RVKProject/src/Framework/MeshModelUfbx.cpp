@@ -0,0 +1,202 @@
+#include "Framework/MeshModel.h"
+#include "Framework/Parallel.h"
+#include "Framework/Vulkan/MaterialDescriptor.h"
+
+#include <filesystem>
+
+namespace RVK {
+	namespace {
+		// one node mesh and material, the same split Assimp makes
+		struct UfbxPart {
+			const ufbx_mesh* mesh;
+			const ufbx_mesh_part* part;
+			u32 materialIndex;
+		};
+
+		struct UfbxPartGeometry {
+			std::vector<Vertex> vertices;
+			std::vector<u32> indices;
+		};
+
+		glm::vec3 ToVec3(const ufbx_vec3& v) {
+			return { static_cast<float>(v.x), static_cast<float>(v.y), static_cast<float>(v.z) };
+		}
+
+		void LoadPartGeometry(const UfbxPart& part, const Material& material, UfbxPartGeometry& geometry) {
+			const ufbx_mesh* mesh = part.mesh;
+			std::vector<u32> triangleIndices(mesh->max_face_triangles * 3);
+
+			geometry.vertices.reserve(part.part->num_triangles * 3);
+			for (u32 faceIndex : part.part->face_indices) {
+				u32 numTriangles = ufbx_triangulate_face(
+					triangleIndices.data(), triangleIndices.size(), mesh, mesh->faces[faceIndex]);
+
+				for (u32 i = 0; i < numTriangles * 3; i++) {
+					u32 index = triangleIndices[i];
+
+					// zeroed so the memcmp in ufbx_generate_indices only sees the attributes
+					Vertex vertex{};
+					vertex.position = ToVec3(ufbx_get_vertex_vec3(&mesh->vertex_position, index));
+					vertex.normal = ToVec3(ufbx_get_vertex_vec3(&mesh->vertex_normal, index));
+					if (mesh->vertex_uv.exists) {
+						ufbx_vec2 uv = ufbx_get_vertex_vec2(&mesh->vertex_uv, index);
+						vertex.uv = { static_cast<float>(uv.x), static_cast<float>(uv.y) };
+					}
+
+					// same as the Assimp path: linearized vertex color times the diffuse color
+					if (mesh->vertex_color.exists) {
+						ufbx_vec4 color = ufbx_get_vertex_vec4(&mesh->vertex_color, index);
+						glm::vec3 linearColor = glm::pow(glm::vec3(color.x, color.y, color.z), glm::vec3(2.2f));
+						vertex.color = glm::vec4(linearColor, static_cast<float>(color.w)) * material.m_PBRMaterial.diffuseColor;
+					}
+					else {
+						vertex.color = material.m_PBRMaterial.diffuseColor;
+					}
+
+					geometry.vertices.push_back(vertex);
+				}
+			}
+
+			geometry.indices.resize(geometry.vertices.size());
+			if (geometry.vertices.empty()) {
+				return;
+			}
+
+			ufbx_vertex_stream stream{ geometry.vertices.data(), geometry.vertices.size(), sizeof(Vertex) };
+			ufbx_error error;
+			size_t vertexCount = ufbx_generate_indices(&stream, 1, geometry.indices.data(), geometry.indices.size(), nullptr, &error);
+			geometry.vertices.resize(vertexCount);
+		}
+	}  // namespace
+
+	void MeshModel::AssimpBuilder::LoadMeshModelUfbx(const std::string& filepath) {
+		ufbx_load_opts opts{};
+		opts.generate_missing_normals = true;
+
+		ufbx_error error;
+		ufbx_scene* scene = ufbx_load_file(filepath.c_str(), &opts, &error);
+		if (!scene) {
+			char message[1024];
+			ufbx_format_error(message, sizeof(message), &error);
+			throw std::runtime_error("Failed to load model! (" + filepath + ")\n" + message);
+		}
+
+		LoadMaterialsUfbx(scene);
+		meshes.clear();
+
+		// like LoadNode, instanced meshes are loaded once per node
+		std::vector<UfbxPart> parts;
+		u32 defaultMaterial = ~0u;
+		for (const ufbx_node* node : scene->nodes) {
+			const ufbx_mesh* mesh = node->mesh;
+			if (!mesh) {
+				continue;
+			}
+
+			for (const ufbx_mesh_part& part : mesh->material_parts) {
+				if (part.num_triangles == 0) {
+					continue;
+				}
+
+				u32 materialIndex;
+				if (part.index < mesh->materials.count) {
+					materialIndex = mesh->materials[part.index]->typed_id;
+				}
+				else {
+					// Assimp adds a default material for meshes without one
+					if (defaultMaterial == ~0u) {
+						defaultMaterial = static_cast<u32>(materials.size());
+						materials.emplace_back();
+						AssignDiffuseMap(materials.back(), "");
+					}
+					materialIndex = defaultMaterial;
+				}
+				parts.push_back({ mesh, &part, materialIndex });
+			}
+		}
+
+		std::vector<UfbxPartGeometry> geometries(parts.size());
+		ParallelFor(static_cast<u32>(parts.size()), [&](u32 i) {
+			LoadPartGeometry(parts[i], materials[parts[i].materialIndex], geometries[i]);
+		});
+
+		// indices stay relative to the mesh, DrawMesh offsets them by firstVertex
+		meshes.resize(parts.size());
+		for (size_t i = 0; i < parts.size(); i++) {
+			UfbxPartGeometry& geometry = geometries[i];
+			Mesh& mesh = meshes[i];
+			mesh.firstVertex = static_cast<u32>(vertices.size());
+			mesh.firstIndex = static_cast<u32>(indices.size());
+			mesh.vertexCount = static_cast<u32>(geometry.vertices.size());
+			mesh.indexCount = static_cast<u32>(geometry.indices.size());
+			mesh.materialIndex = parts[i].materialIndex;
+
+			vertices.insert(vertices.end(), geometry.vertices.begin(), geometry.vertices.end());
+			indices.insert(indices.end(), geometry.indices.begin(), geometry.indices.end());
+
+			mesh.material = materials[mesh.materialIndex];
+			if (!cpuOnly) {
+				mesh.material.m_materialDescriptor = std::make_shared<MaterialDescriptor>(mesh.material, mesh.material.m_materialTextures);
+			}
+
+			VK_CORE_INFO("mesh loaded (ufbx): {0} vertices, {1} indices, material index {2}",
+				mesh.vertexCount, mesh.indexCount, mesh.materialIndex);
+		}
+
+		ufbx_free_scene(scene);
+		ComputeBounds();
+	}
+
+	void MeshModel::AssimpBuilder::LoadMaterialsUfbx(const ufbx_scene* scene) {
+		materials.resize(scene->materials.count);
+		for (const ufbx_material* fbxMaterial : scene->materials) {
+			Material& material = materials[fbxMaterial->typed_id];
+			Material::PBRMaterial& pbrMaterial = material.m_PBRMaterial;
+
+			// same properties and fallbacks as LoadProperties
+			const ufbx_material_map& diffuse = fbxMaterial->fbx.diffuse_color;
+			if (diffuse.has_value) {
+				pbrMaterial.diffuseColor.r = static_cast<float>(diffuse.value_vec3.x);
+				pbrMaterial.diffuseColor.g = static_cast<float>(diffuse.value_vec3.y);
+				pbrMaterial.diffuseColor.b = static_cast<float>(diffuse.value_vec3.z);
+			}
+
+			const ufbx_material_map& roughness = fbxMaterial->pbr.roughness;
+			pbrMaterial.roughness = roughness.has_value ? static_cast<float>(roughness.value_real) : 0.1f;
+
+			const ufbx_material_map& reflection = fbxMaterial->fbx.reflection_factor;
+			const ufbx_material_map& metalness = fbxMaterial->pbr.metalness;
+			if (reflection.has_value) {
+				pbrMaterial.metallic = static_cast<float>(reflection.value_real);
+			}
+			else if (metalness.has_value) {
+				pbrMaterial.metallic = static_cast<float>(metalness.value_real);
+			}
+			else {
+				pbrMaterial.metallic = 0.886f;
+			}
+
+			const ufbx_material_map& emission = fbxMaterial->fbx.emission_color;
+			if (emission.has_value) {
+				pbrMaterial.emissiveColor = ToVec3(emission.value_vec3);
+			}
+
+			const ufbx_material_map& emissionFactor = fbxMaterial->fbx.emission_factor;
+			if (emissionFactor.has_value) {
+				pbrMaterial.emissiveStrength = static_cast<float>(emissionFactor.value_real);
+			}
+
+			pbrMaterial.normalMapIntensity = 1.0f;
+
+			// textures live next to the models, whatever folder the FBX remembers
+			std::string filepath;
+			if (const ufbx_texture* texture = diffuse.texture) {
+				std::string fbxFilepath(texture->relative_filename.length ? texture->relative_filename.data : texture->filename.data);
+				if (!fbxFilepath.empty()) {
+					filepath = "../models/" + std::filesystem::path(fbxFilepath).filename().string();
+				}
+			}
+			AssignDiffuseMap(material, filepath);
+		}
+	}
+}  // namespace RVK
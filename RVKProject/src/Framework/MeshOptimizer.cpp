@@ -0,0 +1,299 @@
+#include "Framework/MeshOptimizer.h"
+#include "Framework/Parallel.h"
+
+namespace RVK {
+	namespace {
+		constexpr u32 NO_INDEX = ~0u;
+		constexpr u32 FORSYTH_CACHE_SIZE = 32;
+
+		// https://tomforsyth1000.github.io/papers/fast_vert_cache_opt.html
+		float ForsythVertexScore(s32 cachePosition, u32 remainingTriangles) {
+			if (remainingTriangles == 0) {
+				return -1.0f;
+			}
+
+			float score = 0.0f;
+			if (cachePosition >= 0) {
+				if (cachePosition < 3) {
+					// the triangle just drawn, deliberately lower so strips don't stall on it
+					score = 0.75f;
+				}
+				else {
+					const float scaler = 1.0f / (FORSYTH_CACHE_SIZE - 3);
+					score = std::pow(1.0f - (cachePosition - 3) * scaler, 1.5f);
+				}
+			}
+
+			// vertices with few triangles left get finished first
+			score += 2.0f * std::pow(static_cast<float>(remainingTriangles), -0.5f);
+			return score;
+		}
+
+		struct Cluster {
+			u32 firstTriangle;
+			u32 triangleCount;
+			float sortKey;
+		};
+	}  // namespace
+
+	void MeshOptimizer::Optimize(MeshModel::AssimpBuilder& builder, const Settings& settings) {
+		struct SubmeshStats {
+			CacheStats before;
+			CacheStats after;
+		};
+		std::vector<SubmeshStats> stats(builder.meshes.size());
+
+		// submeshes own disjoint ranges of both buffers
+		ParallelFor(static_cast<u32>(builder.meshes.size()), [&](u32 i) {
+			const Mesh& mesh = builder.meshes[i];
+			if (mesh.indexCount < 3 || mesh.firstIndex + mesh.indexCount > builder.indices.size()) {
+				return;
+			}
+
+			u32* indices = builder.indices.data() + mesh.firstIndex;
+			Vertex* vertices = builder.vertices.data() + mesh.firstVertex;
+			stats[i].before = AnalyzeVertexCache(indices, mesh.indexCount, mesh.vertexCount);
+
+			if (settings.vertexCache) {
+				OptimizeVertexCache(indices, mesh.indexCount, mesh.vertexCount);
+			}
+			if (settings.overdraw) {
+				OptimizeOverdraw(indices, mesh.indexCount, vertices, mesh.vertexCount);
+			}
+			if (settings.vertexFetch) {
+				OptimizeVertexFetch(vertices, mesh.vertexCount, indices, mesh.indexCount);
+			}
+
+			stats[i].after = AnalyzeVertexCache(indices, mesh.indexCount, mesh.vertexCount);
+		});
+
+		for (size_t i = 0; i < stats.size(); i++) {
+			VK_CORE_INFO("submesh {0}: ACMR {1:.3f} -> {2:.3f}, ATVR {3:.3f} -> {4:.3f}", i,
+				stats[i].before.acmr, stats[i].after.acmr, stats[i].before.atvr, stats[i].after.atvr);
+		}
+	}
+
+	void MeshOptimizer::OptimizeVertexCache(u32* indices, size_t indexCount, u32 vertexCount) {
+		const size_t triangleCount = indexCount / 3;
+		if (triangleCount == 0) {
+			return;
+		}
+
+		std::vector<u32> input(indices, indices + triangleCount * 3);
+
+		// triangles of every vertex, the first remainingTriangles[v] entries are the ones not emitted yet
+		std::vector<u32> remainingTriangles(vertexCount, 0);
+		for (u32 index : input) {
+			remainingTriangles[index]++;
+		}
+		std::vector<u32> adjacencyOffsets(vertexCount + 1, 0);
+		for (u32 v = 0; v < vertexCount; v++) {
+			adjacencyOffsets[v + 1] = adjacencyOffsets[v] + remainingTriangles[v];
+		}
+		std::vector<u32> adjacency(input.size());
+		{
+			std::vector<u32> cursor(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+			for (size_t i = 0; i < input.size(); i++) {
+				adjacency[cursor[input[i]]++] = static_cast<u32>(i / 3);
+			}
+		}
+
+		std::vector<s32> cachePositions(vertexCount, -1);
+		std::vector<float> vertexScores(vertexCount);
+		for (u32 v = 0; v < vertexCount; v++) {
+			vertexScores[v] = ForsythVertexScore(-1, remainingTriangles[v]);
+		}
+
+		std::vector<float> triangleScores(triangleCount);
+		for (size_t t = 0; t < triangleCount; t++) {
+			triangleScores[t] = vertexScores[input[t * 3]] + vertexScores[input[t * 3 + 1]] + vertexScores[input[t * 3 + 2]];
+		}
+		std::vector<bool> emitted(triangleCount, false);
+
+		std::vector<u32> cache;
+		std::vector<u32> newCache;
+		cache.reserve(FORSYTH_CACHE_SIZE + 3);
+		newCache.reserve(FORSYTH_CACHE_SIZE + 3);
+
+		u32 bestTriangle = static_cast<u32>(std::max_element(triangleScores.begin(), triangleScores.end()) - triangleScores.begin());
+		size_t scanCursor = 0;
+
+		for (size_t output = 0; output < triangleCount; output++) {
+			if (bestTriangle == NO_INDEX) {
+				// nothing in the cache has triangles left, continue with the next one in the input
+				while (emitted[scanCursor]) {
+					scanCursor++;
+				}
+				bestTriangle = static_cast<u32>(scanCursor);
+			}
+
+			const u32* triangle = &input[bestTriangle * 3];
+			std::copy(triangle, triangle + 3, indices + output * 3);
+			emitted[bestTriangle] = true;
+
+			// drop the triangle from its vertices' remaining lists
+			for (u32 k = 0; k < 3; k++) {
+				u32 v = triangle[k];
+				u32* begin = &adjacency[adjacencyOffsets[v]];
+				u32* end = begin + remainingTriangles[v];
+				u32* found = std::find(begin, end, bestTriangle);
+				if (found != end) {
+					std::swap(*found, *(end - 1));
+					remainingTriangles[v]--;
+				}
+			}
+
+			// the triangle's vertices move to the front of the LRU cache
+			newCache.assign(triangle, triangle + 3);
+			for (u32 v : cache) {
+				if (v != triangle[0] && v != triangle[1] && v != triangle[2]) {
+					newCache.push_back(v);
+				}
+			}
+
+			for (size_t i = 0; i < newCache.size(); i++) {
+				cachePositions[newCache[i]] = i < FORSYTH_CACHE_SIZE ? static_cast<s32>(i) : -1;
+			}
+
+			// rescore everything that was or is in the cache, only their triangles can change
+			bestTriangle = NO_INDEX;
+			float bestScore = -1.0f;
+			for (u32 v : newCache) {
+				float score = ForsythVertexScore(cachePositions[v], remainingTriangles[v]);
+				float delta = score - vertexScores[v];
+				vertexScores[v] = score;
+
+				const u32* begin = &adjacency[adjacencyOffsets[v]];
+				for (const u32* t = begin; t < begin + remainingTriangles[v]; t++) {
+					triangleScores[*t] += delta;
+					if (triangleScores[*t] > bestScore) {
+						bestScore = triangleScores[*t];
+						bestTriangle = *t;
+					}
+				}
+			}
+
+			if (newCache.size() > FORSYTH_CACHE_SIZE) {
+				newCache.resize(FORSYTH_CACHE_SIZE);
+			}
+			std::swap(cache, newCache);
+		}
+	}
+
+	// Tipsify style: cut the cache optimized order where the cache starts over, then sort the
+	// clusters so the ones facing away from the mesh center, which tend to occlude the rest, come first
+	void MeshOptimizer::OptimizeOverdraw(u32* indices, size_t indexCount, const Vertex* vertices, u32 vertexCount) {
+		const u32 triangleCount = static_cast<u32>(indexCount / 3);
+		if (triangleCount == 0) {
+			return;
+		}
+
+		glm::vec3 meshCenter{ 0.0f };
+		for (u32 v = 0; v < vertexCount; v++) {
+			meshCenter += vertices[v].position;
+		}
+		meshCenter /= static_cast<float>(std::max(vertexCount, 1u));
+
+		// a triangle with three cache misses starts a new cluster
+		std::vector<Cluster> clusters;
+		std::vector<u32> cacheTimestamps(vertexCount, 0);
+		const u32 cacheSize = 16;
+		u32 time = cacheSize + 1;
+		for (u32 t = 0; t < triangleCount; t++) {
+			u32 misses = 0;
+			for (u32 k = 0; k < 3; k++) {
+				u32 v = indices[t * 3 + k];
+				if (time - cacheTimestamps[v] > cacheSize) {
+					cacheTimestamps[v] = time++;
+					misses++;
+				}
+			}
+			if (misses == 3 || clusters.empty()) {
+				clusters.push_back({ t, 0, 0.0f });
+			}
+			clusters.back().triangleCount++;
+		}
+
+		for (Cluster& cluster : clusters) {
+			glm::vec3 centroid{ 0.0f };
+			glm::vec3 normal{ 0.0f };
+			float area = 0.0f;
+			for (u32 t = cluster.firstTriangle; t < cluster.firstTriangle + cluster.triangleCount; t++) {
+				const glm::vec3& p0 = vertices[indices[t * 3]].position;
+				const glm::vec3& p1 = vertices[indices[t * 3 + 1]].position;
+				const glm::vec3& p2 = vertices[indices[t * 3 + 2]].position;
+				glm::vec3 cross = glm::cross(p1 - p0, p2 - p0);
+				float triangleArea = glm::length(cross);
+				centroid += (p0 + p1 + p2) * (triangleArea / 3.0f);
+				normal += cross;
+				area += triangleArea;
+			}
+
+			float normalLength = glm::length(normal);
+			if (area > 0.0f && normalLength > 0.0f) {
+				cluster.sortKey = glm::dot(centroid / area - meshCenter, normal / normalLength);
+			}
+		}
+
+		std::stable_sort(clusters.begin(), clusters.end(),
+			[](const Cluster& a, const Cluster& b) { return a.sortKey > b.sortKey; });
+
+		std::vector<u32> input(indices, indices + triangleCount * 3);
+		size_t output = 0;
+		for (const Cluster& cluster : clusters) {
+			const u32* begin = &input[cluster.firstTriangle * 3];
+			std::copy(begin, begin + cluster.triangleCount * 3, indices + output);
+			output += cluster.triangleCount * 3;
+		}
+	}
+
+	void MeshOptimizer::OptimizeVertexFetch(Vertex* vertices, u32 vertexCount, u32* indices, size_t indexCount) {
+		std::vector<u32> remap(vertexCount, NO_INDEX);
+		u32 nextVertex = 0;
+		for (size_t i = 0; i < indexCount; i++) {
+			u32& newIndex = remap[indices[i]];
+			if (newIndex == NO_INDEX) {
+				newIndex = nextVertex++;
+			}
+			indices[i] = newIndex;
+		}
+		for (u32 v = 0; v < vertexCount; v++) {
+			if (remap[v] == NO_INDEX) {
+				remap[v] = nextVertex++;
+			}
+		}
+
+		std::vector<Vertex> input(vertices, vertices + vertexCount);
+		for (u32 v = 0; v < vertexCount; v++) {
+			vertices[remap[v]] = input[v];
+		}
+	}
+
+	MeshOptimizer::CacheStats MeshOptimizer::AnalyzeVertexCache(const u32* indices, size_t indexCount, u32 vertexCount, u32 cacheSize) {
+		CacheStats stats{};
+		if (indexCount < 3) {
+			return stats;
+		}
+
+		// a vertex is in the FIFO if fewer than cacheSize misses happened since it was loaded
+		std::vector<u32> loadedAt(vertexCount, 0);
+		std::vector<bool> referenced(vertexCount, false);
+		u32 misses = 0;
+		u32 uniqueVertices = 0;
+		for (size_t i = 0; i < indexCount; i++) {
+			u32 v = indices[i];
+			if (!referenced[v]) {
+				referenced[v] = true;
+				uniqueVertices++;
+			}
+			if (loadedAt[v] == 0 || misses - loadedAt[v] >= cacheSize) {
+				misses++;
+				loadedAt[v] = misses;
+			}
+		}
+
+		stats.acmr = static_cast<float>(misses) / static_cast<float>(indexCount / 3);
+		stats.atvr = static_cast<float>(misses) / static_cast<float>(std::max(uniqueVertices, 1u));
+		return stats;
+	}
+}  // namespace RVK
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "Framework/MeshModel.h"
+
+namespace RVK {
+	// Offline reordering of imported meshes, the result is what gets cooked.
+	// All functions work on one submesh: indices relative to its first vertex.
+	class MeshOptimizer {
+	public:
+		struct Settings {
+			bool vertexCache = true;
+			// sorts clusters of the cache optimized order so outward facing ones come first,
+			// costs a little cache efficiency
+			bool overdraw = false;
+			bool vertexFetch = true;
+		};
+
+		struct CacheStats {
+			// transformed vertices per triangle, 0.5 at best and 3 at worst
+			float acmr = 0.0f;
+			// transformed vertices per referenced vertex, 1 at best
+			float atvr = 0.0f;
+		};
+
+		static void Optimize(MeshModel::AssimpBuilder& builder) { Optimize(builder, Settings{}); }
+		static void Optimize(MeshModel::AssimpBuilder& builder, const Settings& settings);
+
+		// Forsyth's linear speed vertex cache optimization
+		static void OptimizeVertexCache(u32* indices, size_t indexCount, u32 vertexCount);
+		static void OptimizeOverdraw(u32* indices, size_t indexCount, const Vertex* vertices, u32 vertexCount);
+		// vertices in order of first use, unreferenced ones move to the end
+		static void OptimizeVertexFetch(Vertex* vertices, u32 vertexCount, u32* indices, size_t indexCount);
+
+		// FIFO cache like most hardware, 16 entries
+		static CacheStats AnalyzeVertexCache(const u32* indices, size_t indexCount, u32 vertexCount, u32 cacheSize = 16);
+	};
+}  // namespace RVK
@@ -0,0 +1,313 @@
+#include "Framework/MeshSimplifier.h"
+#include "Framework/MeshOptimizer.h"
+#include "Framework/Parallel.h"
+
+namespace RVK {
+	namespace {
+		// symmetric 4x4 plane quadric, weighted by triangle area
+		struct Quadric {
+			float a00 = 0.0f, a11 = 0.0f, a22 = 0.0f;
+			float a01 = 0.0f, a02 = 0.0f, a12 = 0.0f;
+			float b0 = 0.0f, b1 = 0.0f, b2 = 0.0f;
+			float c = 0.0f;
+			float weight = 0.0f;
+
+			void AddPlane(const glm::vec3& n, float d, float w) {
+				a00 += w * n.x * n.x; a11 += w * n.y * n.y; a22 += w * n.z * n.z;
+				a01 += w * n.x * n.y; a02 += w * n.x * n.z; a12 += w * n.y * n.z;
+				b0 += w * n.x * d; b1 += w * n.y * d; b2 += w * n.z * d;
+				c += w * d * d;
+				weight += w;
+			}
+
+			void Add(const Quadric& q) {
+				a00 += q.a00; a11 += q.a11; a22 += q.a22;
+				a01 += q.a01; a02 += q.a02; a12 += q.a12;
+				b0 += q.b0; b1 += q.b1; b2 += q.b2;
+				c += q.c;
+				weight += q.weight;
+			}
+
+			// mean squared distance of p to the accumulated planes
+			float Error(const glm::vec3& p) const {
+				float rx = a00 * p.x + a01 * p.y + a02 * p.z + 2.0f * b0;
+				float ry = a01 * p.x + a11 * p.y + a12 * p.z + 2.0f * b1;
+				float rz = a02 * p.x + a12 * p.y + a22 * p.z + 2.0f * b2;
+				float error = p.x * rx + p.y * ry + p.z * rz + c;
+				return weight > 0.0f ? std::max(error, 0.0f) / weight : 0.0f;
+			}
+		};
+
+		struct Collapse {
+			u32 from;
+			u32 to;
+			float error;
+		};
+
+		u64 EdgeKey(u32 a, u32 b) {
+			return (static_cast<u64>(a) << 32) | b;
+		}
+
+		// seams and open borders are locked, everything else can collapse
+		std::vector<bool> FindLockedVertices(const u32* indices, size_t indexCount, const Vertex* vertices, u32 vertexCount) {
+			std::vector<bool> locked(vertexCount, false);
+
+			std::unordered_map<glm::vec3, u32> firstAtPosition;
+			firstAtPosition.reserve(vertexCount);
+			std::vector<u32> positionIndex(vertexCount);
+			for (u32 v = 0; v < vertexCount; v++) {
+				auto [it, inserted] = firstAtPosition.try_emplace(vertices[v].position, v);
+				positionIndex[v] = it->second;
+				if (!inserted) {
+					locked[v] = true;
+					locked[it->second] = true;
+				}
+			}
+
+			// an edge nobody walks the other way is on a border, compared by position so seams don't count
+			std::unordered_set<u64> edges;
+			edges.reserve(indexCount);
+			for (size_t i = 0; i < indexCount; i += 3) {
+				for (u32 k = 0; k < 3; k++) {
+					edges.insert(EdgeKey(positionIndex[indices[i + k]], positionIndex[indices[i + (k + 1) % 3]]));
+				}
+			}
+			for (size_t i = 0; i < indexCount; i += 3) {
+				for (u32 k = 0; k < 3; k++) {
+					u32 a = indices[i + k];
+					u32 b = indices[i + (k + 1) % 3];
+					if (!edges.count(EdgeKey(positionIndex[b], positionIndex[a]))) {
+						locked[a] = true;
+						locked[b] = true;
+					}
+				}
+			}
+			return locked;
+		}
+
+		// moving from onto to must not turn any of from's other triangles over
+		bool FlipsTriangle(const std::vector<u32>& indices, const u32* triangles, u32 triangleCount,
+			const Vertex* vertices, u32 from, u32 to) {
+			const glm::vec3& target = vertices[to].position;
+			for (u32 t = 0; t < triangleCount; t++) {
+				const u32* triangle = &indices[triangles[t] * 3];
+				if (triangle[0] == to || triangle[1] == to || triangle[2] == to) {
+					continue;  // collapses away
+				}
+
+				glm::vec3 before[3];
+				glm::vec3 after[3];
+				for (u32 k = 0; k < 3; k++) {
+					before[k] = vertices[triangle[k]].position;
+					after[k] = triangle[k] == from ? target : before[k];
+				}
+
+				glm::vec3 normalBefore = glm::cross(before[1] - before[0], before[2] - before[0]);
+				glm::vec3 normalAfter = glm::cross(after[1] - after[0], after[2] - after[0]);
+				if (glm::dot(normalBefore, normalAfter) <= 0.25f * glm::length(normalBefore) * glm::length(normalAfter)) {
+					return true;
+				}
+			}
+			return false;
+		}
+	}  // namespace
+
+	void MeshSimplifier::GenerateLods(MeshModel::AssimpBuilder& builder, const Settings& settings) {
+		u32 lodCount = std::clamp(settings.lodCount, 1u, MAX_MESH_LODS);
+		std::vector<std::vector<u32>> lodIndices(builder.meshes.size() * MAX_MESH_LODS);
+
+		// submeshes only read their own ranges, the results are appended afterwards
+		ParallelFor(static_cast<u32>(builder.meshes.size()), [&](u32 i) {
+			Mesh& mesh = builder.meshes[i];
+			mesh.lodCount = 1;
+			if (mesh.indexCount < 3 || mesh.firstIndex + mesh.indexCount > builder.indices.size()) {
+				return;
+			}
+
+			const Vertex* vertices = builder.vertices.data() + mesh.firstVertex;
+			glm::vec3 boundsMin{ std::numeric_limits<float>::max() };
+			glm::vec3 boundsMax{ std::numeric_limits<float>::lowest() };
+			for (u32 v = 0; v < mesh.vertexCount; v++) {
+				boundsMin = glm::min(boundsMin, vertices[v].position);
+				boundsMax = glm::max(boundsMax, vertices[v].position);
+			}
+			float targetError = settings.maxError * glm::length(boundsMax - boundsMin);
+
+			// every level is simplified from the one before, the errors add up
+			const u32* source = builder.indices.data() + mesh.firstIndex;
+			size_t sourceCount = mesh.indexCount;
+			float error = 0.0f;
+			for (u32 lod = 1; lod < lodCount; lod++) {
+				size_t targetCount = static_cast<size_t>(sourceCount * settings.reduction) / 3 * 3;
+				std::vector<u32>& indices = lodIndices[i * MAX_MESH_LODS + lod];
+				indices.resize(sourceCount);
+
+				float lodError = 0.0f;
+				size_t count = Simplify(indices.data(), source, sourceCount, vertices, mesh.vertexCount,
+					targetCount, targetError, &lodError);
+
+				// not worth another draw range if it barely got smaller
+				if (count == 0 || count > sourceCount * 9 / 10) {
+					indices.clear();
+					break;
+				}
+
+				indices.resize(count);
+				MeshOptimizer::OptimizeVertexCache(indices.data(), indices.size(), mesh.vertexCount);
+				error += lodError;
+				mesh.lods[lod - 1] = { 0, static_cast<u32>(count), error };
+				mesh.lodCount = lod + 1;
+
+				source = indices.data();
+				sourceCount = count;
+			}
+		});
+
+		for (size_t i = 0; i < builder.meshes.size(); i++) {
+			Mesh& mesh = builder.meshes[i];
+			for (u32 lod = 1; lod < mesh.lodCount; lod++) {
+				const std::vector<u32>& indices = lodIndices[i * MAX_MESH_LODS + lod];
+				mesh.lods[lod - 1].firstIndex = static_cast<u32>(builder.indices.size());
+				builder.indices.insert(builder.indices.end(), indices.begin(), indices.end());
+			}
+
+			if (mesh.lodCount > 1) {
+				const MeshLod& last = mesh.lods[mesh.lodCount - 2];
+				VK_CORE_INFO("submesh {0}: {1} LODs, {2} -> {3} triangles, error {4:.5f}", i,
+					mesh.lodCount, mesh.indexCount / 3, last.indexCount / 3, last.error);
+			}
+		}
+	}
+
+	size_t MeshSimplifier::Simplify(u32* destination, const u32* indices, size_t indexCount,
+		const Vertex* vertices, u32 vertexCount, size_t targetIndexCount, float targetError, float* resultError) {
+		std::vector<u32> result(indices, indices + indexCount / 3 * 3);
+		float maxError = 0.0f;
+
+		std::vector<bool> locked = FindLockedVertices(result.data(), result.size(), vertices, vertexCount);
+
+		std::vector<Quadric> quadrics(vertexCount);
+		for (size_t i = 0; i < result.size(); i += 3) {
+			const glm::vec3& p0 = vertices[result[i]].position;
+			const glm::vec3& p1 = vertices[result[i + 1]].position;
+			const glm::vec3& p2 = vertices[result[i + 2]].position;
+			glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+			float area = glm::length(normal);
+			if (area <= 0.0f) {
+				continue;
+			}
+			normal /= area;
+			float d = -glm::dot(normal, p0);
+			for (u32 k = 0; k < 3; k++) {
+				quadrics[result[i + k]].AddPlane(normal, d, area);
+			}
+		}
+
+		const float maxCollapseError = targetError * targetError;
+		std::vector<u32> collapseTarget(vertexCount);
+		std::vector<bool> touched(vertexCount);
+		std::vector<Collapse> collapses;
+		std::vector<u32> adjacencyOffsets(vertexCount + 1);
+		std::vector<u32> adjacency;
+
+		while (result.size() > targetIndexCount) {
+			// triangles around every vertex, rebuilt every pass
+			std::fill(adjacencyOffsets.begin(), adjacencyOffsets.end(), 0);
+			for (u32 index : result) {
+				adjacencyOffsets[index + 1]++;
+			}
+			for (u32 v = 0; v < vertexCount; v++) {
+				adjacencyOffsets[v + 1] += adjacencyOffsets[v];
+			}
+			adjacency.resize(result.size());
+			{
+				std::vector<u32> cursor(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+				for (size_t i = 0; i < result.size(); i++) {
+					adjacency[cursor[result[i]]++] = static_cast<u32>(i / 3);
+				}
+			}
+
+			// the cheapest way to get rid of every edge, in both directions
+			collapses.clear();
+			for (size_t i = 0; i < result.size(); i += 3) {
+				for (u32 k = 0; k < 3; k++) {
+					u32 a = result[i + k];
+					u32 b = result[i + (k + 1) % 3];
+					for (u32 direction = 0; direction < 2; direction++) {
+						u32 from = direction ? b : a;
+						u32 to = direction ? a : b;
+						if (locked[from]) {
+							continue;
+						}
+						Quadric q = quadrics[from];
+						q.Add(quadrics[to]);
+						float error = q.Error(vertices[to].position);
+						if (error <= maxCollapseError) {
+							collapses.push_back({ from, to, error });
+						}
+					}
+				}
+			}
+			if (collapses.empty()) {
+				break;
+			}
+			std::sort(collapses.begin(), collapses.end(),
+				[](const Collapse& a, const Collapse& b) { return a.error < b.error; });
+
+			// collapses in one pass can't share a triangle, so the flip test stays valid
+			for (u32 v = 0; v < vertexCount; v++) {
+				collapseTarget[v] = v;
+			}
+			std::fill(touched.begin(), touched.end(), false);
+
+			// every collapse of an interior vertex removes about two triangles
+			size_t collapseBudget = std::max<size_t>((result.size() - targetIndexCount) / 6, 1);
+			size_t collapsed = 0;
+			for (const Collapse& collapse : collapses) {
+				if (collapsed >= collapseBudget) {
+					break;
+				}
+				if (touched[collapse.from] || touched[collapse.to]) {
+					continue;
+				}
+
+				const u32* triangles = &adjacency[adjacencyOffsets[collapse.from]];
+				u32 triangleCount = adjacencyOffsets[collapse.from + 1] - adjacencyOffsets[collapse.from];
+				if (FlipsTriangle(result, triangles, triangleCount, vertices, collapse.from, collapse.to)) {
+					continue;
+				}
+
+				for (u32 t = 0; t < triangleCount; t++) {
+					const u32* triangle = &result[triangles[t] * 3];
+					touched[triangle[0]] = touched[triangle[1]] = touched[triangle[2]] = true;
+				}
+				collapseTarget[collapse.from] = collapse.to;
+				quadrics[collapse.to].Add(quadrics[collapse.from]);
+				maxError = std::max(maxError, collapse.error);
+				collapsed++;
+			}
+			if (collapsed == 0) {
+				break;
+			}
+
+			size_t write = 0;
+			for (size_t i = 0; i < result.size(); i += 3) {
+				u32 a = collapseTarget[result[i]];
+				u32 b = collapseTarget[result[i + 1]];
+				u32 c = collapseTarget[result[i + 2]];
+				if (a != b && b != c && a != c) {
+					result[write++] = a;
+					result[write++] = b;
+					result[write++] = c;
+				}
+			}
+			result.resize(write);
+		}
+
+		std::copy(result.begin(), result.end(), destination);
+		if (resultError) {
+			*resultError = std::sqrt(maxError);
+		}
+		return result.size();
+	}
+}  // namespace RVK
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "Framework/MeshModel.h"
+
+namespace RVK {
+	// Builds the LOD chain that gets cooked with the model.
+	// Like MeshOptimizer, Simplify works on one submesh: indices relative to its first vertex.
+	class MeshSimplifier {
+	public:
+		struct Settings {
+			// levels including the full mesh, at most MAX_MESH_LODS
+			u32 lodCount = MAX_MESH_LODS;
+			// index count of every level relative to the one before
+			float reduction = 0.5f;
+			// relative to the submesh size, a level stops simplifying at this error
+			float maxError = 0.02f;
+		};
+
+		// appends the LOD indices after the existing ones and fills Mesh::lods
+		static void GenerateLods(MeshModel::AssimpBuilder& builder) { GenerateLods(builder, Settings{}); }
+		static void GenerateLods(MeshModel::AssimpBuilder& builder, const Settings& settings);
+
+		// Garland-Heckbert quadric error edge collapses onto existing vertices, so the vertex buffer is shared
+		// by all levels. Vertices on open borders and seams (several vertices at one position, UV or normal
+		// splits and material edges) never move. Returns the new index count, the error is in model units.
+		static size_t Simplify(u32* destination, const u32* indices, size_t indexCount,
+			const Vertex* vertices, u32 vertexCount, size_t targetIndexCount, float targetError, float* resultError = nullptr);
+	};
+}  // namespace RVK
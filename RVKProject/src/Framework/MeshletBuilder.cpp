@@ -0,0 +1,149 @@
+#include "Framework/MeshletBuilder.h"
+#include "Framework/Parallel.h"
+
+namespace RVK {
+	namespace {
+		// every edge has a partner going the other way, compared by position so UV seams don't open it
+		bool IsClosed(const u32* indices, u32 indexCount, const Vertex* vertices, u32 vertexCount) {
+			std::unordered_map<glm::vec3, u32> firstAtPosition;
+			firstAtPosition.reserve(vertexCount);
+			std::vector<u32> positionIndex(vertexCount);
+			for (u32 v = 0; v < vertexCount; v++) {
+				positionIndex[v] = firstAtPosition.try_emplace(vertices[v].position, v).first->second;
+			}
+
+			std::unordered_set<u64> edges;
+			edges.reserve(indexCount);
+			for (u32 i = 0; i < indexCount; i++) {
+				u32 a = positionIndex[indices[i]];
+				u32 b = positionIndex[indices[i - i % 3 + (i + 1) % 3]];
+				edges.insert((static_cast<u64>(a) << 32) | b);
+			}
+			for (u64 edge : edges) {
+				if (!edges.count((edge << 32) | (edge >> 32))) {
+					return false;
+				}
+			}
+			return true;
+		}
+
+		void FinishMeshlet(Meshlet& meshlet, const u32* indices, const Vertex* vertices, bool backfaceCulling) {
+			const u32* triangles = indices + meshlet.firstIndex;
+
+			glm::vec3 boundsMin{ std::numeric_limits<float>::max() };
+			glm::vec3 boundsMax{ std::numeric_limits<float>::lowest() };
+			for (u32 i = 0; i < meshlet.indexCount; i++) {
+				boundsMin = glm::min(boundsMin, vertices[triangles[i]].position);
+				boundsMax = glm::max(boundsMax, vertices[triangles[i]].position);
+			}
+			meshlet.center = 0.5f * (boundsMin + boundsMax);
+			meshlet.radius = 0.0f;
+			for (u32 i = 0; i < meshlet.indexCount; i++) {
+				meshlet.radius = std::max(meshlet.radius, glm::length(vertices[triangles[i]].position - meshlet.center));
+			}
+
+			// no cone unless every triangle is within about 85 degrees of the average normal
+			meshlet.coneAxis = glm::vec3(0.0f);
+			meshlet.coneCutoff = 1.0f;
+			if (!backfaceCulling) {
+				return;
+			}
+
+			std::vector<glm::vec3> normals;
+			normals.reserve(meshlet.indexCount / 3);
+			glm::vec3 axis{ 0.0f };
+			for (u32 i = 0; i < meshlet.indexCount; i += 3) {
+				const glm::vec3& p0 = vertices[triangles[i]].position;
+				const glm::vec3& p1 = vertices[triangles[i + 1]].position;
+				const glm::vec3& p2 = vertices[triangles[i + 2]].position;
+				glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+				float length = glm::length(normal);
+				if (length > 0.0f) {
+					normals.push_back(normal / length);
+					axis += normals.back();
+				}
+			}
+
+			float axisLength = glm::length(axis);
+			if (normals.empty() || axisLength <= 0.0f) {
+				return;
+			}
+			axis /= axisLength;
+
+			float minDot = 1.0f;
+			for (const glm::vec3& normal : normals) {
+				minDot = std::min(minDot, glm::dot(axis, normal));
+			}
+			if (minDot > 0.1f) {
+				meshlet.coneAxis = axis;
+				meshlet.coneCutoff = std::sqrt(1.0f - minDot * minDot);
+			}
+		}
+	}  // namespace
+
+	void MeshletBuilder::Build(MeshModel::AssimpBuilder& builder) {
+		std::vector<std::vector<Meshlet>> submeshMeshlets(builder.meshes.size());
+
+		ParallelFor(static_cast<u32>(builder.meshes.size()), [&](u32 i) {
+			const Mesh& mesh = builder.meshes[i];
+			if (mesh.indexCount < 3 || mesh.firstIndex + mesh.indexCount > builder.indices.size()) {
+				return;
+			}
+
+			const Vertex* vertices = builder.vertices.data() + mesh.firstVertex;
+			const u32* indices = builder.indices.data();
+			// the pipelines don't cull back faces, so open meshes show them
+			bool closed = IsClosed(indices + mesh.firstIndex, mesh.indexCount, vertices, mesh.vertexCount);
+			BuildSubmesh(indices, mesh.firstIndex, mesh.indexCount, vertices, mesh.vertexCount, closed, submeshMeshlets[i]);
+		});
+
+		builder.meshlets.clear();
+		u32 totalMeshlets = 0;
+		for (size_t i = 0; i < builder.meshes.size(); i++) {
+			Mesh& mesh = builder.meshes[i];
+			mesh.firstMeshlet = static_cast<u32>(builder.meshlets.size());
+			mesh.meshletCount = static_cast<u32>(submeshMeshlets[i].size());
+			builder.meshlets.insert(builder.meshlets.end(), submeshMeshlets[i].begin(), submeshMeshlets[i].end());
+			totalMeshlets += mesh.meshletCount;
+		}
+		VK_CORE_INFO("{0} meshlets in {1} submeshes", totalMeshlets, builder.meshes.size());
+	}
+
+	void MeshletBuilder::BuildSubmesh(const u32* indices, u32 firstIndex, u32 indexCount, const Vertex* vertices,
+		u32 vertexCount, bool backfaceCulling, std::vector<Meshlet>& meshlets) {
+		// which meshlet last used a vertex, stands in for clearing a set on every cut
+		std::vector<u32> usedBy(vertexCount, ~0u);
+		u32 meshletVertices = 0;
+
+		Meshlet current{ firstIndex, 0 };
+		u32 meshletIndex = 0;
+		for (u32 i = firstIndex; i + 2 < firstIndex + indexCount; i += 3) {
+			u32 newVertices = 0;
+			for (u32 k = 0; k < 3; k++) {
+				newVertices += usedBy[indices[i + k]] != meshletIndex;
+			}
+			// a triangle reusing a vertex twice counts it twice, close enough for a limit
+			if (meshletVertices + newVertices > MAX_VERTICES || current.indexCount / 3 >= MAX_TRIANGLES) {
+				FinishMeshlet(current, indices, vertices, backfaceCulling);
+				meshlets.push_back(current);
+				current = { i, 0 };
+				meshletIndex++;
+				meshletVertices = 0;
+			}
+
+			for (u32 k = 0; k < 3; k++) {
+				u32& used = usedBy[indices[i + k]];
+				if (used != meshletIndex) {
+					used = meshletIndex;
+					meshletVertices++;
+				}
+			}
+			current.indexCount += 3;
+		}
+
+		if (current.indexCount > 0) {
+			FinishMeshlet(current, indices, vertices, backfaceCulling);
+			meshlets.push_back(current);
+		}
+	}
+}  // namespace RVK
@@ -0,0 +1,19 @@
+#pragma once
+
+#include "Framework/MeshModel.h"
+
+namespace RVK {
+	// Splits every full detail submesh into meshlets at cook time, the LOD levels are drawn whole.
+	class MeshletBuilder {
+	public:
+		static constexpr u32 MAX_VERTICES = 64;
+		static constexpr u32 MAX_TRIANGLES = 124;
+
+		static void Build(MeshModel::AssimpBuilder& builder);
+
+		// Cuts the triangles in their current order, so the vertex cache order is kept and no index moves.
+		// Indices are relative to the submesh. Without backface culling every cone gets a cutoff of 1.
+		static void BuildSubmesh(const u32* indices, u32 firstIndex, u32 indexCount, const Vertex* vertices,
+			u32 vertexCount, bool backfaceCulling, std::vector<Meshlet>& meshlets);
+	};
+}  // namespace RVK
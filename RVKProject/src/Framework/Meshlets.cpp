@@ -0,0 +1,152 @@
+#include "Framework/Meshlets.h"
+
+#if defined(_M_X64) || defined(__SSE2__)
+#define RVK_MESHLET_SSE 1
+#include <emmintrin.h>
+#endif
+
+namespace RVK {
+	MeshletCullView MeshletCullView::Create(const glm::mat4& modelViewProjection, const glm::mat4& model, const glm::vec3& cameraPosition) {
+		MeshletCullView view{};
+
+		// Gribb-Hartmann, clip space z is 0 to 1
+		auto row = [&](u32 i) {
+			return glm::vec4(modelViewProjection[0][i], modelViewProjection[1][i], modelViewProjection[2][i], modelViewProjection[3][i]);
+		};
+		view.planes[0] = row(3) + row(0);
+		view.planes[1] = row(3) - row(0);
+		view.planes[2] = row(3) + row(1);
+		view.planes[3] = row(3) - row(1);
+		view.planes[4] = row(2);
+		view.planes[5] = row(3) - row(2);
+		for (glm::vec4& plane : view.planes) {
+			plane /= glm::length(glm::vec3(plane));
+		}
+
+		view.cameraPosition = glm::vec3(glm::inverse(model) * glm::vec4(cameraPosition, 1.0f));
+
+		float scaleX = glm::length(glm::vec3(model[0]));
+		float scaleY = glm::length(glm::vec3(model[1]));
+		float scaleZ = glm::length(glm::vec3(model[2]));
+		float minScale = std::min({ scaleX, scaleY, scaleZ });
+		float maxScale = std::max({ scaleX, scaleY, scaleZ });
+		view.backfaceCulling = maxScale - minScale <= 0.01f * maxScale;
+		return view;
+	}
+
+	void MeshletCuller::SetMeshlets(const Meshlet* meshlets, u32 meshletCount) {
+		m_count = meshletCount;
+		// Cull starts at any submesh's first meshlet and loads four at a time, three more keep the last load
+		// inside wherever it started. The padding sits behind every plane.
+		u32 padded = meshletCount + 3;
+		m_centerX.assign(padded, 0.0f);
+		m_centerY.assign(padded, 0.0f);
+		m_centerZ.assign(padded, 0.0f);
+		m_radius.assign(padded, -std::numeric_limits<float>::max());
+		m_axisX.assign(padded, 0.0f);
+		m_axisY.assign(padded, 0.0f);
+		m_axisZ.assign(padded, 0.0f);
+		m_cutoff.assign(padded, 1.0f);
+		m_ranges.resize(meshletCount);
+
+		for (u32 i = 0; i < meshletCount; i++) {
+			const Meshlet& meshlet = meshlets[i];
+			m_centerX[i] = meshlet.center.x;
+			m_centerY[i] = meshlet.center.y;
+			m_centerZ[i] = meshlet.center.z;
+			m_radius[i] = meshlet.radius;
+			m_axisX[i] = meshlet.coneAxis.x;
+			m_axisY[i] = meshlet.coneAxis.y;
+			m_axisZ[i] = meshlet.coneAxis.z;
+			m_cutoff[i] = meshlet.coneCutoff;
+			m_ranges[i] = { meshlet.firstIndex, meshlet.indexCount };
+		}
+	}
+
+	u32 MeshletCuller::Cull(const MeshletCullView& view, u32 firstMeshlet, u32 meshletCount, std::vector<IndexRange>& ranges) const {
+		u32 end = std::min(firstMeshlet + meshletCount, m_count);
+		u32 visibleCount = 0;
+
+		// meshlets of a submesh are back to back in the index buffer, so visible neighbours become one draw.
+		// Only the ranges of this call, the previous submesh's may end right where this one starts.
+		size_t first = ranges.size();
+		auto emit = [&](u32 i) {
+			const IndexRange& range = m_ranges[i];
+			if (ranges.size() > first && ranges.back().firstIndex + ranges.back().indexCount == range.firstIndex) {
+				ranges.back().indexCount += range.indexCount;
+			}
+			else {
+				ranges.push_back(range);
+			}
+			visibleCount++;
+		};
+
+#if RVK_MESHLET_SSE
+		const __m128 zero = _mm_setzero_ps();
+		const __m128 cameraX = _mm_set1_ps(view.cameraPosition.x);
+		const __m128 cameraY = _mm_set1_ps(view.cameraPosition.y);
+		const __m128 cameraZ = _mm_set1_ps(view.cameraPosition.z);
+		__m128 planeX[6], planeY[6], planeZ[6], planeW[6];
+		for (u32 p = 0; p < 6; p++) {
+			planeX[p] = _mm_set1_ps(view.planes[p].x);
+			planeY[p] = _mm_set1_ps(view.planes[p].y);
+			planeZ[p] = _mm_set1_ps(view.planes[p].z);
+			planeW[p] = _mm_set1_ps(view.planes[p].w);
+		}
+
+		// four at a time from firstMeshlet, the arrays have three floats of padding for the last load
+		for (u32 i = firstMeshlet; i < end; i += 4) {
+			__m128 centerX = _mm_loadu_ps(&m_centerX[i]);
+			__m128 centerY = _mm_loadu_ps(&m_centerY[i]);
+			__m128 centerZ = _mm_loadu_ps(&m_centerZ[i]);
+			__m128 radius = _mm_loadu_ps(&m_radius[i]);
+			__m128 negativeRadius = _mm_sub_ps(zero, radius);
+
+			__m128 visible = _mm_castsi128_ps(_mm_set1_epi32(-1));
+			for (u32 p = 0; p < 6; p++) {
+				__m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(planeX[p], centerX), _mm_mul_ps(planeY[p], centerY)),
+					_mm_add_ps(_mm_mul_ps(planeZ[p], centerZ), planeW[p]));
+				visible = _mm_and_ps(visible, _mm_cmpge_ps(distance, negativeRadius));
+			}
+
+			// backfacing if the camera is behind the cone: dot(d, axis) >= cutoff * |d| + radius
+			if (view.backfaceCulling) {
+				__m128 dx = _mm_sub_ps(centerX, cameraX);
+				__m128 dy = _mm_sub_ps(centerY, cameraY);
+				__m128 dz = _mm_sub_ps(centerZ, cameraZ);
+				__m128 length = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz)));
+				__m128 along = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, _mm_loadu_ps(&m_axisX[i])), _mm_mul_ps(dy, _mm_loadu_ps(&m_axisY[i]))),
+					_mm_mul_ps(dz, _mm_loadu_ps(&m_axisZ[i])));
+				__m128 limit = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(&m_cutoff[i]), length), radius);
+				visible = _mm_andnot_ps(_mm_cmpge_ps(along, limit), visible);
+			}
+
+			u32 mask = static_cast<u32>(_mm_movemask_ps(visible));
+			for (u32 lane = 0; lane < 4 && i + lane < end; lane++) {
+				if (mask & (1u << lane)) {
+					emit(i + lane);
+				}
+			}
+		}
+#else
+		for (u32 i = firstMeshlet; i < end; i++) {
+			glm::vec3 center{ m_centerX[i], m_centerY[i], m_centerZ[i] };
+			bool visible = true;
+			for (const glm::vec4& plane : view.planes) {
+				visible &= glm::dot(glm::vec3(plane), center) + plane.w >= -m_radius[i];
+			}
+
+			if (visible && view.backfaceCulling) {
+				glm::vec3 d = center - view.cameraPosition;
+				float along = glm::dot(d, glm::vec3(m_axisX[i], m_axisY[i], m_axisZ[i]));
+				visible = along < m_cutoff[i] * glm::length(d) + m_radius[i];
+			}
+
+			if (visible) {
+				emit(i);
+			}
+		}
+#endif
+		return visibleCount;
+	}
+}  // namespace RVK
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "Framework/Utils.h"
+
+#include <glm/glm.hpp>
+
+namespace RVK {
+	// A run of triangles in the index buffer small enough to be culled on its own.
+	// Cooked as is, so it has to stay plain data.
+	struct Meshlet {
+		u32 firstIndex;
+		u32 indexCount;
+		// bounding sphere in model space
+		glm::vec3 center;
+		float radius;
+		// all triangles face within the cone, a cutoff of 1 means no backface culling
+		glm::vec3 coneAxis;
+		float coneCutoff;
+	};
+
+	struct IndexRange {
+		u32 firstIndex;
+		u32 indexCount;
+	};
+
+	// what is left of a model after culling, neighbouring meshlets are merged into one range
+	struct MeshletDrawList {
+		// per submesh into ranges, submesh count + 1 entries, empty draws everything
+		std::vector<u32> meshOffsets;
+		std::vector<IndexRange> ranges;
+		u32 visibleMeshlets = 0;
+		u32 totalMeshlets = 0;
+
+		void Clear() {
+			meshOffsets.clear();
+			ranges.clear();
+			visibleMeshlets = 0;
+			totalMeshlets = 0;
+		}
+	};
+
+	struct MeshletCullView {
+		// frustum planes in model space, xyz normalized and pointing inwards
+		glm::vec4 planes[6];
+		glm::vec3 cameraPosition;
+		// normal cones don't survive non uniform scale
+		bool backfaceCulling = true;
+
+		static MeshletCullView Create(const glm::mat4& modelViewProjection, const glm::mat4& model, const glm::vec3& cameraPosition);
+	};
+
+	// Structure of arrays copy of the meshlet bounds, tested four at a time.
+	class MeshletCuller {
+	public:
+		void SetMeshlets(const Meshlet* meshlets, u32 meshletCount);
+		bool IsEmpty() const { return m_count == 0; }
+		u32 GetCount() const { return m_count; }
+		size_t GetMemorySize() const {
+			return (m_centerX.size() + m_centerY.size() + m_centerZ.size() + m_radius.size() +
+				m_axisX.size() + m_axisY.size() + m_axisZ.size() + m_cutoff.size()) * sizeof(float) +
+				m_ranges.size() * sizeof(IndexRange);
+		}
+
+		// appends the visible ranges of [firstMeshlet, firstMeshlet + meshletCount), returns how many meshlets passed
+		u32 Cull(const MeshletCullView& view, u32 firstMeshlet, u32 meshletCount, std::vector<IndexRange>& ranges) const;
+
+	private:
+		// padded to a multiple of four, the padding is never visible
+		std::vector<float> m_centerX, m_centerY, m_centerZ, m_radius;
+		std::vector<float> m_axisX, m_axisY, m_axisZ, m_cutoff;
+		std::vector<IndexRange> m_ranges;
+		u32 m_count = 0;
+	};
+}  // namespace RVK
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "Framework/JobSystem.h"
+
+namespace RVK {
+	// Calls fn(i) for every i in [0, count) on all hardware threads, the calling thread included.
+	// Items are handed out one at a time, so a few big items don't hold up the rest.
+	// Runs on the JobSystem when there is one, on threads of its own otherwise.
+	template<typename Fn>
+	void ParallelFor(u32 count, Fn&& fn) {
+		if (JobSystem::s_jobSystem) {
+			JobSystem::s_jobSystem->ParallelFor(count, fn);
+			return;
+		}
+
+		u32 threadCount = std::min(std::max(1u, std::thread::hardware_concurrency()), count);
+		if (threadCount <= 1) {
+			for (u32 i = 0; i < count; i++) {
+				fn(i);
+			}
+			return;
+		}
+
+		std::atomic<u32> next{ 0 };
+		auto worker = [&]() {
+			for (u32 i = next++; i < count; i = next++) {
+				fn(i);
+			}
+		};
+
+		std::vector<std::thread> threads;
+		threads.reserve(threadCount - 1);
+		for (u32 i = 0; i < threadCount - 1; i++) {
+			threads.emplace_back(worker);
+		}
+		worker();
+		for (auto& thread : threads) {
+			thread.join();
+		}
+	}
+}  // namespace RVK
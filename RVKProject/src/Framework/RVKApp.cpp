@@ -6,8 +6,13 @@
 #include "Framework/Vulkan/RVKBuffer.h"
 #include "Framework/Camera.h"
 #include "Framework/Vulkan/RenderSystem/entity_render_system.h"
+#include "Framework/Vulkan/RenderSystem/entity_depth_prepass_system.h"
+#include "Framework/Vulkan/RenderSystem/temporal_upscale_system.h"
+#include "Framework/Vulkan/DynamicResolution.h"
 #include "Framework/Vulkan/RenderSystem/entity_point_light_system.h"
 #include "Framework/Component.h"
+#include "Framework/SceneSerializer.h"
+#include "Framework/SystemScheduler.h"
 
 #include "../audio/WorkUnit_0/BGM.h"
 #include "../audio/WorkUnit_0/SE.h"
@@ -70,6 +75,8 @@ namespace RVK {
 		globalPool =
 			RVKDescriptorPool::Builder()
 			.SetMaxSets(MAX_FRAMES_IN_FLIGHT * POOL_SIZE)
+			// material sets are written again when a streamed texture changes its image
+			.SetPoolFlags(VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT)
 			.AddPoolSize(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, MAX_FRAMES_IN_FLIGHT * 10)
 			.AddPoolSize(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, MAX_FRAMES_IN_FLIGHT * 1000)
 			.Build();
@@ -132,8 +139,16 @@ namespace RVK {
 		//criAtomExPlayer_SetCueId(m_BGMplayer, bgm_acb_hn, CRI_BGM_KS039);
 		//criAtomExPlayer_Start(m_BGMplayer);
 		/////////////////////////////////////////////////////////////
-		LoadScene(std::make_unique<Scene>());
-		LoadGameObjects();
+		// the snapshot saved with F5 when there is one, LoadGameObjects builds the scene otherwise
+		if (auto scene = SceneSerializer::Load(SCENE_SNAPSHOT_PATH)) {
+			LoadScene(std::move(scene));
+		}
+		else {
+			LoadScene(std::make_unique<Scene>());
+			LoadGameObjects();
+		}
+		m_test2 = m_currentScene->FindEntity("test2");
+		m_testLight = m_currentScene->FindEntity("testLight");
 	}
 
 	RVKApp::~RVKApp() {
@@ -217,13 +232,109 @@ namespace RVK {
 			textureDescriptorSetLayout->GetDescriptorSetLayout()
 		};
 
-		EntityRenderSystem entityRenderSystem{
-			m_rvkRenderer.GetSwapChainRenderPass(),
-			descriptorSetLayoutsPbr };
+		RVKRenderGraph& renderGraph = m_rvkRenderer.GetRenderGraph();
+
+		std::unique_ptr<EntityDepthPrepassSystem> entityDepthPrepassSystem;
+		std::unique_ptr<EntityRenderSystem> entityRenderSystem;
+		std::unique_ptr<EntityPointLightSystem> entityPointLightSystem;
+		std::unique_ptr<TemporalUpscaleSystem> temporalUpscaleSystem;
+
+		// ping-pong pair owned by the upscaler, they survive graph rebuilds
+		RGResource historyRead = renderGraph.ImportImage(
+			"HistoryRead",
+			TemporalUpscaleSystem::HISTORY_FORMAT,
+			VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+			VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+			VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+		RGResource historyWrite = renderGraph.ImportImage(
+			"HistoryWrite",
+			TemporalUpscaleSystem::HISTORY_FORMAT,
+			VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+			VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+			VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+			VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+			VK_ACCESS_SHADER_READ_BIT);
+
+		RGResource sceneColor = RVKRenderGraph::INVALID_HANDLE;
+		RGResource sceneDepth = RVKRenderGraph::INVALID_HANDLE;
+		RGPass depthPrepass = RVKRenderGraph::INVALID_HANDLE;
+		RGPass forwardPass = RVKRenderGraph::INVALID_HANDLE;
+		RGPass upscalePass = RVKRenderGraph::INVALID_HANDLE;
+		bool useDepthPrepass = true;
+		TemporalUpscaleSystem::Inputs upscaleInputs{};
+
+		// with the prepass off the forward pass clears the depth itself, so the prepass gets culled.
+		// the scene is drawn into the top left of full size targets at the dynamic resolution scale,
+		// the upscale pass resolves it into the back buffer
+		auto buildRenderGraph = [&]() {
+			renderGraph.ClearPasses();
+			sceneColor = renderGraph.CreateImage("SceneColor", { VK_FORMAT_R16G16B16A16_SFLOAT });
+			sceneDepth = renderGraph.CreateImage("SceneDepth", { m_rvkRenderer.GetDepthFormat() });
+
+			depthPrepass = renderGraph.AddPass("DepthPrepass",
+				[&](RVKRenderGraph::PassBuilder& builder) {
+					builder.WriteDepth(sceneDepth);
+				},
+				[&](FrameInfo& frameInfo) {
+					entityDepthPrepassSystem->Render(frameInfo, m_currentScene->m_entityRoot);
+				});
+
+			forwardPass = renderGraph.AddPass("Forward",
+				[&](RVKRenderGraph::PassBuilder& builder) {
+					builder.WriteColor(sceneColor, VK_ATTACHMENT_LOAD_OP_CLEAR, { { 0.15f, 1.0f, 0.15f, 1.0f } });
+					builder.WriteDepth(sceneDepth, useDepthPrepass ? VK_ATTACHMENT_LOAD_OP_LOAD : VK_ATTACHMENT_LOAD_OP_CLEAR);
+				},
+				[&](FrameInfo& frameInfo) {
+					// order here matters
+					entityRenderSystem->RenderEntities(frameInfo, m_currentScene->m_entityRoot);
+					entityPointLightSystem->Render(frameInfo, m_currentScene->m_entityRoot);
+				});
+
+			upscalePass = renderGraph.AddPass("TemporalUpscale",
+				[&](RVKRenderGraph::PassBuilder& builder) {
+					builder.ReadTexture(sceneColor);
+					builder.ReadTexture(sceneDepth);
+					builder.ReadTexture(historyRead);
+					builder.WriteColor(m_rvkRenderer.GetBackBuffer(), VK_ATTACHMENT_LOAD_OP_DONT_CARE);
+					builder.WriteColor(historyWrite, VK_ATTACHMENT_LOAD_OP_DONT_CARE);
+				},
+				[&](FrameInfo& frameInfo) {
+					upscaleInputs.sceneColor = renderGraph.GetImageView(sceneColor);
+					upscaleInputs.sceneDepth = renderGraph.GetImageView(sceneDepth);
+					upscaleInputs.sceneExtent = renderGraph.GetImageExtent(sceneColor);
+					temporalUpscaleSystem->Render(frameInfo, upscaleInputs);
+				});
+
+			renderGraph.Compile();
+			if (entityRenderSystem) {
+				entityRenderSystem->SetDepthPrepass(useDepthPrepass);
+			}
+		};
+		buildRenderGraph();
+
+		// pipelines only need a compatible render pass, load ops don't matter so these survive a rebuild
+		entityDepthPrepassSystem = std::make_unique<EntityDepthPrepassSystem>(
+			renderGraph.GetRenderPass(depthPrepass),
+			descriptorSetLayoutsPbr);
+
+		entityRenderSystem = std::make_unique<EntityRenderSystem>(
+			renderGraph.GetRenderPass(forwardPass),
+			descriptorSetLayoutsPbr);
+		entityRenderSystem->SetDepthPrepass(useDepthPrepass);
+
+		entityPointLightSystem = std::make_unique<EntityPointLightSystem>(
+			renderGraph.GetRenderPass(forwardPass),
+			globalSetLayout->GetDescriptorSetLayout());
+
+		temporalUpscaleSystem = std::make_unique<TemporalUpscaleSystem>(renderGraph.GetRenderPass(upscalePass));
+
+		DynamicResolution dynamicResolution{};
 
-		EntityPointLightSystem entityPointLightSystem{
-			m_rvkRenderer.GetSwapChainRenderPass(),
-			globalSetLayout->GetDescriptorSetLayout() };
+		bool prepassKeyDown = false;
+		bool saveKeyDown = false;
+		float timingElapsed = 0.0f;
+		u32 timingFrames = 0;
+		std::unordered_map<std::string, float> passTimeSums;
 
 		KeyboardMovementController cameraController{};
 
@@ -244,10 +355,6 @@ namespace RVK {
 		//	//m_pBody->setRigidDynamicLockFlags(physx::PxRigidDynamicLockFlag::eLOCK_LINEAR_Y);
 		//}
 
-		m_test2 = m_currentScene->CreateEntity("test2");
-		m_test2.AddComponent<Components::Transform>(glm::vec3(0.5f, 0.0f, 0.0f), glm::vec3(0.0f), glm::vec3(0.1f));
-		m_test2.AddComponent<Components::Model>("models/Helicopter.fbx").SetOffsetPosition(glm::vec3(0.0f));
-
 		/*m_testFloor = m_currentScene->CreateEntity("Floor");
 		m_testFloor.AddComponent<Components::Mesh>("models/quad.obj", Model::ModelType::TinyObj);
 		m_testFloor.AddComponent<Components::Transform>(glm::vec3(0.0f, -3.0f, 0.0f), glm::vec3(0.0f), glm::vec3(5.0f));
@@ -259,62 +366,121 @@ namespace RVK {
 			m_pScene->addActor(*m_pFloor);
 		}*/
 
-		m_testLight = m_currentScene->CreateEntity("testLight");
-		m_testLight.AddComponent<Components::Transform>(glm::vec3(0.f, 0.f, 0.f));
-		m_testLight.AddComponent<Components::PointLight>(glm::vec3(1.f, 0.f, 0.f), 0.1f, 0.1f );
-
 		//criAtomExPlayer_SetCueId(m_BGMplayer, bgm_acb_hn, CRI_BGM_KS039);
 		//criAtomExPlayer_Start(m_BGMplayer);
 
+		// The systems touching GLFW stay on this thread, physics has nothing in the registry and runs next to
+		// them on a worker. Everything else moving a Transform goes one after the other, then the transforms.
+		float frameTime = 0.0f;
+		SystemScheduler updateSystems;
+		updateSystems.Add("MovementController",
+			SystemScheduler::Access().Write<Components::Transform>().MainThread(),
+			[&](entt::registry&) {
+				if (m_test2) {
+					cameraController.MoveInPlaneXZ(m_rvkWindow.GetGLFWwindow(), frameTime, m_test2);
+				}
+			});
+		updateSystems.Add("Camera",
+			SystemScheduler::Access().Write<Components::Camera, Components::Transform>().MainThread(),
+			[&](entt::registry& registry) {
+				float aspect = m_rvkRenderer.GetAspectRatio();
+				for (auto [entity, cam, transform] : registry.view<Components::Camera, Components::Transform>().each()) {
+					if (cam.currentCamera) {
+						glm::vec3 position = transform.GetPosition();
+						glm::vec3 rotate{ 0 };
+						if (glfwGetKey(m_rvkWindow.GetGLFWwindow(), GLFW_KEY_KP_4) == GLFW_PRESS) rotate.y += 1.f;
+						if (glfwGetKey(m_rvkWindow.GetGLFWwindow(), GLFW_KEY_KP_6) == GLFW_PRESS) rotate.y -= 1.f;
+						if (glfwGetKey(m_rvkWindow.GetGLFWwindow(), GLFW_KEY_KP_8) == GLFW_PRESS) rotate.x += 1.f;
+						if (glfwGetKey(m_rvkWindow.GetGLFWwindow(), GLFW_KEY_KP_2) == GLFW_PRESS) rotate.x -= 1.f;
+
+						if (glm::dot(rotate, rotate) > std::numeric_limits<float>::epsilon()) {
+							cam.rotation += 1.5f * frameTime * glm::normalize(rotate);
+						}
+
+						// limit pitch values between about +/- 85ish degrees
+						cam.rotation.x = glm::clamp(cam.rotation.x, -1.5f, 1.5f);
+						cam.rotation.y = glm::mod(cam.rotation.y, glm::two_pi<float>());
+
+						float yaw = cam.rotation.y;
+						const glm::vec3 forwardDir{ -sin(yaw), 0.f, -cos(yaw) };
+						const glm::vec3 rightDir{ -forwardDir.z, 0.f, forwardDir.x };
+						const glm::vec3 upDir{ 0.f, 1.f, 0.f };
+
+						glm::vec3 moveDir{ 0.f };
+						if (glfwGetKey(m_rvkWindow.GetGLFWwindow(), GLFW_KEY_UP) == GLFW_PRESS && glfwGetKey(m_rvkWindow.GetGLFWwindow(), GLFW_KEY_UP) != GLFW_REPEAT) moveDir += forwardDir;
+						if (glfwGetKey(m_rvkWindow.GetGLFWwindow(), GLFW_KEY_DOWN) == GLFW_PRESS) moveDir -= forwardDir;
+						if (glfwGetKey(m_rvkWindow.GetGLFWwindow(), GLFW_KEY_LEFT) == GLFW_PRESS) moveDir -= rightDir;
+						if (glfwGetKey(m_rvkWindow.GetGLFWwindow(), GLFW_KEY_RIGHT) == GLFW_PRESS) moveDir += rightDir;
+						if (glfwGetKey(m_rvkWindow.GetGLFWwindow(), GLFW_KEY_KP_7) == GLFW_PRESS) moveDir += upDir;
+						if (glfwGetKey(m_rvkWindow.GetGLFWwindow(), GLFW_KEY_KP_9) == GLFW_PRESS) moveDir -= upDir;
+
+						if (glm::dot(moveDir, moveDir) > std::numeric_limits<float>::epsilon()) {
+							position += 3.0f * frameTime * glm::normalize(moveDir);
+						}
+
+						// the transform only changes when the camera moved, its children stay clean otherwise
+						if (position != transform.GetPosition()) {
+							transform.SetPosition(position);
+						}
+						if (Components::Transform::EulerToQuat(cam.rotation) != transform.GetRotation()) {
+							transform.SetRotation(cam.rotation);
+						}
+						cam.camera.SetViewYXZ(position, cam.rotation);
+						cam.camera.SetPerspectiveProjection(glm::radians(50.f), aspect, 0.1f, 100.f);
+					}
+				}
+			});
+		updateSystems.Add("PointLights",
+			SystemScheduler::Access().Read<Components::PointLight>().Write<Components::Transform>(),
+			[&](entt::registry& registry) {
+				entityPointLightSystem->Animate(frameTime, registry);
+			});
+		updateSystems.Add("Physics",
+			SystemScheduler::Access().Write("Physics"),
+			[&](entt::registry&) {
+				m_pScene->simulate(frameTime);
+				m_pScene->fetchResults(true);
+			});
+		updateSystems.Add("Transforms",
+			SystemScheduler::Access().Write<Components::Transform, Components::WorldTransform, Components::Model>(),
+			[&](entt::registry&) {
+				m_currentScene->UpdateTransforms();
+			});
+		updateSystems.LogGraph();
+
 		while (!m_rvkWindow.ShouldClose()) {
-			glfwPollEvents();
+			if (m_rvkWindow.IsMinimized()) {
+				// nothing gets rendered, don't spin but keep the simulation and audio going
+				glfwWaitEventsTimeout(1.0 / 60.0);
+			}
+			else {
+				glfwPollEvents();
+			}
 			criAtomEx_ExecuteMain();
 			auto newTime = std::chrono::high_resolution_clock::now();
-			float frameTime =
-				std::chrono::duration<float, std::chrono::seconds::period>(newTime - currentTime).count();
+			frameTime = std::chrono::duration<float, std::chrono::seconds::period>(newTime - currentTime).count();
 			currentTime = newTime;
 
-			cameraController.MoveInPlaneXZ(m_rvkWindow.GetGLFWwindow(), frameTime, m_test2);
-
-			float aspect = m_rvkRenderer.GetAspectRatio();
-			for (auto [entity, cam, transform] : 
-				m_currentScene->m_entityRoot.view<Components::Camera, Components::Transform>().each()) {
-				if (cam.currentCamera) {
-					glm::vec3 rotate{ 0 };
-					if (glfwGetKey(m_rvkWindow.GetGLFWwindow(), GLFW_KEY_KP_4) == GLFW_PRESS) rotate.y += 1.f;
-					if (glfwGetKey(m_rvkWindow.GetGLFWwindow(), GLFW_KEY_KP_6) == GLFW_PRESS) rotate.y -= 1.f;
-					if (glfwGetKey(m_rvkWindow.GetGLFWwindow(), GLFW_KEY_KP_8) == GLFW_PRESS) rotate.x += 1.f;
-					if (glfwGetKey(m_rvkWindow.GetGLFWwindow(), GLFW_KEY_KP_2) == GLFW_PRESS) rotate.x -= 1.f;
-
-					if (glm::dot(rotate, rotate) > std::numeric_limits<float>::epsilon()) {
-						transform.rotation += 1.5f * frameTime * glm::normalize(rotate);
-					}
-
-					// limit pitch values between about +/- 85ish degrees
-					transform.rotation.x = glm::clamp(transform.rotation.x, -1.5f, 1.5f);
-					transform.rotation.y = glm::mod(transform.rotation.y, glm::two_pi<float>());
-
-					float yaw = transform.rotation.y;
-					const glm::vec3 forwardDir{ -sin(yaw), 0.f, -cos(yaw) };
-					const glm::vec3 rightDir{ -forwardDir.z, 0.f, forwardDir.x };
-					const glm::vec3 upDir{ 0.f, 1.f, 0.f };
-
-					glm::vec3 moveDir{ 0.f };
-					if (glfwGetKey(m_rvkWindow.GetGLFWwindow(), GLFW_KEY_UP) == GLFW_PRESS && glfwGetKey(m_rvkWindow.GetGLFWwindow(), GLFW_KEY_UP) != GLFW_REPEAT) moveDir += forwardDir;
-					if (glfwGetKey(m_rvkWindow.GetGLFWwindow(), GLFW_KEY_DOWN) == GLFW_PRESS) moveDir -= forwardDir;
-					if (glfwGetKey(m_rvkWindow.GetGLFWwindow(), GLFW_KEY_LEFT) == GLFW_PRESS) moveDir -= rightDir;
-					if (glfwGetKey(m_rvkWindow.GetGLFWwindow(), GLFW_KEY_RIGHT) == GLFW_PRESS) moveDir += rightDir;
-					if (glfwGetKey(m_rvkWindow.GetGLFWwindow(), GLFW_KEY_KP_7) == GLFW_PRESS) moveDir += upDir;
-					if (glfwGetKey(m_rvkWindow.GetGLFWwindow(), GLFW_KEY_KP_9) == GLFW_PRESS) moveDir -= upDir;
-
-					if (glm::dot(moveDir, moveDir) > std::numeric_limits<float>::epsilon()) {
-						transform.position += 3.0f * frameTime * glm::normalize(moveDir);
-					}
+			// input, physics and everything that moves things, then the transforms
+			updateSystems.Run(m_currentScene->m_entityRoot);
+
+			bool prepassKeyPressed = glfwGetKey(m_rvkWindow.GetGLFWwindow(), GLFW_KEY_P) == GLFW_PRESS;
+			if (prepassKeyPressed && !prepassKeyDown) {
+				useDepthPrepass = !useDepthPrepass;
+				// the old transient images and framebuffers go through the deletion queue
+				buildRenderGraph();
+				passTimeSums.clear();
+				timingElapsed = 0.0f;
+				timingFrames = 0;
+				VK_CORE_INFO("Depth Prepass {0}", useDepthPrepass ? "On" : "Off");
+			}
+			prepassKeyDown = prepassKeyPressed;
 
-					cam.camera.SetViewYXZ(transform.position, transform.rotation);
-					cam.camera.SetPerspectiveProjection(glm::radians(50.f), aspect, 0.1f, 100.f);
-				}
+			bool saveKeyPressed = glfwGetKey(m_rvkWindow.GetGLFWwindow(), GLFW_KEY_F5) == GLFW_PRESS;
+			if (saveKeyPressed && !saveKeyDown && !SceneSerializer::Save(*m_currentScene, SCENE_SNAPSHOT_PATH)) {
+				VK_CORE_WARN("Could not save the scene to {0}", SCENE_SNAPSHOT_PATH);
 			}
+			saveKeyDown = saveKeyPressed;
 
 			if (glfwGetKey(m_rvkWindow.GetGLFWwindow(), GLFW_KEY_Z) == GLFW_PRESS) {
 				criAtomExPlayer_SetCueId(m_BGMplayer, bgm_acb_hn, CRI_BASIC_MUSIC1);
@@ -339,11 +505,14 @@ namespace RVK {
 			//	physx::PxTransform t{ reinterpret_cast<const physx::PxVec3&>(bodyPos) };
 			//	m_pBody->setGlobalPose(t);
 			//}
-			m_pScene->simulate(frameTime);
-			m_pScene->fetchResults(true);
-
 			//m_test.GetComponent<Components::Transform>().position = reinterpret_cast<const glm::vec3&>(m_pBody->getGlobalPose().p)/* - glm::vec3(0.f, 1.5f, 0.f)*/;
 
+			// uploads of finished loads are submitted ahead of the frame
+			m_assetLoader.Update();
+			m_resourceManager.Update();
+			m_textureStreamer.Update();
+			Texture::FlushBlits();
+
 			if (auto commandBuffer = m_rvkRenderer.BeginFrame()) {
 				int frameIndex = m_rvkRenderer.GetFrameIndex();
 				FrameInfo frameInfo{
@@ -353,29 +522,69 @@ namespace RVK {
 					globalDescriptorSets[frameIndex],
 				};
 
+				// resolution for this frame, the upscaler brings it back to the swap chain size
+				float renderScale = dynamicResolution.GetScale();
+				renderGraph.SetRenderScale(depthPrepass, renderScale);
+				renderGraph.SetRenderScale(forwardPass, renderScale);
+				temporalUpscaleSystem->Prepare(frameInfo, renderGraph, historyRead, historyWrite);
+				upscaleInputs.renderExtent = RVKRenderGraph::ScaleExtent(renderGraph.GetExtent(), renderScale);
+				upscaleInputs.jitter = temporalUpscaleSystem->GetJitter();
+
 				// update
 				GlobalUbo ubo{};
 				for (auto [entity, cam] :
 					m_currentScene->m_entityRoot.view<Components::Camera>().each()) {
 					if (cam.currentCamera) {
-						ubo.projection = cam.camera.GetProjection();
+						// pixels go down, NDC y goes up
+						cam.camera.SetJitter(glm::vec2(
+							2.0f * upscaleInputs.jitter.x / upscaleInputs.renderExtent.width,
+							-2.0f * upscaleInputs.jitter.y / upscaleInputs.renderExtent.height));
+						ubo.projection = cam.camera.GetJitteredProjection();
 						ubo.view = cam.camera.GetView();
 						ubo.inverseView = cam.camera.GetInverseView();
+						upscaleInputs.viewProjection = cam.camera.GetProjection() * cam.camera.GetView();
 					}
 				}
-				entityPointLightSystem.Update(frameInfo, ubo, m_currentScene->m_entityRoot);
+				entityPointLightSystem->Update(ubo, m_currentScene->m_entityRoot);
+				entityRenderSystem->Update(ubo, upscaleInputs.renderExtent, m_currentScene->m_entityRoot);
 				uboBuffers[frameIndex]->WriteToBuffer(&ubo);
 				uboBuffers[frameIndex]->Flush();
 
 				// render
-				m_rvkRenderer.BeginSwapChainRenderPass(commandBuffer);
-
-				// order here matters
-				entityRenderSystem.RenderEntities(frameInfo, m_currentScene->m_entityRoot);
-				entityPointLightSystem.Render(frameInfo, m_currentScene->m_entityRoot);
-
-				m_rvkRenderer.EndSwapChainRenderPass(commandBuffer);
+				m_rvkRenderer.ExecuteRenderGraph(frameInfo);
 				m_rvkRenderer.EndFrame();
+
+				float gpuTime = 0.0f;
+				for (const auto& timing : renderGraph.GetPassTimings()) {
+					passTimeSums[timing.name] += timing.gpuTime;
+					gpuTime += timing.gpuTime;
+				}
+				dynamicResolution.Update(gpuTime);
+
+				timingElapsed += frameTime;
+				timingFrames++;
+				if (timingElapsed >= 2.0f) {
+					std::string report;
+					for (const auto& [name, sum] : passTimeSums) {
+						report += fmt::format(" {0}: {1:.3f}ms", name, sum / timingFrames);
+					}
+					VK_CORE_INFO("GPU Pass Timings (Depth Prepass {0}, Render Scale {1:.2f}, Meshlets {2}/{3}):{4}",
+						useDepthPrepass ? "On" : "Off", dynamicResolution.GetScale(),
+						entityRenderSystem->GetVisibleMeshlets(), entityRenderSystem->GetTestedMeshlets(), report);
+					ResourceManager::Stats resources = m_resourceManager.GetStats();
+					VK_CORE_INFO("Models: {0} in use, {1} loading, {2} cached ({3:.1f} MB), {4:.1f} MB CPU, {5:.1f} MB GPU, {6} hits, {7} misses, {8} evictions",
+						resources.inUse, resources.loading, resources.cached, resources.cachedBytes / (1024.0 * 1024.0),
+						resources.cpuBytes / (1024.0 * 1024.0), resources.gpuBytes / (1024.0 * 1024.0),
+						resources.hits, resources.misses, resources.evictions);
+					TextureStreamer::Stats textures = m_textureStreamer.GetStats();
+					VK_CORE_INFO("Textures: {0} streamed, {1} reading, {2:.1f} MB resident, {3:.1f} MB wanted of {4:.1f} MB budget, {5:.1f} MB read",
+						textures.textures, textures.streaming, textures.residentBytes / (1024.0 * 1024.0),
+						textures.wantedBytes / (1024.0 * 1024.0), textures.budget / (1024.0 * 1024.0),
+						textures.streamedBytes / (1024.0 * 1024.0));
+					passTimeSums.clear();
+					timingElapsed = 0.0f;
+					timingFrames = 0;
+				}
 			}
 		}
 
@@ -383,6 +592,14 @@ namespace RVK {
 	}
 
 	void RVKApp::LoadGameObjects() {
+		Entity test2 = m_currentScene->CreateEntity("test2");
+		test2.AddComponent<Components::Transform>(glm::vec3(0.5f, 0.0f, 0.0f), glm::vec3(0.0f), glm::vec3(0.1f));
+		test2.AddComponent<Components::Model>("models/Helicopter.fbx", MeshImporter::Auto, VertexFormat::Compressed).SetOffsetPosition(glm::vec3(0.0f));
+
+		Entity testLight = m_currentScene->CreateEntity("testLight");
+		testLight.AddComponent<Components::Transform>(glm::vec3(0.f, 0.f, 0.f));
+		testLight.AddComponent<Components::PointLight>(glm::vec3(1.f, 0.f, 0.f), 0.1f, 0.1f );
+
 		std::vector<glm::vec3> lightColors{
 			{1.f, .1f, .1f},
 			{.1f, .1f, 1.f},
@@ -393,7 +610,7 @@ namespace RVK {
 		};
 
 		for (int i = 0; i < lightColors.size(); i++) {
-			auto pointLight = m_currentScene->CreateEntity("Point Light "+ i);
+			auto pointLight = m_currentScene->CreateEntity("Point Light " + std::to_string(i));
 			pointLight.AddComponent<Components::PointLight>(lightColors[i]);
 			auto rotateLight = glm::rotate(
 				glm::mat4(1.f),
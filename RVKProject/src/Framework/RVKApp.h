@@ -7,6 +7,9 @@
 #include <cri_le_atom_wasapi.h>
 
 #include "Framework/Utils.h"
+#include "Framework/JobSystem.h"
+#include "Framework/ResourceManager.h"
+#include "Framework/TextureStreamer.h"
 #include "Framework/Vulkan/RVKWindow.h"
 #include "Framework/Vulkan/RVKRenderer.h"
 #include "Framework/Vulkan/RVKDescriptors.h"
@@ -18,6 +21,8 @@ namespace RVK {
 	 public:
 	  static constexpr int WIDTH = 1280;
 	  static constexpr int HEIGHT = 720;
+	  // F5 saves the current scene here, it is loaded instead of LoadGameObjects from then on
+	  static constexpr const char* SCENE_SNAPSHOT_PATH = "scenes/default.rvkscene";
 	  // note: order of declarations matters
 	  std::unique_ptr<RVKDescriptorPool> globalPool{};
 
@@ -33,8 +38,14 @@ namespace RVK {
 	 private:
 	  void LoadGameObjects();
 
+	  // first in and last out, everything below may use ParallelFor
+	  JobSystem m_jobSystem;
 	  RVKWindow m_rvkWindow{WIDTH, HEIGHT, "Vulkan App"};
 	  RVKRenderer m_rvkRenderer{m_rvkWindow};
+	  // after the renderer, so the workers stop before the device goes away
+	  TextureStreamer m_textureStreamer;
+	  AssetLoader m_assetLoader;
+	  ResourceManager m_resourceManager{m_assetLoader};
 
 	  std::unique_ptr<Scene> m_currentScene;
 
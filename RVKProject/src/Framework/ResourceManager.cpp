@@ -0,0 +1,147 @@
+#include "Framework/ResourceManager.h"
+
+#include <filesystem>
+
+namespace RVK {
+	ResourceManager* ResourceManager::s_resourceManager = nullptr;
+
+	ResourceManager::ResourceManager(AssetLoader& assetLoader, u64 cacheBudget)
+		: m_assetLoader(assetLoader), m_cacheBudget(cacheBudget) {
+		if (s_resourceManager) {
+			VK_CORE_CRITICAL("ResourceManager already initialized");
+		}
+		s_resourceManager = this;
+	}
+
+	ResourceManager::~ResourceManager() {
+		// handles still around release into nothing
+		if (s_resourceManager == this) {
+			s_resourceManager = nullptr;
+		}
+	}
+
+	std::string ResourceManager::MakeKey(const std::string& path, MeshImporter importer, VertexFormat vertexFormat) {
+		// "models/a.obj" and "models/../models/a.obj" are the same file, Auto and the importer it picks the same import
+		std::error_code error;
+		std::filesystem::path canonical = std::filesystem::weakly_canonical(ENGINE_DIR + path, error);
+		std::string file = error ? path : canonical.generic_string();
+		return file + "|" + std::to_string(static_cast<u32>(MeshModel::ResolveImporter(path, importer))) +
+			"|" + std::to_string(static_cast<u32>(vertexFormat));
+	}
+
+	u64 ResourceManager::GetBytes(const ModelAsset& asset) {
+		if (!asset.IsResident()) {
+			return 0;
+		}
+		MeshModel::MemoryUsage usage = asset.GetModel()->GetMemoryUsage();
+		return usage.cpuBytes + usage.gpuBytes;
+	}
+
+	std::shared_ptr<ModelAsset> ResourceManager::GetModel(const std::string& path, MeshImporter importer, VertexFormat vertexFormat) {
+		std::string key = MakeKey(path, importer, vertexFormat);
+		Entry& entry = m_entries[key];
+		if (auto handle = entry.handle.lock()) {
+			m_hits++;
+			return handle;
+		}
+
+		if (entry.asset) {
+			m_hits++;
+		}
+		else {
+			m_misses++;
+			entry.asset = m_assetLoader.LoadModel(path, importer, vertexFormat);
+		}
+		if (entry.cached) {
+			m_lru.erase(entry.lruPosition);
+			entry.cached = false;
+		}
+
+		// the entry keeps the asset, the handle only tells when the last user is gone
+		std::shared_ptr<ModelAsset> handle(entry.asset.get(), [key](ModelAsset*) {
+			if (s_resourceManager) {
+				s_resourceManager->Release(key);
+			}
+		});
+		entry.handle = handle;
+		return handle;
+	}
+
+	void ResourceManager::Release(const std::string& key) {
+		auto it = m_entries.find(key);
+		if (it == m_entries.end() || it->second.cached) {
+			return;
+		}
+
+		Entry& entry = it->second;
+		m_lru.push_front(key);
+		entry.lruPosition = m_lru.begin();
+		entry.cached = true;
+		Trim();
+	}
+
+	void ResourceManager::Trim() {
+		u64 cachedBytes = 0;
+		for (auto it = m_lru.begin(); it != m_lru.end();) {
+			auto entry = m_entries.find(*it);
+			// nothing to keep of a load that failed, the next GetModel tries again
+			if (entry->second.asset->GetState() == ModelAsset::State::Failed) {
+				it = m_lru.erase(it);
+				m_entries.erase(entry);
+				continue;
+			}
+			cachedBytes += GetBytes(*entry->second.asset);
+			++it;
+		}
+
+		// from the least recently released, models still loading take no memory yet and stay
+		for (auto it = m_lru.end(); it != m_lru.begin() && cachedBytes > m_cacheBudget;) {
+			--it;
+			auto entry = m_entries.find(*it);
+			u64 bytes = GetBytes(*entry->second.asset);
+			if (bytes == 0) {
+				continue;
+			}
+
+			cachedBytes -= bytes;
+			m_evictions++;
+			VK_CORE_INFO("Evicted {0} from the model cache ({1:.1f} MB)", entry->second.asset->GetPath(), bytes / (1024.0 * 1024.0));
+			it = m_lru.erase(it);
+			m_entries.erase(entry);
+		}
+	}
+
+	void ResourceManager::SetCacheBudget(u64 cacheBudget) {
+		m_cacheBudget = cacheBudget;
+		Trim();
+	}
+
+	ResourceManager::Stats ResourceManager::GetStats() const {
+		Stats stats{};
+		for (const auto& [key, entry] : m_entries) {
+			if (!entry.asset) {
+				continue;
+			}
+
+			if (entry.cached) {
+				stats.cached += entry.asset->IsResident() ? 1 : 0;
+				stats.cachedBytes += GetBytes(*entry.asset);
+			}
+			else {
+				stats.inUse++;
+			}
+			if (!entry.asset->IsResident()) {
+				stats.loading += entry.asset->GetState() != ModelAsset::State::Failed ? 1 : 0;
+				continue;
+			}
+
+			MeshModel::MemoryUsage usage = entry.asset->GetModel()->GetMemoryUsage();
+			stats.cpuBytes += usage.cpuBytes;
+			stats.gpuBytes += usage.gpuBytes;
+		}
+		stats.hits = m_hits;
+		stats.misses = m_misses;
+		stats.evictions = m_evictions;
+		return stats;
+	}
+}  // namespace RVK
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "Framework/AssetLoader.h"
+
+#include <list>
+
+namespace RVK {
+	// Hands out one ModelAsset per file, importer and vertex format. Models nobody holds any more stay
+	// loaded in a least recently used list until it grows past the budget. Main thread only.
+	class ResourceManager {
+	public:
+		static ResourceManager* s_resourceManager;
+		static constexpr u64 DEFAULT_CACHE_BUDGET = 256ull * 1024 * 1024;
+
+		struct Stats {
+			// held by someone
+			u32 inUse = 0;
+			// not resident yet, in use or not
+			u32 loading = 0;
+			// resident and held by nobody
+			u32 cached = 0;
+			// of every resident model, cached ones included
+			u64 cpuBytes = 0;
+			u64 gpuBytes = 0;
+			u64 cachedBytes = 0;
+			u64 hits = 0;
+			u64 misses = 0;
+			u64 evictions = 0;
+		};
+
+	public:
+		ResourceManager(AssetLoader& assetLoader, u64 cacheBudget = DEFAULT_CACHE_BUDGET);
+		~ResourceManager();
+
+		NO_COPY(ResourceManager)
+		NO_MOVE(ResourceManager)
+
+		// the asset stays cached until every handle returned for it is gone
+		std::shared_ptr<ModelAsset> GetModel(
+			const std::string& path,
+			MeshImporter importer = MeshImporter::Auto,
+			VertexFormat vertexFormat = VertexFormat::Full);
+
+		// models released while loading only get their size once resident, so trim every frame
+		void Update() { Trim(); }
+		void SetCacheBudget(u64 cacheBudget);
+		Stats GetStats() const;
+
+	private:
+		struct Entry {
+			std::shared_ptr<ModelAsset> asset;
+			// the control block shared by all users, expired while the entry is cached
+			std::weak_ptr<ModelAsset> handle;
+			// position in m_lru while nobody holds it
+			std::list<std::string>::iterator lruPosition;
+			bool cached = false;
+		};
+
+		static std::string MakeKey(const std::string& path, MeshImporter importer, VertexFormat vertexFormat);
+		static u64 GetBytes(const ModelAsset& asset);
+		void Release(const std::string& key);
+		void Trim();
+
+		AssetLoader& m_assetLoader;
+		u64 m_cacheBudget;
+		std::unordered_map<std::string, Entry> m_entries;
+		// most recently released first
+		std::list<std::string> m_lru;
+		u64 m_hits = 0;
+		u64 m_misses = 0;
+		u64 m_evictions = 0;
+	};
+}  // namespace RVK
@@ -3,16 +3,205 @@
 #include "Framework/Entity.h"
 
 namespace RVK {
-	Scene::Scene(){
+	namespace {
+		// inverse transpose, the world matrices can carry non uniform scale from any parent
+		glm::mat4 GetNormalMatrix(const glm::mat4& matrix) {
+			return glm::mat4(glm::transpose(glm::inverse(glm::mat3(matrix))));
+		}
+	}  // namespace
+
+	Scene::Scene() : Scene(true) {}
+
+	Scene::Scene(bool createDebugCamera) {
+		m_entityRoot.on_construct<Components::Transform>().connect<&Scene::OnTransformConstruct>();
+		m_entityRoot.on_destroy<Components::Transform>().connect<&Scene::OnTransformDestroy>();
+		m_entityRoot.on_destroy<Components::Tag>().connect<&Scene::OnTagDestroy>(*this);
+
+		if (!createDebugCamera) {
+			return;
+		}
 		Entity m_debugCamera = CreateEntity("Debug Camera");
 		m_debugCamera.AddComponent<Components::Camera>(true);
 		m_debugCamera.AddComponent<Components::Transform>(glm::vec3{ 0.0f, 0.0f, 2.5f });
 	}
 
-	Entity& Scene::CreateEntity(std::string_view name) {
-		Entity entity(m_entityRoot.create(), this, name);
-		m_entityMap[name] = entity.GetEntityID();
+	Entity Scene::CreateEntity(std::string_view name) {
+		Entity entity(m_entityRoot.create(), this);
+		StringId id(name);
+		entity.AddComponent<Components::Tag>(id);
+		m_entityMap[id].push_back(entity.GetEntityID());
 
 		return entity;
 	}
-}
\ No newline at end of file
+
+	Entity Scene::FindEntity(StringId name) {
+		auto it = m_entityMap.find(name);
+		return it != m_entityMap.end() ? Entity(it->second.back(), this) : Entity{};
+	}
+
+	void Scene::OnTagDestroy(entt::registry& registry, entt::entity entity) {
+		// the others with the same name stay, the one before it is found again if it was the newest
+		auto it = m_entityMap.find(registry.get<Components::Tag>(entity).tag);
+		if (it == m_entityMap.end()) {
+			return;
+		}
+		std::vector<entt::entity>& entities = it->second;
+		entities.erase(std::remove(entities.begin(), entities.end(), entity), entities.end());
+		if (entities.empty()) {
+			m_entityMap.erase(it);
+		}
+	}
+
+	void Scene::OnTransformConstruct(entt::registry& registry, entt::entity entity) {
+		registry.emplace_or_replace<Components::WorldTransform>(entity);
+	}
+
+	void Scene::OnTransformDestroy(entt::registry& registry, entt::entity entity) {
+		// children become roots where they are, their local transform is now relative to the world
+		auto& transform = registry.get<Components::Transform>(entity);
+		for (entt::entity child : transform.m_children) {
+			auto& childTransform = registry.get<Components::Transform>(child);
+			childTransform.m_parent = entt::null;
+			childTransform.m_dirty = true;
+		}
+		if (transform.m_parent != entt::null) {
+			auto& siblings = registry.get<Components::Transform>(transform.m_parent).m_children;
+			siblings.erase(std::find(siblings.begin(), siblings.end(), entity));
+		}
+		registry.remove<Components::WorldTransform>(entity);
+	}
+
+	void Scene::Detach(entt::entity child) {
+		auto& transform = m_entityRoot.get<Components::Transform>(child);
+		if (transform.m_parent == entt::null) {
+			return;
+		}
+		auto& siblings = m_entityRoot.get<Components::Transform>(transform.m_parent).m_children;
+		siblings.erase(std::find(siblings.begin(), siblings.end(), child));
+		transform.m_parent = entt::null;
+	}
+
+	bool Scene::SetParent(entt::entity child, entt::entity parent) {
+		if (!m_entityRoot.all_of<Components::Transform>(child) ||
+			(parent != entt::null && !m_entityRoot.all_of<Components::Transform>(parent))) {
+			return false;
+		}
+		for (entt::entity ancestor = parent; ancestor != entt::null;
+			ancestor = m_entityRoot.get<Components::Transform>(ancestor).m_parent) {
+			if (ancestor == child) {
+				VK_CORE_WARN("SetParent would make the entity its own ancestor");
+				return false;
+			}
+		}
+
+		Detach(child);
+		auto& transform = m_entityRoot.get<Components::Transform>(child);
+		transform.m_parent = parent;
+		transform.m_dirty = true;
+		if (parent != entt::null) {
+			m_entityRoot.get<Components::Transform>(parent).m_children.push_back(child);
+		}
+		return true;
+	}
+
+	void Scene::UpdateTransforms() {
+		auto view = m_entityRoot.view<Components::Transform>();
+		if (view.size() >= BATCH_MIN_TRANSFORMS) {
+			UpdateTransformsBatched();
+			return;
+		}
+		for (auto entity : view) {
+			if (view.get<Components::Transform>(entity).m_parent == entt::null) {
+				UpdateTransform(entity, nullptr, false);
+			}
+		}
+	}
+
+	void Scene::UpdateTransform(entt::entity entity, const Components::WorldTransform* parent, bool parentChanged) {
+		auto& transform = m_entityRoot.get<Components::Transform>(entity);
+		auto& world = m_entityRoot.get<Components::WorldTransform>(entity);
+		bool changed = transform.UpdateLocalMatrix() || parentChanged;
+		if (changed) {
+			world.matrix = parent ? parent->matrix * transform.GetLocalMatrix() : transform.GetLocalMatrix();
+			world.normalMatrix = GetNormalMatrix(world.matrix);
+		}
+		UpdateMeshMatrix(entity, world, changed);
+
+		// the pools don't change during the update, so world stays where it is
+		for (entt::entity child : transform.m_children) {
+			UpdateTransform(child, &world, changed);
+		}
+	}
+
+	void Scene::UpdateTransformsBatched() {
+		auto view = m_entityRoot.view<Components::Transform>();
+		m_transformBatch.Clear();
+		m_transformBatch.Reserve(static_cast<u32>(view.size()));
+		m_batchEntities.clear();
+		m_transformLevel.clear();
+		for (auto entity : view) {
+			if (view.get<Components::Transform>(entity).m_parent == entt::null) {
+				m_transformLevel.emplace_back(entity, TransformBatch::NO_PARENT);
+			}
+		}
+
+		// breadth first, a level of the hierarchy is a level of the batch
+		// only what is dirty or below something dirty goes in, the rest keeps its matrices
+		while (!m_transformLevel.empty()) {
+			for (auto [entity, parent] : m_transformLevel) {
+				auto& transform = view.get<Components::Transform>(entity);
+				u32 index = TransformBatch::NO_PARENT;
+				if (transform.m_dirty || parent != TransformBatch::NO_PARENT) {
+					if (parent == TransformBatch::NO_PARENT && transform.m_parent != entt::null) {
+						const auto& parentWorld = m_entityRoot.get<Components::WorldTransform>(transform.m_parent);
+						parent = m_transformBatch.AddFixed(parentWorld.matrix, parentWorld.normalMatrix);
+					}
+					index = m_transformBatch.Add(transform.m_position, transform.m_rotation, transform.m_scale, parent);
+					m_batchEntities.push_back(entity);
+				}
+				for (entt::entity child : transform.m_children) {
+					m_nextTransformLevel.emplace_back(child, index);
+				}
+			}
+			m_transformBatch.NextLevel();
+			std::swap(m_transformLevel, m_nextTransformLevel);
+			m_nextTransformLevel.clear();
+		}
+		if (!m_batchEntities.empty()) {
+			m_transformBatch.Update();
+		}
+
+		for (u32 i = 0; i < static_cast<u32>(m_batchEntities.size()); i++) {
+			entt::entity entity = m_batchEntities[i];
+			auto& transform = view.get<Components::Transform>(entity);
+			auto& world = m_entityRoot.get<Components::WorldTransform>(entity);
+			transform.m_localMatrix = m_transformBatch.GetLocalMatrix(i);
+			transform.m_dirty = false;
+			world.matrix = m_transformBatch.GetWorldMatrix(i);
+			world.normalMatrix = m_transformBatch.GetNormalMatrix(i);
+			UpdateMeshMatrix(entity, world, true);
+		}
+		// offsets that changed while their entity didn't
+		for (auto [entity, model, world] : m_entityRoot.view<Components::Model, Components::WorldTransform>().each()) {
+			if (model.offset.IsDirty()) {
+				UpdateMeshMatrix(entity, world, false);
+			}
+		}
+	}
+
+	void Scene::UpdateMeshMatrix(entt::entity entity, Components::WorldTransform& world, bool changed) {
+		auto* mesh = m_entityRoot.try_get<Components::Model>(entity);
+		bool offsetChanged = mesh && mesh->offset.UpdateLocalMatrix();
+		if (!changed && !offsetChanged) {
+			return;
+		}
+		if (mesh) {
+			world.meshMatrix = world.matrix * mesh->offset.GetLocalMatrix();
+			world.meshNormalMatrix = GetNormalMatrix(world.meshMatrix);
+		}
+		else {
+			world.meshMatrix = world.matrix;
+			world.meshNormalMatrix = world.normalMatrix;
+		}
+	}
+}
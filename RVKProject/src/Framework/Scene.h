@@ -5,11 +5,13 @@
 
 #include "Framework/Camera.h"
 #include "Framework/Component.h"
+#include "Framework/TransformBatch.h"
 
 namespace RVK {
 	class Entity;
 	class Scene {
 	public:
+		// with the debug camera
 		Scene();
 		~Scene() = default;
 
@@ -17,7 +19,21 @@ namespace RVK {
 		//virtual void PreUpdate();
 		//virtual void Update([[maybe_unused]] float deltaTime);
 
-		Entity& CreateEntity(std::string_view name);
+		// the name is interned and the entity tagged with it
+		Entity CreateEntity(std::string_view name);
+		// the last entity created with the name still alive, an empty Entity if there is none.
+		// Names built at runtime go through StringId::Hash, which doesn't intern them.
+		Entity FindEntity(StringId name);
+
+		// Transform hierarchy
+		// entt::null detaches, false if either has no Transform or parent is child or below it.
+		// The child keeps its local transform, so it moves along with the new parent.
+		bool SetParent(entt::entity child, entt::entity parent);
+		// Top down from the roots, local matrices are rebuilt where they are dirty and world matrices where
+		// they or a parent changed. Once per frame after gameplay moved things and before the renderers read them.
+		// From BATCH_MIN_TRANSFORMS on the changed subtrees go through a TransformBatch instead of one by one.
+		void UpdateTransforms();
+		static constexpr u32 BATCH_MIN_TRANSFORMS = 1024;
 
 		bool IsRunning() { return m_isRunning; }
 		bool IsPause() { return m_isPaused; }
@@ -25,11 +41,30 @@ namespace RVK {
 		entt::registry m_entityRoot;
 
 	private:
+		friend class SceneSerializer;
+
+		// empty, for a scene that is loaded into
+		explicit Scene(bool createDebugCamera);
+		void UpdateTransform(entt::entity entity, const Components::WorldTransform* parent, bool parentChanged);
+		void UpdateTransformsBatched();
+		void UpdateMeshMatrix(entt::entity entity, Components::WorldTransform& world, bool changed);
+		void Detach(entt::entity child);
+		static void OnTransformConstruct(entt::registry& registry, entt::entity entity);
+		static void OnTransformDestroy(entt::registry& registry, entt::entity entity);
+		void OnTagDestroy(entt::registry& registry, entt::entity entity);
+
 		//Entity m_debugCamera;
 		//std::unique_ptr<physx::PxScene> m_pxScene;
-		std::unordered_map<std::string_view, entt::entity> m_entityMap;
+		// every entity alive with the name, in the order they were created in
+		std::unordered_map<StringId, std::vector<entt::entity>> m_entityMap;
+
+		// kept between frames so the batched update doesn't allocate
+		TransformBatch m_transformBatch;
+		std::vector<entt::entity> m_batchEntities;
+		// entity and the batch index of its parent, NO_PARENT if the parent didn't change
+		std::vector<std::pair<entt::entity, u32>> m_transformLevel, m_nextTransformLevel;
 
 		bool m_isRunning = false;
 		bool m_isPaused = false;
 	};
-}
\ No newline at end of file
+}
@@ -0,0 +1,413 @@
+#include "Framework/SceneSerializer.h"
+#include "Framework/MappedFile.h"
+#include "Framework/Parallel.h"
+
+#include <filesystem>
+#include <fstream>
+
+namespace RVK {
+	namespace {
+		using EntityValue = entt::entt_traits<entt::entity>::entity_type;
+		constexpr u32 SECTION_COUNT = static_cast<u32>(SceneSection::Count);
+		// records per ParallelFor item while loading
+		constexpr u32 CHUNK_SIZE = 1024;
+
+		constexpr std::array<u32, SECTION_COUNT> SECTION_STRIDES = {
+			sizeof(SceneTagRecord),
+			sizeof(SceneTransformRecord),
+			sizeof(SceneModelRecord),
+			sizeof(SceneCameraRecord),
+			sizeof(Components::PointLight),
+		};
+		// loaded straight out of the file
+		static_assert(std::is_trivially_copyable_v<Components::PointLight>);
+
+		u64 AlignBlob(u64 offset) {
+			return (offset + 15) & ~u64(15);
+		}
+
+		template<typename T>
+		const T* GetBlob(const u8* data, u64 offset) {
+			return reinterpret_cast<const T*>(data + offset);
+		}
+
+		SceneTransformRecord ToRecord(const Components::Transform& transform) {
+			SceneTransformRecord record{};
+			record.position = transform.GetPosition();
+			record.parent = entt::to_integral(transform.GetParent());
+			record.rotation = transform.GetRotation();
+			record.scale = transform.GetScale();
+			return record;
+		}
+
+		void FromRecord(Components::Transform& transform, const SceneTransformRecord& record) {
+			transform.SetPosition(record.position);
+			transform.SetRotation(record.rotation);
+			transform.SetScale(record.scale);
+		}
+
+		// The archive entt::snapshot writes to. The entities and the components of a pool go to blobs of their
+		// own, the loader hands both to the registry as they are.
+		class SnapshotWriter {
+		public:
+			struct Section {
+				std::vector<entt::entity> entities;
+				std::vector<u8> data;
+			};
+
+			void BeginEntityPool() { m_section = nullptr; }
+			void Begin(SceneSection section) { m_section = &m_sections[static_cast<u32>(section)]; }
+
+			// the size of a pool, or the free list of the entity pool
+			void operator()(EntityValue value) {
+				if (!m_section) {
+					m_entityPool.push_back(value);
+					return;
+				}
+				m_section->entities.reserve(value);
+			}
+			void operator()(entt::entity entity) {
+				if (!m_section) {
+					m_entityPool.push_back(entt::to_integral(entity));
+					return;
+				}
+				m_section->entities.push_back(entity);
+			}
+
+			void operator()(const Components::Tag& tag) {
+				std::string_view name = tag.tag.GetString();
+				Write(SceneTagRecord{ AddString(name), static_cast<u32>(name.size()) });
+			}
+			void operator()(const Components::Transform& transform) {
+				Write(ToRecord(transform));
+			}
+			void operator()(const Components::Model& model) {
+				SceneModelRecord record{};
+				record.offset = ToRecord(model.offset);
+				record.asset = model.asset ? AddAsset(*model.asset) : SceneSerializer::NO_ASSET;
+				if (!model.asset) {
+					m_missingAssets++;
+				}
+				Write(record);
+			}
+			void operator()(const Components::Camera& camera) {
+				SceneCameraRecord record{};
+				record.rotation = camera.rotation;
+				record.currentCamera = camera.currentCamera ? 1 : 0;
+				record.fixedAspectRatio = camera.fixedAspectRatio ? 1 : 0;
+				Write(record);
+			}
+			void operator()(const Components::PointLight& pointLight) {
+				Write(pointLight);
+			}
+
+			const std::vector<u32>& GetEntityPool() const { return m_entityPool; }
+			const Section& GetSection(u32 section) const { return m_sections[section]; }
+			const std::vector<SceneAssetRecord>& GetAssets() const { return m_assets; }
+			const std::string& GetStrings() const { return m_strings; }
+			u32 GetMissingAssets() const { return m_missingAssets; }
+
+		private:
+			template<typename Record>
+			void Write(const Record& record) {
+				const u8* bytes = reinterpret_cast<const u8*>(&record);
+				m_section->data.insert(m_section->data.end(), bytes, bytes + sizeof(Record));
+			}
+
+			u32 AddString(std::string_view string) {
+				u32 offset = static_cast<u32>(m_strings.size());
+				m_strings += string;
+				return offset;
+			}
+
+			// one record per file, importer and vertex format, like the ResourceManager
+			u32 AddAsset(const ModelAsset& asset) {
+				std::string key = asset.GetPath() + '|' + std::to_string(static_cast<u32>(asset.GetImporter())) +
+					'|' + std::to_string(static_cast<u32>(asset.GetVertexFormat()));
+				auto [it, inserted] = m_assetIndices.try_emplace(key, static_cast<u32>(m_assets.size()));
+				if (inserted) {
+					SceneAssetRecord record{};
+					record.pathLength = static_cast<u32>(asset.GetPath().size());
+					record.pathOffset = AddString(asset.GetPath());
+					record.importer = static_cast<u32>(asset.GetImporter());
+					record.vertexFormat = static_cast<u32>(asset.GetVertexFormat());
+					m_assets.push_back(record);
+				}
+				return it->second;
+			}
+
+			std::vector<u32> m_entityPool;
+			std::array<Section, SECTION_COUNT> m_sections;
+			Section* m_section = nullptr;
+			std::vector<SceneAssetRecord> m_assets;
+			std::unordered_map<std::string, u32> m_assetIndices;
+			std::string m_strings;
+			u32 m_missingAssets = 0;
+		};
+
+		// entt::snapshot_loader reads the entity pool through it
+		struct SnapshotReader {
+			const u32* data;
+
+			void operator()(EntityValue& value) { value = *data++; }
+			void operator()(entt::entity& entity) { entity = static_cast<entt::entity>(*data++); }
+		};
+
+		// fn(i) for every record, a chunk per job
+		template<typename Fn>
+		void ForEachRecord(u32 count, Fn&& fn) {
+			ParallelFor((count + CHUNK_SIZE - 1) / CHUNK_SIZE, [&](u32 chunk) {
+				u32 end = std::min(count, (chunk + 1) * CHUNK_SIZE);
+				for (u32 i = chunk * CHUNK_SIZE; i < end; i++) {
+					fn(i);
+				}
+			});
+		}
+	}  // namespace
+
+	bool SceneSerializer::Save(Scene& scene, const std::string& filepath) {
+		SnapshotWriter writer;
+		entt::snapshot snapshot{ scene.m_entityRoot };
+		writer.BeginEntityPool();
+		snapshot.get<entt::entity>(writer);
+		writer.Begin(SceneSection::Tag);
+		snapshot.get<Components::Tag>(writer);
+		writer.Begin(SceneSection::Transform);
+		snapshot.get<Components::Transform>(writer);
+		writer.Begin(SceneSection::Model);
+		snapshot.get<Components::Model>(writer);
+		writer.Begin(SceneSection::Camera);
+		snapshot.get<Components::Camera>(writer);
+		writer.Begin(SceneSection::PointLight);
+		snapshot.get<Components::PointLight>(writer);
+		if (writer.GetMissingAssets() > 0) {
+			VK_CORE_WARN("{0} models in {1} weren't loaded through the ResourceManager, they are saved empty",
+				writer.GetMissingAssets(), filepath);
+		}
+
+		SceneFileHeader header{};
+		header.magic = MAGIC;
+		header.version = VERSION;
+		header.entityPoolSize = static_cast<u32>(writer.GetEntityPool().size());
+		header.assetCount = static_cast<u32>(writer.GetAssets().size());
+
+		std::error_code error;
+		std::filesystem::path directory = std::filesystem::path(filepath).parent_path();
+		if (!directory.empty()) {
+			std::filesystem::create_directories(directory, error);
+		}
+
+		// written next to the final file and renamed, so a crash never leaves half a scene behind
+		std::string tempPath = filepath + ".tmp";
+		{
+			std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+			if (!file) {
+				return false;
+			}
+
+			u64 offset = sizeof(SceneFileHeader);
+			auto writeBlob = [&](const void* data, u64 size) {
+				u64 aligned = AlignBlob(offset);
+				static constexpr char padding[16]{};
+				file.write(padding, static_cast<std::streamsize>(aligned - offset));
+				file.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+				offset = aligned + size;
+				return aligned;
+			};
+
+			file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+			header.entityPoolOffset = writeBlob(writer.GetEntityPool().data(), writer.GetEntityPool().size() * sizeof(u32));
+			for (u32 i = 0; i < SECTION_COUNT; i++) {
+				const SnapshotWriter::Section& section = writer.GetSection(i);
+				SceneFileSection& fileSection = header.sections[i];
+				fileSection.count = static_cast<u32>(section.entities.size());
+				fileSection.stride = SECTION_STRIDES[i];
+				fileSection.entityOffset = writeBlob(section.entities.data(), section.entities.size() * sizeof(entt::entity));
+				fileSection.dataOffset = writeBlob(section.data.data(), section.data.size());
+			}
+			header.assetOffset = writeBlob(writer.GetAssets().data(), writer.GetAssets().size() * sizeof(SceneAssetRecord));
+			header.stringOffset = writeBlob(writer.GetStrings().data(), writer.GetStrings().size());
+			header.stringSize = writer.GetStrings().size();
+
+			file.seekp(0);
+			file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+			if (!file) {
+				return false;
+			}
+		}
+
+		std::filesystem::rename(tempPath, filepath, error);
+		if (error) {
+			std::filesystem::remove(tempPath, error);
+			return false;
+		}
+
+		auto alive = scene.m_entityRoot.storage<entt::entity>().each();
+		VK_CORE_INFO("Saved scene {0}: {1} entities, {2} transforms, {3} models of {4} files", filepath,
+			std::distance(alive.begin(), alive.end()), header.sections[static_cast<u32>(SceneSection::Transform)].count,
+			header.sections[static_cast<u32>(SceneSection::Model)].count, header.assetCount);
+		return true;
+	}
+
+	std::unique_ptr<Scene> SceneSerializer::Load(const std::string& filepath) {
+		auto startTime = std::chrono::high_resolution_clock::now();
+		MappedFile file;
+		if (!file.Open(filepath)) {
+			return nullptr;
+		}
+
+		u64 fileSize = file.GetSize();
+		const u8* data = file.GetData();
+		auto header = reinterpret_cast<const SceneFileHeader*>(data);
+		auto fits = [fileSize](u64 offset, u64 size) { return offset <= fileSize && size <= fileSize - offset; };
+		bool valid = fileSize >= sizeof(SceneFileHeader) &&
+			header->magic == MAGIC &&
+			header->version == VERSION &&
+			header->entityPoolSize >= 2 &&
+			fits(header->entityPoolOffset, u64(header->entityPoolSize) * sizeof(u32)) &&
+			fits(header->assetOffset, u64(header->assetCount) * sizeof(SceneAssetRecord)) &&
+			fits(header->stringOffset, header->stringSize);
+		for (u32 i = 0; valid && i < SECTION_COUNT; i++) {
+			const SceneFileSection& section = header->sections[i];
+			valid = section.stride == SECTION_STRIDES[i] &&
+				fits(section.entityOffset, u64(section.count) * sizeof(entt::entity)) &&
+				fits(section.dataOffset, u64(section.count) * section.stride);
+		}
+		const u32* entityPool = valid ? GetBlob<u32>(data, header->entityPoolOffset) : nullptr;
+		// the size of the pool and its free list, then the entities
+		valid = valid && u64(entityPool[0]) + 2 == header->entityPoolSize && entityPool[1] <= entityPool[0];
+		if (!valid) {
+			VK_CORE_WARN("Scene {0} is corrupt or outdated", filepath);
+			return nullptr;
+		}
+
+		auto getSection = [header](SceneSection section) -> const SceneFileSection& {
+			return header->sections[static_cast<u32>(section)];
+		};
+		const char* strings = GetBlob<char>(data, header->stringOffset);
+		auto getString = [&](u32 offset, u32 length) {
+			return u64(offset) + length <= header->stringSize ? std::string_view(strings + offset, length) : std::string_view();
+		};
+
+		std::unique_ptr<Scene> scene(new Scene(false));
+		entt::registry& registry = scene->m_entityRoot;
+		SnapshotReader reader{ entityPool };
+		entt::snapshot_loader{ registry }.get<entt::entity>(reader);
+
+		// a component of an entity the pool doesn't have would trip the registry
+		for (const SceneFileSection& section : header->sections) {
+			const auto* entities = GetBlob<entt::entity>(data, section.entityOffset);
+			if (!std::all_of(entities, entities + section.count, [&](entt::entity entity) { return registry.valid(entity); })) {
+				VK_CORE_WARN("Scene {0} is corrupt or outdated", filepath);
+				return nullptr;
+			}
+		}
+
+		{
+			const SceneFileSection& section = getSection(SceneSection::Tag);
+			const auto* entities = GetBlob<entt::entity>(data, section.entityOffset);
+			const auto* records = GetBlob<SceneTagRecord>(data, section.dataOffset);
+			u32 count = section.count;
+			// on this thread, the workers would only take turns at the string table
+			std::vector<Components::Tag> tags(count);
+			scene->m_entityMap.reserve(count);
+			for (u32 i = 0; i < count; i++) {
+				tags[i].tag = StringId(getString(records[i].nameOffset, records[i].nameLength));
+				// in the order they were created in, like CreateEntity adds them
+				scene->m_entityMap[tags[i].tag].push_back(entities[i]);
+			}
+			registry.insert<Components::Tag>(entities, entities + count, tags.begin());
+		}
+
+		{
+			const SceneFileSection& section = getSection(SceneSection::Transform);
+			const auto* entities = GetBlob<entt::entity>(data, section.entityOffset);
+			const auto* records = GetBlob<SceneTransformRecord>(data, section.dataOffset);
+			u32 count = section.count;
+			// both pools in one go instead of a WorldTransform per Transform through the construct signal,
+			// then filled where they are
+			auto construct = registry.on_construct<Components::Transform>();
+			construct.disconnect<&Scene::OnTransformConstruct>();
+			registry.insert<Components::WorldTransform>(entities, entities + count);
+			registry.insert<Components::Transform>(entities, entities + count);
+			construct.connect<&Scene::OnTransformConstruct>();
+			auto& storage = registry.storage<Components::Transform>();
+			ForEachRecord(count, [&](u32 i) {
+				FromRecord(storage.get(entities[i]), records[i]);
+			});
+			// once every Transform is in, SetParent rejects whatever a broken file could hang off itself
+			for (u32 i = 0; i < count; i++) {
+				auto parent = static_cast<entt::entity>(records[i].parent);
+				if (parent != entt::null && !scene->SetParent(entities[i], parent)) {
+					VK_CORE_WARN("Scene {0} has a broken transform hierarchy", filepath);
+				}
+			}
+		}
+
+		{
+			// every file once, the ResourceManager loads them on its workers all at the same time
+			const auto* assetRecords = GetBlob<SceneAssetRecord>(data, header->assetOffset);
+			std::vector<std::shared_ptr<ModelAsset>> assets(header->assetCount);
+			std::vector<std::shared_ptr<MeshModel>> models(header->assetCount);
+			for (u32 i = 0; i < header->assetCount; i++) {
+				const SceneAssetRecord& record = assetRecords[i];
+				std::string path(getString(record.pathOffset, record.pathLength));
+				if (path.empty() || record.importer > static_cast<u32>(MeshImporter::Obj) ||
+					record.vertexFormat >= static_cast<u32>(VertexFormat::Count)) {
+					continue;
+				}
+				auto importer = static_cast<MeshImporter>(record.importer);
+				auto vertexFormat = static_cast<VertexFormat>(record.vertexFormat);
+				if (ResourceManager::s_resourceManager) {
+					assets[i] = ResourceManager::s_resourceManager->GetModel(path, importer, vertexFormat);
+				}
+				else {
+					models[i] = MeshModel::CreateMeshModelFromFile(path, importer, vertexFormat);
+				}
+			}
+
+			const SceneFileSection& section = getSection(SceneSection::Model);
+			const auto* entities = GetBlob<entt::entity>(data, section.entityOffset);
+			const auto* records = GetBlob<SceneModelRecord>(data, section.dataOffset);
+			u32 count = section.count;
+			std::vector<Components::Model> modelComponents(count);
+			ForEachRecord(count, [&](u32 i) {
+				Components::Model& model = modelComponents[i];
+				FromRecord(model.offset, records[i].offset);
+				if (records[i].asset < header->assetCount) {
+					model.asset = assets[records[i].asset];
+					model.model = models[records[i].asset];
+				}
+			});
+			registry.insert<Components::Model>(entities, entities + count, modelComponents.begin());
+		}
+
+		{
+			const SceneFileSection& section = getSection(SceneSection::Camera);
+			const auto* entities = GetBlob<entt::entity>(data, section.entityOffset);
+			const auto* records = GetBlob<SceneCameraRecord>(data, section.dataOffset);
+			u32 count = section.count;
+			std::vector<Components::Camera> cameras(count);
+			for (u32 i = 0; i < count; i++) {
+				cameras[i].rotation = records[i].rotation;
+				cameras[i].currentCamera = records[i].currentCamera != 0;
+				cameras[i].fixedAspectRatio = records[i].fixedAspectRatio != 0;
+			}
+			registry.insert<Components::Camera>(entities, entities + count, cameras.begin());
+		}
+
+		{
+			// the records are the components
+			const SceneFileSection& section = getSection(SceneSection::PointLight);
+			const auto* entities = GetBlob<entt::entity>(data, section.entityOffset);
+			const auto* records = GetBlob<Components::PointLight>(data, section.dataOffset);
+			u32 count = section.count;
+			registry.insert<Components::PointLight>(entities, entities + count, records);
+		}
+
+		double time = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count();
+		auto alive = registry.storage<entt::entity>().each();
+		VK_CORE_INFO("Loaded scene {0}: {1} entities in {2:.2f} ms", filepath, std::distance(alive.begin(), alive.end()), time);
+		return scene;
+	}
+}  // namespace RVK
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "Framework/Scene.h"
+
+namespace RVK {
+	enum class SceneSection : u32 {
+		Tag = 0,
+		Transform,
+		Model,
+		Camera,
+		PointLight,
+		Count
+	};
+
+	// .rvkscene layout: header, the entity pool the way EnTT's snapshot writes it, then every component pool
+	// as two 16 byte aligned blobs, its entities and its records, so a pool goes into the registry with one insert.
+	// Models refer to the asset table by index and every file is resolved once, however many entities use it.
+	struct SceneFileSection {
+		u32 count;
+		u32 stride;
+		u64 entityOffset;
+		u64 dataOffset;
+	};
+
+	struct SceneFileHeader {
+		u32 magic;
+		u32 version;
+		// u32s in the entity pool, its size and free list come first
+		u32 entityPoolSize;
+		u32 assetCount;
+		u64 entityPoolOffset;
+		u64 assetOffset;
+		u64 stringOffset;
+		u64 stringSize;
+		SceneFileSection sections[static_cast<u32>(SceneSection::Count)];
+	};
+
+	struct SceneTagRecord {
+		// into the string table
+		u32 nameOffset;
+		u32 nameLength;
+	};
+
+	struct SceneTransformRecord {
+		glm::vec3 position;
+		// entt::null for roots
+		u32 parent;
+		glm::quat rotation;
+		glm::vec3 scale;
+		u32 spare;
+	};
+
+	struct SceneModelRecord {
+		// parent is unused
+		SceneTransformRecord offset;
+		// into the asset table, NO_ASSET for models that weren't loaded from a file
+		u32 asset;
+		u32 spare[3];
+	};
+
+	struct SceneAssetRecord {
+		u32 pathOffset;
+		u32 pathLength;
+		u32 importer;
+		u32 vertexFormat;
+	};
+
+	struct SceneCameraRecord {
+		glm::vec3 rotation;
+		u32 currentCamera;
+		u32 fixedAspectRatio;
+		u32 spare[3];
+	};
+
+	class SceneSerializer {
+	public:
+		static constexpr u32 MAGIC = 0x534B5652; // "RVKS"
+		static constexpr u32 VERSION = 1;
+		static constexpr u32 NO_ASSET = ~0u;
+
+		// Tags, Transforms, Models, Cameras and PointLights, the WorldTransforms are rebuilt on the first update
+		static bool Save(Scene& scene, const std::string& filepath);
+		// nullptr if the file is missing, corrupt or from an older version. Main thread only, the models
+		// go through the ResourceManager when there is one and load in the background like any other.
+		static std::unique_ptr<Scene> Load(const std::string& filepath);
+	};
+}  // namespace RVK
@@ -0,0 +1,48 @@
+#include "Framework/StringId.h"
+
+#include <mutex>
+#include <shared_mutex>
+
+namespace RVK {
+	namespace {
+		// never shrinks, the strings are nodes of their own and stay where they are
+		struct StringTable {
+			std::shared_mutex mutex;
+			std::unordered_map<u64, std::string> strings;
+		};
+
+		StringTable& GetStringTable() {
+			static StringTable table;
+			return table;
+		}
+	}  // namespace
+
+	StringId::StringId(std::string_view string)
+		: m_id(HashString(string)) {
+		StringTable& table = GetStringTable();
+		{
+			// names are interned once and looked up many times after
+			std::shared_lock<std::shared_mutex> lock(table.mutex);
+			auto it = table.strings.find(m_id);
+			if (it != table.strings.end()) {
+				if (it->second != string) {
+					VK_CORE_CRITICAL("StringId collision between '{0}' and '{1}'", it->second, string);
+				}
+				return;
+			}
+		}
+
+		std::unique_lock<std::shared_mutex> lock(table.mutex);
+		auto [it, inserted] = table.strings.try_emplace(m_id, string);
+		if (!inserted && it->second != string) {
+			VK_CORE_CRITICAL("StringId collision between '{0}' and '{1}'", it->second, string);
+		}
+	}
+
+	std::string_view StringId::GetString() const {
+		StringTable& table = GetStringTable();
+		std::shared_lock<std::shared_mutex> lock(table.mutex);
+		auto it = table.strings.find(m_id);
+		return it != table.strings.end() ? std::string_view(it->second) : std::string_view();
+	}
+}  // namespace RVK
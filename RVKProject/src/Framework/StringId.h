@@ -0,0 +1,47 @@
+#pragma once
+
+#include "Framework/Utils.h"
+
+namespace RVK {
+	// FNV-1a, 64 bit so two names practically never share one, the string table still checks
+	constexpr u64 HashString(std::string_view string) {
+		u64 hash = 0xcbf29ce484222325ull;
+		for (char c : string) {
+			hash ^= static_cast<u8>(c);
+			hash *= 0x100000001b3ull;
+		}
+		return hash;
+	}
+
+	// A name by its hash, compared and looked up as a number. Literals are hashed at compile time, names built
+	// at runtime are interned once so GetString can give them back for the logs and the editor.
+	class StringId {
+	public:
+		constexpr StringId() = default;
+		template<size_t N>
+		consteval StringId(const char (&literal)[N])
+			: m_id(HashString(std::string_view(literal, N - 1))) {}
+		explicit StringId(std::string_view string);
+		// hashed only, for looking up names built at runtime without allocating or locking the string table
+		static constexpr StringId Hash(std::string_view string) { return StringId(HashString(string), 0); }
+
+		constexpr u64 GetId() const { return m_id; }
+		constexpr bool IsValid() const { return m_id != 0; }
+		// empty if the same name was never interned at runtime
+		std::string_view GetString() const;
+
+		constexpr bool operator==(const StringId& other) const = default;
+
+	private:
+		constexpr StringId(u64 id, int)
+			: m_id(id) {}
+
+		u64 m_id = 0;
+	};
+}  // namespace RVK
+
+template<>
+struct std::hash<RVK::StringId> {
+	// already a hash
+	size_t operator()(RVK::StringId id) const { return static_cast<size_t>(id.GetId()); }
+};
@@ -0,0 +1,128 @@
+#include "Framework/SystemScheduler.h"
+
+namespace RVK {
+	namespace {
+		bool Overlaps(const std::vector<entt::id_type>& a, const std::vector<entt::id_type>& b) {
+			return std::any_of(a.begin(), a.end(), [&](entt::id_type id) {
+				return std::find(b.begin(), b.end(), id) != b.end();
+			});
+		}
+	}  // namespace
+
+	bool SystemScheduler::Access::ConflictsWith(const Access& other) const {
+		// both on the main thread are in order anyway
+		if (m_mainThread && other.m_mainThread) {
+			return true;
+		}
+		return Overlaps(m_writes, other.m_writes) || Overlaps(m_writes, other.m_reads) || Overlaps(m_reads, other.m_writes);
+	}
+
+	void SystemScheduler::Add(std::string_view name, const Access& access, System system) {
+		auto node = std::make_unique<Node>();
+		node->name = name;
+		node->access = access;
+		node->system = std::move(system);
+		m_nodes.push_back(std::move(node));
+		m_dirty = true;
+	}
+
+	void SystemScheduler::Build() {
+		for (auto& node : m_nodes) {
+			node->dependents.clear();
+			node->dependencyCount = 0;
+		}
+		// only ever on earlier systems, so the order they were added in is always a valid one
+		for (u32 i = 0; i < m_nodes.size(); i++) {
+			for (u32 j = 0; j < i; j++) {
+				if (m_nodes[i]->access.ConflictsWith(m_nodes[j]->access)) {
+					m_nodes[j]->dependents.push_back(i);
+					m_nodes[i]->dependencyCount++;
+				}
+			}
+		}
+		m_dirty = false;
+	}
+
+	void SystemScheduler::LogGraph() {
+		if (m_dirty) {
+			Build();
+		}
+		for (const auto& node : m_nodes) {
+			std::string dependents;
+			for (u32 dependent : node->dependents) {
+				dependents += (dependents.empty() ? "" : ", ") + m_nodes[dependent]->name;
+			}
+			VK_CORE_INFO("{0}{1} -> [{2}]", node->name, node->access.m_mainThread ? " (main thread)" : "", dependents);
+		}
+	}
+
+	void SystemScheduler::Run(entt::registry& registry) {
+		if (m_dirty) {
+			Build();
+		}
+		for (const auto& node : m_nodes) {
+			for (auto storage : node->access.m_storages) {
+				storage(registry);
+			}
+		}
+
+		JobSystem* jobSystem = JobSystem::s_jobSystem;
+		if (!jobSystem) {
+			for (const auto& node : m_nodes) {
+				node->system(registry);
+			}
+			return;
+		}
+
+		m_remaining = static_cast<u32>(m_nodes.size());
+		for (const auto& node : m_nodes) {
+			node->waitingFor = node->dependencyCount;
+		}
+		for (u32 i = 0; i < m_nodes.size(); i++) {
+			if (m_nodes[i]->dependencyCount == 0) {
+				Release(i, registry);
+			}
+		}
+
+		// this thread runs the main thread systems as they become ready and helps with the rest
+		while (m_remaining.load(std::memory_order_acquire) != 0) {
+			u32 ready = NONE;
+			{
+				std::lock_guard<std::mutex> lock(m_mainThreadMutex);
+				if (!m_mainThreadReady.empty()) {
+					ready = m_mainThreadReady.back();
+					m_mainThreadReady.pop_back();
+				}
+			}
+			if (ready != NONE) {
+				Execute(ready, registry);
+			}
+			else if (!jobSystem->RunOne()) {
+				std::this_thread::yield();
+			}
+		}
+		// the last jobs may still be on their way out
+		jobSystem->Wait(m_jobs);
+	}
+
+	void SystemScheduler::Release(u32 node, entt::registry& registry) {
+		if (m_nodes[node]->access.m_mainThread) {
+			std::lock_guard<std::mutex> lock(m_mainThreadMutex);
+			m_mainThreadReady.push_back(node);
+			return;
+		}
+		JobSystem::s_jobSystem->Schedule(m_jobs, [this, node, &registry]() {
+			Execute(node, registry);
+		});
+	}
+
+	void SystemScheduler::Execute(u32 node, entt::registry& registry) {
+		m_nodes[node]->system(registry);
+		for (u32 dependent : m_nodes[node]->dependents) {
+			if (m_nodes[dependent]->waitingFor.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+				Release(dependent, registry);
+			}
+		}
+		m_remaining.fetch_sub(1, std::memory_order_release);
+	}
+}  // namespace RVK
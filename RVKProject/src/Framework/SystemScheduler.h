@@ -0,0 +1,111 @@
+#pragma once
+
+#include <EnTT/entt.hpp>
+
+#include "Framework/Parallel.h"
+
+namespace RVK {
+	// Systems that run once per frame over a registry. Each one declares what it reads and writes, two that
+	// touch the same thing with at least one of them writing run in the order they were added in, everything
+	// else runs at the same time on the JobSystem.
+	class SystemScheduler {
+	public:
+		class Access {
+		public:
+			template<typename... Components>
+			Access& Read() {
+				(AddComponent<Components>(m_reads), ...);
+				return *this;
+			}
+			template<typename... Components>
+			Access& Write() {
+				(AddComponent<Components>(m_writes), ...);
+				return *this;
+			}
+			// state outside the registry, by name
+			Access& Read(std::string_view resource) {
+				m_reads.push_back(entt::hashed_string::value(resource.data(), resource.size()));
+				return *this;
+			}
+			Access& Write(std::string_view resource) {
+				m_writes.push_back(entt::hashed_string::value(resource.data(), resource.size()));
+				return *this;
+			}
+			// for GLFW input and the like, runs on the thread calling Run
+			Access& MainThread() {
+				m_mainThread = true;
+				return *this;
+			}
+
+			bool ConflictsWith(const Access& other) const;
+
+		private:
+			friend class SystemScheduler;
+
+			template<typename Component>
+			void AddComponent(std::vector<entt::id_type>& ids) {
+				ids.push_back(entt::type_hash<Component>::value());
+				m_storages.push_back([](entt::registry& registry) { registry.storage<Component>(); });
+			}
+
+			std::vector<entt::id_type> m_reads;
+			std::vector<entt::id_type> m_writes;
+			// a pool created while other systems run would move the registry's pools under them
+			std::vector<void (*)(entt::registry&)> m_storages;
+			bool m_mainThread = false;
+		};
+		using System = std::function<void(entt::registry&)>;
+
+		void Add(std::string_view name, const Access& access, System system);
+		// every system once, returns when all of them are done
+		void Run(entt::registry& registry);
+		void LogGraph();
+
+	private:
+		static constexpr u32 NONE = ~0u;
+
+		struct Node {
+			std::string name;
+			Access access;
+			System system;
+			std::vector<u32> dependents;
+			u32 dependencyCount = 0;
+			std::atomic<u32> waitingFor{ 0 };
+		};
+
+		// which systems wait for which, rebuilt after Add
+		void Build();
+		void Release(u32 node, entt::registry& registry);
+		void Execute(u32 node, entt::registry& registry);
+
+		std::vector<std::unique_ptr<Node>> m_nodes;
+		bool m_dirty = false;
+
+		std::atomic<u32> m_remaining{ 0 };
+		JobCounter m_jobs{ 0 };
+		std::mutex m_mainThreadMutex;
+		std::vector<u32> m_mainThreadReady;
+	};
+
+	// fn(entity) for every entity in the view on the JobSystem, a chunk of the leading pool per job.
+	// fn may only write to the components of the entity it is given.
+	template<typename View, typename Fn>
+	void ParallelForEach(const View& view, Fn&& fn) {
+		constexpr u32 CHUNK_SIZE = 256;
+		const auto* entities = view.handle();
+		if (!entities) {
+			return;
+		}
+
+		u32 count = static_cast<u32>(entities->size());
+		ParallelFor((count + CHUNK_SIZE - 1) / CHUNK_SIZE, [&](u32 chunk) {
+			u32 end = std::min(count, (chunk + 1) * CHUNK_SIZE);
+			for (u32 i = chunk * CHUNK_SIZE; i < end; i++) {
+				auto entity = (*entities)[i];
+				if (view.contains(entity)) {
+					fn(entity);
+				}
+			}
+		});
+	}
+}  // namespace RVK
@@ -6,8 +6,43 @@
 #include "Framework/Vulkan/VKUtils.h"
 #include "Framework/Vulkan/RVKDevice.h"
 #include "Framework/RVKApp.h"
+#include "Framework/Parallel.h"
+#include "Framework/TextureCooker.h"
+#include "Framework/TextureStreamer.h"
+#include "Framework/Vulkan/RVKStagingRing.h"
 
 namespace RVK {
+	std::vector<Texture*> Texture::s_blitTextures;
+
+	namespace {
+		void ImageBarrier(VkCommandBuffer commandBuffer, VkImage image, u32 levelCount, VkImageLayout oldLayout,
+			VkImageLayout newLayout, VkAccessFlags srcAccess, VkAccessFlags dstAccess, VkPipelineStageFlags srcStage,
+			VkPipelineStageFlags dstStage) {
+			VkImageMemoryBarrier barrier{};
+			barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+			barrier.oldLayout = oldLayout;
+			barrier.newLayout = newLayout;
+			barrier.srcAccessMask = srcAccess;
+			barrier.dstAccessMask = dstAccess;
+			barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier.image = image;
+			barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+			barrier.subresourceRange.baseMipLevel = 0;
+			barrier.subresourceRange.levelCount = levelCount;
+			barrier.subresourceRange.baseArrayLayer = 0;
+			barrier.subresourceRange.layerCount = 1;
+			vkCmdPipelineBarrier(commandBuffer, srcStage, dstStage, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+		}
+
+		void DestroyStagingBuffer(VkBuffer buffer, VkDeviceMemory memory) {
+			RVKDevice::s_rvkDevice->DeferDestroy([buffer, memory]() {
+				auto device = RVKDevice::s_rvkDevice->GetDevice();
+				vkDestroyBuffer(device, buffer, nullptr);
+				vkFreeMemory(device, memory, nullptr);
+			});
+		}
+	}  // namespace
 
 	Texture::Texture(bool nearestFilter)
 		: m_fileName(""), m_rendererID(0), m_localBuffer(nullptr), m_type(0), m_width(0), m_height(0), m_bytesPerPixel(0),
@@ -18,59 +53,165 @@ namespace RVK {
 	}
 
 	Texture::~Texture() {
-		auto device = RVKDevice::s_rvkDevice->GetDevice();
+		// textures the importers only named, never created
+		if (m_textureImage == VK_NULL_HANDLE) {
+			return;
+		}
+		if (m_cooked && TextureStreamer::s_textureStreamer) {
+			TextureStreamer::s_textureStreamer->Unregister(*this);
+		}
+		if (!m_pendingBlits.empty()) {
+			s_blitTextures.erase(std::find(s_blitTextures.begin(), s_blitTextures.end(), this));
+			for (const PendingBlit& blit : m_pendingBlits) {
+				if (blit.memory != VK_NULL_HANDLE) {
+					DestroyStagingBuffer(blit.buffer, blit.memory);
+				}
+			}
+		}
 
-		vkDestroyImage(device, m_textureImage, nullptr);
-		vkDestroyImageView(device, m_imageView, nullptr);
-		vkDestroySampler(device, m_sampler, nullptr);
-		vkFreeMemory(device, m_textureImageMemory, nullptr);
+		RVKDevice::s_rvkDevice->DeferDestroy(
+			[image = m_textureImage, imageView = m_imageView, sampler = m_sampler, memory = m_textureImageMemory]() {
+				auto device = RVKDevice::s_rvkDevice->GetDevice();
+
+				vkDestroyImage(device, image, nullptr);
+				vkDestroyImageView(device, imageView, nullptr);
+				vkDestroySampler(device, sampler, nullptr);
+				vkFreeMemory(device, memory, nullptr);
+			});
 	}
 
 	Texture::Texture(u32 ID, int internalFormat, int dataFormat, int type)
 		: m_rendererID{ ID }, m_internalFormat{ internalFormat }, m_dataFormat{ dataFormat }, m_type{ type }, m_sRGB{ false } {}
 
-	// create texture from raw memory
+	// create texture from raw memory, transparent black without data, to be filled in with Blit
 	bool Texture::Init(const u32 width, const u32 height, bool sRGB, const void* data, int minFilter, int magFilter) {
-		bool ok = false;
 		m_fileName = "raw memory";
 		m_sRGB = sRGB;
-		m_localBuffer = (u8*)data;
 		m_minFilter = SetFilter(minFilter);
 		m_magFilter = SetFilter(magFilter);
 		m_minFilterMip = SetFilterMip(minFilter);
-
-		if (m_localBuffer) {
-			m_width = width;
-			m_height = height;
-			m_bytesPerPixel = 4;
-			ok = Create();
+		m_width = width;
+		m_height = height;
+		m_bytesPerPixel = 4;
+
+		std::vector<u8> clear;
+		if (!data) {
+			clear.resize(static_cast<size_t>(width) * height * 4, 0);
+			data = clear.data();
 		}
+		m_localBuffer = (u8*)data;
+		bool ok = Create();
+		m_localBuffer = nullptr;
 		return ok;
 	}
 
 	// create texture from file on disk
 	bool Texture::Init(const std::string& fileName, bool sRGB, bool flip) {
-		bool ok = false;
-		stbi_set_flip_vertically_on_load(flip);
-		m_fileName = fileName;
-		m_sRGB = sRGB;
-		m_localBuffer = stbi_load(m_fileName.c_str(), &m_width, &m_height, &m_bytesPerPixel, 4);
+		Image image;
+		if (!Decode(fileName, flip, image)) {
+			m_fileName = fileName;
+			m_sRGB = sRGB;
+			return false;
+		}
+		return Init(image, sRGB);
+	}
 
-		if (m_localBuffer) {
-			ok = Create();
-			stbi_image_free(m_localBuffer);
+	// create texture from pixels decoded elsewhere
+	bool Texture::Init(const Image& image, bool sRGB) {
+		m_fileName = image.fileName;
+		m_sRGB = sRGB;
+		if (image.cooked) {
+			return InitStreamed(image.cooked, sRGB);
 		}
-		else {
-			VK_CORE_CRITICAL("Texture: Couldn't load file {0}", fileName);
+		if (!image.pixels) {
+			return false;
 		}
 
+		auto start = std::chrono::high_resolution_clock::now();
+		m_width = image.width;
+		m_height = image.height;
+		m_bytesPerPixel = 4;
+		m_localBuffer = image.pixels.get();
+		bool ok = Create();
+		m_localBuffer = nullptr;
+
+		double uploadTime = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+		VK_CORE_INFO("Texture {0}: {1}x{2}, decoded in {3:.1f} ms, uploaded in {4:.1f} ms",
+			m_fileName, m_width, m_height, image.decodeTime, uploadTime);
 		return ok;
 	}
 
+	void Texture::PixelDeleter::operator()(u8* pixels) const {
+		stbi_image_free(pixels);
+	}
+
+	bool Texture::Decode(const std::string& fileName, bool flip, Image& image) {
+		auto start = std::chrono::high_resolution_clock::now();
+		stbi_set_flip_vertically_on_load_thread(flip);
+
+		int channels = 0;
+		image.fileName = fileName;
+		image.pixels.reset(stbi_load(fileName.c_str(), &image.width, &image.height, &channels, 4));
+		image.decodeTime = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+		if (!image.pixels) {
+			VK_CORE_CRITICAL("Texture: Couldn't load file {0}", fileName);
+			return false;
+		}
+		return true;
+	}
+
+	bool Texture::DecodeCooked(const std::string& fileName, bool flip, Image& image) {
+		auto start = std::chrono::high_resolution_clock::now();
+		std::string cookedPath = TextureCooker::GetCookedPath(fileName);
+		if (!TextureCooker::IsUpToDate(fileName, cookedPath, flip)) {
+			if (!Decode(fileName, flip, image)) {
+				return false;
+			}
+			if (!TextureCooker::Cook(image, cookedPath, flip)) {
+				VK_CORE_WARN("Texture: Couldn't cook {0}, it stays fully resident", fileName);
+				return true;
+			}
+		}
+
+		auto cooked = std::make_shared<CookedTexture>();
+		if (!cooked->Open(cookedPath)) {
+			return image.pixels ? true : Decode(fileName, flip, image);
+		}
+
+		image.fileName = fileName;
+		image.width = static_cast<int>(cooked->GetHeader().width);
+		image.height = static_cast<int>(cooked->GetHeader().height);
+		image.pixels.reset();
+		image.cooked = std::move(cooked);
+		image.decodeTime = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+		return true;
+	}
+
+	void Texture::DecodeAll(const std::vector<std::string>& fileNames, bool flip, std::vector<Image>& images, bool cook) {
+		images.clear();
+		images.resize(fileNames.size());
+		// a model's textures are few and big, one per thread at a time
+		ParallelFor(static_cast<u32>(fileNames.size()), [&](u32 i) {
+			if (cook) {
+				DecodeCooked(fileNames[i], flip, images[i]);
+			}
+			else {
+				Decode(fileNames[i], flip, images[i]);
+			}
+		});
+	}
+
+	u64 Texture::GetMemorySize() const {
+		if (m_cooked) {
+			return m_cooked->GetMipChainSize(m_residentMip);
+		}
+		return static_cast<u64>(m_width) * static_cast<u64>(m_height) * 4;
+	}
+
 	// create texture from file in memory
 	bool Texture::Init(const unsigned char* data, int length, bool sRGB) {
 		bool ok = false;
-		stbi_set_flip_vertically_on_load(true);
+		stbi_set_flip_vertically_on_load_thread(true);
 		m_fileName = "file in memory";
 		m_sRGB = sRGB;
 		m_localBuffer = stbi_load_from_memory(data, length, &m_width, &m_height, &m_bytesPerPixel, 4);
@@ -219,37 +360,76 @@ namespace RVK {
 			return false;
 		}
 
-		VkBuffer stagingBuffer;
-		VkDeviceMemory stagingBufferMemory;
-		CreateBuffer(imageSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer,
-			stagingBufferMemory);
-
-		void* data;
-		vkMapMemory(device, stagingBufferMemory, 0, imageSize, 0, &data);
-		memcpy(data, m_localBuffer, static_cast<size_t>(imageSize));
-		vkUnmapMemory(device, stagingBufferMemory);
+		m_minAlpha = 255;
+		for (size_t i = 3; i < imageSize; i += 4) {
+			m_minAlpha = std::min(m_minAlpha, m_localBuffer[i]);
+		}
 
 		VkFormat format = m_sRGB ? VK_FORMAT_R8G8B8A8_SRGB : VK_FORMAT_R8G8B8A8_UNORM;
-		CreateImage(format, VK_IMAGE_TILING_OPTIMAL,
-			/*VK_IMAGE_USAGE_TRANSFER_SRC_BIT |*/ VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
-			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+		// Resize copies out of it
+		VkImageUsageFlags usage = VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+		VkImageUsageFlags hostUsage = RVKDevice::s_rvkDevice->GetHostImageCopyUsage(format, usage);
+		CreateImage(format, VK_IMAGE_TILING_OPTIMAL, usage | hostUsage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+		VkBufferImageCopy region{};
+		region.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+		region.imageExtent = { static_cast<u32>(m_width), static_cast<u32>(m_height), 1 };
+		if (hostUsage) {
+			RVKDevice::s_rvkDevice->CopyMemoryToImage(m_textureImage, 1, m_localBuffer, { region });
+		}
+		else {
+			VkBuffer stagingBuffer;
+			VkDeviceMemory stagingBufferMemory;
+			CreateBuffer(imageSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+				VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer,
+				stagingBufferMemory);
+
+			void* data;
+			vkMapMemory(device, stagingBufferMemory, 0, imageSize, 0, &data);
+			memcpy(data, m_localBuffer, static_cast<size_t>(imageSize));
+			vkUnmapMemory(device, stagingBufferMemory);
+
+			// transitions and copy in one submit, or in the open upload batch
+			VkCommandBuffer commandBuffer = RVKDevice::s_rvkDevice->BeginSingleTimeCommands();
+			ImageBarrier(commandBuffer, m_textureImage, 1, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+				0, VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+			vkCmdCopyBufferToImage(commandBuffer, stagingBuffer, m_textureImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+			ImageBarrier(commandBuffer, m_textureImage, 1, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+				VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+			RVKDevice::s_rvkDevice->EndSingleTimeCommands(commandBuffer);
+
+			// the copy may still be in an upload batch
+			DestroyStagingBuffer(stagingBuffer, stagingBufferMemory);
+		}
 
-		TransitionImageLayout(VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+		//GenerateMipmaps();
 
-		RVKDevice::s_rvkDevice->CopyBufferToImage(stagingBuffer, m_textureImage, static_cast<u32>(m_width),
-			static_cast<u32>(m_height), 1 /*layerCount*/
-		);
+		m_imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
 
-		//GenerateMipmaps();
+		CreateSampler();
+		m_imageView = CreateImageView(m_textureImage, 1);
 
-		TransitionImageLayout(VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+		m_descriptorImageInfo.sampler = m_sampler;
+		m_descriptorImageInfo.imageView = m_imageView;
+		m_descriptorImageInfo.imageLayout = m_imageLayout;
 
-		m_imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		// Check image handles
+		if (m_textureImage == VK_NULL_HANDLE) {
+			VK_CORE_ERROR("Invalid Vulkan Image Handle");
+		}
+
+		if (m_imageView == VK_NULL_HANDLE) {
+			VK_CORE_ERROR("Invalid Vulkan Image View Handle");
+		}
 
-		vkDestroyBuffer(device, stagingBuffer, nullptr);
-		vkFreeMemory(device, stagingBufferMemory, nullptr);
+		if (m_sampler == VK_NULL_HANDLE) {
+			VK_CORE_ERROR("Invalid Vulkan Sampler Handle");
+		}
+
+		return true;
+	}
 
+	void Texture::CreateSampler() {
 		// Create a texture sampler
 		// In Vulkan, textures are accessed by samplers
 		// This separates sampling information from texture data.
@@ -273,12 +453,14 @@ namespace RVK {
 		samplerCreateInfo.borderColor = VK_BORDER_COLOR_FLOAT_OPAQUE_WHITE;
 
 		{
-			auto result = vkCreateSampler(device, &samplerCreateInfo, nullptr, &m_sampler);
+			auto result = vkCreateSampler(RVKDevice::s_rvkDevice->GetDevice(), &samplerCreateInfo, nullptr, &m_sampler);
 			if (result != VK_SUCCESS) {
 				VK_CORE_CRITICAL("failed to create sampler!");
 			}
 		}
+	}
 
+	VkImageView Texture::CreateImageView(VkImage image, u32 levelCount) {
 		// Create image view
 		// Textures are not directly accessed by shaders and
 		// are abstracted by image views.
@@ -302,53 +484,413 @@ namespace RVK {
 		view.subresourceRange.layerCount = 1;
 		// Linear tiling usually won't support mip maps
 		// Only set mip map count if optimal tiling is used
-		//view.subresourceRange.levelCount = m_mipLevels;
-		view.subresourceRange.levelCount = 1;
+		view.subresourceRange.levelCount = levelCount;
 		// The view will be based on the texture's image
-		view.image = m_textureImage;
+		view.image = image;
 
+		VkImageView imageView = VK_NULL_HANDLE;
 		{
-			auto result = vkCreateImageView(device, &view, nullptr, &m_imageView);
+			auto result = vkCreateImageView(RVKDevice::s_rvkDevice->GetDevice(), &view, nullptr, &imageView);
 			if (result != VK_SUCCESS) {
 				VK_CORE_CRITICAL("failed to create image view!");
 			}
 		}
+		return imageView;
+	}
+
+	bool Texture::InitStreamed(const std::shared_ptr<CookedTexture>& cooked, bool sRGB) {
+		auto start = std::chrono::high_resolution_clock::now();
+		const CookedTextureHeader& header = cooked->GetHeader();
+		m_cooked = cooked;
+		m_sRGB = sRGB;
+		m_width = static_cast<int>(header.width);
+		m_height = static_cast<int>(header.height);
+		m_bytesPerPixel = 4;
+		m_mipLevels = header.mipCount;
+		m_minAlpha = static_cast<u8>(header.minAlpha);
+		m_imageFormat = m_sRGB ? VK_FORMAT_R8G8B8A8_SRGB : VK_FORMAT_R8G8B8A8_UNORM;
+		m_imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
 
+		m_tailMip = m_mipLevels - 1;
+		while (m_tailMip > 0 && std::max(header.mips[m_tailMip - 1].width, header.mips[m_tailMip - 1].height) <= STREAMING_TAIL_SIZE) {
+			m_tailMip--;
+		}
+		// without a streamer nobody would ask for the rest
+		u32 firstMip = TextureStreamer::s_textureStreamer ? m_tailMip : 0;
+
+		CreateSampler();
+		m_residentMip = m_mipLevels;
+		SetResidentMip(firstMip, m_cooked->GetMip(firstMip));
 		m_descriptorImageInfo.sampler = m_sampler;
-		m_descriptorImageInfo.imageView = m_imageView;
-		m_descriptorImageInfo.imageLayout = m_imageLayout;
+		if (TextureStreamer::s_textureStreamer) {
+			TextureStreamer::s_textureStreamer->Register(*this);
+		}
 
-		// Check image handles
-		if (m_textureImage == VK_NULL_HANDLE) {
-			VK_CORE_ERROR("Invalid Vulkan Image Handle");
+		double uploadTime = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+		VK_CORE_INFO("Texture {0}: {1}x{2} streamed, {3} of {4} mips resident, uploaded in {5:.1f} ms",
+			m_fileName, m_width, m_height, m_mipLevels - m_residentMip, m_mipLevels, uploadTime);
+		return true;
+	}
+
+	void Texture::SetResidentMip(u32 mip, const u8* levels) {
+		VK_ASSERT(m_cooked && mip < m_mipLevels, "Only streamed textures change their resident mips");
+		if (mip == m_residentMip) {
+			return;
 		}
 
-		if (m_imageView == VK_NULL_HANDLE) {
-			VK_CORE_ERROR("Invalid Vulkan Image View Handle");
+		auto device = RVKDevice::s_rvkDevice->GetDevice();
+		const CookedTextureHeader& header = m_cooked->GetHeader();
+		u32 levelCount = m_mipLevels - mip;
+
+		VkImageCreateInfo imageInfo{};
+		imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+		imageInfo.imageType = VK_IMAGE_TYPE_2D;
+		imageInfo.extent.width = header.mips[mip].width;
+		imageInfo.extent.height = header.mips[mip].height;
+		imageInfo.extent.depth = 1;
+		imageInfo.mipLevels = levelCount;
+		imageInfo.arrayLayers = 1;
+		imageInfo.format = m_imageFormat;
+		imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+		imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		// the next move copies out of it
+		imageInfo.usage = VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+		imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+		imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+		// new levels come from the cooked data, the ones both images have from the old image
+		u32 copyFrom = m_textureImage != VK_NULL_HANDLE ? std::max(mip, m_residentMip) : m_mipLevels;
+		u32 uploadEnd = std::min(copyFrom, m_mipLevels);
+
+		// a first image that is all cooked data is copied on the host, straight out of the mapped file
+		VkImageUsageFlags hostUsage = 0;
+		if (copyFrom == m_mipLevels) {
+			hostUsage = RVKDevice::s_rvkDevice->GetHostImageCopyUsage(m_imageFormat, imageInfo.usage);
+			imageInfo.usage |= hostUsage;
 		}
 
-		if (m_sampler == VK_NULL_HANDLE) {
-			VK_CORE_ERROR("Invalid Vulkan Sampler Handle");
+		VkImage image;
+		VkDeviceMemory memory;
+		RVKDevice::s_rvkDevice->CreateImageWithInfo(imageInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, image, memory);
+
+		VkBuffer stagingBuffer = VK_NULL_HANDLE;
+		VkDeviceMemory stagingBufferMemory = VK_NULL_HANDLE;
+		std::vector<VkBufferImageCopy> uploads;
+		if (mip < uploadEnd) {
+			VK_ASSERT(levels != nullptr, "Levels missing for the new mips");
+			if (!hostUsage) {
+				VkDeviceSize size = header.mips[uploadEnd - 1].offset + header.mips[uploadEnd - 1].size - header.mips[mip].offset;
+				CreateBuffer(size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+					VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory);
+
+				void* data;
+				vkMapMemory(device, stagingBufferMemory, 0, size, 0, &data);
+				memcpy(data, levels, static_cast<size_t>(size));
+				vkUnmapMemory(device, stagingBufferMemory);
+			}
+
+			for (u32 level = mip; level < uploadEnd; level++) {
+				VkBufferImageCopy region{};
+				region.bufferOffset = header.mips[level].offset - header.mips[mip].offset;
+				region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+				region.imageSubresource.mipLevel = level - mip;
+				region.imageSubresource.baseArrayLayer = 0;
+				region.imageSubresource.layerCount = 1;
+				region.imageExtent = { header.mips[level].width, header.mips[level].height, 1 };
+				uploads.push_back(region);
+			}
 		}
 
-		return true;
+		if (hostUsage) {
+			RVKDevice::s_rvkDevice->CopyMemoryToImage(image, levelCount, levels, uploads);
+		}
+		else {
+			VkCommandBuffer commandBuffer = RVKDevice::s_rvkDevice->BeginSingleTimeCommands();
+			ImageBarrier(commandBuffer, image, levelCount, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+				0, VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+			if (!uploads.empty()) {
+				vkCmdCopyBufferToImage(commandBuffer, stagingBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+					static_cast<u32>(uploads.size()), uploads.data());
+			}
+			if (copyFrom < m_mipLevels) {
+				// the frames submitted before still sample it, the transition waits for them
+				ImageBarrier(commandBuffer, m_textureImage, m_mipLevels - m_residentMip, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+					VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, 0, VK_ACCESS_TRANSFER_READ_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+					VK_PIPELINE_STAGE_TRANSFER_BIT);
+
+				std::vector<VkImageCopy> copies;
+				for (u32 level = copyFrom; level < m_mipLevels; level++) {
+					VkImageCopy region{};
+					region.srcSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, level - m_residentMip, 0, 1 };
+					region.dstSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, level - mip, 0, 1 };
+					region.extent = { header.mips[level].width, header.mips[level].height, 1 };
+					copies.push_back(region);
+				}
+				vkCmdCopyImage(commandBuffer, m_textureImage, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, image,
+					VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, static_cast<u32>(copies.size()), copies.data());
+			}
+			ImageBarrier(commandBuffer, image, levelCount, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+				VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+			RVKDevice::s_rvkDevice->EndSingleTimeCommands(commandBuffer);
+		}
+
+		if (stagingBuffer != VK_NULL_HANDLE) {
+			RVKDevice::s_rvkDevice->DeferDestroy([stagingBuffer, stagingBufferMemory]() {
+				auto device = RVKDevice::s_rvkDevice->GetDevice();
+				vkDestroyBuffer(device, stagingBuffer, nullptr);
+				vkFreeMemory(device, stagingBufferMemory, nullptr);
+			});
+		}
+		if (m_textureImage != VK_NULL_HANDLE) {
+			// descriptors written with the old view stay valid until the frames using them are done
+			RVKDevice::s_rvkDevice->DeferDestroy([image = m_textureImage, imageView = m_imageView, memory = m_textureImageMemory]() {
+				auto device = RVKDevice::s_rvkDevice->GetDevice();
+				vkDestroyImageView(device, imageView, nullptr);
+				vkDestroyImage(device, image, nullptr);
+				vkFreeMemory(device, memory, nullptr);
+			});
+		}
+
+		m_textureImage = image;
+		m_textureImageMemory = memory;
+		m_imageView = CreateImageView(image, levelCount);
+		m_residentMip = mip;
+		m_version++;
+
+		m_descriptorImageInfo.imageView = m_imageView;
+		m_descriptorImageInfo.imageLayout = m_imageLayout;
 	}
 
 	void Texture::Blit(u32 x, u32 y, u32 width, u32 height, u32 bytesPerPixel, const void* data)
 	{
-		VK_CORE_CRITICAL("not implemented void Texture::Blit(u32 x, u32 y, u32 width, u32 height, u32 "
-			"bytesPerPixel, const void* data)");
+		if (m_cooked || m_textureImage == VK_NULL_HANDLE) {
+			VK_CORE_WARN("Texture {0}: Blit needs a texture created from pixels", m_fileName);
+			return;
+		}
+		if (bytesPerPixel != 1 && bytesPerPixel != 3 && bytesPerPixel != 4) {
+			VK_CORE_WARN("Texture {0}: Blit with {1} bytes per pixel is not supported", m_fileName, bytesPerPixel);
+			return;
+		}
+		if (!data || x >= static_cast<u32>(m_width) || y >= static_cast<u32>(m_height) || width == 0 || height == 0) {
+			return;
+		}
+
+		// clipped to the texture, the source rows keep their length
+		u32 sourceWidth = width;
+		width = std::min(width, static_cast<u32>(m_width) - x);
+		height = std::min(height, static_cast<u32>(m_height) - y);
+
+		VkDeviceSize size = static_cast<VkDeviceSize>(width) * height * 4;
+		PendingBlit blit{};
+		u8* pixels = nullptr;
+		if (RVKStagingRing::s_stagingRing) {
+			RVKStagingRing::Allocation allocation = RVKStagingRing::s_stagingRing->Allocate(size, 4);
+			blit.buffer = allocation.buffer;
+			blit.region.bufferOffset = allocation.offset;
+			pixels = allocation.data;
+		}
+		if (!pixels) {
+			auto device = RVKDevice::s_rvkDevice->GetDevice();
+			CreateBuffer(size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+				VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, blit.buffer, blit.memory);
+			blit.region.bufferOffset = 0;
+			void* mapped;
+			vkMapMemory(device, blit.memory, 0, size, 0, &mapped);
+			pixels = static_cast<u8*>(mapped);
+		}
+
+		// the mapped memory is write combined, it is only written to
+		const u8* source = static_cast<const u8*>(data);
+		for (u32 row = 0; row < height; row++) {
+			const u8* in = source + static_cast<size_t>(row) * sourceWidth * bytesPerPixel;
+			u8* out = pixels + static_cast<size_t>(row) * width * 4;
+			if (bytesPerPixel == 4) {
+				memcpy(out, in, static_cast<size_t>(width) * 4);
+				for (u32 column = 0; column < width; column++) {
+					m_minAlpha = std::min(m_minAlpha, in[column * 4 + 3]);
+				}
+				continue;
+			}
+			for (u32 column = 0; column < width; column++, in += bytesPerPixel, out += 4) {
+				out[0] = in[0];
+				out[1] = bytesPerPixel == 3 ? in[1] : 0;
+				out[2] = bytesPerPixel == 3 ? in[2] : 0;
+				out[3] = 255;
+			}
+		}
+		if (blit.memory != VK_NULL_HANDLE) {
+			vkUnmapMemory(RVKDevice::s_rvkDevice->GetDevice(), blit.memory);
+		}
+
+		blit.region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		blit.region.imageSubresource.mipLevel = 0;
+		blit.region.imageSubresource.baseArrayLayer = 0;
+		blit.region.imageSubresource.layerCount = 1;
+		blit.region.imageOffset = { static_cast<s32>(x), static_cast<s32>(y), 0 };
+		blit.region.imageExtent = { width, height, 1 };
+
+		if (m_pendingBlits.empty()) {
+			s_blitTextures.push_back(this);
+		}
+		m_pendingBlits.push_back(blit);
 	}
 
 	void Texture::Blit(u32 x, u32 y, u32 width, u32 height, int dataFormat, int type, const void* data)
 	{
-		VK_CORE_CRITICAL("not implemented void Texture::Blit(u32 x, u32 y, u32 width, u32 height, int dataFormat, "
-			"int type, const void* data)");
+		u32 bytesPerPixel = 0;
+		switch (dataFormat) {
+		case TEXTURE_FORMAT_RED:
+			bytesPerPixel = 1;
+			break;
+		case TEXTURE_FORMAT_RGB:
+			bytesPerPixel = 3;
+			break;
+		case TEXTURE_FORMAT_RGBA:
+			bytesPerPixel = 4;
+			break;
+		}
+		if (bytesPerPixel == 0 || type != TEXTURE_TYPE_UNSIGNED_BYTE) {
+			VK_CORE_WARN("Texture {0}: Blit with data format {1} and type {2} is not supported", m_fileName, dataFormat, type);
+			return;
+		}
+		Blit(x, y, width, height, bytesPerPixel, data);
+	}
+
+	void Texture::RecordBlits(VkCommandBuffer commandBuffer) {
+		// frames submitted before may still sample it
+		ImageBarrier(commandBuffer, m_textureImage, 1, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+			VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 0, VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+			VK_PIPELINE_STAGE_TRANSFER_BIT);
+
+		// one copy per run of rects out of the same buffer, usually all of them come from the ring
+		std::vector<VkBufferImageCopy> regions;
+		for (size_t i = 0; i < m_pendingBlits.size(); i++) {
+			regions.push_back(m_pendingBlits[i].region);
+			if (i + 1 == m_pendingBlits.size() || m_pendingBlits[i + 1].buffer != m_pendingBlits[i].buffer) {
+				vkCmdCopyBufferToImage(commandBuffer, m_pendingBlits[i].buffer, m_textureImage,
+					VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, static_cast<u32>(regions.size()), regions.data());
+				regions.clear();
+			}
+			if (m_pendingBlits[i].memory != VK_NULL_HANDLE) {
+				DestroyStagingBuffer(m_pendingBlits[i].buffer, m_pendingBlits[i].memory);
+			}
+		}
+		m_pendingBlits.clear();
+
+		ImageBarrier(commandBuffer, m_textureImage, 1, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+			VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+	}
+
+	void Texture::FlushBlits() {
+		if (s_blitTextures.empty()) {
+			return;
+		}
+
+		RVKDevice::s_rvkDevice->BeginUploadBatch();
+		VkCommandBuffer commandBuffer = RVKDevice::s_rvkDevice->BeginSingleTimeCommands();
+		for (Texture* texture : s_blitTextures) {
+			texture->RecordBlits(commandBuffer);
+		}
+		s_blitTextures.clear();
+		RVKDevice::s_rvkDevice->EndSingleTimeCommands(commandBuffer);
+		RVKDevice::s_rvkDevice->EndUploadBatch();
+
+		if (RVKStagingRing::s_stagingRing) {
+			RVKStagingRing::s_stagingRing->Retire();
+		}
 	}
 
 	void Texture::Resize(u32 width, u32 height)
 	{
-		VK_CORE_CRITICAL("not implemented void Texture::Resize(u32 width, u32 height)");
+		if (m_cooked) {
+			VK_CORE_WARN("Texture {0}: streamed textures can't be resized", m_fileName);
+			return;
+		}
+		if (width == 0 || height == 0 || (width == static_cast<u32>(m_width) && height == static_cast<u32>(m_height))) {
+			return;
+		}
+		if (m_textureImage == VK_NULL_HANDLE) {
+			std::vector<u8> clear(static_cast<size_t>(width) * height * 4, 0);
+			m_width = width;
+			m_height = height;
+			m_bytesPerPixel = 4;
+			m_localBuffer = clear.data();
+			Create();
+			m_localBuffer = nullptr;
+			return;
+		}
+
+		VkImageCreateInfo imageInfo{};
+		imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+		imageInfo.imageType = VK_IMAGE_TYPE_2D;
+		imageInfo.extent.width = width;
+		imageInfo.extent.height = height;
+		imageInfo.extent.depth = 1;
+		imageInfo.mipLevels = 1;
+		imageInfo.arrayLayers = 1;
+		imageInfo.format = m_imageFormat;
+		imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+		imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		imageInfo.usage = VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+		imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+		imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+		VkImage image;
+		VkDeviceMemory memory;
+		RVKDevice::s_rvkDevice->CreateImageWithInfo(imageInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, image, memory);
+
+		VkCommandBuffer commandBuffer = RVKDevice::s_rvkDevice->BeginSingleTimeCommands();
+		// rects queued for the old size land in the old image first and get copied over with it
+		bool blitted = !m_pendingBlits.empty();
+		if (blitted) {
+			s_blitTextures.erase(std::find(s_blitTextures.begin(), s_blitTextures.end(), this));
+			RecordBlits(commandBuffer);
+		}
+		ImageBarrier(commandBuffer, image, 1, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+			0, VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+		VkClearColorValue clear{};
+		VkImageSubresourceRange range{ VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+		vkCmdClearColorImage(commandBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, &clear, 1, &range);
+		ImageBarrier(commandBuffer, image, 1, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+			VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+
+		// the frames submitted before still sample it, the transition waits for them and for the blits
+		ImageBarrier(commandBuffer, m_textureImage, 1, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+			VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_TRANSFER_READ_BIT,
+			VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+		VkImageCopy region{};
+		region.srcSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+		region.dstSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+		region.extent = { std::min(width, static_cast<u32>(m_width)), std::min(height, static_cast<u32>(m_height)), 1 };
+		vkCmdCopyImage(commandBuffer, m_textureImage, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, image,
+			VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+
+		ImageBarrier(commandBuffer, image, 1, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+			VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+		RVKDevice::s_rvkDevice->EndSingleTimeCommands(commandBuffer);
+		if (blitted && RVKStagingRing::s_stagingRing) {
+			RVKStagingRing::s_stagingRing->Retire();
+		}
+
+		// descriptors written with the old view stay valid until the frames using them are done
+		RVKDevice::s_rvkDevice->DeferDestroy([image = m_textureImage, imageView = m_imageView, memory = m_textureImageMemory]() {
+			auto device = RVKDevice::s_rvkDevice->GetDevice();
+			vkDestroyImageView(device, imageView, nullptr);
+			vkDestroyImage(device, image, nullptr);
+			vkFreeMemory(device, memory, nullptr);
+		});
+
+		if (width > static_cast<u32>(m_width) || height > static_cast<u32>(m_height)) {
+			m_minAlpha = 0;
+		}
+		m_width = width;
+		m_height = height;
+		m_textureImage = image;
+		m_textureImageMemory = memory;
+		m_imageView = CreateImageView(image, 1);
+		m_version++;
+
+		m_descriptorImageInfo.imageView = m_imageView;
 	}
 
 	void Texture::GenerateMipmaps()
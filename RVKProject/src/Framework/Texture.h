@@ -2,10 +2,39 @@
 #include "Framework/Vulkan/VkUtils.h"
 
 namespace RVK {
+	class CookedTexture;
+
 	class Texture {
 	public:
 		static constexpr bool USE_SRGB = true;
 		static constexpr bool USE_UNORM = false;
+		// streamed textures keep the levels up to this size resident all the time
+		static constexpr u32 STREAMING_TAIL_SIZE = 128;
+
+		struct PixelDeleter {
+			void operator()(u8* pixels) const;
+		};
+
+		// RGBA8 pixels out of stb_image, or the cooked mip chain of the file when it has one.
+		// Decoding touches no Vulkan objects, so any thread can make one.
+		struct Image {
+			std::string fileName;
+			int width = 0;
+			int height = 0;
+			std::unique_ptr<u8, PixelDeleter> pixels;
+			// the texture gets streamed from it, pixels stay empty
+			std::shared_ptr<CookedTexture> cooked;
+			// milliseconds
+			double decodeTime = 0.0;
+		};
+
+		// the flip only applies to this call, stb_image keeps it per thread
+		static bool Decode(const std::string& fileName, bool flip, Image& image);
+		// opens the .rvktex next to the file, decoding and cooking it first if the file changed,
+		// falls back to the decoded pixels when the cooked file can't be written
+		static bool DecodeCooked(const std::string& fileName, bool flip, Image& image);
+		// on all hardware threads, images that failed keep no pixels
+		static void DecodeAll(const std::vector<std::string>& fileNames, bool flip, std::vector<Image>& images, bool cook = false);
 
 	public:
 		Texture(bool nearestFilter = false);
@@ -16,11 +45,23 @@ namespace RVK {
 		bool Init(const u32 width, const u32 height, bool sRGB, const void* data, int minFilter, int magFilter);
 		bool Init(const std::string& fileName, bool sRGB, bool flip = true);
 		bool Init(const unsigned char* data, int length, bool sRGB);
+		// upload half of Init(fileName), the image keeps its pixels, cooked images start streaming
+		bool Init(const Image& image, bool sRGB);
 
+		// keeps the overlapping texels, new ones are transparent black, the old image goes into the deletion queue
 		void Resize(u32 width, u32 height);
+		// Queues an update of the rect, the pixels are copied right away and go to the GPU with the next FlushBlits.
+		// 1, 3 or 4 bytes per pixel, tightly packed rows, expanded to RGBA like an upload to a GL RGBA texture.
 		void Blit(u32 x, u32 y, u32 width, u32 height, u32 bytesPerPixel, const void* data);
+		// GL_RED, GL_RGB or GL_RGBA with GL_UNSIGNED_BYTE
 		void Blit(u32 x, u32 y, u32 width, u32 height, int dataFormat, int type, const void* data);
+		// records the rects of all textures blitted since the last call in one submission,
+		// main thread once per frame outside of command buffer recording
+		static void FlushBlits();
 		void SetFilename(const std::string& filename) { m_fileName = filename; }
+		void SetSRGB(bool sRGB) { m_sRGB = sRGB; }
+		const std::string& GetFilename() const { return m_fileName; }
+		bool IsSRGB() const { return m_sRGB; }
 
 		VkDescriptorImageInfo& GetDescriptorImageInfo() { return m_descriptorImageInfo; }
         int GetWidth() const { return m_width; }
@@ -28,17 +69,40 @@ namespace RVK {
         VkImage& GetImage() { return m_textureImage; }
 		VkImageView& GetImageView() { return m_imageView; }
 		VkSampler& GetSampler() { return m_sampler; }
+		// RGBA8, a single level or the resident part of the mip chain
+		u64 GetMemorySize() const;
+		// smallest alpha of all texels, 0 to 1
+		float GetMinAlpha() const { return m_minAlpha / 255.0f; }
 
         VkDescriptorSet& GetDescriptorSet() { return m_descriptorSet; }
 
+		// Streaming
+		// the image holds the levels from the resident mip down, its view starts there as well, so the
+		// resident mip is the texture's min LOD and nothing ever samples a level that isn't there
+		bool IsStreamed() const { return m_cooked != nullptr; }
+		const std::shared_ptr<CookedTexture>& GetCookedTexture() const { return m_cooked; }
+		u32 GetMipCount() const { return m_mipLevels; }
+		u32 GetResidentMip() const { return m_residentMip; }
+		// the most detailed level that is never dropped
+		u32 GetTailMip() const { return m_tailMip; }
+		// Moves the image to one starting at mip, the levels both have are copied on the GPU.
+		// levels has the cooked data of mip up to the resident mip, nullptr when levels are dropped.
+		// Main thread outside of command buffer recording, goes into the open upload batch if there is one.
+		void SetResidentMip(u32 mip, const u8* levels);
+		// changes with the image view, descriptors written with another one are stale
+		u32 GetVersion() const { return m_version; }
 
 	private:
         bool Create();
+        bool InitStreamed(const std::shared_ptr<CookedTexture>& cooked, bool sRGB);
+        void CreateSampler();
+        VkImageView CreateImageView(VkImage image, u32 levelCount);
         void CreateBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer,
             VkDeviceMemory& bufferMemory);
         void CreateImage(VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties);
         void TransitionImageLayout(VkImageLayout oldLayout, VkImageLayout newLayout);
         void GenerateMipmaps();
+        void RecordBlits(VkCommandBuffer commandBuffer);
 
         VkFilter SetFilter(int minMagFilter);
         VkFilter SetFilterMip(int minFilter);
@@ -52,21 +116,37 @@ namespace RVK {
 
         int m_internalFormat, m_dataFormat;
         bool m_sRGB;
+        u8 m_minAlpha = 255;
         VkFilter m_minFilter;
         VkFilter m_magFilter;
         VkFilter m_minFilterMip;
         int m_type;
 
         VkFormat m_imageFormat;
-        VkImage m_textureImage;
-        VkDeviceMemory m_textureImageMemory;
+        VkImage m_textureImage = VK_NULL_HANDLE;
+        VkDeviceMemory m_textureImageMemory = VK_NULL_HANDLE;
         VkImageLayout m_imageLayout;
-        VkImageView m_imageView;
-        VkSampler m_sampler;
+        VkImageView m_imageView = VK_NULL_HANDLE;
+        VkSampler m_sampler = VK_NULL_HANDLE;
 
         VkDescriptorImageInfo m_descriptorImageInfo;
         VkDescriptorSet m_descriptorSet;
 
+        // streamed textures only
+        std::shared_ptr<CookedTexture> m_cooked;
+        u32 m_residentMip = 0;
+        u32 m_tailMip = 0;
+        u32 m_version = 0;
+
+        struct PendingBlit {
+            VkBuffer buffer;
+            // set when the staging ring was full and the rect got a buffer of its own
+            VkDeviceMemory memory;
+            VkBufferImageCopy region;
+        };
+        std::vector<PendingBlit> m_pendingBlits;
+        static std::vector<Texture*> s_blitTextures;
+
     private:
         static constexpr int TEXTURE_FILTER_NEAREST = 9728;
         static constexpr int TEXTURE_FILTER_LINEAR = 9729;
@@ -74,5 +154,9 @@ namespace RVK {
         static constexpr int TEXTURE_FILTER_LINEAR_MIPMAP_NEAREST = 9985;
         static constexpr int TEXTURE_FILTER_NEAREST_MIPMAP_LINEAR = 9986;
         static constexpr int TEXTURE_FILTER_LINEAR_MIPMAP_LINEAR = 9987;
+        static constexpr int TEXTURE_FORMAT_RED = 6403;
+        static constexpr int TEXTURE_FORMAT_RGB = 6407;
+        static constexpr int TEXTURE_FORMAT_RGBA = 6408;
+        static constexpr int TEXTURE_TYPE_UNSIGNED_BYTE = 5121;
 	};
 }
\ No newline at end of file
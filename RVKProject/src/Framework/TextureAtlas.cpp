@@ -0,0 +1,164 @@
+#include "Framework/TextureAtlas.h"
+#include "Framework/TextureCooker.h"
+
+#include <stb/stb_image.h>
+
+#include <map>
+
+namespace RVK {
+	namespace {
+		u32 AlignUp(u32 value, u32 alignment) {
+			return (value + alignment - 1) / alignment * alignment;
+		}
+
+		struct Item {
+			u32 image;
+			u32 width;
+			u32 height;
+			u32 x = 0;
+			u32 y = 0;
+		};
+
+		struct Page {
+			u32 width = 0;
+			u32 height = 0;
+			std::vector<const Item*> items;
+		};
+	}  // namespace
+
+	TextureAtlas::Placements TextureAtlas::Pack(const std::vector<Source>& textures, const std::string& sourcePath, bool flip) {
+		// stb reads the size from the header, only the small ones get decoded
+		std::vector<Source> small;
+		std::unordered_set<std::string> seen;
+		for (const Source& texture : textures) {
+			int width = 0;
+			int height = 0;
+			int channels = 0;
+			if (seen.insert(texture.path).second && stbi_info(texture.path.c_str(), &width, &height, &channels) &&
+				static_cast<u32>(width) <= MAX_PACKED_SIZE && static_cast<u32>(height) <= MAX_PACKED_SIZE) {
+				small.push_back(texture);
+			}
+		}
+		if (small.size() < 2) {
+			return {};
+		}
+
+		std::vector<std::string> paths;
+		for (const Source& texture : small) {
+			paths.push_back(texture.path);
+		}
+		std::vector<RVK::Texture::Image> images;
+		RVK::Texture::DecodeAll(paths, flip, images);
+
+		// by format, then by whether the alpha test is needed
+		std::map<std::pair<bool, bool>, std::vector<Item>> groups;
+		for (u32 i = 0; i < images.size(); i++) {
+			const RVK::Texture::Image& image = images[i];
+			if (!image.pixels) {
+				continue;
+			}
+
+			u64 pixelCount = u64(image.width) * image.height;
+			u8 minAlpha = 255;
+			for (u64 p = 0; p < pixelCount; p++) {
+				minAlpha = std::min(minAlpha, image.pixels.get()[p * 4 + 3]);
+			}
+			Item item{ i, AlignUp(image.width + 2 * PADDING, ALIGNMENT), AlignUp(image.height + 2 * PADDING, ALIGNMENT) };
+			groups[{ small[i].sRGB, minAlpha < 128 }].push_back(item);
+		}
+
+		Placements placements;
+		u32 pageCount = 0;
+		u64 sourceBytes = 0;
+		u64 pageBytes = 0;
+		for (auto& [key, items] : groups) {
+			// shelves, the tallest textures first so every shelf is about as high as what is on it
+			std::sort(items.begin(), items.end(), [](const Item& a, const Item& b) { return a.height > b.height; });
+			std::vector<Page> pages;
+			u32 x = 0;
+			u32 y = 0;
+			u32 shelfHeight = 0;
+			for (Item& item : items) {
+				if (x + item.width > PAGE_SIZE) {
+					x = 0;
+					y += shelfHeight;
+					shelfHeight = 0;
+				}
+				if (pages.empty() || y + item.height > PAGE_SIZE) {
+					pages.emplace_back();
+					x = 0;
+					y = 0;
+					shelfHeight = 0;
+				}
+
+				item.x = x;
+				item.y = y;
+				Page& page = pages.back();
+				page.items.push_back(&item);
+				page.width = std::max(page.width, x + item.width);
+				page.height = std::max(page.height, y + item.height);
+				x += item.width;
+				shelfHeight = std::max(shelfHeight, item.height);
+			}
+
+			for (const Page& page : pages) {
+				// a texture alone on a page saves nothing
+				if (page.items.size() < 2) {
+					continue;
+				}
+
+				// the space between textures is opaque, so it never lowers the page's smallest alpha
+				RVK::Texture::Image pageImage;
+				pageImage.fileName = sourcePath;
+				pageImage.width = static_cast<int>(page.width);
+				pageImage.height = static_cast<int>(page.height);
+				size_t pageSize = size_t(page.width) * page.height * 4;
+				// released by stbi_image_free like any decoded image
+				pageImage.pixels.reset(static_cast<u8*>(std::malloc(pageSize)));
+				std::memset(pageImage.pixels.get(), 255, pageSize);
+
+				for (const Item* item : page.items) {
+					const RVK::Texture::Image& image = images[item->image];
+					u32 width = static_cast<u32>(image.width);
+					u32 height = static_cast<u32>(image.height);
+					// the whole padded rect, the texture wraps into its border
+					for (u32 py = 0; py < item->height; py++) {
+						u32 sy = (py + height - PADDING % height) % height;
+						u8* row = pageImage.pixels.get() + (size_t(item->y + py) * page.width + item->x) * 4;
+						for (u32 px = 0; px < item->width; px++) {
+							u32 sx = (px + width - PADDING % width) % width;
+							std::memcpy(row + size_t(px) * 4, image.pixels.get() + (size_t(sy) * width + sx) * 4, 4);
+						}
+					}
+				}
+
+				std::string pagePath = GetPagePath(sourcePath, pageCount);
+				if (!TextureCooker::Cook(pageImage, TextureCooker::GetCookedPath(pagePath), flip)) {
+					continue;
+				}
+				pageCount++;
+				pageBytes += pageSize;
+
+				for (const Item* item : page.items) {
+					const RVK::Texture::Image& image = images[item->image];
+					Placement& placement = placements[image.fileName];
+					placement.page = pagePath;
+					placement.uvTransform = glm::vec4(
+						static_cast<float>(image.width) / page.width,
+						static_cast<float>(image.height) / page.height,
+						static_cast<float>(item->x + PADDING) / page.width,
+						static_cast<float>(item->y + PADDING) / page.height);
+					sourceBytes += u64(image.width) * image.height * 4;
+				}
+			}
+		}
+
+		if (!placements.empty()) {
+			// every texture had its own image, view and sampler, a page has one of each. The descriptor sets stay
+			// one per material.
+			VK_CORE_INFO("Atlas {0}: {1} textures in {2} pages, {3:.1f} KB of textures in {4:.1f} KB of pages, {5} fewer images",
+				sourcePath, placements.size(), pageCount, sourceBytes / 1024.0, pageBytes / 1024.0, placements.size() - pageCount);
+		}
+		return placements;
+	}
+}  // namespace RVK
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "Framework/Texture.h"
+
+namespace RVK {
+	// Cook time packing of a model's small diffuse maps into shared pages, one image, view and sampler
+	// for all of them. Textures are grouped by format and by whether they need the alpha test, so a page
+	// never turns opaque materials into alpha tested ones. Every texture keeps a border of its own texels
+	// wrapped around it, the materials sample it through a UV rect and repeat inside of it.
+	class TextureAtlas {
+	public:
+		// textures up to this size on both sides are packed
+		static constexpr u32 MAX_PACKED_SIZE = 256;
+		static constexpr u32 PAGE_SIZE = 2048;
+		// wrapped border, the first three mips of a page don't bleed between textures
+		static constexpr u32 PADDING = 8;
+		// rect corners land on whole texels down to mip 4
+		static constexpr u32 ALIGNMENT = 16;
+
+		struct Source {
+			std::string path;
+			bool sRGB;
+		};
+
+		struct Placement {
+			// stands in for the texture path, the page is cooked to its .rvktex
+			std::string page;
+			// xy scale, zw offset, applied to the wrapped UV
+			glm::vec4 uvTransform;
+		};
+
+		using Placements = std::unordered_map<std::string, Placement>;
+
+		// the pages are cooked next to sourcePath, with the flip the loader decodes the textures with
+		static Placements Pack(const std::vector<Source>& textures, const std::string& sourcePath, bool flip);
+		static std::string GetPagePath(const std::string& sourcePath, u32 page) { return sourcePath + ".atlas" + std::to_string(page); }
+	};
+}  // namespace RVK
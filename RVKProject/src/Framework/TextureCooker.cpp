@@ -0,0 +1,178 @@
+#include "Framework/TextureCooker.h"
+
+#include <filesystem>
+#include <fstream>
+
+namespace RVK {
+	namespace {
+		bool GetSourceStamp(const std::string& sourcePath, u64& size, s64& time) {
+			std::error_code error;
+			size = static_cast<u64>(std::filesystem::file_size(sourcePath, error));
+			if (error) {
+				return false;
+			}
+			time = static_cast<s64>(std::filesystem::last_write_time(sourcePath, error).time_since_epoch().count());
+			return !error;
+		}
+
+		u64 AlignBlob(u64 offset) {
+			return (offset + 15) & ~u64(15);
+		}
+
+		// 2x2 box filter, the last row or column of odd sizes is reused
+		void Downsample(const u8* source, u32 width, u32 height, u8* destination, u32 mipWidth, u32 mipHeight) {
+			for (u32 y = 0; y < mipHeight; y++) {
+				u32 y0 = std::min(y * 2, height - 1);
+				u32 y1 = std::min(y * 2 + 1, height - 1);
+				for (u32 x = 0; x < mipWidth; x++) {
+					u32 x0 = std::min(x * 2, width - 1);
+					u32 x1 = std::min(x * 2 + 1, width - 1);
+					for (u32 c = 0; c < 4; c++) {
+						u32 sum = source[(y0 * width + x0) * 4 + c] + source[(y0 * width + x1) * 4 + c] +
+							source[(y1 * width + x0) * 4 + c] + source[(y1 * width + x1) * 4 + c];
+						destination[(y * mipWidth + x) * 4 + c] = static_cast<u8>((sum + 2) / 4);
+					}
+				}
+			}
+		}
+	}  // namespace
+
+	bool CookedTexture::Open(const std::string& filepath) {
+		m_header = nullptr;
+		m_path = filepath;
+		if (!m_file.Open(filepath)) {
+			return false;
+		}
+
+		u64 fileSize = m_file.GetSize();
+		if (fileSize < sizeof(CookedTextureHeader)) {
+			m_file.Close();
+			return false;
+		}
+
+		auto header = reinterpret_cast<const CookedTextureHeader*>(m_file.GetData());
+		auto fits = [fileSize](u64 offset, u64 size) { return offset <= fileSize && size <= fileSize - offset; };
+		bool valid = header->magic == TextureCooker::MAGIC &&
+			header->version == TextureCooker::VERSION &&
+			header->mipCount >= 1 && header->mipCount <= CookedTextureHeader::MAX_MIPS;
+		for (u32 mip = 0; valid && mip < header->mipCount; mip++) {
+			const CookedTextureHeader::Mip& level = header->mips[mip];
+			valid = level.size == u64(level.width) * level.height * 4 && fits(level.offset, level.size) &&
+				(mip == 0 || level.offset == header->mips[mip - 1].offset + header->mips[mip - 1].size);
+		}
+		if (!valid) {
+			VK_CORE_WARN("Cooked texture {0} is corrupt or outdated", filepath);
+			m_file.Close();
+			return false;
+		}
+
+		m_header = header;
+		return true;
+	}
+
+	u64 CookedTexture::GetMipChainSize(u32 firstMip) const {
+		const CookedTextureHeader::Mip& last = m_header->mips[m_header->mipCount - 1];
+		return last.offset + last.size - m_header->mips[firstMip].offset;
+	}
+
+	bool TextureCooker::IsUpToDate(const std::string& sourcePath, const std::string& cookedPath, bool flip) {
+		std::ifstream file(cookedPath, std::ios::binary);
+		if (!file) {
+			return false;
+		}
+
+		CookedTextureHeader header{};
+		if (!file.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+			return false;
+		}
+
+		u64 sourceSize;
+		s64 sourceTime;
+		if (!GetSourceStamp(sourcePath, sourceSize, sourceTime)) {
+			// source is gone, whatever was cooked is all there is
+			return header.magic == MAGIC && header.version == VERSION;
+		}
+
+		return header.magic == MAGIC &&
+			header.version == VERSION &&
+			header.flipped == static_cast<u32>(flip) &&
+			header.sourceSize == sourceSize &&
+			header.sourceTime == sourceTime;
+	}
+
+	bool TextureCooker::Cook(const Texture::Image& image, const std::string& cookedPath, bool flip) {
+		if (!image.pixels || image.width <= 0 || image.height <= 0) {
+			return false;
+		}
+
+		CookedTextureHeader header{};
+		header.magic = MAGIC;
+		header.version = VERSION;
+		if (!GetSourceStamp(image.fileName, header.sourceSize, header.sourceTime)) {
+			return false;
+		}
+
+		header.width = static_cast<u32>(image.width);
+		header.height = static_cast<u32>(image.height);
+		header.flipped = static_cast<u32>(flip);
+		header.mipCount = std::min(static_cast<u32>(std::floor(std::log2(std::max(header.width, header.height)))) + 1,
+			CookedTextureHeader::MAX_MIPS);
+
+		u64 pixelCount = u64(header.width) * header.height;
+		header.minAlpha = 255;
+		for (u64 i = 0; i < pixelCount; i++) {
+			header.minAlpha = std::min<u32>(header.minAlpha, image.pixels.get()[i * 4 + 3]);
+		}
+
+		// the chain is built in memory first, a 4k texture adds a third on top of its pixels
+		std::vector<std::vector<u8>> mips(header.mipCount);
+		const u8* previous = image.pixels.get();
+		u32 width = header.width;
+		u32 height = header.height;
+		u64 offset = AlignBlob(sizeof(CookedTextureHeader));
+		for (u32 mip = 0; mip < header.mipCount; mip++) {
+			u32 mipWidth = mip == 0 ? width : std::max(width / 2, 1u);
+			u32 mipHeight = mip == 0 ? height : std::max(height / 2, 1u);
+			if (mip > 0) {
+				mips[mip].resize(u64(mipWidth) * mipHeight * 4);
+				Downsample(previous, width, height, mips[mip].data(), mipWidth, mipHeight);
+				previous = mips[mip].data();
+			}
+			width = mipWidth;
+			height = mipHeight;
+
+			header.mips[mip] = { offset, u64(width) * height * 4, width, height };
+			offset += header.mips[mip].size;
+		}
+
+		// written next to the final file and renamed, so a crash never leaves half a texture behind
+		std::string tempPath = cookedPath + ".tmp";
+		{
+			std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+			if (!file) {
+				return false;
+			}
+
+			static constexpr char padding[16]{};
+			file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+			file.write(padding, static_cast<std::streamsize>(header.mips[0].offset - sizeof(header)));
+			for (u32 mip = 0; mip < header.mipCount; mip++) {
+				const u8* data = mip == 0 ? image.pixels.get() : mips[mip].data();
+				file.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(header.mips[mip].size));
+			}
+			if (!file) {
+				return false;
+			}
+		}
+
+		std::error_code error;
+		std::filesystem::rename(tempPath, cookedPath, error);
+		if (error) {
+			std::filesystem::remove(tempPath, error);
+			return false;
+		}
+
+		VK_CORE_INFO("Cooked {0}: {1}x{2}, {3} mips", cookedPath, header.width, header.height, header.mipCount);
+		return true;
+	}
+}  // namespace RVK
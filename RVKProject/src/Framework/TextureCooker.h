@@ -0,0 +1,63 @@
+#pragma once
+
+#include "Framework/Texture.h"
+#include "Framework/MappedFile.h"
+
+namespace RVK {
+	// .rvktex layout: header, then the RGBA8 mip chain from the full size down to 1x1, 16 byte aligned.
+	// The levels are stored largest first and back to back, so any run of them is one contiguous read.
+	struct CookedTextureHeader {
+		static constexpr u32 MAX_MIPS = 16;
+
+		struct Mip {
+			u64 offset;
+			u64 size;
+			u32 width;
+			u32 height;
+		};
+
+		u32 magic;
+		u32 version;
+		// the source the file was cooked from, it gets cooked again when these don't match
+		u64 sourceSize;
+		s64 sourceTime;
+
+		u32 width;
+		u32 height;
+		u32 mipCount;
+		u32 flipped;
+		// smallest alpha of the full size level, 0 to 255
+		u32 minAlpha;
+		u32 spare;
+
+		Mip mips[MAX_MIPS];
+	};
+
+	class CookedTexture {
+	public:
+		bool Open(const std::string& filepath);
+
+		const std::string& GetPath() const { return m_path; }
+		const CookedTextureHeader& GetHeader() const { return *m_header; }
+		const u8* GetMip(u32 mip) const { return m_file.GetData() + m_header->mips[mip].offset; }
+		// levels firstMip up to the smallest, they are contiguous in the file
+		u64 GetMipChainSize(u32 firstMip) const;
+
+	private:
+		std::string m_path;
+		MappedFile m_file;
+		const CookedTextureHeader* m_header = nullptr;
+	};
+
+	class TextureCooker {
+	public:
+		static constexpr u32 MAGIC = 0x544B5652; // "RVKT"
+		static constexpr u32 VERSION = 1;
+
+		static std::string GetCookedPath(const std::string& sourcePath) { return sourcePath + ".rvktex"; }
+		// false if the cooked file is missing, from an older version, a different source or flip
+		static bool IsUpToDate(const std::string& sourcePath, const std::string& cookedPath, bool flip);
+		// box filters the mip chain out of the decoded pixels
+		static bool Cook(const Texture::Image& image, const std::string& cookedPath, bool flip);
+	};
+}  // namespace RVK
@@ -0,0 +1,224 @@
+#include "Framework/TextureStreamer.h"
+#include "Framework/Vulkan/RVKDevice.h"
+
+#include <queue>
+
+namespace RVK {
+	TextureStreamer* TextureStreamer::s_textureStreamer = nullptr;
+
+	namespace {
+		u64 GetChainSize(const Texture& texture, u32 firstMip) {
+			return texture.GetCookedTexture()->GetMipChainSize(firstMip);
+		}
+	}  // namespace
+
+	TextureStreamer::TextureStreamer(u64 budget) : m_budget(budget) {
+		if (s_textureStreamer) {
+			VK_CORE_CRITICAL("TextureStreamer already initialized");
+		}
+		s_textureStreamer = this;
+
+		// reads are memory copies out of mapped files, the disk is the limit and one thread keeps it busy
+		m_worker = std::thread(&TextureStreamer::WorkerLoop, this);
+	}
+
+	TextureStreamer::~TextureStreamer() {
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_stop = true;
+			m_reads.clear();
+		}
+		m_wakeUp.notify_all();
+		m_worker.join();
+
+		if (s_textureStreamer == this) {
+			s_textureStreamer = nullptr;
+		}
+	}
+
+	void TextureStreamer::Register(Texture& texture) {
+		Entry& entry = m_entries[&texture];
+		entry.texture = &texture;
+		entry.requestedMip = texture.GetTailMip();
+		entry.targetMip = texture.GetResidentMip();
+		entry.lastNeeded = m_frame;
+		entry.read = 0;
+	}
+
+	void TextureStreamer::Unregister(Texture& texture) {
+		// a read still in flight finds no entry and is thrown away
+		m_entries.erase(&texture);
+	}
+
+	void TextureStreamer::Request(const Texture& texture, float screenSize) {
+		auto it = m_entries.find(&texture);
+		if (it == m_entries.end()) {
+			return;
+		}
+
+		// one texel per pixel across the larger side
+		float texels = static_cast<float>(std::max(texture.GetWidth(), texture.GetHeight()));
+		float pixels = std::max(screenSize, 1.0f);
+		u32 mip = texels > pixels ? static_cast<u32>(std::floor(std::log2(texels / pixels))) : 0;
+
+		Entry& entry = it->second;
+		entry.requestedMip = std::min({ entry.requestedMip, mip, texture.GetTailMip() });
+	}
+
+	void TextureStreamer::WorkerLoop() {
+		while (true) {
+			Read read;
+			{
+				std::unique_lock<std::mutex> lock(m_mutex);
+				m_wakeUp.wait(lock, [this]() { return m_stop || !m_reads.empty(); });
+				if (m_stop) {
+					return;
+				}
+				read = std::move(m_reads.front());
+				m_reads.pop_front();
+			}
+
+			// touching the pages is what reads the file, the main thread then copies from memory
+			const CookedTextureHeader& header = read.file->GetHeader();
+			u64 size = header.mips[read.endMip].offset - header.mips[read.firstMip].offset;
+			const u8* levels = read.file->GetMip(read.firstMip);
+			read.data.assign(levels, levels + size);
+			m_streamedBytes += size;
+
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_done.push_back(std::move(read));
+		}
+	}
+
+	void TextureStreamer::ApplyReads() {
+		std::deque<Read> done;
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			done.swap(m_done);
+		}
+
+		for (Read& read : done) {
+			auto it = m_entries.find(read.texture);
+			// the texture went away, a new one in its place has no read
+			if (it == m_entries.end() || it->second.read != read.id) {
+				continue;
+			}
+
+			Entry& entry = it->second;
+			entry.read = 0;
+			// levels are only dropped while no read is in flight, so this holds
+			if (entry.texture->GetResidentMip() == read.endMip) {
+				entry.texture->SetResidentMip(read.firstMip, read.data.data());
+			}
+		}
+	}
+
+	void TextureStreamer::FitBudget() {
+		u64 total = 0;
+		for (const auto& [key, entry] : m_entries) {
+			total += GetChainSize(*entry.texture, entry.targetMip);
+		}
+		m_wantedBytes = total;
+		if (total <= m_budget) {
+			return;
+		}
+
+		// the largest top levels go first, one of them frees as much as many small ones
+		using Candidate = std::pair<u64, Entry*>;
+		std::priority_queue<Candidate> candidates;
+		auto push = [&](Entry& entry) {
+			if (entry.targetMip < entry.texture->GetTailMip()) {
+				candidates.push({ entry.texture->GetCookedTexture()->GetHeader().mips[entry.targetMip].size, &entry });
+			}
+		};
+		for (auto& [key, entry] : m_entries) {
+			push(entry);
+		}
+
+		while (total > m_budget && !candidates.empty()) {
+			auto [size, entry] = candidates.top();
+			candidates.pop();
+			total -= size;
+			entry->targetMip++;
+			push(*entry);
+		}
+	}
+
+	void TextureStreamer::Update() {
+		m_frame++;
+
+		for (auto& [key, entry] : m_entries) {
+			u32 requestedMip = entry.requestedMip;
+			entry.requestedMip = entry.texture->GetTailMip();
+			if (requestedMip <= entry.targetMip) {
+				entry.targetMip = requestedMip;
+				entry.lastNeeded = m_frame;
+			}
+			else if (m_frame - entry.lastNeeded > DROP_FRAMES) {
+				entry.targetMip = requestedMip;
+			}
+		}
+		FitBudget();
+
+		// finished reads and dropped levels are copies on the GPU, they go out ahead of the frame
+		std::vector<Entry*> missing;
+		RVKDevice::s_rvkDevice->BeginUploadBatch();
+		ApplyReads();
+		for (auto& [key, entry] : m_entries) {
+			u32 residentMip = entry.texture->GetResidentMip();
+			if (entry.read != 0 || entry.targetMip == residentMip) {
+				continue;
+			}
+			if (entry.targetMip > residentMip) {
+				entry.texture->SetResidentMip(entry.targetMip, nullptr);
+			}
+			else {
+				missing.push_back(&entry);
+			}
+		}
+		RVKDevice::s_rvkDevice->EndUploadBatch();
+
+		if (missing.empty()) {
+			return;
+		}
+
+		// textures missing the most levels first
+		std::sort(missing.begin(), missing.end(), [](const Entry* a, const Entry* b) {
+			return a->texture->GetResidentMip() - a->targetMip > b->texture->GetResidentMip() - b->targetMip;
+		});
+
+		u64 readBytes = 0;
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			for (Entry* entry : missing) {
+				if (readBytes >= MAX_READ_BYTES_PER_FRAME) {
+					break;
+				}
+
+				Read read{};
+				read.id = m_nextRead++;
+				read.texture = entry->texture;
+				read.file = entry->texture->GetCookedTexture();
+				read.firstMip = entry->targetMip;
+				read.endMip = entry->texture->GetResidentMip();
+				readBytes += GetChainSize(*entry->texture, read.firstMip) - GetChainSize(*entry->texture, read.endMip);
+				entry->read = read.id;
+				m_reads.push_back(std::move(read));
+			}
+		}
+		m_wakeUp.notify_one();
+	}
+
+	TextureStreamer::Stats TextureStreamer::GetStats() const {
+		Stats stats{};
+		stats.textures = static_cast<u32>(m_entries.size());
+		for (const auto& [key, entry] : m_entries) {
+			stats.streaming += entry.read != 0 ? 1 : 0;
+			stats.residentBytes += entry.texture->GetMemorySize();
+		}
+		stats.wantedBytes = m_wantedBytes;
+		stats.budget = m_budget;
+		stats.streamedBytes = m_streamedBytes;
+		return stats;
+	}
+}  // namespace RVK
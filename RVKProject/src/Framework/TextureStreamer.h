@@ -0,0 +1,97 @@
+#pragma once
+
+#include "Framework/TextureCooker.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace RVK {
+	// Keeps the mips of streamed textures resident that the last frames asked for. Textures start with
+	// their tail, the render systems request a level from the screen size of the meshes using them,
+	// a worker reads missing levels out of the cooked files and the main thread moves the images over.
+	// Levels nobody asked for are dropped after a while, and sooner when the budget runs out.
+	class TextureStreamer {
+	public:
+		static TextureStreamer* s_textureStreamer;
+		static constexpr u64 DEFAULT_BUDGET = 512ull * 1024 * 1024;
+
+		struct Stats {
+			u32 textures = 0;
+			// reads on the worker or waiting for the main thread
+			u32 streaming = 0;
+			u64 residentBytes = 0;
+			// what the requests would take without a budget
+			u64 wantedBytes = 0;
+			u64 budget = 0;
+			// read from the cooked files since the start
+			u64 streamedBytes = 0;
+		};
+
+	public:
+		TextureStreamer(u64 budget = DEFAULT_BUDGET);
+		~TextureStreamer();
+
+		NO_COPY(TextureStreamer)
+		NO_MOVE(TextureStreamer)
+
+		// streamed textures register themselves, main thread only
+		void Register(Texture& texture);
+		void Unregister(Texture& texture);
+
+		// screenSize is how many pixels the texture spans on screen, the largest request of a frame wins
+		void Request(const Texture& texture, float screenSize);
+		// main thread, once per frame outside of command buffer recording, works off the last frame's requests
+		void Update();
+
+		void SetBudget(u64 budget) { m_budget = budget; }
+		Stats GetStats() const;
+
+	private:
+		// a level stays this many frames after the last request that needed it
+		static constexpr u64 DROP_FRAMES = 120;
+		// reads handed to the worker per frame
+		static constexpr u64 MAX_READ_BYTES_PER_FRAME = 32ull * 1024 * 1024;
+
+		struct Entry {
+			Texture* texture;
+			// finest level asked for since the last Update, the tail when nobody asked
+			u32 requestedMip;
+			u32 targetMip;
+			u64 lastNeeded = 0;
+			// the read in flight, 0 for none
+			u64 read = 0;
+		};
+
+		struct Read {
+			u64 id;
+			const Texture* texture;
+			// keeps the file mapped while the worker is on it
+			std::shared_ptr<CookedTexture> file;
+			u32 firstMip;
+			// the resident mip when it was queued, the read fills the levels up to it
+			u32 endMip;
+			std::vector<u8> data;
+		};
+
+		void WorkerLoop();
+		void ApplyReads();
+		void FitBudget();
+
+		std::unordered_map<const Texture*, Entry> m_entries;
+		u64 m_budget;
+		u64 m_frame = 0;
+		u64 m_nextRead = 1;
+		u64 m_wantedBytes = 0;
+
+		std::thread m_worker;
+		std::mutex m_mutex;
+		std::condition_variable m_wakeUp;
+		std::deque<Read> m_reads;
+		// done on the worker, waiting for the main thread
+		std::deque<Read> m_done;
+		bool m_stop = false;
+		std::atomic<u64> m_streamedBytes{ 0 };
+	};
+}  // namespace RVK
@@ -0,0 +1,414 @@
+#include "Framework/TransformBatch.h"
+#include "Framework/Parallel.h"
+
+#if defined(_M_X64) || defined(__SSE2__)
+#define RVK_TRANSFORM_SSE 1
+#include <emmintrin.h>
+#endif
+
+// only the AVX2 kernel is built for AVX2, the rest of the file stays on the baseline instruction set
+#if defined(_M_X64) || defined(__x86_64__)
+#define RVK_TRANSFORM_AVX2 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define RVK_TARGET_AVX2
+#else
+#define RVK_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#else
+#define RVK_TARGET_AVX2
+#endif
+
+namespace RVK {
+	namespace {
+		const glm::mat4 IDENTITY{ 1.0f };
+
+#if RVK_TRANSFORM_AVX2
+		bool CpuHasAVX2() {
+#ifdef _MSC_VER
+			int info[4];
+			__cpuid(info, 0);
+			if (info[0] < 7) {
+				return false;
+			}
+			__cpuid(info, 1);
+			bool osxsave = (info[2] & (1 << 27)) != 0;
+			bool avx = (info[2] & (1 << 28)) != 0;
+			// the OS has to save the upper halves of the ymm registers too
+			if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6) {
+				return false;
+			}
+			__cpuidex(info, 7, 0);
+			return (info[1] & (1 << 5)) != 0;
+#else
+			__builtin_cpu_init();
+			return __builtin_cpu_supports("avx2");
+#endif
+		}
+#endif
+
+#if RVK_TRANSFORM_SSE
+		// columns of four matrices in, element i of a column for all four out, and back
+		inline void Transpose(__m128& a, __m128& b, __m128& c, __m128& d) {
+			_MM_TRANSPOSE4_PS(a, b, c, d);
+		}
+
+		// the first three parent columns weighted by xyz of c, summed in the same order as glm's operator*
+		inline __m128 Combine(__m128 p0, __m128 p1, __m128 p2, __m128 c) {
+			return _mm_add_ps(_mm_add_ps(
+				_mm_mul_ps(p0, _mm_shuffle_ps(c, c, _MM_SHUFFLE(0, 0, 0, 0))),
+				_mm_mul_ps(p1, _mm_shuffle_ps(c, c, _MM_SHUFFLE(1, 1, 1, 1)))),
+				_mm_mul_ps(p2, _mm_shuffle_ps(c, c, _MM_SHUFFLE(2, 2, 2, 2))));
+		}
+
+		// parent * columns for affine matrices, w is 0 in the first three columns and 1 in the last
+		// so those terms are left out, which doesn't change the result
+		inline void Multiply(const glm::mat4& parent, const __m128 (&columns)[4], glm::mat4& out) {
+			const __m128 p0 = _mm_loadu_ps(&parent[0][0]);
+			const __m128 p1 = _mm_loadu_ps(&parent[1][0]);
+			const __m128 p2 = _mm_loadu_ps(&parent[2][0]);
+			for (u32 column = 0; column < 3; column++) {
+				_mm_storeu_ps(&out[column][0], Combine(p0, p1, p2, columns[column]));
+			}
+			_mm_storeu_ps(&out[3][0], _mm_add_ps(Combine(p0, p1, p2, columns[3]), _mm_loadu_ps(&parent[3][0])));
+		}
+
+		// the same for normal matrices, only the upper 3x3 is multiplied
+		inline void MultiplyNormal(const glm::mat4& parent, const __m128 (&columns)[4], glm::mat4& out) {
+			const __m128 p0 = _mm_loadu_ps(&parent[0][0]);
+			const __m128 p1 = _mm_loadu_ps(&parent[1][0]);
+			const __m128 p2 = _mm_loadu_ps(&parent[2][0]);
+			for (u32 column = 0; column < 3; column++) {
+				_mm_storeu_ps(&out[column][0], Combine(p0, p1, p2, columns[column]));
+			}
+			_mm_storeu_ps(&out[3][0], columns[3]);
+		}
+
+		inline void Store(const __m128 (&columns)[4], glm::mat4& out) {
+			for (u32 column = 0; column < 4; column++) {
+				_mm_storeu_ps(&out[column][0], columns[column]);
+			}
+		}
+
+		// one entry once its local and normal columns are back in one register each, roots skip the multiply
+		inline void Finish(const glm::mat4* parentWorld, const glm::mat4* parentNormal, const __m128 (&local)[4],
+			const __m128 (&normal)[4], glm::mat4& outLocal, glm::mat4& outWorld, glm::mat4& outNormal) {
+			Store(local, outLocal);
+			if (parentWorld) {
+				Multiply(*parentWorld, local, outWorld);
+				MultiplyNormal(*parentNormal, normal, outNormal);
+			}
+			else {
+				Store(local, outWorld);
+				Store(normal, outNormal);
+			}
+		}
+#endif
+
+#if RVK_TRANSFORM_AVX2
+		// the same per 128 bit half, entries 0 to 3 in the low and 4 to 7 in the high half
+		RVK_TARGET_AVX2 inline void Transpose(__m256& a, __m256& b, __m256& c, __m256& d) {
+			__m256 t0 = _mm256_unpacklo_ps(a, b);
+			__m256 t1 = _mm256_unpackhi_ps(a, b);
+			__m256 t2 = _mm256_unpacklo_ps(c, d);
+			__m256 t3 = _mm256_unpackhi_ps(c, d);
+			a = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+			b = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+			c = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+			d = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+		}
+#endif
+	}  // namespace
+
+	TransformBatch::Kernel TransformBatch::GetBestKernel() {
+		static const Kernel best = IsSupported(Kernel::AVX2) ? Kernel::AVX2 :
+			IsSupported(Kernel::SSE) ? Kernel::SSE : Kernel::Scalar;
+		return best;
+	}
+
+	bool TransformBatch::IsSupported(Kernel kernel) {
+		switch (kernel) {
+#if RVK_TRANSFORM_SSE
+		case Kernel::SSE:
+			return true;
+#endif
+#if RVK_TRANSFORM_AVX2
+		case Kernel::AVX2: {
+			static const bool hasAVX2 = CpuHasAVX2();
+			return hasAVX2;
+		}
+#endif
+		case Kernel::Scalar:
+			return true;
+		default:
+			return false;
+		}
+	}
+
+	const char* TransformBatch::GetKernelName(Kernel kernel) {
+		switch (kernel) {
+		case Kernel::SSE:
+			return "sse";
+		case Kernel::AVX2:
+			return "avx2";
+		default:
+			return "scalar";
+		}
+	}
+
+	void TransformBatch::Clear() {
+		m_levels.assign(1, 0);
+		m_fixedWorld.clear();
+		m_fixedNormal.clear();
+		m_count = 0;
+	}
+
+	void TransformBatch::Reserve(u32 capacity) {
+		if (capacity <= m_parents.size()) {
+			return;
+		}
+		for (auto* values : { &m_positionX, &m_positionY, &m_positionZ, &m_rotationX, &m_rotationY, &m_rotationZ,
+			&m_rotationW, &m_scaleX, &m_scaleY, &m_scaleZ }) {
+			values->resize(capacity);
+		}
+		m_parents.resize(capacity);
+		m_local.resize(capacity);
+		m_world.resize(capacity);
+		m_normal.resize(capacity);
+	}
+
+	u32 TransformBatch::AddFixed(const glm::mat4& world, const glm::mat4& normal) {
+		m_fixedWorld.push_back(world);
+		m_fixedNormal.push_back(normal);
+		return static_cast<u32>(m_fixedWorld.size() - 1) | FIXED_BIT;
+	}
+
+	u32 TransformBatch::Add(const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale, u32 parent) {
+		VK_CORE_ASSERT(parent == NO_PARENT || (parent & FIXED_BIT) || parent < m_levels.back(),
+			"a parent has to be in an earlier level");
+		// one check for all the arrays instead of one per push_back
+		if (m_count == m_parents.size()) {
+			Reserve(std::max(64u, m_count * 2));
+		}
+		u32 index = m_count++;
+		m_positionX[index] = position.x;
+		m_positionY[index] = position.y;
+		m_positionZ[index] = position.z;
+		m_rotationX[index] = rotation.x;
+		m_rotationY[index] = rotation.y;
+		m_rotationZ[index] = rotation.z;
+		m_rotationW[index] = rotation.w;
+		m_scaleX[index] = scale.x;
+		m_scaleY[index] = scale.y;
+		m_scaleZ[index] = scale.z;
+		m_parents[index] = parent;
+		return index;
+	}
+
+	void TransformBatch::NextLevel() {
+		if (m_levels.back() != m_count) {
+			m_levels.push_back(m_count);
+		}
+	}
+
+	void TransformBatch::Update(Kernel kernel, bool parallel) {
+		if (!IsSupported(kernel)) {
+			kernel = Kernel::Scalar;
+		}
+		NextLevel();
+
+		// a level only reads the ones before it, so its chunks can go in any order
+		for (size_t level = 0; level + 1 < m_levels.size(); level++) {
+			u32 begin = m_levels[level];
+			u32 end = m_levels[level + 1];
+			if (!parallel || end - begin < PARALLEL_MIN) {
+				UpdateRange(kernel, begin, end);
+				continue;
+			}
+			u32 chunkCount = (end - begin + CHUNK_SIZE - 1) / CHUNK_SIZE;
+			ParallelFor(chunkCount, [&](u32 chunk) {
+				u32 first = begin + chunk * CHUNK_SIZE;
+				UpdateRange(kernel, first, std::min(first + CHUNK_SIZE, end));
+			});
+		}
+	}
+
+	void TransformBatch::UpdateRange(Kernel kernel, u32 begin, u32 end) {
+		switch (kernel) {
+		case Kernel::AVX2:
+			UpdateAVX2(begin, end);
+			break;
+		case Kernel::SSE:
+			UpdateSSE(begin, end);
+			break;
+		default:
+			UpdateScalar(begin, end);
+			break;
+		}
+	}
+
+	const glm::mat4& TransformBatch::GetParentWorld(u32 parent) const {
+		if (parent == NO_PARENT) {
+			return IDENTITY;
+		}
+		return (parent & FIXED_BIT) ? m_fixedWorld[parent & ~FIXED_BIT] : m_world[parent];
+	}
+
+	const glm::mat4& TransformBatch::GetParentNormal(u32 parent) const {
+		if (parent == NO_PARENT) {
+			return IDENTITY;
+		}
+		return (parent & FIXED_BIT) ? m_fixedNormal[parent & ~FIXED_BIT] : m_normal[parent];
+	}
+
+	void TransformBatch::UpdateScalar(u32 begin, u32 end) {
+		for (u32 i = begin; i < end; i++) {
+			glm::mat3 rotation = glm::mat3_cast(glm::quat(m_rotationW[i], m_rotationX[i], m_rotationY[i], m_rotationZ[i]));
+			glm::mat4& local = m_local[i];
+			local = glm::mat4(rotation);
+			local[0] *= m_scaleX[i];
+			local[1] *= m_scaleY[i];
+			local[2] *= m_scaleZ[i];
+			local[3] = glm::vec4(m_positionX[i], m_positionY[i], m_positionZ[i], 1.0f);
+			glm::mat3 normal{ rotation[0] / m_scaleX[i], rotation[1] / m_scaleY[i], rotation[2] / m_scaleZ[i] };
+
+			m_world[i] = GetParentWorld(m_parents[i]) * local;
+			m_normal[i] = glm::mat4(glm::mat3(GetParentNormal(m_parents[i])) * normal);
+		}
+	}
+
+	void TransformBatch::UpdateSSE(u32 begin, u32 end) {
+		u32 i = begin;
+#if RVK_TRANSFORM_SSE
+		const __m128 zero = _mm_setzero_ps();
+		const __m128 one = _mm_set1_ps(1.0f);
+		const __m128 two = _mm_set1_ps(2.0f);
+		const __m128 normalW = _mm_set_ps(1.0f, 0.0f, 0.0f, 0.0f);
+		for (; i + 4 <= end; i += 4) {
+			__m128 x = _mm_loadu_ps(&m_rotationX[i]);
+			__m128 y = _mm_loadu_ps(&m_rotationY[i]);
+			__m128 z = _mm_loadu_ps(&m_rotationZ[i]);
+			__m128 w = _mm_loadu_ps(&m_rotationW[i]);
+			__m128 xx = _mm_mul_ps(x, x), yy = _mm_mul_ps(y, y), zz = _mm_mul_ps(z, z);
+			__m128 xy = _mm_mul_ps(x, y), xz = _mm_mul_ps(x, z), yz = _mm_mul_ps(y, z);
+			__m128 wx = _mm_mul_ps(w, x), wy = _mm_mul_ps(w, y), wz = _mm_mul_ps(w, z);
+
+			// columns of glm::mat3_cast
+			__m128 rotation[3][3];
+			rotation[0][0] = _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(yy, zz)));
+			rotation[0][1] = _mm_mul_ps(two, _mm_add_ps(xy, wz));
+			rotation[0][2] = _mm_mul_ps(two, _mm_sub_ps(xz, wy));
+			rotation[1][0] = _mm_mul_ps(two, _mm_sub_ps(xy, wz));
+			rotation[1][1] = _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, zz)));
+			rotation[1][2] = _mm_mul_ps(two, _mm_add_ps(yz, wx));
+			rotation[2][0] = _mm_mul_ps(two, _mm_add_ps(xz, wy));
+			rotation[2][1] = _mm_mul_ps(two, _mm_sub_ps(yz, wx));
+			rotation[2][2] = _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, yy)));
+
+			const __m128 scale[3] = { _mm_loadu_ps(&m_scaleX[i]), _mm_loadu_ps(&m_scaleY[i]), _mm_loadu_ps(&m_scaleZ[i]) };
+			__m128 local[4][4], normal[3][4];
+			for (u32 column = 0; column < 3; column++) {
+				__m128 inverseScale = _mm_div_ps(one, scale[column]);
+				for (u32 row = 0; row < 3; row++) {
+					local[column][row] = _mm_mul_ps(rotation[column][row], scale[column]);
+					normal[column][row] = _mm_mul_ps(rotation[column][row], inverseScale);
+				}
+				local[column][3] = zero;
+				normal[column][3] = zero;
+			}
+			local[3][0] = _mm_loadu_ps(&m_positionX[i]);
+			local[3][1] = _mm_loadu_ps(&m_positionY[i]);
+			local[3][2] = _mm_loadu_ps(&m_positionZ[i]);
+			local[3][3] = one;
+
+			// back to one column per register, the parents are applied entry by entry
+			for (u32 column = 0; column < 4; column++) {
+				Transpose(local[column][0], local[column][1], local[column][2], local[column][3]);
+				if (column < 3) {
+					Transpose(normal[column][0], normal[column][1], normal[column][2], normal[column][3]);
+				}
+			}
+			for (u32 lane = 0; lane < 4; lane++) {
+				const __m128 localColumns[4] = { local[0][lane], local[1][lane], local[2][lane], local[3][lane] };
+				const __m128 normalColumns[4] = { normal[0][lane], normal[1][lane], normal[2][lane], normalW };
+				u32 parent = m_parents[i + lane];
+				bool root = parent == NO_PARENT;
+				Finish(root ? nullptr : &GetParentWorld(parent), root ? nullptr : &GetParentNormal(parent),
+					localColumns, normalColumns, m_local[i + lane], m_world[i + lane], m_normal[i + lane]);
+			}
+		}
+#endif
+		UpdateScalar(i, end);
+	}
+
+	RVK_TARGET_AVX2 void TransformBatch::UpdateAVX2(u32 begin, u32 end) {
+		u32 i = begin;
+#if RVK_TRANSFORM_AVX2
+		const __m256 zero = _mm256_setzero_ps();
+		const __m256 one = _mm256_set1_ps(1.0f);
+		const __m256 two = _mm256_set1_ps(2.0f);
+		const __m128 normalW = _mm_set_ps(1.0f, 0.0f, 0.0f, 0.0f);
+		for (; i + 8 <= end; i += 8) {
+			__m256 x = _mm256_loadu_ps(&m_rotationX[i]);
+			__m256 y = _mm256_loadu_ps(&m_rotationY[i]);
+			__m256 z = _mm256_loadu_ps(&m_rotationZ[i]);
+			__m256 w = _mm256_loadu_ps(&m_rotationW[i]);
+			__m256 xx = _mm256_mul_ps(x, x), yy = _mm256_mul_ps(y, y), zz = _mm256_mul_ps(z, z);
+			__m256 xy = _mm256_mul_ps(x, y), xz = _mm256_mul_ps(x, z), yz = _mm256_mul_ps(y, z);
+			__m256 wx = _mm256_mul_ps(w, x), wy = _mm256_mul_ps(w, y), wz = _mm256_mul_ps(w, z);
+
+			__m256 rotation[3][3];
+			rotation[0][0] = _mm256_sub_ps(one, _mm256_mul_ps(two, _mm256_add_ps(yy, zz)));
+			rotation[0][1] = _mm256_mul_ps(two, _mm256_add_ps(xy, wz));
+			rotation[0][2] = _mm256_mul_ps(two, _mm256_sub_ps(xz, wy));
+			rotation[1][0] = _mm256_mul_ps(two, _mm256_sub_ps(xy, wz));
+			rotation[1][1] = _mm256_sub_ps(one, _mm256_mul_ps(two, _mm256_add_ps(xx, zz)));
+			rotation[1][2] = _mm256_mul_ps(two, _mm256_add_ps(yz, wx));
+			rotation[2][0] = _mm256_mul_ps(two, _mm256_add_ps(xz, wy));
+			rotation[2][1] = _mm256_mul_ps(two, _mm256_sub_ps(yz, wx));
+			rotation[2][2] = _mm256_sub_ps(one, _mm256_mul_ps(two, _mm256_add_ps(xx, yy)));
+
+			const __m256 scale[3] = { _mm256_loadu_ps(&m_scaleX[i]), _mm256_loadu_ps(&m_scaleY[i]), _mm256_loadu_ps(&m_scaleZ[i]) };
+			__m256 local[4][4], normal[3][4];
+			for (u32 column = 0; column < 3; column++) {
+				__m256 inverseScale = _mm256_div_ps(one, scale[column]);
+				for (u32 row = 0; row < 3; row++) {
+					local[column][row] = _mm256_mul_ps(rotation[column][row], scale[column]);
+					normal[column][row] = _mm256_mul_ps(rotation[column][row], inverseScale);
+				}
+				local[column][3] = zero;
+				normal[column][3] = zero;
+			}
+			local[3][0] = _mm256_loadu_ps(&m_positionX[i]);
+			local[3][1] = _mm256_loadu_ps(&m_positionY[i]);
+			local[3][2] = _mm256_loadu_ps(&m_positionZ[i]);
+			local[3][3] = one;
+
+			for (u32 column = 0; column < 4; column++) {
+				Transpose(local[column][0], local[column][1], local[column][2], local[column][3]);
+				if (column < 3) {
+					Transpose(normal[column][0], normal[column][1], normal[column][2], normal[column][3]);
+				}
+			}
+			for (u32 lane = 0; lane < 8; lane++) {
+				// entry lane sits in the low half of register lane, entry lane + 4 in the high half
+				u32 index = lane & 3;
+				__m128 localColumns[4], normalColumns[4];
+				for (u32 column = 0; column < 4; column++) {
+					localColumns[column] = lane < 4 ? _mm256_castps256_ps128(local[column][index]) : _mm256_extractf128_ps(local[column][index], 1);
+					if (column < 3) {
+						normalColumns[column] = lane < 4 ? _mm256_castps256_ps128(normal[column][index]) : _mm256_extractf128_ps(normal[column][index], 1);
+					}
+				}
+				normalColumns[3] = normalW;
+				u32 parent = m_parents[i + lane];
+				bool root = parent == NO_PARENT;
+				Finish(root ? nullptr : &GetParentWorld(parent), root ? nullptr : &GetParentNormal(parent),
+					localColumns, normalColumns, m_local[i + lane], m_world[i + lane], m_normal[i + lane]);
+			}
+		}
+#endif
+		UpdateScalar(i, end);
+	}
+}  // namespace RVK
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "Framework/Utils.h"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+namespace RVK {
+	// Structure of arrays copy of a transform hierarchy, world and normal matrices are built four or eight
+	// entries at a time. Entries go in level by level, parents before the level their children are in.
+	class TransformBatch {
+	public:
+		static constexpr u32 NO_PARENT = ~0u;
+		// entries of the same level are split into chunks of this size between the threads
+		static constexpr u32 CHUNK_SIZE = 512;
+		// levels smaller than this aren't worth starting threads for
+		static constexpr u32 PARALLEL_MIN = 4096;
+
+		enum class Kernel {
+			Scalar,
+			SSE,
+			AVX2,
+		};
+		// the widest kernel this build and this CPU can run, checked once
+		static Kernel GetBestKernel();
+		static bool IsSupported(Kernel kernel);
+		static const char* GetKernelName(Kernel kernel);
+
+		// entries are kept between Clear calls, so a batch refilled every frame doesn't allocate
+		void Clear();
+		void Reserve(u32 capacity);
+		// a parent that isn't part of the batch, e.g. one that didn't change this frame
+		u32 AddFixed(const glm::mat4& world, const glm::mat4& normal);
+		// parent is NO_PARENT, something from AddFixed or an entry of an earlier level, returns the entry's index
+		u32 Add(const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale, u32 parent);
+		// entries added after this can use the ones before as parents
+		void NextLevel();
+
+		void Update(Kernel kernel = GetBestKernel(), bool parallel = true);
+
+		u32 GetCount() const { return m_count; }
+		// translation * rotation * scale
+		const glm::mat4& GetLocalMatrix(u32 index) const { return m_local[index]; }
+		// parent world * local
+		const glm::mat4& GetWorldMatrix(u32 index) const { return m_world[index]; }
+		// inverse transpose of the world matrix, parent normal * rotation / scale, so no inverse is needed
+		const glm::mat4& GetNormalMatrix(u32 index) const { return m_normal[index]; }
+
+	private:
+		void UpdateRange(Kernel kernel, u32 begin, u32 end);
+		void UpdateScalar(u32 begin, u32 end);
+		void UpdateSSE(u32 begin, u32 end);
+		void UpdateAVX2(u32 begin, u32 end);
+		const glm::mat4& GetParentWorld(u32 parent) const;
+		const glm::mat4& GetParentNormal(u32 parent) const;
+
+		static constexpr u32 FIXED_BIT = 0x80000000u;
+
+		std::vector<float> m_positionX, m_positionY, m_positionZ;
+		std::vector<float> m_rotationX, m_rotationY, m_rotationZ, m_rotationW;
+		std::vector<float> m_scaleX, m_scaleY, m_scaleZ;
+		std::vector<u32> m_parents;
+		// first entry of every level, plus the end
+		std::vector<u32> m_levels{ 0 };
+
+		std::vector<glm::mat4> m_local, m_world, m_normal;
+		std::vector<glm::mat4> m_fixedWorld, m_fixedNormal;
+		u32 m_count = 0;
+	};
+}  // namespace RVK
@@ -0,0 +1,40 @@
+#include "Framework/Vulkan/DynamicResolution.h"
+
+namespace RVK {
+	namespace {
+		constexpr float GPU_TIME_SMOOTHING = 0.1f;
+		// scale up only with this much headroom, so the scale doesn't bounce around the target
+		constexpr float SCALE_UP_THRESHOLD = 0.85f;
+		// frames to wait after a change, the timings lag behind by the frames in flight
+		constexpr u32 ADJUST_COOLDOWN = MAX_FRAMES_IN_FLIGHT + 4;
+	}
+
+	void DynamicResolution::Update(float gpuTime) {
+		if (gpuTime <= 0.0f) {
+			return;
+		}
+
+		m_filteredGpuTime = m_filteredGpuTime == 0.0f ?
+			gpuTime : glm::mix(m_filteredGpuTime, gpuTime, GPU_TIME_SMOOTHING);
+
+		if (m_cooldown > 0) {
+			m_cooldown--;
+			return;
+		}
+
+		float ratio = m_settings.targetGpuTime / m_filteredGpuTime;
+		if (ratio >= 1.0f && m_filteredGpuTime > m_settings.targetGpuTime * SCALE_UP_THRESHOLD) {
+			return;
+		}
+
+		float scale = m_scale * glm::sqrt(ratio);
+		scale = glm::clamp(scale, m_scale - m_settings.maxStep, m_scale + m_settings.maxStep);
+		scale = glm::clamp(scale, m_settings.minScale, m_settings.maxScale);
+		if (glm::abs(scale - m_scale) < 0.01f) {
+			return;
+		}
+
+		m_scale = scale;
+		m_cooldown = ADJUST_COOLDOWN;
+	}
+}  // namespace RVK
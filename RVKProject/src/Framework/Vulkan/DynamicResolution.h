@@ -0,0 +1,33 @@
+#pragma once
+
+#include "Framework/Vulkan/VKUtils.h"
+
+namespace RVK {
+	// Picks the render scale from the measured GPU frame time.
+	// The pixel cost is taken to grow with the square of the scale, timings arrive a few frames late
+	// so the scale only moves again once the last change had time to show up.
+	class DynamicResolution {
+	public:
+		struct Settings {
+			// milliseconds, leave some room below the refresh interval
+			float targetGpuTime = 14.0f;
+			float minScale = 0.5f;
+			float maxScale = 1.0f;
+			// largest change per adjustment
+			float maxStep = 0.05f;
+		};
+
+		DynamicResolution() = default;
+		DynamicResolution(const Settings& settings) : m_settings{ settings }, m_scale{ settings.maxScale } {}
+
+		void Update(float gpuTime);
+		float GetScale() const { return m_scale; }
+		float GetFilteredGpuTime() const { return m_filteredGpuTime; }
+
+	private:
+		Settings m_settings{};
+		float m_scale = 1.0f;
+		float m_filteredGpuTime = 0.0f;
+		u32 m_cooldown = 0;
+	};
+}  // namespace RVK
@@ -31,38 +31,56 @@ namespace RVK {
 		roughnessMap = textures[Material::ROUGHNESS_MAP_INDEX] ? textures[Material::ROUGHNESS_MAP_INDEX] : dummy;
 		metallicMap = textures[Material::METALLIC_MAP_INDEX] ? textures[Material::METALLIC_MAP_INDEX] : dummy;
 
-		{
-			RVKDescriptorSetLayout::Builder builder{};
-			builder.AddBinding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_SHADER_STAGE_FRAGMENT_BIT);
-			builder.AddBinding(1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT);
-			//.AddBinding(1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT)
-			//.AddBinding(2, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT)
-			//.AddBinding(3, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT)
-			//.AddBinding(4, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT)
-			//.AddBinding(5, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT);
-			std::unique_ptr<RVKDescriptorSetLayout> localDescriptorSetLayout = builder.Build();
+		m_diffuseMap = diffuseMap;
+		m_bufferInfo = material.m_materialBuffer->DescriptorInfo();
+		Write();
+	}
+
+	void MaterialDescriptor::Write() {
+		RVKDescriptorSetLayout::Builder builder{};
+		builder.AddBinding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_SHADER_STAGE_FRAGMENT_BIT);
+		builder.AddBinding(1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT);
+		//.AddBinding(1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT)
+		//.AddBinding(2, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT)
+		//.AddBinding(3, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT)
+		//.AddBinding(4, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT)
+		//.AddBinding(5, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT);
+		std::unique_ptr<RVKDescriptorSetLayout> localDescriptorSetLayout = builder.Build();
 
-			auto bufferInfo = material.m_materialBuffer->DescriptorInfo();
-			auto& imageInfo0 = static_cast<Texture*>(diffuseMap.get())->GetDescriptorImageInfo();
-			//auto& imageInfo1 = static_cast<Texture*>(normalMap.get())->GetDescriptorImageInfo();
-			//auto& imageInfo2 = static_cast<Texture*>(roughnessMetallicMap.get())->GetDescriptorImageInfo();
-			//auto& imageInfo3 = static_cast<Texture*>(emissiveMap.get())->GetDescriptorImageInfo();
-			//auto& imageInfo4 = static_cast<Texture*>(roughnessMap.get())->GetDescriptorImageInfo();
-			//auto& imageInfo5 = static_cast<Texture*>(metallicMap.get())->GetDescriptorImageInfo();
+		auto& imageInfo0 = m_diffuseMap->GetDescriptorImageInfo();
+		//auto& imageInfo1 = static_cast<Texture*>(normalMap.get())->GetDescriptorImageInfo();
+		//auto& imageInfo2 = static_cast<Texture*>(roughnessMetallicMap.get())->GetDescriptorImageInfo();
+		//auto& imageInfo3 = static_cast<Texture*>(emissiveMap.get())->GetDescriptorImageInfo();
+		//auto& imageInfo4 = static_cast<Texture*>(roughnessMap.get())->GetDescriptorImageInfo();
+		//auto& imageInfo5 = static_cast<Texture*>(metallicMap.get())->GetDescriptorImageInfo();
 
-			RVKDescriptorWriter descriptorWriter(*localDescriptorSetLayout, *GetApp().globalPool);
-			descriptorWriter.WriteBuffer(0, &bufferInfo);
-			descriptorWriter.WriteImage(1, &imageInfo0);
-			//.WriteImage(1, &imageInfo1)
-			//.WriteImage(2, &imageInfo2)
-			//.WriteImage(3, &imageInfo3)
-			//.WriteImage(4, &imageInfo4)
-			//.WriteImage(5, &imageInfo5);
-			descriptorWriter.Build(m_descriptorSet);
+		RVKDescriptorWriter descriptorWriter(*localDescriptorSetLayout, *GetApp().globalPool);
+		descriptorWriter.WriteBuffer(0, &m_bufferInfo);
+		descriptorWriter.WriteImage(1, &imageInfo0);
+		//.WriteImage(1, &imageInfo1)
+		//.WriteImage(2, &imageInfo2)
+		//.WriteImage(3, &imageInfo3)
+		//.WriteImage(4, &imageInfo4)
+		//.WriteImage(5, &imageInfo5);
+		descriptorWriter.Build(m_descriptorSet);
+		m_diffuseVersion = m_diffuseMap->GetVersion();
+	}
+
+	void MaterialDescriptor::Refresh() {
+		if (m_diffuseMap->GetVersion() == m_diffuseVersion) {
+			return;
 		}
+
+		// frames in flight still read the old set, it goes back to the pool once they are done
+		std::vector<VkDescriptorSet> oldSets{ m_descriptorSet };
+		GetApp().globalPool->FreeDescriptors(oldSets);
+		Write();
 	}
 
 	MaterialDescriptor::MaterialDescriptor(MaterialDescriptor const& other) {
 		m_descriptorSet = other.m_descriptorSet;
+		m_diffuseMap = other.m_diffuseMap;
+		m_bufferInfo = other.m_bufferInfo;
+		m_diffuseVersion = other.m_diffuseVersion;
 	}
 }// namespace RVK
\ No newline at end of file
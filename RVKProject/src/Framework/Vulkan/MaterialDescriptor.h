@@ -14,8 +14,16 @@ namespace RVK {
 
     public:
         const VkDescriptorSet& GetDescriptorSet() const { return m_descriptorSet; }
+        // writes a new set when a streamed texture moved to another image view, call before binding
+        void Refresh();
 
     private:
+        void Write();
+
         VkDescriptorSet m_descriptorSet;
+        std::shared_ptr<Texture> m_diffuseMap;
+        VkDescriptorBufferInfo m_bufferInfo{};
+        // Texture::GetVersion of the diffuse map the set was written with
+        u32 m_diffuseVersion = 0;
     };
 } // namespace RVK
@@ -35,8 +35,10 @@ namespace RVK {
 
 	RVKBuffer::~RVKBuffer() {
 		Unmap();
-		vkDestroyBuffer(RVKDevice::s_rvkDevice->GetDevice(), m_buffer, nullptr);
-		vkFreeMemory(RVKDevice::s_rvkDevice->GetDevice(), m_memory, nullptr);
+		RVKDevice::s_rvkDevice->DeferDestroy([buffer = m_buffer, memory = m_memory]() {
+			vkDestroyBuffer(RVKDevice::s_rvkDevice->GetDevice(), buffer, nullptr);
+			vkFreeMemory(RVKDevice::s_rvkDevice->GetDevice(), memory, nullptr);
+		});
 	}
 
 	/**
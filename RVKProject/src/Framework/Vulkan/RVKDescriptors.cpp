@@ -82,7 +82,10 @@ namespace RVK {
 	}
 
 	RVKDescriptorPool::~RVKDescriptorPool() {
-		vkDestroyDescriptorPool(RVKDevice::s_rvkDevice->GetDevice(), m_descriptorPool, nullptr);
+		// queued after any deferred FreeDescriptors on this pool
+		RVKDevice::s_rvkDevice->DeferDestroy([pool = m_descriptorPool]() {
+			vkDestroyDescriptorPool(RVKDevice::s_rvkDevice->GetDevice(), pool, nullptr);
+		});
 	}
 
 	bool RVKDescriptorPool::AllocateDescriptor(
@@ -103,11 +106,14 @@ namespace RVK {
 	}
 
 	void RVKDescriptorPool::FreeDescriptors(std::vector<VkDescriptorSet>& descriptors) const {
-		vkFreeDescriptorSets(
-			RVKDevice::s_rvkDevice->GetDevice(),
-			m_descriptorPool,
-			static_cast<u32>(descriptors.size()),
-			descriptors.data());
+		// the sets may still be bound in frames in flight
+		RVKDevice::s_rvkDevice->DeferDestroy([pool = m_descriptorPool, descriptors]() {
+			vkFreeDescriptorSets(
+				RVKDevice::s_rvkDevice->GetDevice(),
+				pool,
+				static_cast<u32>(descriptors.size()),
+				descriptors.data());
+		});
 	}
 
 	void RVKDescriptorPool::ResetPool() {
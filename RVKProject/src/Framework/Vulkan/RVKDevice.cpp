@@ -15,6 +15,9 @@ namespace RVK {
 	}
 
 	RVKDevice::~RVKDevice() {
+		RetireUploads(true);
+		FlushDeletionQueue();
+
 		vkDestroyCommandPool(m_device, m_commandPool, nullptr);
 		vkDestroyDevice(m_device, nullptr);
 
@@ -37,7 +40,8 @@ namespace RVK {
 		appInfo.applicationVersion = VK_MAKE_VERSION(1, 0, 0);
 		appInfo.pEngineName = "No Engine";
 		appInfo.engineVersion = VK_MAKE_VERSION(1, 0, 0);
-		appInfo.apiVersion = VK_API_VERSION_1_0;
+		// vkGetPhysicalDeviceFeatures2 and friends for the device extension checks
+		appInfo.apiVersion = VK_API_VERSION_1_1;
 
 		VkInstanceCreateInfo createInfo = {};
 		createInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
@@ -118,12 +122,33 @@ namespace RVK {
 		createInfo.pQueueCreateInfos = queueCreateInfos.data();
 
 		createInfo.pEnabledFeatures = &deviceFeatures;
-		createInfo.enabledExtensionCount = static_cast<u32>(DEVICE_EXTENSIONS.size());
-		createInfo.ppEnabledExtensionNames = DEVICE_EXTENSIONS.data();
+
+		std::vector<const char*> extensions = DEVICE_EXTENSIONS;
+		m_hostImageCopy = CheckHostImageCopySupport();
+#ifdef VK_EXT_host_image_copy
+		VkPhysicalDeviceHostImageCopyFeaturesEXT hostImageCopyFeatures{};
+		hostImageCopyFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_HOST_IMAGE_COPY_FEATURES_EXT;
+		hostImageCopyFeatures.hostImageCopy = VK_TRUE;
+		if (m_hostImageCopy) {
+			extensions.push_back(VK_EXT_HOST_IMAGE_COPY_EXTENSION_NAME);
+			extensions.push_back(VK_KHR_COPY_COMMANDS_2_EXTENSION_NAME);
+			extensions.push_back(VK_KHR_FORMAT_FEATURE_FLAGS_2_EXTENSION_NAME);
+			createInfo.pNext = &hostImageCopyFeatures;
+		}
+#endif
+		createInfo.enabledExtensionCount = static_cast<u32>(extensions.size());
+		createInfo.ppEnabledExtensionNames = extensions.data();
 
 		VkResult result = vkCreateDevice(m_physicalDevice, &createInfo, nullptr, &m_device);
 		VK_CHECK(result, "Failed to Create a Logical Device!")
 
+		if (m_hostImageCopy) {
+			m_copyMemoryToImage = vkGetDeviceProcAddr(m_device, "vkCopyMemoryToImageEXT");
+			m_transitionImageLayout = vkGetDeviceProcAddr(m_device, "vkTransitionImageLayoutEXT");
+			m_hostImageCopy = m_copyMemoryToImage && m_transitionImageLayout;
+		}
+		VK_CORE_INFO("Host image copy: {0}", m_hostImageCopy ? "supported" : "not supported");
+
 		vkGetDeviceQueue(m_device, indices.graphicsFamily, 0, &m_graphicsQueue);
 		vkGetDeviceQueue(m_device, indices.presentFamily, 0, &m_presentQueue);
 	}
@@ -369,6 +394,11 @@ namespace RVK {
 	}
 
 	VkCommandBuffer RVKDevice::BeginSingleTimeCommands() {
+		if (m_uploadCommandBuffer != VK_NULL_HANDLE) {
+			m_uploadRecorded = true;
+			return m_uploadCommandBuffer;
+		}
+
 		VkCommandBufferAllocateInfo allocInfo{};
 		allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
 		allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
@@ -387,6 +417,11 @@ namespace RVK {
 	}
 
 	void RVKDevice::EndSingleTimeCommands(VkCommandBuffer commandBuffer) {
+		// submitted with the rest of the batch
+		if (commandBuffer == m_uploadCommandBuffer) {
+			return;
+		}
+
 		vkEndCommandBuffer(commandBuffer);
 
 		VkSubmitInfo submitInfo{};
@@ -400,12 +435,12 @@ namespace RVK {
 		vkFreeCommandBuffers(m_device, m_commandPool, 1, &commandBuffer);
 	}
 
-	void RVKDevice::CopyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size) {
+	void RVKDevice::CopyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size, VkDeviceSize dstOffset) {
 		VkCommandBuffer commandBuffer = BeginSingleTimeCommands();
 
 		VkBufferCopy copyRegion{};
 		copyRegion.srcOffset = 0;  // Optional
-		copyRegion.dstOffset = 0;  // Optional
+		copyRegion.dstOffset = dstOffset;
 		copyRegion.size = size;
 		vkCmdCopyBuffer(commandBuffer, srcBuffer, dstBuffer, 1, &copyRegion);
 
@@ -462,4 +497,231 @@ namespace RVK {
 		result = vkBindImageMemory(m_device, image, imageMemory, 0);
 		VK_CHECK(result, "Failed to Bind Image Memory!");
 	}
+
+	bool RVKDevice::CheckHostImageCopySupport() {
+#ifdef VK_EXT_host_image_copy
+		if (m_properties.apiVersion < VK_API_VERSION_1_1) {
+			return false;
+		}
+
+		u32 extensionCount;
+		vkEnumerateDeviceExtensionProperties(m_physicalDevice, nullptr, &extensionCount, nullptr);
+		std::vector<VkExtensionProperties> availableExtensions(extensionCount);
+		vkEnumerateDeviceExtensionProperties(m_physicalDevice, nullptr, &extensionCount, availableExtensions.data());
+
+		std::set<std::string> requiredExtensions{ VK_EXT_HOST_IMAGE_COPY_EXTENSION_NAME,
+			VK_KHR_COPY_COMMANDS_2_EXTENSION_NAME, VK_KHR_FORMAT_FEATURE_FLAGS_2_EXTENSION_NAME };
+		for (const auto& extension : availableExtensions) {
+			requiredExtensions.erase(extension.extensionName);
+		}
+		if (!requiredExtensions.empty()) {
+			return false;
+		}
+
+		VkPhysicalDeviceHostImageCopyFeaturesEXT hostImageCopyFeatures{};
+		hostImageCopyFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_HOST_IMAGE_COPY_FEATURES_EXT;
+		VkPhysicalDeviceFeatures2 features{};
+		features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+		features.pNext = &hostImageCopyFeatures;
+		vkGetPhysicalDeviceFeatures2(m_physicalDevice, &features);
+		if (!hostImageCopyFeatures.hostImageCopy) {
+			return false;
+		}
+
+		// textures are copied into and left in the layout they are sampled in
+		VkPhysicalDeviceHostImageCopyPropertiesEXT hostImageCopyProperties{};
+		hostImageCopyProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_HOST_IMAGE_COPY_PROPERTIES_EXT;
+		VkPhysicalDeviceProperties2 properties{};
+		properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+		properties.pNext = &hostImageCopyProperties;
+		vkGetPhysicalDeviceProperties2(m_physicalDevice, &properties);
+		std::vector<VkImageLayout> layouts(hostImageCopyProperties.copyDstLayoutCount);
+		hostImageCopyProperties.pCopyDstLayouts = layouts.data();
+		vkGetPhysicalDeviceProperties2(m_physicalDevice, &properties);
+		return std::find(layouts.begin(), layouts.end(), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL) != layouts.end();
+#else
+		return false;
+#endif
+	}
+
+	VkImageUsageFlags RVKDevice::GetHostImageCopyUsage(VkFormat format, VkImageUsageFlags usage) {
+#ifdef VK_EXT_host_image_copy
+		if (!m_hostImageCopy || !m_hostImageCopyEnabled) {
+			return 0;
+		}
+
+		u64 key = (static_cast<u64>(format) << 32) | usage;
+		auto it = m_hostImageCopyFormats.find(key);
+		if (it == m_hostImageCopyFormats.end()) {
+			VkPhysicalDeviceImageFormatInfo2 formatInfo{};
+			formatInfo.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_IMAGE_FORMAT_INFO_2;
+			formatInfo.format = format;
+			formatInfo.type = VK_IMAGE_TYPE_2D;
+			formatInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+			formatInfo.usage = usage | VK_IMAGE_USAGE_HOST_TRANSFER_BIT_EXT;
+
+			// GPUs that would lay the image out worse for the host copies keep the staging path
+			VkHostImageCopyDevicePerformanceQueryEXT performance{};
+			performance.sType = VK_STRUCTURE_TYPE_HOST_IMAGE_COPY_DEVICE_PERFORMANCE_QUERY_EXT;
+			VkImageFormatProperties2 formatProperties{};
+			formatProperties.sType = VK_STRUCTURE_TYPE_IMAGE_FORMAT_PROPERTIES_2;
+			formatProperties.pNext = &performance;
+			VkResult result = vkGetPhysicalDeviceImageFormatProperties2(m_physicalDevice, &formatInfo, &formatProperties);
+			it = m_hostImageCopyFormats.emplace(key, result == VK_SUCCESS && performance.optimalDeviceAccess).first;
+		}
+		return it->second ? VK_IMAGE_USAGE_HOST_TRANSFER_BIT_EXT : 0;
+#else
+		return 0;
+#endif
+	}
+
+	void RVKDevice::CopyMemoryToImage(VkImage image, u32 levelCount, const u8* data, const std::vector<VkBufferImageCopy>& regions) {
+#ifdef VK_EXT_host_image_copy
+		VkHostImageLayoutTransitionInfoEXT transition{};
+		transition.sType = VK_STRUCTURE_TYPE_HOST_IMAGE_LAYOUT_TRANSITION_INFO_EXT;
+		transition.image = image;
+		transition.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		transition.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		transition.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, levelCount, 0, 1 };
+		VkResult result = reinterpret_cast<PFN_vkTransitionImageLayoutEXT>(m_transitionImageLayout)(m_device, 1, &transition);
+		VK_CHECK(result, "Failed to Transition Image Layout on the Host!");
+
+		std::vector<VkMemoryToImageCopyEXT> copies(regions.size());
+		for (size_t i = 0; i < regions.size(); i++) {
+			copies[i].sType = VK_STRUCTURE_TYPE_MEMORY_TO_IMAGE_COPY_EXT;
+			copies[i].pHostPointer = data + regions[i].bufferOffset;
+			copies[i].memoryRowLength = regions[i].bufferRowLength;
+			copies[i].memoryImageHeight = regions[i].bufferImageHeight;
+			copies[i].imageSubresource = regions[i].imageSubresource;
+			copies[i].imageOffset = regions[i].imageOffset;
+			copies[i].imageExtent = regions[i].imageExtent;
+		}
+
+		// no queue is involved, the image is complete when the call returns and later submits see it
+		VkCopyMemoryToImageInfoEXT copyInfo{};
+		copyInfo.sType = VK_STRUCTURE_TYPE_COPY_MEMORY_TO_IMAGE_INFO_EXT;
+		copyInfo.dstImage = image;
+		copyInfo.dstImageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		copyInfo.regionCount = static_cast<u32>(copies.size());
+		copyInfo.pRegions = copies.data();
+		result = reinterpret_cast<PFN_vkCopyMemoryToImageEXT>(m_copyMemoryToImage)(m_device, &copyInfo);
+		VK_CHECK(result, "Failed to Copy Memory to Image!");
+#else
+		VK_CORE_CRITICAL("Host image copy is not available");
+#endif
+	}
+
+	void RVKDevice::BeginUploadBatch() {
+		if (m_uploadCommandBuffer != VK_NULL_HANDLE) {
+			VK_CORE_WARN("Upload batch is already open");
+			return;
+		}
+
+		VkCommandBufferAllocateInfo allocInfo{};
+		allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+		allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+		allocInfo.commandPool = m_commandPool;
+		allocInfo.commandBufferCount = 1;
+		vkAllocateCommandBuffers(m_device, &allocInfo, &m_uploadCommandBuffer);
+
+		VkCommandBufferBeginInfo beginInfo{};
+		beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+		beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+		vkBeginCommandBuffer(m_uploadCommandBuffer, &beginInfo);
+		m_uploadRecorded = false;
+	}
+
+	u64 RVKDevice::EndUploadBatch() {
+		VkCommandBuffer commandBuffer = m_uploadCommandBuffer;
+		m_uploadCommandBuffer = VK_NULL_HANDLE;
+		if (commandBuffer == VK_NULL_HANDLE) {
+			return 0;
+		}
+
+		if (m_uploadRecorded) {
+			// the frames submitted after the batch read what it wrote
+			VkMemoryBarrier barrier{};
+			barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+			barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+			barrier.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT | VK_ACCESS_SHADER_READ_BIT;
+			vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+				0, 1, &barrier, 0, nullptr, 0, nullptr);
+		}
+		vkEndCommandBuffer(commandBuffer);
+		if (!m_uploadRecorded) {
+			vkFreeCommandBuffers(m_device, m_commandPool, 1, &commandBuffer);
+			return 0;
+		}
+
+		VkFenceCreateInfo fenceInfo{};
+		fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+		VkFence fence;
+		VkResult result = vkCreateFence(m_device, &fenceInfo, nullptr, &fence);
+		VK_CHECK(result, "Failed to Create Upload Fence!");
+
+		VkSubmitInfo submitInfo{};
+		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+		submitInfo.commandBufferCount = 1;
+		submitInfo.pCommandBuffers = &commandBuffer;
+		// the frames come later on the same queue, so the deletion queue keeps the staging buffers long enough
+		result = vkQueueSubmit(m_graphicsQueue, 1, &submitInfo, fence);
+		VK_CHECK(result, "Failed to Submit Upload Batch!");
+
+		m_pendingUploads.push_back({ ++m_uploadValue, commandBuffer, fence });
+		return m_uploadValue;
+	}
+
+	bool RVKDevice::IsUploadComplete(u64 upload) {
+		if (upload > m_completedUpload) {
+			RetireUploads(false);
+		}
+		return upload <= m_completedUpload;
+	}
+
+	void RVKDevice::RetireUploads(bool wait) {
+		while (!m_pendingUploads.empty()) {
+			PendingUpload& pending = m_pendingUploads.front();
+			if (wait) {
+				vkWaitForFences(m_device, 1, &pending.fence, VK_TRUE, UINT64_MAX);
+			}
+			else if (vkGetFenceStatus(m_device, pending.fence) != VK_SUCCESS) {
+				break;
+			}
+
+			vkDestroyFence(m_device, pending.fence, nullptr);
+			vkFreeCommandBuffers(m_device, m_commandPool, 1, &pending.commandBuffer);
+			m_completedUpload = pending.upload;
+			m_pendingUploads.pop_front();
+		}
+	}
+
+	void RVKDevice::DeferDestroy(std::function<void()>&& destroy) {
+		m_deletionQueue.push_back({ m_frameValue, std::move(destroy) });
+	}
+
+	void RVKDevice::ProcessDeletionQueue() {
+		// at most MAX_FRAMES_IN_FLIGHT - 1 frames before the next one can still be running
+		while (!m_deletionQueue.empty()) {
+			if (m_deletionQueue.front().frame + MAX_FRAMES_IN_FLIGHT > m_frameValue) {
+				break;
+			}
+			std::function<void()> destroy = std::move(m_deletionQueue.front().destroy);
+			m_deletionQueue.pop_front();
+			destroy();
+		}
+	}
+
+	void RVKDevice::FlushDeletionQueue() {
+		if (m_deletionQueue.empty()) {
+			return;
+		}
+
+		vkDeviceWaitIdle(m_device);
+		// destroying an object may release others, e.g. a texture held by a descriptor
+		while (!m_deletionQueue.empty()) {
+			std::function<void()> destroy = std::move(m_deletionQueue.front().destroy);
+			m_deletionQueue.pop_front();
+			destroy();
+		}
+	}
 }  // namespace RVK
\ No newline at end of file
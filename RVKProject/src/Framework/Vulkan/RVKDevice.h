@@ -53,23 +53,69 @@ namespace RVK {
 			VkDeviceMemory& bufferMemory);
 		VkCommandBuffer BeginSingleTimeCommands();
 		void EndSingleTimeCommands(VkCommandBuffer commandBuffer);
-		void CopyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size);
+		void CopyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size, VkDeviceSize dstOffset = 0);
 		void CopyBufferToImage(
 			VkBuffer buffer, VkImage image, u32 width, u32 height, u32 layerCount);
 
+		// Upload batches
+		// while a batch is open every single time command is recorded into one command buffer that is
+		// submitted without waiting, staging buffers released meanwhile go through the deletion queue
+		void BeginUploadBatch();
+		// returns the value to poll with IsUploadComplete, 0 if nothing was recorded
+		u64 EndUploadBatch();
+		bool IsUploadComplete(u64 upload);
+
 		void CreateImageWithInfo(
 			const VkImageCreateInfo& imageInfo,
 			VkMemoryPropertyFlags properties,
 			VkImage& image,
 			VkDeviceMemory& imageMemory);
 
+		// Host image copy
+		// with VK_EXT_host_image_copy pixels go from host memory straight into optimally tiled images, no staging
+		// buffer, command buffer or submit. Only used for formats the device reads as fast with the extra usage.
+		bool HasHostImageCopy() const { return m_hostImageCopy; }
+		void SetHostImageCopyEnabled(bool enabled) { m_hostImageCopyEnabled = enabled; }
+		// VK_IMAGE_USAGE_HOST_TRANSFER_BIT_EXT for images of the format and usage to upload with CopyMemoryToImage, 0 if they can't
+		VkImageUsageFlags GetHostImageCopyUsage(VkFormat format, VkImageUsageFlags usage);
+		// The image has to be new, the GPU must not be using it. Regions are relative to data, it ends up in
+		// VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, all levels up to levelCount are transitioned on the host.
+		void CopyMemoryToImage(VkImage image, u32 levelCount, const u8* data, const std::vector<VkBufferImageCopy>& regions);
+
+		// Deletion queue
+		// destroy runs once the GPU has finished every frame that was submitted or being recorded
+		// when the object got released, so nothing has to wait for the device to go idle
+		void DeferDestroy(std::function<void()>&& destroy);
+		// the renderer reports frame progress
+		void OnFrameSubmitted() { m_frameValue++; }
+		// call after waiting for the fence of the oldest frame in flight
+		void ProcessDeletionQueue();
+		// waits for the device and destroys everything that is queued
+		void FlushDeletionQueue();
+		u64 GetFrameValue() const { return m_frameValue; }
+
 	private:
+		struct DeferredDestroy {
+			u64 frame;
+			std::function<void()> destroy;
+		};
+
+		struct PendingUpload {
+			u64 upload;
+			VkCommandBuffer commandBuffer;
+			VkFence fence;
+		};
+
 		void CreateInstance();
 		void SetupDebugMessenger();
 		void CreateSurface();
 		void PickPhysicalDevice();
 		void CreateLogicalDevice();
 		void CreateCommandPool();
+		// the extension, what it depends on, the feature and shader read layout as a copy destination
+		bool CheckHostImageCopySupport();
+		// frees the command buffers and fences of finished uploads, in submission order
+		void RetireUploads(bool wait);
 
 		// helper functions
 		bool IsDeviceSuitable(VkPhysicalDevice device);
@@ -91,5 +137,22 @@ namespace RVK {
 		VkSurfaceKHR m_surface;
 		VkQueue m_graphicsQueue;
 		VkQueue m_presentQueue;
+
+		std::deque<DeferredDestroy> m_deletionQueue;
+		// number of submitted frames
+		u64 m_frameValue = 0;
+
+		VkCommandBuffer m_uploadCommandBuffer = VK_NULL_HANDLE;
+		bool m_uploadRecorded = false;
+		std::deque<PendingUpload> m_pendingUploads;
+		u64 m_uploadValue = 0;
+		u64 m_completedUpload = 0;
+
+		bool m_hostImageCopy = false;
+		bool m_hostImageCopyEnabled = true;
+		// per format and usage, whether the device accesses images with the host transfer usage optimally
+		std::unordered_map<u64, bool> m_hostImageCopyFormats;
+		PFN_vkVoidFunction m_copyMemoryToImage = nullptr;
+		PFN_vkVoidFunction m_transitionImageLayout = nullptr;
 	};
 }  // namespace RVK
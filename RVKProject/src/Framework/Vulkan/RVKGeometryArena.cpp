@@ -0,0 +1,225 @@
+#include "Framework/Vulkan/RVKGeometryArena.h"
+#include "Framework/Vulkan/RVKDevice.h"
+#include "Framework/MeshModel.h"
+
+namespace RVK {
+	std::shared_ptr<RVKGeometryArena> RVKGeometryArena::s_geometryArena;
+
+	namespace {
+		void Upload(VkBuffer destination, VkDeviceSize offset, const void* data, VkDeviceSize size) {
+			RVKBuffer stagingBuffer{
+				size,
+				1,
+				VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+				VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+			};
+
+			stagingBuffer.Map();
+			stagingBuffer.WriteToBuffer(const_cast<void*>(data));
+			RVKDevice::s_rvkDevice->CopyBuffer(stagingBuffer.GetBuffer(), destination, size, offset);
+		}
+	}  // namespace
+
+	RVKGeometryArena::RVKGeometryArena() {
+		m_vertexPools.resize(static_cast<size_t>(VertexFormat::Count));
+		for (auto& pool : m_vertexPools) {
+			pool.usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
+		}
+		m_vertexPools[static_cast<size_t>(VertexFormat::Full)].hasPositions = true;
+		m_indexPool.elementSize = sizeof(u32);
+		m_indexPool.usage = VK_BUFFER_USAGE_INDEX_BUFFER_BIT;
+	}
+
+	RVKGeometryArena::~RVKGeometryArena() {}
+
+	std::unique_ptr<RVKBuffer> RVKGeometryArena::CreateBuffer(u32 elementSize, u32 capacity, VkBufferUsageFlags usage) {
+		return std::make_unique<RVKBuffer>(
+			elementSize,
+			capacity,
+			usage | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+	}
+
+	void RVKGeometryArena::Grow(Pool& pool, u32 count) {
+		u32 initial = &pool == &m_indexPool ? INITIAL_INDEX_SLOTS : INITIAL_VERTICES;
+		u32 freeAtEnd = 0;
+		if (!pool.freeRanges.empty()) {
+			auto last = std::prev(pool.freeRanges.end());
+			if (last->first + last->second == pool.capacity) {
+				freeAtEnd = last->second;
+			}
+		}
+
+		u32 capacity = std::max(pool.capacity, initial);
+		while (capacity - pool.capacity + freeAtEnd < count) {
+			capacity *= 2;
+		}
+
+		// the trailing free range holds nothing worth keeping
+		u32 liveCount = pool.capacity - freeAtEnd;
+		auto copy = [&](std::unique_ptr<RVKBuffer>& buffer, u32 elementSize) {
+			auto grown = CreateBuffer(elementSize, capacity, pool.usage);
+			if (buffer && liveCount > 0) {
+				// uploads into the old buffer may sit in the same command buffer
+				VkCommandBuffer commandBuffer = RVKDevice::s_rvkDevice->BeginSingleTimeCommands();
+				VkMemoryBarrier barrier{};
+				barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+				barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+				barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+				vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+					0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+				VkBufferCopy region{};
+				region.size = static_cast<VkDeviceSize>(elementSize) * liveCount;
+				vkCmdCopyBuffer(commandBuffer, buffer->GetBuffer(), grown->GetBuffer(), 1, &region);
+
+				// later uploads into reused holes of the new buffer must land after the copy
+				barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+				barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+				vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+					0, 1, &barrier, 0, nullptr, 0, nullptr);
+				RVKDevice::s_rvkDevice->EndSingleTimeCommands(commandBuffer);
+			}
+			// frames in flight still read the old one, RVKBuffer goes through the deletion queue
+			buffer = std::move(grown);
+		};
+		copy(pool.buffer, pool.elementSize);
+		if (pool.hasPositions) {
+			copy(pool.positions, sizeof(glm::vec3));
+		}
+
+		FreeRange(pool, pool.capacity, capacity - pool.capacity);
+		pool.capacity = capacity;
+		VK_CORE_INFO("Geometry arena grew to {0} elements of {1} bytes", capacity, pool.elementSize);
+	}
+
+	u32 RVKGeometryArena::AllocateRange(Pool& pool, u32 count) {
+		// first fit, models come and go in whole blocks so fragmentation stays low
+		auto fit = std::find_if(pool.freeRanges.begin(), pool.freeRanges.end(),
+			[count](const auto& range) { return range.second >= count; });
+		if (fit == pool.freeRanges.end()) {
+			Grow(pool, count);
+			fit = std::prev(pool.freeRanges.end());
+		}
+
+		u32 offset = fit->first;
+		u32 remaining = fit->second - count;
+		pool.freeRanges.erase(fit);
+		if (remaining > 0) {
+			pool.freeRanges[offset + count] = remaining;
+		}
+		pool.used += count;
+		return offset;
+	}
+
+	void RVKGeometryArena::FreeRange(Pool& pool, u32 offset, u32 count) {
+		if (count == 0) {
+			return;
+		}
+
+		auto next = pool.freeRanges.lower_bound(offset);
+		if (next != pool.freeRanges.end() && offset + count == next->first) {
+			count += next->second;
+			next = pool.freeRanges.erase(next);
+		}
+		if (next != pool.freeRanges.begin()) {
+			auto previous = std::prev(next);
+			if (previous->first + previous->second == offset) {
+				previous->second += count;
+				return;
+			}
+		}
+		pool.freeRanges[offset] = count;
+	}
+
+	RVKGeometryArena::Allocation RVKGeometryArena::Allocate(VertexFormat vertexFormat, u32 vertexSize, const void* vertices,
+		const glm::vec3* positions, u32 vertexCount, const u32* indices, u32 indexCount) {
+		Allocation allocation{};
+		allocation.binding.vertexFormat = vertexFormat;
+		allocation.binding.indexType = VK_INDEX_TYPE_UINT32;
+
+		Pool& vertexPool = m_vertexPools[static_cast<size_t>(vertexFormat)];
+		if (vertexPool.elementSize == 0) {
+			vertexPool.elementSize = vertexSize;
+		}
+		VK_ASSERT(vertexPool.elementSize == vertexSize, "Vertex size does not match the arena");
+		VK_ASSERT(vertexPool.hasPositions == (positions != nullptr), "Positions go with the full vertex format only");
+
+		allocation.vertexCount = vertexCount;
+		allocation.baseVertex = AllocateRange(vertexPool, vertexCount);
+		VkDeviceSize vertexOffset = static_cast<VkDeviceSize>(allocation.baseVertex) * vertexSize;
+		Upload(vertexPool.buffer->GetBuffer(), vertexOffset, vertices, static_cast<VkDeviceSize>(vertexSize) * vertexCount);
+		if (positions) {
+			Upload(vertexPool.positions->GetBuffer(), static_cast<VkDeviceSize>(allocation.baseVertex) * sizeof(glm::vec3),
+				positions, sizeof(glm::vec3) * vertexCount);
+		}
+
+		if (indexCount == 0) {
+			return allocation;
+		}
+
+		// half the index memory and bandwidth for every submesh below 65536 vertices
+		bool shortIndices = std::all_of(indices, indices + indexCount, [](u32 index) { return index <= 0xFFFF; });
+		std::vector<u16> shortData;
+		const void* indexData = indices;
+		if (shortIndices) {
+			shortData.assign(indices, indices + indexCount);
+			indexData = shortData.data();
+			allocation.binding.indexType = VK_INDEX_TYPE_UINT16;
+		}
+
+		VkDeviceSize indexBytes = allocation.GetIndexSize() * indexCount;
+		allocation.indexCount = indexCount;
+		allocation.indexSlotCount = static_cast<u32>((indexBytes + sizeof(u32) - 1) / sizeof(u32));
+		allocation.indexSlot = AllocateRange(m_indexPool, allocation.indexSlotCount);
+		allocation.firstIndex = static_cast<u32>(allocation.indexSlot * sizeof(u32) / allocation.GetIndexSize());
+		Upload(m_indexPool.buffer->GetBuffer(), static_cast<VkDeviceSize>(allocation.indexSlot) * sizeof(u32), indexData, indexBytes);
+		return allocation;
+	}
+
+	void RVKGeometryArena::Free(const Allocation& allocation) {
+		Pool& vertexPool = m_vertexPools[static_cast<size_t>(allocation.binding.vertexFormat)];
+		FreeRange(vertexPool, allocation.baseVertex, allocation.vertexCount);
+		vertexPool.used -= allocation.vertexCount;
+		FreeRange(m_indexPool, allocation.indexSlot, allocation.indexSlotCount);
+		m_indexPool.used -= allocation.indexSlotCount;
+	}
+
+	void RVKGeometryArena::Bind(VkCommandBuffer commandBuffer, const Binding& binding) {
+		const Pool& vertexPool = m_vertexPools[static_cast<size_t>(binding.vertexFormat)];
+		VkBuffer buffers[] = { vertexPool.buffer->GetBuffer() };
+		VkDeviceSize offsets[] = { 0 };
+		vkCmdBindVertexBuffers(commandBuffer, 0, 1, buffers, offsets);
+
+		if (m_indexPool.buffer) {
+			vkCmdBindIndexBuffer(commandBuffer, m_indexPool.buffer->GetBuffer(), 0, binding.indexType);
+		}
+	}
+
+	void RVKGeometryArena::BindPositions(VkCommandBuffer commandBuffer, const Binding& binding) {
+		const Pool& vertexPool = m_vertexPools[static_cast<size_t>(binding.vertexFormat)];
+		VkBuffer buffers[] = { vertexPool.positions ? vertexPool.positions->GetBuffer() : vertexPool.buffer->GetBuffer() };
+		VkDeviceSize offsets[] = { 0 };
+		vkCmdBindVertexBuffers(commandBuffer, 0, 1, buffers, offsets);
+
+		if (m_indexPool.buffer) {
+			vkCmdBindIndexBuffer(commandBuffer, m_indexPool.buffer->GetBuffer(), 0, binding.indexType);
+		}
+	}
+
+	VkDeviceSize RVKGeometryArena::GetUsedBytes() const {
+		VkDeviceSize bytes = static_cast<VkDeviceSize>(m_indexPool.used) * m_indexPool.elementSize;
+		for (const auto& pool : m_vertexPools) {
+			bytes += static_cast<VkDeviceSize>(pool.used) * (pool.elementSize + (pool.positions ? sizeof(glm::vec3) : 0));
+		}
+		return bytes;
+	}
+
+	VkDeviceSize RVKGeometryArena::GetCapacityBytes() const {
+		VkDeviceSize bytes = static_cast<VkDeviceSize>(m_indexPool.capacity) * m_indexPool.elementSize;
+		for (const auto& pool : m_vertexPools) {
+			bytes += static_cast<VkDeviceSize>(pool.capacity) * (pool.elementSize + (pool.positions ? sizeof(glm::vec3) : 0));
+		}
+		return bytes;
+	}
+}  // namespace RVK
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "Framework/Vulkan/RVKBuffer.h"
+
+#include <map>
+
+namespace RVK {
+	enum class VertexFormat : u32;
+
+	// Scene wide vertex and index buffers that models are placed into, so a pass binds geometry once per
+	// vertex format and index type instead of once per model. One vertex buffer per VertexFormat, full
+	// vertices get a position buffer with the same layout next to it, all models share the index buffer.
+	// Allocate and Free on the main thread and not while a command buffer is recorded, the buffers grow.
+	class RVKGeometryArena {
+	public:
+		static std::shared_ptr<RVKGeometryArena> s_geometryArena;
+
+		// what has to be bound to draw an allocation
+		struct Binding {
+			VertexFormat vertexFormat;
+			VkIndexType indexType;
+
+			bool operator==(const Binding& other) const = default;
+		};
+
+		struct Allocation {
+			Binding binding;
+			// add to Mesh::firstVertex and Mesh::firstIndex, the index buffer is always bound at offset 0
+			u32 baseVertex = 0;
+			u32 vertexCount = 0;
+			u32 firstIndex = 0;
+			u32 indexCount = 0;
+			// in 4 byte slots of the index buffer
+			u32 indexSlot = 0;
+			u32 indexSlotCount = 0;
+
+			VkDeviceSize GetIndexSize() const { return binding.indexType == VK_INDEX_TYPE_UINT16 ? 2 : 4; }
+		};
+
+	public:
+		RVKGeometryArena();
+		~RVKGeometryArena();
+
+		NO_COPY(RVKGeometryArena)
+
+		// Uploads through RVKDevice::CopyBuffer, so it goes into the open upload batch if there is one.
+		// Indices are relative to the submesh and become 16 bit when all of them fit.
+		// positions only for the formats that have a separate position stream, nullptr otherwise.
+		Allocation Allocate(VertexFormat vertexFormat, u32 vertexSize, const void* vertices, const glm::vec3* positions,
+			u32 vertexCount, const u32* indices, u32 indexCount);
+		// the GPU may still read the range, call it through the deletion queue
+		void Free(const Allocation& allocation);
+
+		void Bind(VkCommandBuffer commandBuffer, const Binding& binding);
+		// depth prepass, compressed vertices have their position first and are read with the full stride
+		void BindPositions(VkCommandBuffer commandBuffer, const Binding& binding);
+
+		VkDeviceSize GetUsedBytes() const;
+		VkDeviceSize GetCapacityBytes() const;
+
+	private:
+		struct Pool {
+			std::unique_ptr<RVKBuffer> buffer;
+			// full vertices only
+			std::unique_ptr<RVKBuffer> positions;
+			bool hasPositions = false;
+			u32 elementSize = 0;
+			VkBufferUsageFlags usage = 0;
+			u32 capacity = 0;
+			u32 used = 0;
+			// offset to size in elements, neighbours are merged on free, used is kept by the callers
+			std::map<u32, u32> freeRanges;
+		};
+
+		static constexpr u32 INITIAL_VERTICES = 256 * 1024;
+		static constexpr u32 INITIAL_INDEX_SLOTS = 1024 * 1024;
+
+		u32 AllocateRange(Pool& pool, u32 count);
+		void FreeRange(Pool& pool, u32 offset, u32 count);
+		// doubles until count fits at the end, the old contents are copied over so offsets stay valid
+		void Grow(Pool& pool, u32 count);
+		std::unique_ptr<RVKBuffer> CreateBuffer(u32 elementSize, u32 capacity, VkBufferUsageFlags usage);
+
+		std::vector<Pool> m_vertexPools;
+		Pool m_indexPool;
+	};
+}  // namespace RVK
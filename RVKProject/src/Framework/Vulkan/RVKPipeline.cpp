@@ -11,9 +11,12 @@ namespace RVK {
 	}
 
 	RVKPipeline::~RVKPipeline() {
-		vkDestroyShaderModule(RVKDevice::s_rvkDevice->GetDevice(), m_vertShaderModule, nullptr);
-		vkDestroyShaderModule(RVKDevice::s_rvkDevice->GetDevice(), m_fragShaderModule, nullptr);
-		vkDestroyPipeline(RVKDevice::s_rvkDevice->GetDevice(), m_graphicsPipeline, nullptr);
+		RVKDevice::s_rvkDevice->DeferDestroy(
+			[vertShaderModule = m_vertShaderModule, fragShaderModule = m_fragShaderModule, pipeline = m_graphicsPipeline]() {
+				vkDestroyShaderModule(RVKDevice::s_rvkDevice->GetDevice(), vertShaderModule, nullptr);
+				vkDestroyShaderModule(RVKDevice::s_rvkDevice->GetDevice(), fragShaderModule, nullptr);
+				vkDestroyPipeline(RVKDevice::s_rvkDevice->GetDevice(), pipeline, nullptr);
+			});
 	}
 
 	void RVKPipeline::CreateGraphicsPipeline(
@@ -26,10 +29,22 @@ namespace RVK {
 			"Cannot Create a Graphics Pipeline: No RenderPass Provided in ConfigInfo!");
 
 		auto vertCode = ReadFile(vertFilepath);
-		auto fragCode = ReadFile(fragFilepath);
-
 		CreateShaderModule(vertCode, &m_vertShaderModule);
-		CreateShaderModule(fragCode, &m_fragShaderModule);
+
+		u32 stageCount = 1;
+		if (!fragFilepath.empty()) {
+			auto fragCode = ReadFile(fragFilepath);
+			CreateShaderModule(fragCode, &m_fragShaderModule);
+			stageCount = 2;
+		}
+
+		VkSpecializationInfo specializationInfo{};
+		specializationInfo.mapEntryCount = static_cast<u32>(configInfo.specializationEntries.size());
+		specializationInfo.pMapEntries = configInfo.specializationEntries.data();
+		specializationInfo.dataSize = configInfo.specializationData.size();
+		specializationInfo.pData = configInfo.specializationData.data();
+		const VkSpecializationInfo* pSpecializationInfo =
+			configInfo.specializationEntries.empty() ? nullptr : &specializationInfo;
 
 		VkPipelineShaderStageCreateInfo shaderStages[2];
 		shaderStages[0].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
@@ -38,14 +53,14 @@ namespace RVK {
 		shaderStages[0].pName = "main";
 		shaderStages[0].flags = 0;
 		shaderStages[0].pNext = nullptr;
-		shaderStages[0].pSpecializationInfo = nullptr;
+		shaderStages[0].pSpecializationInfo = pSpecializationInfo;
 		shaderStages[1].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
 		shaderStages[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
 		shaderStages[1].module = m_fragShaderModule;
 		shaderStages[1].pName = "main";
 		shaderStages[1].flags = 0;
 		shaderStages[1].pNext = nullptr;
-		shaderStages[1].pSpecializationInfo = nullptr;
+		shaderStages[1].pSpecializationInfo = pSpecializationInfo;
 
 		auto& bindingDescriptions = configInfo.bindingDescriptions;
 		auto& attributeDescriptions = configInfo.attributeDescriptions;
@@ -59,7 +74,7 @@ namespace RVK {
 
 		VkGraphicsPipelineCreateInfo pipelineInfo{};
 		pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
-		pipelineInfo.stageCount = 2;
+		pipelineInfo.stageCount = stageCount;
 		pipelineInfo.pStages = shaderStages;
 		pipelineInfo.pVertexInputState = &vertexInputInfo;
 		pipelineInfo.pInputAssemblyState = &configInfo.inputAssemblyInfo;
@@ -181,4 +196,27 @@ namespace RVK {
 		configInfo.colorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
 		configInfo.colorBlendAttachment.alphaBlendOp = VK_BLEND_OP_ADD;
 	}
+
+	void RVKPipeline::AddSpecializationConstant(PipelineConfigInfo& configInfo, u32 constantID, u32 value) {
+		VkSpecializationMapEntry entry{};
+		entry.constantID = constantID;
+		entry.offset = static_cast<u32>(configInfo.specializationData.size());
+		entry.size = sizeof(u32);
+		configInfo.specializationEntries.push_back(entry);
+
+		const u8* bytes = reinterpret_cast<const u8*>(&value);
+		configInfo.specializationData.insert(configInfo.specializationData.end(), bytes, bytes + sizeof(u32));
+	}
+
+	void RVKPipeline::SetVertexFormat(PipelineConfigInfo& configInfo, VertexFormat vertexFormat) {
+		if (vertexFormat == VertexFormat::Compressed) {
+			configInfo.bindingDescriptions = CompressedVertex::GetBindingDescriptions();
+			configInfo.attributeDescriptions = CompressedVertex::GetAttributeDescriptions();
+			AddSpecializationConstant(configInfo, COMPRESSED_VERTEX_CONSTANT_ID, VK_TRUE);
+		}
+		else {
+			configInfo.bindingDescriptions = Vertex::GetBindingDescriptions();
+			configInfo.attributeDescriptions = Vertex::GetAttributeDescriptions();
+		}
+	}
 }  // namespace RVK
@@ -3,6 +3,8 @@
 #include "Framework/Vulkan/VKUtils.h"
 
 namespace RVK {
+	enum class VertexFormat : u32;
+
 	struct PipelineConfigInfo {
 		PipelineConfigInfo() = default;
 
@@ -19,6 +21,9 @@ namespace RVK {
 		VkPipelineDepthStencilStateCreateInfo depthStencilInfo;
 		std::vector<VkDynamicState> dynamicStateEnables;
 		VkPipelineDynamicStateCreateInfo dynamicStateInfo;
+		// shared by all shader stages, ids a stage doesn't use are ignored
+		std::vector<VkSpecializationMapEntry> specializationEntries{};
+		std::vector<u8> specializationData{};
 		VkPipelineLayout pipelineLayout = nullptr;
 		VkRenderPass renderPass = nullptr;
 		u32 subpass = 0;
@@ -26,6 +31,7 @@ namespace RVK {
 
 	class RVKPipeline {
 	public:
+		// an empty fragFilepath creates a vertex only pipeline (depth only passes)
 		RVKPipeline(const std::string& vertFilepath, const std::string& fragFilepath, const PipelineConfigInfo& configInfo);
 		~RVKPipeline();
 
@@ -36,6 +42,9 @@ namespace RVK {
 
 		static void DefaultPipelineConfigInfo(PipelineConfigInfo& configInfo);
 		static void EnableAlphaBlending(PipelineConfigInfo& configInfo);
+		static void AddSpecializationConstant(PipelineConfigInfo& configInfo, u32 constantID, u32 value);
+		// vertex input of the MeshModel format, compressed vertices get decoded in the vertex shader
+		static void SetVertexFormat(PipelineConfigInfo& configInfo, VertexFormat vertexFormat);
 
 	private:
 		void CreateGraphicsPipeline(
@@ -47,6 +56,6 @@ namespace RVK {
 
 		VkPipeline m_graphicsPipeline;
 		VkShaderModule m_vertShaderModule;
-		VkShaderModule m_fragShaderModule;
+		VkShaderModule m_fragShaderModule = VK_NULL_HANDLE;
 	};
 }  // namespace RVK
@@ -0,0 +1,1095 @@
+#include "Framework/Vulkan/RVKRenderGraph.h"
+#include "Framework/Vulkan/RVKDevice.h"
+
+namespace RVK {
+	namespace {
+		constexpr VkAccessFlags WRITE_ACCESS_MASK =
+			VK_ACCESS_SHADER_WRITE_BIT |
+			VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT |
+			VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT |
+			VK_ACCESS_TRANSFER_WRITE_BIT |
+			VK_ACCESS_HOST_WRITE_BIT |
+			VK_ACCESS_MEMORY_WRITE_BIT;
+
+		bool IsDepthFormat(VkFormat format) {
+			return format == VK_FORMAT_D16_UNORM || format == VK_FORMAT_X8_D24_UNORM_PACK32 ||
+				format == VK_FORMAT_D32_SFLOAT || format == VK_FORMAT_D16_UNORM_S8_UINT ||
+				format == VK_FORMAT_D24_UNORM_S8_UINT || format == VK_FORMAT_D32_SFLOAT_S8_UINT;
+		}
+
+		bool HasStencilComponent(VkFormat format) {
+			return format == VK_FORMAT_D16_UNORM_S8_UINT || format == VK_FORMAT_D24_UNORM_S8_UINT ||
+				format == VK_FORMAT_D32_SFLOAT_S8_UINT;
+		}
+
+		VkImageAspectFlags AspectFromFormat(VkFormat format) {
+			if (!IsDepthFormat(format)) {
+				return VK_IMAGE_ASPECT_COLOR_BIT;
+			}
+			return HasStencilComponent(format) ?
+				VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT : VK_IMAGE_ASPECT_DEPTH_BIT;
+		}
+
+		bool Overlaps(u32 firstA, u32 lastA, u32 firstB, u32 lastB) {
+			return firstA <= lastB && firstB <= lastA;
+		}
+	}
+
+	////////////////////////////////////////////////////////////////////////
+	// PassBuilder
+	////////////////////////////////////////////////////////////////////////
+	void RVKRenderGraph::PassBuilder::WriteColor(RGResource image, VkAttachmentLoadOp loadOp, VkClearColorValue clearColor) {
+		ResourceUse use{};
+		use.resource = image;
+		use.type = UseType::ColorWrite;
+		use.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+		use.stages = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+		use.access = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+		use.write = true;
+		use.read = loadOp == VK_ATTACHMENT_LOAD_OP_LOAD;
+		if (use.read) {
+			use.access |= VK_ACCESS_COLOR_ATTACHMENT_READ_BIT;
+		}
+		m_graph.AddUse(m_pass, use);
+		m_graph.GetResource(image).usage |= VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+
+		Attachment attachment{};
+		attachment.resource = image;
+		attachment.loadOp = loadOp;
+		attachment.layout = use.layout;
+		attachment.clearValue.color = clearColor;
+		m_graph.m_passes[m_pass].colorAttachments.push_back(attachment);
+	}
+
+	void RVKRenderGraph::PassBuilder::WriteDepth(RGResource image, VkAttachmentLoadOp loadOp, float clearDepth) {
+		VK_CORE_ASSERT(m_graph.m_passes[m_pass].depthAttachment.empty(), "Render Graph Pass Already Has a Depth Attachment!");
+
+		ResourceUse use{};
+		use.resource = image;
+		use.type = UseType::DepthWrite;
+		use.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+		use.stages = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+		use.access = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+		use.write = true;
+		use.read = loadOp == VK_ATTACHMENT_LOAD_OP_LOAD;
+		m_graph.AddUse(m_pass, use);
+		m_graph.GetResource(image).usage |= VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+
+		Attachment attachment{};
+		attachment.resource = image;
+		attachment.loadOp = loadOp;
+		attachment.layout = use.layout;
+		attachment.clearValue.depthStencil = { clearDepth, 0 };
+		m_graph.m_passes[m_pass].depthAttachment.push_back(attachment);
+	}
+
+	void RVKRenderGraph::PassBuilder::ReadDepth(RGResource image) {
+		VK_CORE_ASSERT(m_graph.m_passes[m_pass].depthAttachment.empty(), "Render Graph Pass Already Has a Depth Attachment!");
+
+		ResourceUse use{};
+		use.resource = image;
+		use.type = UseType::DepthRead;
+		use.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+		use.stages = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+		use.access = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT;
+		use.read = true;
+		m_graph.AddUse(m_pass, use);
+		m_graph.GetResource(image).usage |= VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+
+		Attachment attachment{};
+		attachment.resource = image;
+		attachment.loadOp = VK_ATTACHMENT_LOAD_OP_LOAD;
+		attachment.layout = use.layout;
+		attachment.clearValue.depthStencil = { 1.0f, 0 };
+		m_graph.m_passes[m_pass].depthAttachment.push_back(attachment);
+	}
+
+	void RVKRenderGraph::PassBuilder::ReadTexture(RGResource image, VkPipelineStageFlags stages) {
+		ResourceUse use{};
+		use.resource = image;
+		use.type = UseType::Texture;
+		use.layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		use.stages = stages;
+		use.access = VK_ACCESS_SHADER_READ_BIT;
+		use.read = true;
+		m_graph.AddUse(m_pass, use);
+		m_graph.GetResource(image).usage |= VK_IMAGE_USAGE_SAMPLED_BIT;
+	}
+
+	void RVKRenderGraph::PassBuilder::ReadBuffer(RGResource buffer, VkPipelineStageFlags stages, VkAccessFlags access) {
+		ResourceUse use{};
+		use.resource = buffer;
+		use.type = UseType::Buffer;
+		use.stages = stages;
+		use.access = access;
+		use.read = true;
+		m_graph.AddUse(m_pass, use);
+	}
+
+	void RVKRenderGraph::PassBuilder::WriteBuffer(RGResource buffer, VkPipelineStageFlags stages, VkAccessFlags access) {
+		ResourceUse use{};
+		use.resource = buffer;
+		use.type = UseType::Buffer;
+		use.stages = stages;
+		use.access = access;
+		use.write = true;
+		m_graph.AddUse(m_pass, use);
+	}
+
+	void RVKRenderGraph::PassBuilder::SetSideEffect() {
+		m_graph.m_passes[m_pass].sideEffect = true;
+	}
+
+	////////////////////////////////////////////////////////////////////////
+	// RVKRenderGraph
+	////////////////////////////////////////////////////////////////////////
+	RVKRenderGraph::RVKRenderGraph(VkExtent2D extent) : m_extent{ extent } {
+		CreateQueryPool();
+	}
+
+	RVKRenderGraph::~RVKRenderGraph() {
+		DestroyFramebuffers();
+		DestroyTransientImages();
+
+		if (m_queryPool != VK_NULL_HANDLE) {
+			vkDestroyQueryPool(RVKDevice::s_rvkDevice->GetDevice(), m_queryPool, nullptr);
+		}
+
+		for (auto& entry : m_renderPassCache) {
+			vkDestroyRenderPass(RVKDevice::s_rvkDevice->GetDevice(), entry.renderPass, nullptr);
+		}
+		m_renderPassCache.clear();
+	}
+
+	RGResource RVKRenderGraph::CreateImage(const std::string& name, const ImageDesc& desc) {
+		Resource resource{};
+		resource.name = name;
+		resource.desc = desc;
+		resource.aspect = AspectFromFormat(desc.format);
+		resource.usage = desc.usage;
+
+		m_resources.push_back(resource);
+		m_isDirty = true;
+		return static_cast<RGResource>(m_resources.size() - 1);
+	}
+
+	RGResource RVKRenderGraph::ImportImage(
+		const std::string& name,
+		VkFormat format,
+		VkImageLayout initialLayout,
+		VkImageLayout finalLayout,
+		VkPipelineStageFlags initialStages,
+		VkPipelineStageFlags finalStages,
+		VkAccessFlags finalAccess) {
+		Resource resource{};
+		resource.name = name;
+		resource.imported = true;
+		resource.desc.format = format;
+		resource.aspect = AspectFromFormat(format);
+		resource.initialLayout = initialLayout;
+		resource.finalLayout = finalLayout;
+		resource.initialStages = initialStages;
+		resource.finalStages = finalStages;
+		resource.finalAccess = finalAccess;
+
+		m_importedResources.push_back(resource);
+		m_isDirty = true;
+		return static_cast<RGResource>(m_importedResources.size() - 1) | IMPORTED_BIT;
+	}
+
+	RGResource RVKRenderGraph::ImportBuffer(const std::string& name, VkBuffer buffer, VkDeviceSize size) {
+		Resource resource{};
+		resource.name = name;
+		resource.isImage = false;
+		resource.imported = true;
+		resource.buffer = buffer;
+		resource.size = size;
+
+		m_importedResources.push_back(resource);
+		m_isDirty = true;
+		return static_cast<RGResource>(m_importedResources.size() - 1) | IMPORTED_BIT;
+	}
+
+	void RVKRenderGraph::SetImportedImage(RGResource resource, VkImage image, VkImageView view, VkExtent2D extent) {
+		VK_CORE_ASSERT(resource & IMPORTED_BIT, "Only Imported Images Can Be Set From Outside the Render Graph!");
+		Resource& imported = GetResource(resource);
+		imported.image = image;
+		imported.view = view;
+		imported.extent = extent;
+	}
+
+	RGPass RVKRenderGraph::AddPass(const std::string& name, const SetupFn& setup, ExecuteFn execute) {
+		Pass pass{};
+		pass.name = name;
+		pass.execute = std::move(execute);
+		m_passes.push_back(std::move(pass));
+
+		RGPass handle = static_cast<RGPass>(m_passes.size() - 1);
+		PassBuilder builder{ *this, handle };
+		setup(builder);
+
+		m_isDirty = true;
+		return handle;
+	}
+
+	void RVKRenderGraph::ClearPasses() {
+		DestroyFramebuffers();
+		DestroyTransientImages();
+		m_passes.clear();
+		m_resources.clear();
+		m_executionOrder.clear();
+		m_finalBarriers = {};
+		m_isDirty = true;
+	}
+
+	void RVKRenderGraph::SetExtent(VkExtent2D extent) {
+		// framebuffers reference the old swap chain views, so they go even if the extent is the same
+		DestroyFramebuffers();
+		if (extent.width != m_extent.width || extent.height != m_extent.height) {
+			m_extent = extent;
+			m_isDirty = true;
+		}
+	}
+
+	RVKRenderGraph::Resource& RVKRenderGraph::GetResource(RGResource resource) {
+		if (resource & IMPORTED_BIT) {
+			return m_importedResources[resource & ~IMPORTED_BIT];
+		}
+		return m_resources[resource];
+	}
+
+	void RVKRenderGraph::AddUse(RGPass pass, const ResourceUse& use) {
+		m_passes[pass].uses.push_back(use);
+	}
+
+	void RVKRenderGraph::Compile() {
+		if (!m_isDirty) {
+			return;
+		}
+
+		DestroyFramebuffers();
+		DestroyTransientImages();
+
+		BuildDependencies();
+		CullPasses();
+		SortPasses();
+		ComputeLifetimes();
+		CreateTransientImages();
+		CreateRenderPasses();
+		PlanBarriers();
+
+		m_isDirty = false;
+	}
+
+	void RVKRenderGraph::BuildDependencies() {
+		struct Tracker {
+			RGPass lastWriter = INVALID_HANDLE;
+			std::vector<RGPass> readers;
+		};
+		std::unordered_map<RGResource, Tracker> trackers;
+
+		auto addUnique = [](std::vector<RGPass>& passes, RGPass pass) {
+			if (std::find(passes.begin(), passes.end(), pass) == passes.end()) {
+				passes.push_back(pass);
+			}
+		};
+
+		for (RGPass p = 0; p < m_passes.size(); p++) {
+			Pass& pass = m_passes[p];
+			pass.producers.clear();
+			pass.predecessors.clear();
+
+			for (const auto& use : pass.uses) {
+				Tracker& tracker = trackers[use.resource];
+
+				// read after write
+				if (use.read && tracker.lastWriter != INVALID_HANDLE && tracker.lastWriter != p) {
+					addUnique(pass.producers, tracker.lastWriter);
+					addUnique(pass.predecessors, tracker.lastWriter);
+				}
+
+				if (use.write) {
+					// write after write and write after read only constrain the order
+					if (tracker.lastWriter != INVALID_HANDLE && tracker.lastWriter != p) {
+						addUnique(pass.predecessors, tracker.lastWriter);
+					}
+					for (RGPass reader : tracker.readers) {
+						if (reader != p) {
+							addUnique(pass.predecessors, reader);
+						}
+					}
+					tracker.lastWriter = p;
+					tracker.readers.clear();
+				}
+				else {
+					addUnique(tracker.readers, p);
+				}
+			}
+		}
+	}
+
+	void RVKRenderGraph::CullPasses() {
+		std::vector<bool> needed(m_passes.size(), false);
+
+		for (RGPass p = 0; p < m_passes.size(); p++) {
+			Pass& pass = m_passes[p];
+			needed[p] = pass.sideEffect;
+			for (const auto& use : pass.uses) {
+				if (use.write && (use.resource & IMPORTED_BIT)) {
+					needed[p] = true;
+				}
+			}
+		}
+
+		// producers are always declared before their consumers
+		for (RGPass p = static_cast<RGPass>(m_passes.size()); p-- > 0;) {
+			if (!needed[p]) {
+				continue;
+			}
+			for (RGPass producer : m_passes[p].producers) {
+				needed[producer] = true;
+			}
+		}
+
+		for (RGPass p = 0; p < m_passes.size(); p++) {
+			m_passes[p].culled = !needed[p];
+		}
+	}
+
+	void RVKRenderGraph::SortPasses() {
+		// Kahn's algorithm, independent passes keep their declaration order
+		std::vector<u32> inDegree(m_passes.size(), 0);
+		std::vector<std::vector<RGPass>> successors(m_passes.size());
+		for (RGPass p = 0; p < m_passes.size(); p++) {
+			if (m_passes[p].culled) {
+				continue;
+			}
+			for (RGPass predecessor : m_passes[p].predecessors) {
+				if (!m_passes[predecessor].culled) {
+					successors[predecessor].push_back(p);
+					inDegree[p]++;
+				}
+			}
+		}
+
+		std::set<RGPass> ready;
+		for (RGPass p = 0; p < m_passes.size(); p++) {
+			if (!m_passes[p].culled && inDegree[p] == 0) {
+				ready.insert(p);
+			}
+		}
+
+		m_executionOrder.clear();
+		while (!ready.empty()) {
+			RGPass p = *ready.begin();
+			ready.erase(ready.begin());
+			m_executionOrder.push_back(p);
+
+			for (RGPass successor : successors[p]) {
+				if (--inDegree[successor] == 0) {
+					ready.insert(successor);
+				}
+			}
+		}
+	}
+
+	void RVKRenderGraph::ComputeLifetimes() {
+		for (auto& resource : m_resources) {
+			resource.firstUse = INVALID_HANDLE;
+			resource.lastUse = INVALID_HANDLE;
+			resource.memorySlot = INVALID_HANDLE;
+		}
+		for (auto& resource : m_importedResources) {
+			resource.firstUse = INVALID_HANDLE;
+			resource.lastUse = INVALID_HANDLE;
+		}
+
+		for (u32 i = 0; i < m_executionOrder.size(); i++) {
+			for (const auto& use : m_passes[m_executionOrder[i]].uses) {
+				Resource& resource = GetResource(use.resource);
+				if (resource.firstUse == INVALID_HANDLE) {
+					resource.firstUse = i;
+				}
+				resource.lastUse = i;
+			}
+		}
+	}
+
+	void RVKRenderGraph::CreateTransientImages() {
+		VkDevice device = RVKDevice::s_rvkDevice->GetDevice();
+
+		struct Candidate {
+			RGResource resource;
+			VkMemoryRequirements requirements;
+		};
+		std::vector<Candidate> candidates;
+
+		for (RGResource r = 0; r < m_resources.size(); r++) {
+			Resource& resource = m_resources[r];
+			if (!resource.isImage || resource.firstUse == INVALID_HANDLE) {
+				continue;
+			}
+
+			resource.extent = resource.desc.width > 0 && resource.desc.height > 0 ?
+				VkExtent2D{ resource.desc.width, resource.desc.height } :
+				VkExtent2D{
+					std::max(1u, static_cast<u32>(m_extent.width * resource.desc.scale)),
+					std::max(1u, static_cast<u32>(m_extent.height * resource.desc.scale)) };
+
+			VkImageCreateInfo imageInfo{};
+			imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+			imageInfo.imageType = VK_IMAGE_TYPE_2D;
+			imageInfo.extent.width = resource.extent.width;
+			imageInfo.extent.height = resource.extent.height;
+			imageInfo.extent.depth = 1;
+			imageInfo.mipLevels = 1;
+			imageInfo.arrayLayers = 1;
+			imageInfo.format = resource.desc.format;
+			imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+			imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+			imageInfo.usage = resource.usage;
+			imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+			imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+			VkResult result = vkCreateImage(device, &imageInfo, nullptr, &resource.image);
+			VK_CHECK(result, "Failed to Create Render Graph Image!");
+
+			Candidate candidate{ r };
+			vkGetImageMemoryRequirements(device, resource.image, &candidate.requirements);
+			candidates.push_back(candidate);
+		}
+
+		// greedy first fit, biggest images first so the small ones fill in behind them
+		std::stable_sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) {
+			return a.requirements.size > b.requirements.size;
+			});
+
+		for (const auto& candidate : candidates) {
+			Resource& resource = m_resources[candidate.resource];
+
+			for (u32 s = 0; s < m_memorySlots.size() && resource.memorySlot == INVALID_HANDLE; s++) {
+				MemorySlot& slot = m_memorySlots[s];
+				if ((slot.memoryTypeBits & candidate.requirements.memoryTypeBits) == 0) {
+					continue;
+				}
+
+				bool free = true;
+				for (RGResource other : slot.resources) {
+					const Resource& occupant = m_resources[other];
+					if (Overlaps(resource.firstUse, resource.lastUse, occupant.firstUse, occupant.lastUse)) {
+						free = false;
+						break;
+					}
+				}
+
+				if (free) {
+					resource.memorySlot = s;
+				}
+			}
+
+			if (resource.memorySlot == INVALID_HANDLE) {
+				resource.memorySlot = static_cast<u32>(m_memorySlots.size());
+				m_memorySlots.emplace_back();
+			}
+
+			MemorySlot& slot = m_memorySlots[resource.memorySlot];
+			slot.size = std::max(slot.size, candidate.requirements.size);
+			slot.memoryTypeBits &= candidate.requirements.memoryTypeBits;
+			slot.resources.push_back(candidate.resource);
+		}
+
+		// every image is bound at offset 0, so the alignment is always satisfied
+		VkDeviceSize totalSize = 0;
+		VkDeviceSize aliasedSize = 0;
+		for (auto& slot : m_memorySlots) {
+			VkMemoryAllocateInfo allocInfo{};
+			allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+			allocInfo.allocationSize = slot.size;
+			allocInfo.memoryTypeIndex = RVKDevice::s_rvkDevice->FindMemoryType(slot.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+			VkResult result = vkAllocateMemory(device, &allocInfo, nullptr, &slot.memory);
+			VK_CHECK(result, "Failed to Allocate Render Graph Memory!");
+			aliasedSize += slot.size;
+
+			for (RGResource r : slot.resources) {
+				Resource& resource = m_resources[r];
+				result = vkBindImageMemory(device, resource.image, slot.memory, 0);
+				VK_CHECK(result, "Failed to Bind Render Graph Image Memory!");
+
+				VkMemoryRequirements requirements;
+				vkGetImageMemoryRequirements(device, resource.image, &requirements);
+				totalSize += requirements.size;
+
+				VkImageViewCreateInfo viewInfo{};
+				viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+				viewInfo.image = resource.image;
+				viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+				viewInfo.format = resource.desc.format;
+				// a sampled view may only have a single aspect, passes sample the depth of depth stencil images
+				viewInfo.subresourceRange.aspectMask = (resource.usage & VK_IMAGE_USAGE_SAMPLED_BIT) && (resource.aspect & VK_IMAGE_ASPECT_DEPTH_BIT) ?
+					VK_IMAGE_ASPECT_DEPTH_BIT : resource.aspect;
+				viewInfo.subresourceRange.baseMipLevel = 0;
+				viewInfo.subresourceRange.levelCount = 1;
+				viewInfo.subresourceRange.baseArrayLayer = 0;
+				viewInfo.subresourceRange.layerCount = 1;
+
+				result = vkCreateImageView(device, &viewInfo, nullptr, &resource.view);
+				VK_CHECK(result, "Failed to Create Render Graph Image View!");
+			}
+		}
+
+		if (!candidates.empty()) {
+			VK_CORE_INFO("Render Graph: {0} Transient Images in {1} Allocations, {2} KB ({3} KB Without Aliasing)",
+				candidates.size(), m_memorySlots.size(), aliasedSize / 1024, totalSize / 1024);
+		}
+	}
+
+	void RVKRenderGraph::CreateRenderPasses() {
+		// position of every pass in the execution order, culled passes are left out
+		std::vector<u32> orderIndex(m_passes.size(), INVALID_HANDLE);
+		for (u32 i = 0; i < m_executionOrder.size(); i++) {
+			orderIndex[m_executionOrder[i]] = i;
+		}
+
+		// an attachment only has to be stored if a later pass reads it before overwriting it
+		auto needsStore = [&](RGPass p, RGResource r) {
+			if (orderIndex[p] == INVALID_HANDLE || (r & IMPORTED_BIT)) {
+				return true;
+			}
+			for (u32 i = orderIndex[p] + 1; i < m_executionOrder.size(); i++) {
+				for (const auto& use : m_passes[m_executionOrder[i]].uses) {
+					if (use.resource == r) {
+						return use.read;
+					}
+				}
+			}
+			return false;
+		};
+
+		for (RGPass p = 0; p < m_passes.size(); p++) {
+			Pass& pass = m_passes[p];
+			if (pass.colorAttachments.empty() && pass.depthAttachment.empty()) {
+				continue;
+			}
+
+			for (auto& attachment : pass.colorAttachments) {
+				attachment.storeOp = needsStore(p, attachment.resource) ?
+					VK_ATTACHMENT_STORE_OP_STORE : VK_ATTACHMENT_STORE_OP_DONT_CARE;
+			}
+			for (auto& attachment : pass.depthAttachment) {
+				attachment.storeOp = needsStore(p, attachment.resource) ?
+					VK_ATTACHMENT_STORE_OP_STORE : VK_ATTACHMENT_STORE_OP_DONT_CARE;
+			}
+
+			pass.renderPass = FindOrCreateRenderPass(pass);
+		}
+	}
+
+	VkRenderPass RVKRenderGraph::FindOrCreateRenderPass(const Pass& pass) {
+		std::vector<u32> key;
+		key.push_back(static_cast<u32>(pass.colorAttachments.size()));
+		auto appendKey = [&](const Attachment& attachment) {
+			key.push_back(static_cast<u32>(GetResource(attachment.resource).desc.format));
+			key.push_back(static_cast<u32>(attachment.loadOp));
+			key.push_back(static_cast<u32>(attachment.storeOp));
+			key.push_back(static_cast<u32>(attachment.layout));
+		};
+		for (const auto& attachment : pass.colorAttachments) {
+			appendKey(attachment);
+		}
+		for (const auto& attachment : pass.depthAttachment) {
+			appendKey(attachment);
+		}
+
+		for (const auto& entry : m_renderPassCache) {
+			if (entry.key == key) {
+				return entry.renderPass;
+			}
+		}
+
+		// layout transitions are done by the graph barriers, so the render pass never changes layouts
+		std::vector<VkAttachmentDescription> attachments;
+		std::vector<VkAttachmentReference> colorReferences;
+		VkAttachmentReference depthReference{};
+
+		auto describe = [&](const Attachment& attachment) {
+			VkAttachmentDescription description{};
+			description.format = GetResource(attachment.resource).desc.format;
+			description.samples = VK_SAMPLE_COUNT_1_BIT;
+			description.loadOp = attachment.loadOp;
+			description.storeOp = attachment.storeOp;
+			description.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+			description.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+			description.initialLayout = attachment.layout;
+			description.finalLayout = attachment.layout;
+			attachments.push_back(description);
+			return VkAttachmentReference{ static_cast<u32>(attachments.size() - 1), attachment.layout };
+		};
+
+		for (const auto& attachment : pass.colorAttachments) {
+			colorReferences.push_back(describe(attachment));
+		}
+		for (const auto& attachment : pass.depthAttachment) {
+			depthReference = describe(attachment);
+		}
+
+		VkSubpassDescription subpass{};
+		subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+		subpass.colorAttachmentCount = static_cast<u32>(colorReferences.size());
+		subpass.pColorAttachments = colorReferences.data();
+		subpass.pDepthStencilAttachment = pass.depthAttachment.empty() ? nullptr : &depthReference;
+
+		VkRenderPassCreateInfo renderPassInfo{};
+		renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+		renderPassInfo.attachmentCount = static_cast<u32>(attachments.size());
+		renderPassInfo.pAttachments = attachments.data();
+		renderPassInfo.subpassCount = 1;
+		renderPassInfo.pSubpasses = &subpass;
+
+		RenderPassEntry entry{ key };
+		VkResult result = vkCreateRenderPass(RVKDevice::s_rvkDevice->GetDevice(), &renderPassInfo, nullptr, &entry.renderPass);
+		VK_CHECK(result, "Failed to Create Render Graph Render Pass!");
+
+		m_renderPassCache.push_back(entry);
+		return entry.renderPass;
+	}
+
+	bool RVKRenderGraph::Transition(ResourceState& state, const ResourceUse& use, Barrier& barrier,
+		VkPipelineStageFlags& srcStages) const {
+		VkAccessFlags writeAccess = use.access & WRITE_ACCESS_MASK;
+		bool layoutChange = use.type != UseType::Buffer && state.layout != use.layout;
+
+		barrier.resource = use.resource;
+		barrier.oldLayout = state.layout;
+		barrier.newLayout = use.type == UseType::Buffer ? state.layout : use.layout;
+
+		if (layoutChange || writeAccess != 0) {
+			// the layout transition and writes have to wait for everything before them
+			VkPipelineStageFlags waitStages = state.writeStages | state.readStages;
+			if (!layoutChange && waitStages == 0) {
+				state.writeStages = use.stages;
+				state.writeAccess = writeAccess;
+				state.visibleStages = 0;
+				state.visibleAccess = 0;
+				return false;
+			}
+
+			barrier.srcAccess = state.writeAccess;
+			barrier.dstAccess = use.access;
+			srcStages |= waitStages;
+
+			// a layout transition counts as a write that is already visible to this use
+			state.layout = barrier.newLayout;
+			state.writeStages = use.stages;
+			state.writeAccess = writeAccess;
+			state.readStages = writeAccess != 0 ? 0 : use.stages;
+			state.visibleStages = writeAccess != 0 ? 0 : use.stages;
+			state.visibleAccess = writeAccess != 0 ? 0 : use.access;
+			return true;
+		}
+
+		// read only, reads don't need to wait for each other
+		bool covered = (use.stages & ~state.visibleStages) == 0 && (use.access & ~state.visibleAccess) == 0;
+		state.readStages |= use.stages;
+		if (state.writeStages == 0 || covered) {
+			return false;
+		}
+
+		barrier.srcAccess = state.writeAccess;
+		barrier.dstAccess = use.access;
+		srcStages |= state.writeStages;
+
+		state.visibleStages |= use.stages;
+		state.visibleAccess |= use.access;
+		return true;
+	}
+
+	void RVKRenderGraph::PlanBarriers() {
+		// the state every aliased memory slot is left in by its last user
+		struct SlotState {
+			VkPipelineStageFlags stages = 0;
+			VkAccessFlags access = 0;
+		};
+
+		std::vector<SlotState> slotStates(m_memorySlots.size());
+
+		// run twice: the first run only finds the end of frame state of each slot, which is
+		// what the first user of a slot has to wait for in the next frame
+		for (int run = 0; run < 2; run++) {
+			bool record = run == 1;
+			std::vector<ResourceState> states(m_resources.size());
+			std::vector<ResourceState> importedStates(m_importedResources.size());
+			std::vector<bool> started(m_resources.size(), false);
+
+			for (u32 i = 0; i < m_importedResources.size(); i++) {
+				importedStates[i].layout = m_importedResources[i].initialLayout;
+				importedStates[i].writeStages = m_importedResources[i].initialStages;
+			}
+
+			for (RGPass p : m_executionOrder) {
+				Pass& pass = m_passes[p];
+				if (record) {
+					pass.barriers = {};
+				}
+
+				for (auto use : pass.uses) {
+					ResourceState* state = nullptr;
+					if (use.resource & IMPORTED_BIT) {
+						state = &importedStates[use.resource & ~IMPORTED_BIT];
+					}
+					else {
+						Resource& resource = m_resources[use.resource];
+						state = &states[use.resource];
+						if (!started[use.resource]) {
+							// a transient image starts from garbage, it only has to wait for the
+							// previous user of its memory
+							started[use.resource] = true;
+							state->layout = VK_IMAGE_LAYOUT_UNDEFINED;
+							if (resource.memorySlot != INVALID_HANDLE) {
+								state->writeStages = slotStates[resource.memorySlot].stages;
+								state->writeAccess = slotStates[resource.memorySlot].access;
+							}
+						}
+					}
+
+					// storing a depth attachment writes it, even when the pass only tests against it
+					if (use.type == UseType::DepthRead) {
+						for (const auto& attachment : pass.depthAttachment) {
+							if (attachment.storeOp == VK_ATTACHMENT_STORE_OP_STORE) {
+								use.access |= VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+							}
+						}
+					}
+
+					Barrier barrier{};
+					VkPipelineStageFlags srcStages = 0;
+					if (Transition(*state, use, barrier, srcStages) && record) {
+						pass.barriers.barriers.push_back(barrier);
+						pass.barriers.srcStages |= srcStages;
+						pass.barriers.dstStages |= use.stages;
+					}
+
+					if (!(use.resource & IMPORTED_BIT)) {
+						u32 slot = m_resources[use.resource].memorySlot;
+						if (slot != INVALID_HANDLE) {
+							slotStates[slot].stages = state->writeStages | state->readStages;
+							slotStates[slot].access = state->writeAccess;
+						}
+					}
+				}
+			}
+
+			if (!record) {
+				continue;
+			}
+
+			// imported images are handed back in the layout the outside world expects
+			m_finalBarriers = {};
+			for (u32 i = 0; i < m_importedResources.size(); i++) {
+				const Resource& resource = m_importedResources[i];
+				const ResourceState& state = importedStates[i];
+				if (!resource.isImage || resource.finalLayout == VK_IMAGE_LAYOUT_UNDEFINED ||
+					resource.finalLayout == state.layout) {
+					continue;
+				}
+
+				Barrier barrier{};
+				barrier.resource = i | IMPORTED_BIT;
+				barrier.oldLayout = state.layout;
+				barrier.newLayout = resource.finalLayout;
+				barrier.srcAccess = state.writeAccess;
+				barrier.dstAccess = resource.finalAccess;
+				m_finalBarriers.barriers.push_back(barrier);
+				m_finalBarriers.srcStages |= state.writeStages | state.readStages;
+				m_finalBarriers.dstStages |= resource.finalStages;
+			}
+		}
+	}
+
+	void RVKRenderGraph::RecordBarriers(VkCommandBuffer commandBuffer, const BarrierBatch& batch) {
+		if (batch.barriers.empty()) {
+			return;
+		}
+
+		std::vector<VkImageMemoryBarrier> imageBarriers;
+		std::vector<VkBufferMemoryBarrier> bufferBarriers;
+		for (const auto& barrier : batch.barriers) {
+			Resource& resource = GetResource(barrier.resource);
+			if (resource.isImage) {
+				VkImageMemoryBarrier imageBarrier{};
+				imageBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+				imageBarrier.srcAccessMask = barrier.srcAccess;
+				imageBarrier.dstAccessMask = barrier.dstAccess;
+				imageBarrier.oldLayout = barrier.oldLayout;
+				imageBarrier.newLayout = barrier.newLayout;
+				imageBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+				imageBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+				imageBarrier.image = resource.image;
+				imageBarrier.subresourceRange.aspectMask = resource.aspect;
+				imageBarrier.subresourceRange.baseMipLevel = 0;
+				imageBarrier.subresourceRange.levelCount = 1;
+				imageBarrier.subresourceRange.baseArrayLayer = 0;
+				imageBarrier.subresourceRange.layerCount = 1;
+				imageBarriers.push_back(imageBarrier);
+			}
+			else {
+				VkBufferMemoryBarrier bufferBarrier{};
+				bufferBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+				bufferBarrier.srcAccessMask = barrier.srcAccess;
+				bufferBarrier.dstAccessMask = barrier.dstAccess;
+				bufferBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+				bufferBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+				bufferBarrier.buffer = resource.buffer;
+				bufferBarrier.offset = 0;
+				bufferBarrier.size = VK_WHOLE_SIZE;
+				bufferBarriers.push_back(bufferBarrier);
+			}
+		}
+
+		vkCmdPipelineBarrier(
+			commandBuffer,
+			batch.srcStages != 0 ? batch.srcStages : VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+			batch.dstStages != 0 ? batch.dstStages : VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+			0,
+			0, nullptr,
+			static_cast<u32>(bufferBarriers.size()), bufferBarriers.data(),
+			static_cast<u32>(imageBarriers.size()), imageBarriers.data());
+	}
+
+	VkFramebuffer RVKRenderGraph::FindOrCreateFramebuffer(Pass& pass, VkExtent2D& extent) {
+		std::vector<VkImageView> views;
+		extent = { 0, 0 };
+		for (const auto& attachment : pass.colorAttachments) {
+			const Resource& resource = GetResource(attachment.resource);
+			views.push_back(resource.view);
+			extent = resource.extent;
+		}
+		for (const auto& attachment : pass.depthAttachment) {
+			const Resource& resource = GetResource(attachment.resource);
+			views.push_back(resource.view);
+			extent = resource.extent;
+		}
+
+		for (const auto& framebuffer : pass.framebuffers) {
+			if (framebuffer.views == views) {
+				return framebuffer.framebuffer;
+			}
+		}
+
+		VkFramebufferCreateInfo framebufferInfo{};
+		framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+		framebufferInfo.renderPass = pass.renderPass;
+		framebufferInfo.attachmentCount = static_cast<u32>(views.size());
+		framebufferInfo.pAttachments = views.data();
+		framebufferInfo.width = extent.width;
+		framebufferInfo.height = extent.height;
+		framebufferInfo.layers = 1;
+
+		Framebuffer framebuffer{ views };
+		VkResult result = vkCreateFramebuffer(RVKDevice::s_rvkDevice->GetDevice(), &framebufferInfo, nullptr, &framebuffer.framebuffer);
+		VK_CHECK(result, "Failed to Create Render Graph Framebuffer!");
+
+		pass.framebuffers.push_back(framebuffer);
+		return framebuffer.framebuffer;
+	}
+
+	VkExtent2D RVKRenderGraph::ScaleExtent(VkExtent2D extent, float scale) {
+		if (scale >= 1.0f) {
+			return extent;
+		}
+		return {
+			std::max(1u, static_cast<u32>(extent.width * scale)),
+			std::max(1u, static_cast<u32>(extent.height * scale)) };
+	}
+
+	VkRenderPass RVKRenderGraph::GetRenderPass(RGPass pass) {
+		Compile();
+		return m_passes[pass].renderPass;
+	}
+
+	void RVKRenderGraph::CreateQueryPool() {
+		const VkPhysicalDeviceLimits& limits = RVKDevice::s_rvkDevice->m_properties.limits;
+		if (!limits.timestampComputeAndGraphics) {
+			VK_CORE_WARN("Render Graph: Timestamps Not Supported, No GPU Pass Timings");
+			return;
+		}
+		m_timestampPeriod = limits.timestampPeriod;
+
+		VkQueryPoolCreateInfo queryPoolInfo{};
+		queryPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+		queryPoolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+		queryPoolInfo.queryCount = MAX_TIMED_PASSES * 2 * MAX_FRAMES_IN_FLIGHT;
+
+		VkResult result = vkCreateQueryPool(RVKDevice::s_rvkDevice->GetDevice(), &queryPoolInfo, nullptr, &m_queryPool);
+		VK_CHECK(result, "Failed to Create Render Graph Query Pool!");
+	}
+
+	void RVKRenderGraph::ReadTimestamps(int frameIndex) {
+		// the frame fence was waited on before this frame slot is reused, so no need to wait here
+		std::vector<std::string>& names = m_timedPasses[frameIndex];
+		if (m_queryPool == VK_NULL_HANDLE || names.empty()) {
+			return;
+		}
+
+		std::vector<u64> timestamps(names.size() * 2);
+		VkResult result = vkGetQueryPoolResults(
+			RVKDevice::s_rvkDevice->GetDevice(),
+			m_queryPool,
+			frameIndex * MAX_TIMED_PASSES * 2,
+			static_cast<u32>(timestamps.size()),
+			timestamps.size() * sizeof(u64),
+			timestamps.data(),
+			sizeof(u64),
+			VK_QUERY_RESULT_64_BIT);
+		if (result != VK_SUCCESS) {
+			return;
+		}
+
+		m_passTimings.resize(names.size());
+		for (size_t i = 0; i < names.size(); i++) {
+			m_passTimings[i].name = names[i];
+			m_passTimings[i].gpuTime =
+				static_cast<float>(timestamps[i * 2 + 1] - timestamps[i * 2]) * m_timestampPeriod / 1000000.0f;
+		}
+	}
+
+	void RVKRenderGraph::Execute(FrameInfo& frameInfo) {
+		Compile();
+
+		VkCommandBuffer commandBuffer = frameInfo.commandBuffer;
+		ReadTimestamps(frameInfo.frameIndex);
+
+		u32 firstQuery = frameInfo.frameIndex * MAX_TIMED_PASSES * 2;
+		std::vector<std::string>& timedPasses = m_timedPasses[frameInfo.frameIndex];
+		timedPasses.clear();
+		if (m_queryPool != VK_NULL_HANDLE) {
+			vkCmdResetQueryPool(commandBuffer, m_queryPool, firstQuery, MAX_TIMED_PASSES * 2);
+		}
+
+		for (RGPass p : m_executionOrder) {
+			Pass& pass = m_passes[p];
+
+			u32 query = firstQuery + static_cast<u32>(timedPasses.size()) * 2;
+			bool timed = m_queryPool != VK_NULL_HANDLE && timedPasses.size() < MAX_TIMED_PASSES;
+			if (timed) {
+				vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, m_queryPool, query);
+				timedPasses.push_back(pass.name);
+			}
+
+			RecordBarriers(commandBuffer, pass.barriers);
+			ExecutePass(frameInfo, pass);
+
+			if (timed) {
+				vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, m_queryPool, query + 1);
+			}
+		}
+
+		RecordBarriers(commandBuffer, m_finalBarriers);
+	}
+
+	void RVKRenderGraph::ExecutePass(FrameInfo& frameInfo, Pass& pass) {
+		VkCommandBuffer commandBuffer = frameInfo.commandBuffer;
+		if (pass.renderPass == VK_NULL_HANDLE) {
+			pass.execute(frameInfo);
+			return;
+		}
+
+		VkExtent2D framebufferExtent{};
+		VkFramebuffer framebuffer = FindOrCreateFramebuffer(pass, framebufferExtent);
+		VkExtent2D extent = ScaleExtent(framebufferExtent, pass.renderScale);
+
+		std::vector<VkClearValue> clearValues;
+		for (const auto& attachment : pass.colorAttachments) {
+			clearValues.push_back(attachment.clearValue);
+		}
+		for (const auto& attachment : pass.depthAttachment) {
+			clearValues.push_back(attachment.clearValue);
+		}
+
+		VkRenderPassBeginInfo renderPassInfo{};
+		renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+		renderPassInfo.renderPass = pass.renderPass;
+		renderPassInfo.framebuffer = framebuffer;
+		renderPassInfo.renderArea.offset = { 0, 0 };
+		renderPassInfo.renderArea.extent = extent;
+		renderPassInfo.clearValueCount = static_cast<u32>(clearValues.size());
+		renderPassInfo.pClearValues = clearValues.data();
+
+		vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+
+		VkViewport viewport{};
+		viewport.x = 0.0f;
+		viewport.y = static_cast<float>(extent.height);
+		viewport.width = static_cast<float>(extent.width);
+		viewport.height = static_cast<float>(extent.height) * -1.0f;
+		viewport.minDepth = 0.0f;
+		viewport.maxDepth = 1.0f;
+		VkRect2D scissor{ {0, 0}, extent };
+		vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+		vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+
+		pass.execute(frameInfo);
+
+		vkCmdEndRenderPass(commandBuffer);
+	}
+
+	void RVKRenderGraph::DestroyTransientImages() {
+		std::vector<VkImageView> views;
+		std::vector<VkImage> images;
+		std::vector<VkDeviceMemory> memories;
+		for (auto& resource : m_resources) {
+			if (resource.view != VK_NULL_HANDLE) {
+				views.push_back(resource.view);
+				resource.view = VK_NULL_HANDLE;
+			}
+			if (resource.image != VK_NULL_HANDLE) {
+				images.push_back(resource.image);
+				resource.image = VK_NULL_HANDLE;
+			}
+			resource.memorySlot = INVALID_HANDLE;
+		}
+
+		for (auto& slot : m_memorySlots) {
+			memories.push_back(slot.memory);
+		}
+		m_memorySlots.clear();
+
+		if (views.empty() && images.empty() && memories.empty()) {
+			return;
+		}
+
+		// frames in flight may still render to them
+		RVKDevice::s_rvkDevice->DeferDestroy([views = std::move(views), images = std::move(images), memories = std::move(memories)]() {
+			VkDevice device = RVKDevice::s_rvkDevice->GetDevice();
+			for (VkImageView view : views) {
+				vkDestroyImageView(device, view, nullptr);
+			}
+			for (VkImage image : images) {
+				vkDestroyImage(device, image, nullptr);
+			}
+			for (VkDeviceMemory memory : memories) {
+				vkFreeMemory(device, memory, nullptr);
+			}
+		});
+	}
+
+	void RVKRenderGraph::DestroyFramebuffers() {
+		std::vector<VkFramebuffer> framebuffers;
+		for (auto& pass : m_passes) {
+			for (auto& framebuffer : pass.framebuffers) {
+				framebuffers.push_back(framebuffer.framebuffer);
+			}
+			pass.framebuffers.clear();
+		}
+
+		if (framebuffers.empty()) {
+			return;
+		}
+
+		RVKDevice::s_rvkDevice->DeferDestroy([framebuffers = std::move(framebuffers)]() {
+			for (VkFramebuffer framebuffer : framebuffers) {
+				vkDestroyFramebuffer(RVKDevice::s_rvkDevice->GetDevice(), framebuffer, nullptr);
+			}
+		});
+	}
+}  // namespace RVK
@@ -0,0 +1,259 @@
+#pragma once
+
+#include "Framework/Vulkan/VKUtils.h"
+
+namespace RVK {
+	using RGResource = u32;
+	using RGPass = u32;
+
+	// Frame graph on top of plain render passes.
+	// Passes declare the images and buffers they touch, the graph works out the execution order,
+	// culls passes whose results are never used, aliases the memory of transient images whose
+	// lifetimes don't overlap and records the pipeline barriers between passes.
+	class RVKRenderGraph {
+	public:
+		static constexpr u32 INVALID_HANDLE = std::numeric_limits<u32>::max();
+
+		struct ImageDesc {
+			VkFormat format = VK_FORMAT_UNDEFINED;
+			// size relative to the graph extent, only used when width/height are 0
+			float scale = 1.0f;
+			u32 width = 0;
+			u32 height = 0;
+			// extra usage on top of what the passes declare
+			VkImageUsageFlags usage = 0;
+		};
+
+		class PassBuilder {
+		public:
+			void WriteColor(
+				RGResource image,
+				VkAttachmentLoadOp loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
+				VkClearColorValue clearColor = { { 0.0f, 0.0f, 0.0f, 1.0f } });
+			void WriteDepth(
+				RGResource image,
+				VkAttachmentLoadOp loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
+				float clearDepth = 1.0f);
+			// depth test against the attachment without writing it
+			void ReadDepth(RGResource image);
+			void ReadTexture(RGResource image, VkPipelineStageFlags stages = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+			void ReadBuffer(RGResource buffer, VkPipelineStageFlags stages, VkAccessFlags access);
+			void WriteBuffer(RGResource buffer, VkPipelineStageFlags stages, VkAccessFlags access);
+			// keep the pass even if nothing reads its outputs
+			void SetSideEffect();
+
+		private:
+			PassBuilder(RVKRenderGraph& graph, RGPass pass) : m_graph{ graph }, m_pass{ pass } {}
+
+			RVKRenderGraph& m_graph;
+			RGPass m_pass;
+
+			friend class RVKRenderGraph;
+		};
+
+		using SetupFn = std::function<void(PassBuilder&)>;
+		using ExecuteFn = std::function<void(FrameInfo&)>;
+
+		struct PassTiming {
+			std::string name;
+			float gpuTime; // milliseconds
+		};
+
+	public:
+		RVKRenderGraph(VkExtent2D extent);
+		~RVKRenderGraph();
+
+		NO_COPY(RVKRenderGraph)
+
+		RGResource CreateImage(const std::string& name, const ImageDesc& desc);
+		RGResource ImportImage(
+			const std::string& name,
+			VkFormat format,
+			VkImageLayout initialLayout,
+			VkImageLayout finalLayout,
+			VkPipelineStageFlags initialStages = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+			// who reads the image after the graph, so the final barrier makes the writes visible to it
+			VkPipelineStageFlags finalStages = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+			VkAccessFlags finalAccess = 0);
+		RGResource ImportBuffer(const std::string& name, VkBuffer buffer, VkDeviceSize size);
+		void SetImportedImage(RGResource resource, VkImage image, VkImageView view, VkExtent2D extent);
+
+		RGPass AddPass(const std::string& name, const SetupFn& setup, ExecuteFn execute);
+		// removes all passes and transient images, imported resources stay valid
+		void ClearPasses();
+
+		void SetExtent(VkExtent2D extent);
+		VkExtent2D GetExtent() const { return m_extent; }
+		// draws the pass into the top left part of its attachments, can change every frame
+		void SetRenderScale(RGPass pass, float scale) { m_passes[pass].renderScale = scale; }
+		static VkExtent2D ScaleExtent(VkExtent2D extent, float scale);
+
+		void Compile();
+		void Execute(FrameInfo& frameInfo);
+
+		VkRenderPass GetRenderPass(RGPass pass);
+		VkImage GetImage(RGResource resource) { return GetResource(resource).image; }
+		VkImageView GetImageView(RGResource resource) { return GetResource(resource).view; }
+		VkExtent2D GetImageExtent(RGResource resource) { return GetResource(resource).extent; }
+		bool IsPassCulled(RGPass pass) const { return m_passes[pass].culled; }
+		// GPU time of every executed pass, from the last frame whose timestamps came back
+		const std::vector<PassTiming>& GetPassTimings() const { return m_passTimings; }
+
+	private:
+		static constexpr u32 IMPORTED_BIT = 0x80000000;
+		static constexpr u32 MAX_TIMED_PASSES = 32;
+
+		enum class UseType {
+			ColorWrite,
+			DepthWrite,
+			DepthRead,
+			Texture,
+			Buffer
+		};
+
+		struct ResourceUse {
+			RGResource resource;
+			UseType type;
+			VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+			VkPipelineStageFlags stages = 0;
+			VkAccessFlags access = 0;
+			bool write = false;
+			// the previous content is needed (loadOp LOAD or read access)
+			bool read = false;
+		};
+
+		struct Attachment {
+			RGResource resource;
+			VkAttachmentLoadOp loadOp;
+			VkAttachmentStoreOp storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+			VkImageLayout layout;
+			VkClearValue clearValue;
+		};
+
+		struct Barrier {
+			RGResource resource;
+			VkImageLayout oldLayout;
+			VkImageLayout newLayout;
+			VkAccessFlags srcAccess;
+			VkAccessFlags dstAccess;
+		};
+
+		struct BarrierBatch {
+			std::vector<Barrier> barriers;
+			VkPipelineStageFlags srcStages = 0;
+			VkPipelineStageFlags dstStages = 0;
+		};
+
+		struct Framebuffer {
+			std::vector<VkImageView> views;
+			VkFramebuffer framebuffer;
+		};
+
+		struct Pass {
+			std::string name;
+			ExecuteFn execute;
+			std::vector<ResourceUse> uses;
+			std::vector<Attachment> colorAttachments;
+			std::vector<Attachment> depthAttachment;
+			bool sideEffect = false;
+			bool culled = false;
+			float renderScale = 1.0f;
+
+			// passes whose output this pass reads
+			std::vector<RGPass> producers;
+			// every pass that has to run before this one, producers included
+			std::vector<RGPass> predecessors;
+
+			VkRenderPass renderPass = VK_NULL_HANDLE;
+			BarrierBatch barriers;
+			std::vector<Framebuffer> framebuffers;
+		};
+
+		struct Resource {
+			std::string name;
+			bool isImage = true;
+			bool imported = false;
+
+			// images
+			ImageDesc desc;
+			VkImageAspectFlags aspect = VK_IMAGE_ASPECT_COLOR_BIT;
+			VkImageUsageFlags usage = 0;
+			VkImage image = VK_NULL_HANDLE;
+			VkImageView view = VK_NULL_HANDLE;
+			VkExtent2D extent{ 0, 0 };
+			VkImageLayout initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+			VkImageLayout finalLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+			VkPipelineStageFlags initialStages = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+			VkPipelineStageFlags finalStages = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+			VkAccessFlags finalAccess = 0;
+
+			// buffers
+			VkBuffer buffer = VK_NULL_HANDLE;
+			VkDeviceSize size = 0;
+
+			// lifetime in execution order, INVALID_HANDLE if unused
+			u32 firstUse = INVALID_HANDLE;
+			u32 lastUse = INVALID_HANDLE;
+			u32 memorySlot = INVALID_HANDLE;
+		};
+
+		struct ResourceState {
+			VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+			VkPipelineStageFlags writeStages = 0;
+			VkAccessFlags writeAccess = 0;
+			VkPipelineStageFlags readStages = 0;
+			VkPipelineStageFlags visibleStages = 0;
+			VkAccessFlags visibleAccess = 0;
+		};
+
+		struct MemorySlot {
+			VkDeviceMemory memory = VK_NULL_HANDLE;
+			VkDeviceSize size = 0;
+			u32 memoryTypeBits = ~0u;
+			std::vector<RGResource> resources;
+		};
+
+		struct RenderPassEntry {
+			std::vector<u32> key;
+			VkRenderPass renderPass;
+		};
+
+		Resource& GetResource(RGResource resource);
+		void AddUse(RGPass pass, const ResourceUse& use);
+
+		void BuildDependencies();
+		void CullPasses();
+		void SortPasses();
+		void ComputeLifetimes();
+		void CreateTransientImages();
+		void CreateRenderPasses();
+		void PlanBarriers();
+		void DestroyTransientImages();
+		void DestroyFramebuffers();
+
+		bool Transition(ResourceState& state, const ResourceUse& use, Barrier& barrier,
+			VkPipelineStageFlags& srcStages) const;
+		VkRenderPass FindOrCreateRenderPass(const Pass& pass);
+		VkFramebuffer FindOrCreateFramebuffer(Pass& pass, VkExtent2D& extent);
+		void RecordBarriers(VkCommandBuffer commandBuffer, const BarrierBatch& batch);
+		void ExecutePass(FrameInfo& frameInfo, Pass& pass);
+		void CreateQueryPool();
+		void ReadTimestamps(int frameIndex);
+
+		std::vector<Pass> m_passes;
+		std::vector<Resource> m_resources;
+		std::vector<Resource> m_importedResources;
+		std::vector<RGPass> m_executionOrder;
+		std::vector<MemorySlot> m_memorySlots;
+		std::vector<RenderPassEntry> m_renderPassCache;
+		BarrierBatch m_finalBarriers;
+
+		VkExtent2D m_extent;
+		bool m_isDirty = true;
+
+		VkQueryPool m_queryPool = VK_NULL_HANDLE;
+		float m_timestampPeriod = 0.0f;
+		std::array<std::vector<std::string>, MAX_FRAMES_IN_FLIGHT> m_timedPasses;
+		std::vector<PassTiming> m_passTimings;
+	};
+}  // namespace RVK
@@ -1,22 +1,42 @@
 #include "Framework/Vulkan/RVKRenderer.h"
 #include "Framework/Vulkan/RVKDevice.h"
+#include "Framework/Vulkan/RVKGeometryArena.h"
+#include "Framework/Vulkan/RVKStagingRing.h"
 
 namespace RVK {
 	RVKRenderer::RVKRenderer(RVKWindow& window)
 		: m_rvkWindow{ window }{
+		RVKGeometryArena::s_geometryArena = std::make_shared<RVKGeometryArena>();
+		RVKStagingRing::s_stagingRing = std::make_shared<RVKStagingRing>();
 		RecreateSwapChain();
 		CreateCommandBuffers();
 	}
 
-	RVKRenderer::~RVKRenderer() { FreeCommandBuffers(); }
+	RVKRenderer::~RVKRenderer() {
+		vkDeviceWaitIdle(RVKDevice::s_rvkDevice->GetDevice());
+		m_renderGraph = nullptr;
+		// models still queued for deletion keep the arena alive until the flush
+		RVKGeometryArena::s_geometryArena = nullptr;
+		RVKStagingRing::s_stagingRing = nullptr;
+		RVKDevice::s_rvkDevice->FlushDeletionQueue();
+		FreeCommandBuffers();
+	}
 
 	void RVKRenderer::RecreateSwapChain() {
 		auto extent = m_rvkWindow.GetExtent();
-		while (extent.width == 0 || extent.height == 0) {
-			extent = m_rvkWindow.GetExtent();
-			glfwWaitEvents();
+		if (m_rvkSwapChain == nullptr) {
+			// nothing to draw with yet, so the very first swap chain has to wait for a usable window
+			while (extent.width == 0 || extent.height == 0) {
+				glfwWaitEvents();
+				extent = m_rvkWindow.GetExtent();
+			}
 		}
-		vkDeviceWaitIdle(RVKDevice::s_rvkDevice->GetDevice());
+		else if (extent.width == 0 || extent.height == 0) {
+			// minimized, BeginFrame tries again once the window has a size
+			m_swapChainOutdated = true;
+			return;
+		}
+		m_swapChainOutdated = false;
 
 		if (m_rvkSwapChain == nullptr) {
 			m_rvkSwapChain = std::make_unique<RVKSwapChain>(extent);
@@ -28,6 +48,22 @@ namespace RVK {
 			if (!oldSwapChain->CompareSwapFormats(*m_rvkSwapChain.get())) {
 				VK_CORE_CRITICAL("Swap Chain Image(or Depth) Format Has Changed!");
 			}
+
+			// frames in flight may still render to or present the old images
+			RVKDevice::s_rvkDevice->DeferDestroy([oldSwapChain = std::move(oldSwapChain)]() mutable { oldSwapChain = nullptr; });
+		}
+
+		if (m_renderGraph == nullptr) {
+			m_renderGraph = std::make_unique<RVKRenderGraph>(m_rvkSwapChain->GetSwapChainExtent());
+			m_backBuffer = m_renderGraph->ImportImage(
+				"BackBuffer",
+				m_rvkSwapChain->GetSwapChainImageFormat(),
+				VK_IMAGE_LAYOUT_UNDEFINED,
+				VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
+				VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT);
+		}
+		else {
+			m_renderGraph->SetExtent(m_rvkSwapChain->GetSwapChainExtent());
 		}
 	}
 
@@ -56,7 +92,17 @@ namespace RVK {
 	VkCommandBuffer RVKRenderer::BeginFrame() {
 		VK_ASSERT(!m_isFrameStarted, "Can't Call BeginFrame while already in progress!");
 
+		if (m_swapChainOutdated) {
+			RecreateSwapChain();
+			if (m_swapChainOutdated) {
+				return nullptr;
+			}
+		}
+
 		auto result = m_rvkSwapChain->AcquireNextImage(&m_currentImageIndex);
+		// the fence of this frame slot has been waited on, anything older is done on the GPU
+		RVKDevice::s_rvkDevice->ProcessDeletionQueue();
+
 		if (result == VK_ERROR_OUT_OF_DATE_KHR) {
 			RecreateSwapChain();
 			return nullptr;
@@ -67,6 +113,11 @@ namespace RVK {
 		}
 
 		m_isFrameStarted = true;
+		m_renderGraph->SetImportedImage(
+			m_backBuffer,
+			m_rvkSwapChain->GetImage(m_currentImageIndex),
+			m_rvkSwapChain->GetImageView(m_currentImageIndex),
+			m_rvkSwapChain->GetSwapChainExtent());
 
 		auto commandBuffer = GetCurrentCommandBuffer();
 		VkCommandBufferBeginInfo beginInfo{};
@@ -86,6 +137,7 @@ namespace RVK {
 		VK_CHECK(result, "Failed to Record Command buffer!")
 
 		result = m_rvkSwapChain->SubmitCommandBuffers(&commandBuffer, &m_currentImageIndex);
+		RVKDevice::s_rvkDevice->OnFrameSubmitted();
 		if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR ||
 			m_rvkWindow.WasWindowResized()) {
 			m_rvkWindow.ResetWindowResizedFlag();
@@ -99,46 +151,11 @@ namespace RVK {
 		m_currentFrameIndex = (m_currentFrameIndex + 1) % MAX_FRAMES_IN_FLIGHT;
 	}
 
-	void RVKRenderer::BeginSwapChainRenderPass(VkCommandBuffer commandBuffer) {
-		VK_ASSERT(m_isFrameStarted, "Can't Call BeginSwapChainRenderPass if Frame is not in progress!");
-		VK_ASSERT(
-			commandBuffer == GetCurrentCommandBuffer(),
-			"Can't Begin Render Pass on Command Buffer from a different Frame!"
-		);
-
-		VkRenderPassBeginInfo renderPassInfo{};
-		renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-		renderPassInfo.renderPass = m_rvkSwapChain->GetRenderPass();
-		renderPassInfo.framebuffer = m_rvkSwapChain->GetFrameBuffer(m_currentImageIndex);
-
-		renderPassInfo.renderArea.offset = { 0, 0 };
-		renderPassInfo.renderArea.extent = m_rvkSwapChain->GetSwapChainExtent();
-
-		std::array<VkClearValue, 2> clearValues{};
-		clearValues[0].color = { 0.15f, 1.0f, 0.15f, 1.0f };
-		clearValues[1].depthStencil = { 1.0f, 0 };
-		renderPassInfo.clearValueCount = static_cast<u32>(clearValues.size());
-		renderPassInfo.pClearValues = clearValues.data();
-
-		vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
-
-		VkViewport viewport{};
-		viewport.x = 0.0f;
-		viewport.y = static_cast<float>(m_rvkSwapChain->GetSwapChainExtent().height);
-		viewport.width = static_cast<float>(m_rvkSwapChain->GetSwapChainExtent().width);
-		viewport.height = static_cast<float>(m_rvkSwapChain->GetSwapChainExtent().height) * -1.0f;
-		viewport.minDepth = 0.0f;
-		viewport.maxDepth = 1.0f;
-		VkRect2D scissor{ {0, 0}, m_rvkSwapChain->GetSwapChainExtent() };
-		vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
-		vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
-	}
-
-	void RVKRenderer::EndSwapChainRenderPass(VkCommandBuffer commandBuffer) {
-		VK_ASSERT(m_isFrameStarted, "Can't Call EndSwapChainRenderPass if Frame is not in progress!");
+	void RVKRenderer::ExecuteRenderGraph(FrameInfo& frameInfo) {
+		VK_ASSERT(m_isFrameStarted, "Can't Call ExecuteRenderGraph if Frame is not in progress!");
 		VK_ASSERT(
-			commandBuffer == GetCurrentCommandBuffer(),
-			"Can't End Render Pass on Command Buffer from a different Frame!");
-		vkCmdEndRenderPass(commandBuffer);
+			frameInfo.commandBuffer == GetCurrentCommandBuffer(),
+			"Can't Execute Render Graph on Command Buffer from a different Frame!");
+		m_renderGraph->Execute(frameInfo);
 	}
 }  // namespace RVK
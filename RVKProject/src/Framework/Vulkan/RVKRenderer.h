@@ -2,6 +2,7 @@
 
 #include "Framework/Vulkan/RVKDevice.h"
 #include "Framework/Vulkan/RVKSwapChain.h"
+#include "Framework/Vulkan/RVKRenderGraph.h"
 
 namespace RVK {
 	class RVKRenderer {
@@ -11,7 +12,9 @@ namespace RVK {
 
 		NO_COPY(RVKRenderer)
 
-		VkRenderPass GetSwapChainRenderPass() const { return m_rvkSwapChain->GetRenderPass(); }
+		RVKRenderGraph& GetRenderGraph() const { return *m_renderGraph; }
+		RGResource GetBackBuffer() const { return m_backBuffer; }
+		VkFormat GetDepthFormat() const { return m_rvkSwapChain->FindDepthFormat(); }
 		float GetAspectRatio() const { return m_rvkSwapChain->ExtentAspectRatio(); }
 		bool IsFrameInProgress() const { return m_isFrameStarted; }
 
@@ -25,10 +28,10 @@ namespace RVK {
 			return m_currentFrameIndex;
 		}
 
+		// returns nullptr when no frame can be rendered, e.g. while the window is minimized
 		VkCommandBuffer BeginFrame();
 		void EndFrame();
-		void BeginSwapChainRenderPass(VkCommandBuffer commandBuffer);
-		void EndSwapChainRenderPass(VkCommandBuffer commandBuffer);
+		void ExecuteRenderGraph(FrameInfo& frameInfo);
 
 	private:
 		void CreateCommandBuffers();
@@ -38,9 +41,12 @@ namespace RVK {
 		RVKWindow& m_rvkWindow;
 		std::unique_ptr<RVKSwapChain> m_rvkSwapChain;
 		std::vector<VkCommandBuffer> m_commandBuffers;
+		std::unique_ptr<RVKRenderGraph> m_renderGraph;
+		RGResource m_backBuffer;
 
 		u32 m_currentImageIndex;
 		int m_currentFrameIndex{ 0 };
 		bool m_isFrameStarted{ false };
+		bool m_swapChainOutdated{ false };
 	};
 }  // namespace RVK
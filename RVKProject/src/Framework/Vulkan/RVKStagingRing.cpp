@@ -0,0 +1,53 @@
+#include "Framework/Vulkan/RVKStagingRing.h"
+#include "Framework/Vulkan/RVKDevice.h"
+
+namespace RVK {
+	std::shared_ptr<RVKStagingRing> RVKStagingRing::s_stagingRing;
+
+	RVKStagingRing::RVKStagingRing(VkDeviceSize size) : m_size(size) {
+		m_buffer = std::make_unique<RVKBuffer>(
+			m_size,
+			1,
+			VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+		m_buffer->Map();
+	}
+
+	RVKStagingRing::~RVKStagingRing() {}
+
+	RVKStagingRing::Allocation RVKStagingRing::Allocate(VkDeviceSize size, VkDeviceSize alignment) {
+		if (size > m_size) {
+			return {};
+		}
+
+		VkDeviceSize offset = (m_head + alignment - 1) & ~(alignment - 1);
+		// an allocation never wraps, the rest of the lap is skipped
+		if (offset % m_size + size > m_size) {
+			offset = (offset / m_size + 1) * m_size;
+		}
+		if (offset + size - m_tail > m_size) {
+			return {};
+		}
+		m_head = offset + size;
+
+		Allocation allocation;
+		allocation.buffer = m_buffer->GetBuffer();
+		allocation.offset = offset % m_size;
+		allocation.data = static_cast<u8*>(m_buffer->GetMappedMemory()) + allocation.offset;
+		return allocation;
+	}
+
+	void RVKStagingRing::Retire() {
+		if (m_retired == m_head) {
+			return;
+		}
+		m_retired = m_head;
+
+		// the deletion queue runs in order, so the tail only moves forward
+		RVKDevice::s_rvkDevice->DeferDestroy([ring = std::weak_ptr<RVKStagingRing>(s_stagingRing), end = m_head]() {
+			if (auto staging = ring.lock()) {
+				staging->m_tail = end;
+			}
+		});
+	}
+}  // namespace RVK
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "Framework/Vulkan/RVKBuffer.h"
+
+namespace RVK {
+	// Persistently mapped upload memory that small, frequent transfers write into instead of creating a
+	// staging buffer each. Allocations are handed out in order around the ring, Retire hands everything
+	// allocated so far to the deletion queue, and the space comes back once the frames that used it are done.
+	// Main thread only.
+	class RVKStagingRing {
+	public:
+		static std::shared_ptr<RVKStagingRing> s_stagingRing;
+		static constexpr VkDeviceSize DEFAULT_SIZE = 16ull * 1024 * 1024;
+
+		struct Allocation {
+			VkBuffer buffer = VK_NULL_HANDLE;
+			VkDeviceSize offset = 0;
+			// nullptr when the ring is full
+			u8* data = nullptr;
+		};
+
+	public:
+		RVKStagingRing(VkDeviceSize size = DEFAULT_SIZE);
+		~RVKStagingRing();
+
+		NO_COPY(RVKStagingRing)
+
+		// alignment has to be a power of two, the data is host coherent
+		Allocation Allocate(VkDeviceSize size, VkDeviceSize alignment = 16);
+		// after recording the copies that read the allocations
+		void Retire();
+
+		VkDeviceSize GetSize() const { return m_size; }
+		VkDeviceSize GetUsedBytes() const { return m_head - m_tail; }
+
+	private:
+		std::unique_ptr<RVKBuffer> m_buffer;
+		VkDeviceSize m_size;
+		// running byte counts, the offset into the buffer is modulo m_size
+		VkDeviceSize m_head = 0;
+		VkDeviceSize m_tail = 0;
+		VkDeviceSize m_retired = 0;
+	};
+}  // namespace RVK
@@ -15,10 +15,15 @@ namespace RVK {
 	void RVKSwapChain::Init() {
 		CreateSwapChain();
 		CreateImageViews();
-		CreateRenderPass();
-		CreateDepthResources();
-		CreateFramebuffers();
-		CreateSyncObjects();
+		if (m_oldSwapChain != nullptr) {
+			InheritSyncObjects(*m_oldSwapChain);
+		}
+		else {
+			CreateSyncObjects();
+		}
+
+		// the depth buffer belongs to the render graph now, the format is only kept for CompareSwapFormats
+		m_swapChainDepthFormat = FindDepthFormat();
 	}
 
 	RVKSwapChain::~RVKSwapChain() {
@@ -32,20 +37,8 @@ namespace RVK {
 			m_swapChain = nullptr;
 		}
 
-		for (int i = 0; i < m_depthImages.size(); i++) {
-			vkDestroyImageView(RVKDevice::s_rvkDevice->GetDevice(), m_depthImageViews[i], nullptr);
-			vkDestroyImage(RVKDevice::s_rvkDevice->GetDevice(), m_depthImages[i], nullptr);
-			vkFreeMemory(RVKDevice::s_rvkDevice->GetDevice(), m_depthImageMemorys[i], nullptr);
-		}
-
-		for (auto framebuffer : m_swapChainFramebuffers) {
-			vkDestroyFramebuffer(RVKDevice::s_rvkDevice->GetDevice(), framebuffer, nullptr);
-		}
-
-		vkDestroyRenderPass(RVKDevice::s_rvkDevice->GetDevice(), m_renderPass, nullptr);
-
-		// cleanup synchronization objects
-		for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+		// cleanup synchronization objects, empty if a newer swap chain took them over
+		for (size_t i = 0; i < m_inFlightFences.size(); i++) {
 			vkDestroySemaphore(RVKDevice::s_rvkDevice->GetDevice(), m_renderFinishedSemaphores[i], nullptr);
 			vkDestroySemaphore(RVKDevice::s_rvkDevice->GetDevice(), m_imageAvailableSemaphores[i], nullptr);
 			vkDestroyFence(RVKDevice::s_rvkDevice->GetDevice(), m_inFlightFences[i], nullptr);
@@ -197,134 +190,6 @@ namespace RVK {
 		}
 	}
 
-	void RVKSwapChain::CreateRenderPass() {
-		VkAttachmentDescription depthAttachment{};
-		depthAttachment.format = FindDepthFormat();
-		depthAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
-		depthAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-		depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-		depthAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-		depthAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-		depthAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-		depthAttachment.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
-
-		VkAttachmentReference depthAttachmentRef{};
-		depthAttachmentRef.attachment = 1;
-		depthAttachmentRef.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
-
-		VkAttachmentDescription colorAttachment = {};
-		colorAttachment.format = GetSwapChainImageFormat();
-		colorAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
-		colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-		colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
-		colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-		colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-		colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-		colorAttachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
-
-		VkAttachmentReference colorAttachmentRef = {};
-		colorAttachmentRef.attachment = 0;
-		colorAttachmentRef.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-
-		VkSubpassDescription subpass = {};
-		subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
-		subpass.colorAttachmentCount = 1;
-		subpass.pColorAttachments = &colorAttachmentRef;
-		subpass.pDepthStencilAttachment = &depthAttachmentRef;
-
-		VkSubpassDependency dependency = {};
-		dependency.dstSubpass = 0;
-		dependency.dstAccessMask =
-			VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
-		dependency.dstStageMask =
-			VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
-		dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
-		dependency.srcAccessMask = 0;
-		dependency.srcStageMask =
-			VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
-
-		std::array<VkAttachmentDescription, 2> attachments = { colorAttachment, depthAttachment };
-		VkRenderPassCreateInfo renderPassInfo = {};
-		renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
-		renderPassInfo.attachmentCount = static_cast<u32>(attachments.size());
-		renderPassInfo.pAttachments = attachments.data();
-		renderPassInfo.subpassCount = 1;
-		renderPassInfo.pSubpasses = &subpass;
-		renderPassInfo.dependencyCount = 1;
-		renderPassInfo.pDependencies = &dependency;
-
-		VkResult result = vkCreateRenderPass(RVKDevice::s_rvkDevice->GetDevice(), &renderPassInfo, nullptr, &m_renderPass);
-		VK_CHECK(result, "Failed to Create Render Pass!");
-	}
-
-	void RVKSwapChain::CreateFramebuffers() {
-		m_swapChainFramebuffers.resize(ImageCount());
-		for (size_t i = 0; i < ImageCount(); i++) {
-			std::array<VkImageView, 2> attachments = { m_swapChainImageViews[i], m_depthImageViews[i] };
-
-			VkExtent2D swapChainExtent = GetSwapChainExtent();
-			VkFramebufferCreateInfo framebufferInfo = {};
-			framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
-			framebufferInfo.renderPass = m_renderPass;
-			framebufferInfo.attachmentCount = static_cast<u32>(attachments.size());
-			framebufferInfo.pAttachments = attachments.data();
-			framebufferInfo.width = swapChainExtent.width;
-			framebufferInfo.height = swapChainExtent.height;
-			framebufferInfo.layers = 1;
-
-			VkResult result = vkCreateFramebuffer(RVKDevice::s_rvkDevice->GetDevice(), &framebufferInfo, nullptr, &m_swapChainFramebuffers[i]);
-			VK_CHECK(result, "Failed to Create Framebuffer!");
-		}
-	}
-
-	void RVKSwapChain::CreateDepthResources() {
-		VkFormat depthFormat = FindDepthFormat();
-		m_swapChainDepthFormat = depthFormat;
-		VkExtent2D swapChainExtent = GetSwapChainExtent();
-
-		m_depthImages.resize(ImageCount());
-		m_depthImageMemorys.resize(ImageCount());
-		m_depthImageViews.resize(ImageCount());
-
-		for (int i = 0; i < m_depthImages.size(); i++) {
-			VkImageCreateInfo imageInfo{};
-			imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
-			imageInfo.imageType = VK_IMAGE_TYPE_2D;
-			imageInfo.extent.width = swapChainExtent.width;
-			imageInfo.extent.height = swapChainExtent.height;
-			imageInfo.extent.depth = 1;
-			imageInfo.mipLevels = 1;
-			imageInfo.arrayLayers = 1;
-			imageInfo.format = depthFormat;
-			imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
-			imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-			imageInfo.usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
-			imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
-			imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-			imageInfo.flags = 0;
-
-			RVKDevice::s_rvkDevice->CreateImageWithInfo(
-				imageInfo,
-				VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-				m_depthImages[i],
-				m_depthImageMemorys[i]);
-
-			VkImageViewCreateInfo viewInfo{};
-			viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
-			viewInfo.image = m_depthImages[i];
-			viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
-			viewInfo.format = depthFormat;
-			viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
-			viewInfo.subresourceRange.baseMipLevel = 0;
-			viewInfo.subresourceRange.levelCount = 1;
-			viewInfo.subresourceRange.baseArrayLayer = 0;
-			viewInfo.subresourceRange.layerCount = 1;
-
-			VkResult result = vkCreateImageView(RVKDevice::s_rvkDevice->GetDevice(), &viewInfo, nullptr, &m_depthImageViews[i]);
-			VK_CHECK(result, "Failed to Create Texture Image View!");
-		}
-	}
-
 	void RVKSwapChain::CreateSyncObjects() {
 		m_imageAvailableSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
 		m_renderFinishedSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
@@ -349,6 +214,19 @@ namespace RVK {
 		}
 	}
 
+	void RVKSwapChain::InheritSyncObjects(RVKSwapChain& previous) {
+		// the fences still guard the frames in flight, so they carry over instead of waiting for the device
+		m_imageAvailableSemaphores = std::move(previous.m_imageAvailableSemaphores);
+		m_renderFinishedSemaphores = std::move(previous.m_renderFinishedSemaphores);
+		m_inFlightFences = std::move(previous.m_inFlightFences);
+		m_currentFrame = previous.m_currentFrame;
+		previous.m_imageAvailableSemaphores.clear();
+		previous.m_renderFinishedSemaphores.clear();
+		previous.m_inFlightFences.clear();
+
+		m_imagesInFlight.resize(ImageCount(), VK_NULL_HANDLE);
+	}
+
 	VkSurfaceFormatKHR RVKSwapChain::ChooseSwapSurfaceFormat(
 		const std::vector<VkSurfaceFormatKHR>& availableFormats) {
 		for (const auto& availableFormat : availableFormats) {
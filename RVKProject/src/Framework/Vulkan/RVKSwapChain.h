@@ -13,8 +13,7 @@ namespace RVK {
 
 		NO_COPY(RVKSwapChain)
 
-		VkFramebuffer GetFrameBuffer(int index) { return m_swapChainFramebuffers[index]; }
-		VkRenderPass GetRenderPass() { return m_renderPass; }
+		VkImage GetImage(int index) { return m_swapChainImages[index]; }
 		VkImageView GetImageView(int index) { return m_swapChainImageViews[index]; }
 		size_t ImageCount() { return m_swapChainImages.size(); }
 		VkFormat GetSwapChainImageFormat() { return m_swapChainImageFormat; }
@@ -39,10 +38,8 @@ namespace RVK {
 		void Init();
 		void CreateSwapChain();
 		void CreateImageViews();
-		void CreateDepthResources();
-		void CreateRenderPass();
-		void CreateFramebuffers();
 		void CreateSyncObjects();
+		void InheritSyncObjects(RVKSwapChain& previous);
 
 		// Helper functions
 		VkSurfaceFormatKHR ChooseSwapSurfaceFormat(
@@ -55,12 +52,6 @@ namespace RVK {
 		VkFormat m_swapChainDepthFormat;
 		VkExtent2D m_swapChainExtent;
 
-		std::vector<VkFramebuffer> m_swapChainFramebuffers;
-		VkRenderPass m_renderPass;
-
-		std::vector<VkImage> m_depthImages;
-		std::vector<VkDeviceMemory> m_depthImageMemorys;
-		std::vector<VkImageView> m_depthImageViews;
 		std::vector<VkImage> m_swapChainImages;
 		std::vector<VkImageView> m_swapChainImageViews;
 
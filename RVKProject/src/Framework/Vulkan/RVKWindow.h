@@ -13,6 +13,7 @@ namespace RVK {
 		bool ShouldClose() { return glfwWindowShouldClose(m_window); }
 		VkExtent2D GetExtent() { return {static_cast<u32>(m_width), static_cast<u32>(m_height)}; }
 		bool WasWindowResized() { return m_framebufferResized; }
+		bool IsMinimized() { return m_width == 0 || m_height == 0; }
 		void ResetWindowResizedFlag() { m_framebufferResized = false; }
 		GLFWwindow *GetGLFWwindow() const { return m_window; }
 
@@ -0,0 +1,149 @@
+#include "Framework/Vulkan/RenderSystem/entity_depth_prepass_system.h"
+#include "Framework/Vulkan/RenderSystem/entity_render_system.h"
+
+#include "Framework/Vulkan/RVKDevice.h"
+#include "Framework/Component.h"
+
+#include <optional>
+
+namespace RVK {
+	EntityDepthPrepassSystem::EntityDepthPrepassSystem(VkRenderPass renderPass, std::vector<VkDescriptorSetLayout> globalSetLayouts) {
+		CreatePipelineLayout(globalSetLayouts);
+		CreatePipelines(renderPass);
+	}
+
+	EntityDepthPrepassSystem::~EntityDepthPrepassSystem() {
+		vkDestroyPipelineLayout(RVKDevice::s_rvkDevice->GetDevice(), m_pipelineLayout, nullptr);
+	}
+
+	void EntityDepthPrepassSystem::CreatePipelineLayout(std::vector<VkDescriptorSetLayout> globalSetLayouts) {
+		VkPushConstantRange pushConstantRange{};
+		pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+		pushConstantRange.offset = 0;
+		pushConstantRange.size = sizeof(EntityPushConstantData);
+
+		VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+		pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+		pipelineLayoutInfo.setLayoutCount = static_cast<u32>(globalSetLayouts.size());
+		pipelineLayoutInfo.pSetLayouts = globalSetLayouts.data();
+		pipelineLayoutInfo.pushConstantRangeCount = 1;
+		pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+
+		VkResult result = vkCreatePipelineLayout(RVKDevice::s_rvkDevice->GetDevice(), &pipelineLayoutInfo, nullptr, &m_pipelineLayout);
+		VK_CHECK(result, "Failed to Create Pipeline Layout!");
+	}
+
+	void EntityDepthPrepassSystem::CreatePipelines(VkRenderPass renderPass) {
+		VK_ASSERT(m_pipelineLayout != nullptr, "Cannot Create Pipeline before Pipeline Layout!");
+
+		for (u32 format = 0; format < static_cast<u32>(VertexFormat::Count); format++) {
+			VertexFormat vertexFormat = static_cast<VertexFormat>(format);
+
+			// depth only render pass, nothing to blend
+			PipelineConfigInfo opaqueConfig{};
+			RVKPipeline::DefaultPipelineConfigInfo(opaqueConfig);
+			opaqueConfig.colorBlendInfo.attachmentCount = 0;
+			if (vertexFormat == VertexFormat::Compressed) {
+				// unorm positions come out of the shader input as floats, no decode needed
+				opaqueConfig.bindingDescriptions = CompressedVertex::GetBindingDescriptions();
+				opaqueConfig.attributeDescriptions = CompressedVertex::GetPositionAttributeDescriptions();
+			}
+			else {
+				opaqueConfig.bindingDescriptions = Vertex::GetPositionBindingDescriptions();
+				opaqueConfig.attributeDescriptions = Vertex::GetPositionAttributeDescriptions();
+			}
+			opaqueConfig.renderPass = renderPass;
+			opaqueConfig.pipelineLayout = m_pipelineLayout;
+			m_opaquePipelines[format] = std::make_unique<RVKPipeline>(
+				"shaders/depth_prepass.vert.spv",
+				"",
+				opaqueConfig
+			);
+
+			PipelineConfigInfo alphaTestConfig{};
+			RVKPipeline::DefaultPipelineConfigInfo(alphaTestConfig);
+			RVKPipeline::SetVertexFormat(alphaTestConfig, vertexFormat);
+			alphaTestConfig.colorBlendInfo.attachmentCount = 0;
+			alphaTestConfig.renderPass = renderPass;
+			alphaTestConfig.pipelineLayout = m_pipelineLayout;
+			m_alphaTestPipelines[format] = std::make_unique<RVKPipeline>(
+				"shaders/depth_prepass_alpha.vert.spv",
+				"shaders/depth_prepass_alpha.frag.spv",
+				alphaTestConfig
+			);
+		}
+	}
+
+	void EntityDepthPrepassSystem::Render(FrameInfo& frameInfo, entt::registry& registry) {
+		auto view = registry.view<Components::Model, Components::WorldTransform>();
+
+		auto pushConstants = [&](Components::Model& mesh, Components::WorldTransform& transform) {
+			// same matrix as the main pass, the EQUAL test needs identical math
+			EntityPushConstantData push{};
+			push.modelMatrix = transform.meshMatrix * mesh.model->GetPositionDecode();
+			push.normalMatrix = transform.meshNormalMatrix;
+
+			vkCmdPushConstants(
+				frameInfo.commandBuffer,
+				m_pipelineLayout,
+				VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
+				0,
+				sizeof(EntityPushConstantData),
+				&push);
+		};
+
+		// opaque meshes first, they are the cheap ones and fill most of the depth buffer
+		m_opaquePipelines[static_cast<size_t>(VertexFormat::Full)]->Bind(frameInfo.commandBuffer);
+		VertexFormat boundFormat = VertexFormat::Full;
+		vkCmdBindDescriptorSets(
+			frameInfo.commandBuffer,
+			VK_PIPELINE_BIND_POINT_GRAPHICS,
+			m_pipelineLayout,
+			0,
+			1,
+			&frameInfo.globalDescriptorSet,
+			0,
+			nullptr);
+
+		// every model lives in the geometry arena, buffers only change with the format or index type
+		std::optional<RVKGeometryArena::Binding> boundGeometry;
+		for (auto entity : view) {
+			auto& mesh = view.get<Components::Model>(entity);
+			auto& transform = view.get<Components::WorldTransform>(entity);
+			if (mesh.model == nullptr) continue;
+
+			if (mesh.model->GetVertexFormat() != boundFormat) {
+				boundFormat = mesh.model->GetVertexFormat();
+				m_opaquePipelines[static_cast<size_t>(boundFormat)]->Bind(frameInfo.commandBuffer);
+			}
+
+			pushConstants(mesh, transform);
+			if (boundGeometry != mesh.model->GetGeometryBinding()) {
+				boundGeometry = mesh.model->GetGeometryBinding();
+				mesh.model->BindPositions(frameInfo.commandBuffer);
+			}
+			mesh.model->DrawOpaque(frameInfo.commandBuffer, mesh.lod, &mesh.visibleMeshlets);
+		}
+
+		bool alphaTestBound = false;
+		boundGeometry.reset();
+		for (auto entity : view) {
+			auto& mesh = view.get<Components::Model>(entity);
+			auto& transform = view.get<Components::WorldTransform>(entity);
+			if (mesh.model == nullptr || !mesh.model->HasAlphaTestedMeshes()) continue;
+
+			if (!alphaTestBound || mesh.model->GetVertexFormat() != boundFormat) {
+				boundFormat = mesh.model->GetVertexFormat();
+				m_alphaTestPipelines[static_cast<size_t>(boundFormat)]->Bind(frameInfo.commandBuffer);
+				alphaTestBound = true;
+			}
+
+			pushConstants(mesh, transform);
+			if (boundGeometry != mesh.model->GetGeometryBinding()) {
+				boundGeometry = mesh.model->GetGeometryBinding();
+				mesh.model->Bind(frameInfo.commandBuffer);
+			}
+			mesh.model->DrawAlphaTested(frameInfo, m_pipelineLayout, mesh.lod, &mesh.visibleMeshlets);
+		}
+	}
+}  // namespace RVK
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <EnTT/entt.hpp>
+
+#include "Framework/Vulkan/RVKPipeline.h"
+#include "Framework/MeshModel.h"
+
+namespace RVK {
+	// Lays down the scene depth before the main pass.
+	// Opaque meshes only fetch positions, meshes that need the alpha test run a cut down fragment shader.
+	class EntityDepthPrepassSystem {
+	public:
+		EntityDepthPrepassSystem(VkRenderPass renderPass, std::vector<VkDescriptorSetLayout> globalSetLayouts);
+		~EntityDepthPrepassSystem();
+
+		NO_COPY(EntityDepthPrepassSystem)
+
+		void Render(FrameInfo& frameInfo, entt::registry& registry);
+
+	private:
+		void CreatePipelineLayout(std::vector<VkDescriptorSetLayout> globalSetLayouts);
+		void CreatePipelines(VkRenderPass renderPass);
+
+		// one per VertexFormat
+		std::array<std::unique_ptr<RVKPipeline>, static_cast<size_t>(VertexFormat::Count)> m_opaquePipelines;
+		std::array<std::unique_ptr<RVKPipeline>, static_cast<size_t>(VertexFormat::Count)> m_alphaTestPipelines;
+		VkPipelineLayout m_pipelineLayout;
+	};
+}  // namespace RVK
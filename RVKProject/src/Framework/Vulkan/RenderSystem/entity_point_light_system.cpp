@@ -3,6 +3,7 @@
 #include "Framework/Vulkan/RVKDevice.h"
 //#include "Framework/Vulkan/FrameInfo.h"
 #include "Framework/Component.h"
+#include "Framework/SystemScheduler.h"
 
 namespace RVK {
 	struct PointLightPushConstants {
@@ -56,8 +57,18 @@ namespace RVK {
 		);
 	}
 
-	void EntityPointLightSystem::Update(FrameInfo& frameInfo, GlobalUbo& ubo, entt::registry& registry) {
-		auto rotateLight = glm::rotate(glm::mat4(1.f), 0.5f * frameInfo.frameTime, { 0.f, -1.f, 0.f });
+	void EntityPointLightSystem::Animate(float frameTime, entt::registry& registry) {
+		auto rotateLight = glm::rotate(glm::mat4(1.f), 0.5f * frameTime, { 0.f, -1.f, 0.f });
+
+		// every light only moves itself
+		auto view = registry.view<Components::PointLight, Components::Transform>();
+		ParallelForEach(view, [&](entt::entity entity) {
+			auto& transform = view.get<Components::Transform>(entity);
+			transform.SetPosition(glm::vec3(rotateLight * glm::vec4(transform.GetPosition(), 1.f)));
+		});
+	}
+
+	void EntityPointLightSystem::Update(GlobalUbo& ubo, entt::registry& registry) {
 		int lightIndex = 0;
 
 		auto view = registry.view<Components::PointLight, Components::Transform>();
@@ -67,10 +78,9 @@ namespace RVK {
 			auto& transform = view.get<Components::Transform>(entity);
 
 			assert(lightIndex < MAX_LIGHTS && "Point lights exceed maximum specified");
-			transform.position = glm::vec3(rotateLight * glm::vec4(transform.position, 1.f));
 
-			//copy light to ubo
-			ubo.pointLights[lightIndex].position = glm::vec4(transform.position, 1.f);
+			//copy light to ubo, lights are roots so the local position is where they are
+			ubo.pointLights[lightIndex].position = glm::vec4(transform.GetPosition(), 1.f);
 			ubo.pointLights[lightIndex].color = glm::vec4(pointLight.color, pointLight.lightIntensity);
 
 			lightIndex += 1;
@@ -97,7 +107,7 @@ namespace RVK {
 			auto& transform = view.get<Components::Transform>(entity);
 
 			PointLightPushConstants push{};
-			push.position = glm::vec4(transform.position, 1.f);
+			push.position = glm::vec4(transform.GetPosition(), 1.f);
 			push.color = glm::vec4(pointLight.color, pointLight.lightIntensity);
 
 			push.radius = pointLight.radius;
@@ -13,7 +13,9 @@ namespace RVK {
 
 		NO_COPY(EntityPointLightSystem)
 
-		void Update(FrameInfo& frameInfo, GlobalUbo& ubo, entt::registry& registry);
+		// moves the lights, before the transforms are updated
+		void Animate(float frameTime, entt::registry& registry);
+		void Update(GlobalUbo& ubo, entt::registry& registry);
 		void Render(FrameInfo& frameInfo, entt::registry& registry);
 
 	private:
@@ -2,13 +2,11 @@
 
 #include "Framework/Vulkan/RVKDevice.h"
 #include "Framework/Component.h"
+#include "Framework/Parallel.h"
 
-namespace RVK {
-	struct EntityPushConstantData {
-		glm::mat4 modelMatrix{ 1.f };
-		glm::mat4 normalMatrix{ 1.f };
-	};
+#include <optional>
 
+namespace RVK {
 	EntityRenderSystem::EntityRenderSystem(VkRenderPass renderPass, std::vector<VkDescriptorSetLayout> globalSetLayout) {
 		CreatePipelineLayout(globalSetLayout);
 		CreatePipeline(renderPass);
@@ -40,19 +38,129 @@ namespace RVK {
 	void EntityRenderSystem::CreatePipeline(VkRenderPass renderPass) {
 		VK_ASSERT(m_pipelineLayout != nullptr, "Cannot Create Pipeline before Pipeline Layout!");
 
-		PipelineConfigInfo pipelineConfig{};
-		RVKPipeline::DefaultPipelineConfigInfo(pipelineConfig);
-		pipelineConfig.renderPass = renderPass;
-		pipelineConfig.pipelineLayout = m_pipelineLayout;
-		m_rvkPipeline = std::make_unique<RVKPipeline>(
-			"shaders/simple_shader.vert.spv",
-			"shaders/simple_shader.frag.spv",
-			pipelineConfig
-		);
+		for (u32 format = 0; format < static_cast<u32>(VertexFormat::Count); format++) {
+			VertexFormat vertexFormat = static_cast<VertexFormat>(format);
+
+			PipelineConfigInfo pipelineConfig{};
+			RVKPipeline::DefaultPipelineConfigInfo(pipelineConfig);
+			RVKPipeline::SetVertexFormat(pipelineConfig, vertexFormat);
+			pipelineConfig.renderPass = renderPass;
+			pipelineConfig.pipelineLayout = m_pipelineLayout;
+			m_rvkPipelines[format] = std::make_unique<RVKPipeline>(
+				"shaders/simple_shader.vert.spv",
+				"shaders/simple_shader.frag.spv",
+				pipelineConfig
+			);
+
+			PipelineConfigInfo depthEqualConfig{};
+			RVKPipeline::DefaultPipelineConfigInfo(depthEqualConfig);
+			RVKPipeline::SetVertexFormat(depthEqualConfig, vertexFormat);
+			depthEqualConfig.depthStencilInfo.depthWriteEnable = VK_FALSE;
+			depthEqualConfig.depthStencilInfo.depthCompareOp = VK_COMPARE_OP_EQUAL;
+			RVKPipeline::AddSpecializationConstant(depthEqualConfig, 0, VK_FALSE); // ALPHA_TEST
+			depthEqualConfig.renderPass = renderPass;
+			depthEqualConfig.pipelineLayout = m_pipelineLayout;
+			m_depthEqualPipelines[format] = std::make_unique<RVKPipeline>(
+				"shaders/simple_shader.vert.spv",
+				"shaders/simple_shader.frag.spv",
+				depthEqualConfig
+			);
+		}
+	}
+
+	void EntityRenderSystem::Update(const GlobalUbo& ubo, VkExtent2D renderExtent, entt::registry& registry) {
+		// pixels covered by one unit one unit away from the camera
+		float pixelsPerUnit = std::abs(ubo.projection[1][1]) * 0.5f * static_cast<float>(renderExtent.height);
+		glm::mat4 viewProjection = ubo.projection * ubo.view;
+		glm::vec3 cameraPosition = glm::vec3(ubo.inverseView[3]);
+
+		struct CullJob {
+			Components::Model* mesh;
+			glm::mat4 modelMatrix;
+		};
+		std::vector<CullJob> cullJobs;
+		u32 cullMeshlets = 0;
+
+		auto view = registry.view<Components::Model, Components::WorldTransform>();
+		for (auto entity : view) {
+			auto& mesh = view.get<Components::Model>(entity);
+			auto& transform = view.get<Components::WorldTransform>(entity);
+			mesh.visibleMeshlets.Clear();
+			// still loading, the passes skip models without a MeshModel
+			if (!mesh.IsResident()) {
+				mesh.lod = 0;
+				continue;
+			}
+
+			const glm::mat4& modelMatrix = transform.meshMatrix;
+			float scale = std::max({ glm::length(glm::vec3(modelMatrix[0])), glm::length(glm::vec3(modelMatrix[1])),
+				glm::length(glm::vec3(modelMatrix[2])) });
+
+			// projected size at the nearest point of the bounding sphere
+			glm::vec3 boundsMin = mesh.model->GetBoundsMin();
+			glm::vec3 boundsMax = mesh.model->GetBoundsMax();
+			glm::vec4 center = ubo.view * modelMatrix * glm::vec4(0.5f * (boundsMin + boundsMax), 1.0f);
+			float radius = 0.5f * glm::length(boundsMax - boundsMin) * scale;
+			float distance = std::max(glm::length(glm::vec3(center)) - radius, 1e-3f);
+			float pixelsPerModelUnit = scale * pixelsPerUnit / distance;
+			// textures are assumed to stretch over the whole model once
+			mesh.model->RequestTextureMips(glm::length(boundsMax - boundsMin) * pixelsPerModelUnit);
+
+			if (mesh.model->GetLodCount() <= 1) {
+				mesh.lod = 0;
+				if (mesh.model->HasMeshlets()) {
+					cullJobs.push_back({ &mesh, modelMatrix });
+				}
+				continue;
+			}
+
+			auto pixelError = [&](u32 lod) { return mesh.model->GetLodError(lod) * pixelsPerModelUnit; };
+
+			u32 lodCount = mesh.model->GetLodCount();
+			u32 lod = std::min(mesh.lod, lodCount - 1);
+			while (lod > 0 && pixelError(lod) > LOD_PIXEL_ERROR) {
+				lod--;
+			}
+			while (lod + 1 < lodCount && pixelError(lod + 1) <= LOD_PIXEL_ERROR * LOD_HYSTERESIS) {
+				lod++;
+			}
+			mesh.lod = lod;
+
+			// the simplified levels are drawn whole
+			if (lod == 0 && mesh.model->HasMeshlets()) {
+				cullJobs.push_back({ &mesh, modelMatrix });
+			}
+		}
+
+		for (const CullJob& job : cullJobs) {
+			cullMeshlets += job.mesh->model->GetMeshletCount();
+		}
+		auto cull = [&](u32 i) {
+			const CullJob& job = cullJobs[i];
+			MeshletCullView cullView = MeshletCullView::Create(viewProjection * job.modelMatrix, job.modelMatrix, cameraPosition);
+			job.mesh->model->CullMeshlets(cullView, job.mesh->visibleMeshlets);
+		};
+		if (cullMeshlets >= PARALLEL_CULL_MESHLETS) {
+			ParallelFor(static_cast<u32>(cullJobs.size()), cull);
+		}
+		else {
+			for (u32 i = 0; i < cullJobs.size(); i++) {
+				cull(i);
+			}
+		}
+
+		m_visibleMeshlets = 0;
+		m_testedMeshlets = 0;
+		for (const CullJob& job : cullJobs) {
+			m_visibleMeshlets += job.mesh->visibleMeshlets.visibleMeshlets;
+			m_testedMeshlets += job.mesh->visibleMeshlets.totalMeshlets;
+		}
 	}
 
 	void EntityRenderSystem::RenderEntities(FrameInfo& frameInfo, entt::registry& registry) {
-		m_rvkPipeline->Bind(frameInfo.commandBuffer);
+		auto& pipelines = m_depthPrepass ? m_depthEqualPipelines : m_rvkPipelines;
+		pipelines[static_cast<size_t>(VertexFormat::Full)]->Bind(frameInfo.commandBuffer);
+		VertexFormat boundFormat = VertexFormat::Full;
 
 		vkCmdBindDescriptorSets(
 			frameInfo.commandBuffer,
@@ -86,15 +194,24 @@ namespace RVK {
 			static_cast<Model*>(mesh.model.get())->Draw(frameInfo.commandBuffer);
 		}*/
 
-		auto view2 = registry.view<Components::Model, Components::Transform>();
+		// every model lives in the geometry arena, buffers only change with the format or index type
+		std::optional<RVKGeometryArena::Binding> boundGeometry;
+		auto view2 = registry.view<Components::Model, Components::WorldTransform>();
 		for (auto entity : view2) {
 			auto& mesh = view2.get<Components::Model>(entity);
-			auto& transform = view2.get<Components::Transform>(entity);
+			auto& transform = view2.get<Components::WorldTransform>(entity);
 
 			if (mesh.model == nullptr) continue;
+
+			// the layouts match, so the global set stays bound across the switch
+			if (mesh.model->GetVertexFormat() != boundFormat) {
+				boundFormat = mesh.model->GetVertexFormat();
+				pipelines[static_cast<size_t>(boundFormat)]->Bind(frameInfo.commandBuffer);
+			}
+
 			EntityPushConstantData push{};
-			push.modelMatrix = mesh.offset.GetTransform() * transform.GetTransform();
-			push.normalMatrix = mesh.offset.NormalMatrix() * transform.NormalMatrix();
+			push.modelMatrix = transform.meshMatrix * mesh.model->GetPositionDecode();
+			push.normalMatrix = transform.meshNormalMatrix;
 
 			vkCmdPushConstants(
 				frameInfo.commandBuffer,
@@ -104,8 +221,11 @@ namespace RVK {
 				sizeof(EntityPushConstantData),
 				&push);
 
-			static_cast<MeshModel*>(mesh.model.get())->Bind(frameInfo, m_pipelineLayout);
-			static_cast<MeshModel*>(mesh.model.get())->Draw(frameInfo, m_pipelineLayout);
+			if (boundGeometry != mesh.model->GetGeometryBinding()) {
+				boundGeometry = mesh.model->GetGeometryBinding();
+				mesh.model->Bind(frameInfo.commandBuffer);
+			}
+			static_cast<MeshModel*>(mesh.model.get())->Draw(frameInfo, m_pipelineLayout, mesh.lod, &mesh.visibleMeshlets);
 		}
 	}
 }  // namespace RVK
@@ -3,8 +3,14 @@
 #include <EnTT/entt.hpp>
 
 #include "Framework/Vulkan/RVKPipeline.h"
+#include "Framework/MeshModel.h"
 
 namespace RVK {
+	struct EntityPushConstantData {
+		glm::mat4 modelMatrix{ 1.f };
+		glm::mat4 normalMatrix{ 1.f };
+	};
+
 	class EntityRenderSystem {
 	public:
 		EntityRenderSystem(VkRenderPass renderPass, std::vector<VkDescriptorSetLayout> globalSetLayouts);
@@ -12,13 +18,35 @@ namespace RVK {
 
 		NO_COPY(EntityRenderSystem)
 
+		// picks the lod of every model and culls the meshlets of the full detail ones,
+		// before the depth prepass so both passes draw the same triangles.
+		// Models the AssetLoader finished become visible here.
+		void Update(const GlobalUbo& ubo, VkExtent2D renderExtent, entt::registry& registry);
 		void RenderEntities(FrameInfo& frameInfo, entt::registry& registry);
+		// with a depth prepass the depth buffer is already final, so only the EQUAL fragments get shaded
+		void SetDepthPrepass(bool enabled) { m_depthPrepass = enabled; }
+
+		// meshlets that passed culling in the last Update and all the ones that were tested
+		u32 GetVisibleMeshlets() const { return m_visibleMeshlets; }
+		u32 GetTestedMeshlets() const { return m_testedMeshlets; }
 
 	private:
+		// coarsest lod whose error stays under this many pixels
+		static constexpr float LOD_PIXEL_ERROR = 1.0f;
+		// a coarser lod has to beat the limit by this factor, so models near it don't flicker between two
+		static constexpr float LOD_HYSTERESIS = 0.75f;
+		// below this many meshlets a frame the threads cost more than the culling
+		static constexpr u32 PARALLEL_CULL_MESHLETS = 16384;
+
 		void CreatePipelineLayout(std::vector<VkDescriptorSetLayout> globalSetLayout);
 		void CreatePipeline(VkRenderPass renderPass);
 
-		std::unique_ptr<RVKPipeline> m_rvkPipeline;
+		// one per VertexFormat
+		std::array<std::unique_ptr<RVKPipeline>, static_cast<size_t>(VertexFormat::Count)> m_rvkPipelines;
+		std::array<std::unique_ptr<RVKPipeline>, static_cast<size_t>(VertexFormat::Count)> m_depthEqualPipelines;
 		VkPipelineLayout m_pipelineLayout;
+		bool m_depthPrepass = false;
+		u32 m_visibleMeshlets = 0;
+		u32 m_testedMeshlets = 0;
 	};
 }  // namespace RVK
@@ -0,0 +1,283 @@
+#include "Framework/Vulkan/RenderSystem/temporal_upscale_system.h"
+
+#include "Framework/Vulkan/RVKDevice.h"
+
+namespace RVK {
+	namespace {
+		// weight of the new frame, the rest comes from the history
+		constexpr float CURRENT_FRAME_WEIGHT = 0.1f;
+		constexpr u32 JITTER_SEQUENCE_LENGTH = 8;
+
+		struct TemporalUpscaleUbo {
+			glm::mat4 invViewProjection{ 1.f };
+			glm::mat4 prevViewProjection{ 1.f };
+			glm::vec4 renderSize{};  // xy rendered size in pixels, zw 1 / scene image size
+			glm::vec4 outputSize{};  // xy output size in pixels, zw 1 / output size
+			glm::vec4 jitter{};      // xy jitter in render pixels, z current frame weight, w history valid
+		};
+
+		float Halton(u32 index, u32 base) {
+			float fraction = 1.0f;
+			float result = 0.0f;
+			while (index > 0) {
+				fraction /= static_cast<float>(base);
+				result += fraction * static_cast<float>(index % base);
+				index /= base;
+			}
+			return result;
+		}
+	}
+
+	TemporalUpscaleSystem::TemporalUpscaleSystem(VkRenderPass renderPass) {
+		CreateDescriptors();
+		CreatePipelineLayout();
+		CreatePipeline(renderPass);
+		CreateSampler();
+	}
+
+	TemporalUpscaleSystem::~TemporalUpscaleSystem() {
+		DestroyHistory();
+		RVKDevice::s_rvkDevice->DeferDestroy([sampler = m_sampler]() {
+			vkDestroySampler(RVKDevice::s_rvkDevice->GetDevice(), sampler, nullptr);
+		});
+		vkDestroyPipelineLayout(RVKDevice::s_rvkDevice->GetDevice(), m_pipelineLayout, nullptr);
+	}
+
+	void TemporalUpscaleSystem::CreateDescriptors() {
+		m_setLayout = RVKDescriptorSetLayout::Builder()
+			.AddBinding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_SHADER_STAGE_FRAGMENT_BIT)
+			.AddBinding(1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT) // scene color
+			.AddBinding(2, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT) // scene depth
+			.AddBinding(3, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT) // history
+			.Build();
+
+		m_descriptorPool = RVKDescriptorPool::Builder()
+			.SetMaxSets(MAX_FRAMES_IN_FLIGHT)
+			.AddPoolSize(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, MAX_FRAMES_IN_FLIGHT)
+			.AddPoolSize(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, MAX_FRAMES_IN_FLIGHT * 3)
+			.Build();
+
+		// the inputs change with the graph and the history every frame, so each frame in flight
+		// gets its own set that is rewritten once the frame's fence has been waited on
+		m_descriptorSets.resize(MAX_FRAMES_IN_FLIGHT);
+		m_uboBuffers.resize(MAX_FRAMES_IN_FLIGHT);
+		for (int i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+			bool success = m_descriptorPool->AllocateDescriptor(m_setLayout->GetDescriptorSetLayout(), m_descriptorSets[i]);
+			VK_ASSERT(success, "Failed to Allocate Temporal Upscale Descriptor Set!");
+
+			m_uboBuffers[i] = std::make_unique<RVKBuffer>(
+				sizeof(TemporalUpscaleUbo),
+				1,
+				VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+				VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+			m_uboBuffers[i]->Map();
+		}
+	}
+
+	void TemporalUpscaleSystem::CreatePipelineLayout() {
+		VkDescriptorSetLayout setLayout = m_setLayout->GetDescriptorSetLayout();
+
+		VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+		pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+		pipelineLayoutInfo.setLayoutCount = 1;
+		pipelineLayoutInfo.pSetLayouts = &setLayout;
+		pipelineLayoutInfo.pushConstantRangeCount = 0;
+		pipelineLayoutInfo.pPushConstantRanges = nullptr;
+
+		VkResult result = vkCreatePipelineLayout(RVKDevice::s_rvkDevice->GetDevice(), &pipelineLayoutInfo, nullptr, &m_pipelineLayout);
+		VK_CHECK(result, "Failed to Create Pipeline Layout!");
+	}
+
+	void TemporalUpscaleSystem::CreatePipeline(VkRenderPass renderPass) {
+		VK_ASSERT(m_pipelineLayout != nullptr, "Cannot Create Pipeline before Pipeline Layout!");
+
+		PipelineConfigInfo pipelineConfig{};
+		RVKPipeline::DefaultPipelineConfigInfo(pipelineConfig);
+		pipelineConfig.attributeDescriptions.clear();
+		pipelineConfig.bindingDescriptions.clear();
+		pipelineConfig.depthStencilInfo.depthTestEnable = VK_FALSE;
+		pipelineConfig.depthStencilInfo.depthWriteEnable = VK_FALSE;
+
+		// back buffer and history get the same result
+		std::array<VkPipelineColorBlendAttachmentState, 2> blendAttachments{
+			pipelineConfig.colorBlendAttachment,
+			pipelineConfig.colorBlendAttachment };
+		pipelineConfig.colorBlendInfo.attachmentCount = static_cast<u32>(blendAttachments.size());
+		pipelineConfig.colorBlendInfo.pAttachments = blendAttachments.data();
+
+		pipelineConfig.renderPass = renderPass;
+		pipelineConfig.pipelineLayout = m_pipelineLayout;
+		m_rvkPipeline = std::make_unique<RVKPipeline>(
+			"shaders/temporal_upscale.vert.spv",
+			"shaders/temporal_upscale.frag.spv",
+			pipelineConfig
+		);
+	}
+
+	void TemporalUpscaleSystem::CreateSampler() {
+		VkSamplerCreateInfo samplerInfo{};
+		samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+		samplerInfo.magFilter = VK_FILTER_LINEAR;
+		samplerInfo.minFilter = VK_FILTER_LINEAR;
+		samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+		samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+		samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+		samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+		samplerInfo.anisotropyEnable = VK_FALSE;
+		samplerInfo.maxAnisotropy = 1.0f;
+		samplerInfo.borderColor = VK_BORDER_COLOR_FLOAT_OPAQUE_BLACK;
+		samplerInfo.unnormalizedCoordinates = VK_FALSE;
+		samplerInfo.compareEnable = VK_FALSE;
+		samplerInfo.minLod = 0.0f;
+		samplerInfo.maxLod = 0.0f;
+
+		VkResult result = vkCreateSampler(RVKDevice::s_rvkDevice->GetDevice(), &samplerInfo, nullptr, &m_sampler);
+		VK_CHECK(result, "Failed to Create Temporal Upscale Sampler!");
+	}
+
+	void TemporalUpscaleSystem::CreateHistory(VkCommandBuffer commandBuffer, VkExtent2D extent) {
+		std::array<VkImageMemoryBarrier, 2> barriers{};
+		for (size_t i = 0; i < m_history.size(); i++) {
+			HistoryImage& history = m_history[i];
+
+			VkImageCreateInfo imageInfo{};
+			imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+			imageInfo.imageType = VK_IMAGE_TYPE_2D;
+			imageInfo.extent.width = extent.width;
+			imageInfo.extent.height = extent.height;
+			imageInfo.extent.depth = 1;
+			imageInfo.mipLevels = 1;
+			imageInfo.arrayLayers = 1;
+			imageInfo.format = HISTORY_FORMAT;
+			imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+			imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+			imageInfo.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+			imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+			imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+			RVKDevice::s_rvkDevice->CreateImageWithInfo(imageInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, history.image, history.memory);
+
+			VkImageViewCreateInfo viewInfo{};
+			viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+			viewInfo.image = history.image;
+			viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+			viewInfo.format = HISTORY_FORMAT;
+			viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+			viewInfo.subresourceRange.baseMipLevel = 0;
+			viewInfo.subresourceRange.levelCount = 1;
+			viewInfo.subresourceRange.baseArrayLayer = 0;
+			viewInfo.subresourceRange.layerCount = 1;
+
+			VkResult result = vkCreateImageView(RVKDevice::s_rvkDevice->GetDevice(), &viewInfo, nullptr, &history.view);
+			VK_CHECK(result, "Failed to Create History Image View!");
+
+			// the graph expects both images in the layout the last frame left them in
+			barriers[i].sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+			barriers[i].srcAccessMask = 0;
+			barriers[i].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+			barriers[i].oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+			barriers[i].newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+			barriers[i].srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barriers[i].dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barriers[i].image = history.image;
+			barriers[i].subresourceRange = viewInfo.subresourceRange;
+		}
+
+		vkCmdPipelineBarrier(
+			commandBuffer,
+			VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+			VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+			0,
+			0, nullptr,
+			0, nullptr,
+			static_cast<u32>(barriers.size()), barriers.data());
+
+		m_historyExtent = extent;
+		m_historyValid = false;
+	}
+
+	void TemporalUpscaleSystem::DestroyHistory() {
+		for (HistoryImage& history : m_history) {
+			if (history.image == VK_NULL_HANDLE) {
+				continue;
+			}
+
+			RVKDevice::s_rvkDevice->DeferDestroy([history]() {
+				vkDestroyImageView(RVKDevice::s_rvkDevice->GetDevice(), history.view, nullptr);
+				vkDestroyImage(RVKDevice::s_rvkDevice->GetDevice(), history.image, nullptr);
+				vkFreeMemory(RVKDevice::s_rvkDevice->GetDevice(), history.memory, nullptr);
+			});
+			history = {};
+		}
+		m_historyExtent = { 0, 0 };
+	}
+
+	void TemporalUpscaleSystem::Prepare(FrameInfo& frameInfo, RVKRenderGraph& renderGraph, RGResource historyRead, RGResource historyWrite) {
+		VkExtent2D extent = renderGraph.GetExtent();
+		if (extent.width != m_historyExtent.width || extent.height != m_historyExtent.height) {
+			DestroyHistory();
+			CreateHistory(frameInfo.commandBuffer, extent);
+		}
+
+		m_historyIndex ^= 1;
+		m_jitterIndex = (m_jitterIndex + 1) % JITTER_SEQUENCE_LENGTH;
+
+		const HistoryImage& read = m_history[m_historyIndex ^ 1];
+		const HistoryImage& write = m_history[m_historyIndex];
+		renderGraph.SetImportedImage(historyRead, read.image, read.view, m_historyExtent);
+		renderGraph.SetImportedImage(historyWrite, write.image, write.view, m_historyExtent);
+	}
+
+	glm::vec2 TemporalUpscaleSystem::GetJitter() const {
+		// Halton(2, 3) covers the pixel evenly over a short sequence
+		return glm::vec2(Halton(m_jitterIndex + 1, 2), Halton(m_jitterIndex + 1, 3)) - 0.5f;
+	}
+
+	void TemporalUpscaleSystem::Render(FrameInfo& frameInfo, const Inputs& inputs) {
+		TemporalUpscaleUbo ubo{};
+		ubo.invViewProjection = glm::inverse(inputs.viewProjection);
+		ubo.prevViewProjection = m_prevViewProjection;
+		ubo.renderSize = glm::vec4(
+			static_cast<float>(inputs.renderExtent.width),
+			static_cast<float>(inputs.renderExtent.height),
+			1.0f / static_cast<float>(inputs.sceneExtent.width),
+			1.0f / static_cast<float>(inputs.sceneExtent.height));
+		ubo.outputSize = glm::vec4(
+			static_cast<float>(m_historyExtent.width),
+			static_cast<float>(m_historyExtent.height),
+			1.0f / static_cast<float>(m_historyExtent.width),
+			1.0f / static_cast<float>(m_historyExtent.height));
+		ubo.jitter = glm::vec4(inputs.jitter, CURRENT_FRAME_WEIGHT, m_historyValid ? 1.0f : 0.0f);
+
+		RVKBuffer& uboBuffer = *m_uboBuffers[frameInfo.frameIndex];
+		uboBuffer.WriteToBuffer(&ubo);
+		uboBuffer.Flush();
+
+		auto bufferInfo = uboBuffer.DescriptorInfo();
+		VkDescriptorImageInfo colorInfo{ m_sampler, inputs.sceneColor, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+		VkDescriptorImageInfo depthInfo{ m_sampler, inputs.sceneDepth, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+		VkDescriptorImageInfo historyInfo{ m_sampler, m_history[m_historyIndex ^ 1].view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+
+		VkDescriptorSet& descriptorSet = m_descriptorSets[frameInfo.frameIndex];
+		RVKDescriptorWriter(*m_setLayout, *m_descriptorPool)
+			.WriteBuffer(0, &bufferInfo)
+			.WriteImage(1, &colorInfo)
+			.WriteImage(2, &depthInfo)
+			.WriteImage(3, &historyInfo)
+			.Overwrite(descriptorSet);
+
+		m_rvkPipeline->Bind(frameInfo.commandBuffer);
+		vkCmdBindDescriptorSets(
+			frameInfo.commandBuffer,
+			VK_PIPELINE_BIND_POINT_GRAPHICS,
+			m_pipelineLayout,
+			0,
+			1,
+			&descriptorSet,
+			0,
+			nullptr);
+		vkCmdDraw(frameInfo.commandBuffer, 3, 1, 0, 0);
+
+		m_prevViewProjection = inputs.viewProjection;
+		m_historyValid = true;
+	}
+}  // namespace RVK
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "Framework/Vulkan/RVKPipeline.h"
+#include "Framework/Vulkan/RVKBuffer.h"
+#include "Framework/Vulkan/RVKDescriptors.h"
+#include "Framework/Vulkan/RVKRenderGraph.h"
+
+namespace RVK {
+	// Resolves the jittered scene, rendered at a reduced size, into the full resolution back buffer.
+	// Motion vectors come from the depth and the camera matrices, so only camera motion gets
+	// reprojected correctly, moving objects rely on the neighborhood clamp.
+	class TemporalUpscaleSystem {
+	public:
+		static constexpr VkFormat HISTORY_FORMAT = VK_FORMAT_R16G16B16A16_SFLOAT;
+
+		struct Inputs {
+			VkImageView sceneColor = VK_NULL_HANDLE;
+			VkImageView sceneDepth = VK_NULL_HANDLE;
+			// size of the scene images and the top left part of them rendered this frame
+			VkExtent2D sceneExtent{ 0, 0 };
+			VkExtent2D renderExtent{ 0, 0 };
+			// in render pixels
+			glm::vec2 jitter{ 0.f };
+			// without the jitter
+			glm::mat4 viewProjection{ 1.f };
+		};
+
+		TemporalUpscaleSystem(VkRenderPass renderPass);
+		~TemporalUpscaleSystem();
+
+		NO_COPY(TemporalUpscaleSystem)
+
+		// (re)creates the history at the graph extent and hands this frame's pair to the graph
+		void Prepare(FrameInfo& frameInfo, RVKRenderGraph& renderGraph, RGResource historyRead, RGResource historyWrite);
+		void Render(FrameInfo& frameInfo, const Inputs& inputs);
+		// sub pixel offset of the current frame in render pixels, between -0.5 and 0.5
+		glm::vec2 GetJitter() const;
+		void ResetHistory() { m_historyValid = false; }
+
+	private:
+		struct HistoryImage {
+			VkImage image = VK_NULL_HANDLE;
+			VkDeviceMemory memory = VK_NULL_HANDLE;
+			VkImageView view = VK_NULL_HANDLE;
+		};
+
+		void CreateDescriptors();
+		void CreatePipelineLayout();
+		void CreatePipeline(VkRenderPass renderPass);
+		void CreateSampler();
+		void CreateHistory(VkCommandBuffer commandBuffer, VkExtent2D extent);
+		void DestroyHistory();
+
+		std::unique_ptr<RVKPipeline> m_rvkPipeline;
+		VkPipelineLayout m_pipelineLayout;
+		std::unique_ptr<RVKDescriptorSetLayout> m_setLayout;
+		std::unique_ptr<RVKDescriptorPool> m_descriptorPool;
+		std::vector<VkDescriptorSet> m_descriptorSets;
+		std::vector<std::unique_ptr<RVKBuffer>> m_uboBuffers;
+		VkSampler m_sampler;
+
+		std::array<HistoryImage, 2> m_history{};
+		VkExtent2D m_historyExtent{ 0, 0 };
+		// the history written this frame, the other one is read
+		u32 m_historyIndex = 0;
+		bool m_historyValid = false;
+		u32 m_jitterIndex = 0;
+		glm::mat4 m_prevViewProjection{ 1.f };
+	};
+}  // namespace RVK
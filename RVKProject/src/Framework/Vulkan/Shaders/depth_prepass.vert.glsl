@@ -0,0 +1,34 @@
+#version 450
+#pragma shader_stage(vertex)
+#extension GL_KHR_vulkan_glsl: enable
+
+#include "../SharedDefines.h"
+
+layout(location = 0) in vec3 position;
+
+struct PointLight {
+  vec4 position; // ignore w
+  vec4 color; // w is intensity
+};
+
+layout(set = 0, binding = 0) uniform GlobalUbo {
+  mat4 projection;
+  mat4 view;
+  mat4 invView;
+  vec4 ambientLightColor; // w is intensity
+  PointLight pointLights[MAX_LIGHTS];
+  int numLights;
+} ubo;
+
+layout(push_constant) uniform Push {
+  mat4 modelMatrix;
+  mat4 normalMatrix;
+} push;
+
+// must match simple_shader.vert bit for bit
+invariant gl_Position;
+
+void main() {
+  vec4 positionWorld = push.modelMatrix * vec4(position, 1.0);
+  gl_Position = ubo.projection * ubo.view * positionWorld;
+}
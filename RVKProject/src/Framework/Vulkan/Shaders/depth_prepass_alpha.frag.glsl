@@ -0,0 +1,54 @@
+#version 450
+#pragma shader_stage(fragment)
+#extension GL_KHR_vulkan_glsl: enable
+
+#include "../SharedDefines.h"
+
+layout (location = 0) in vec4 fragColor;
+layout (location = 1) in vec2 fragUV;
+
+layout (set = 1, binding = 0) uniform MaterialUbo {
+    int features;
+    float roughness;
+    float metallic;
+
+    // byte 16 to 31
+    vec4 diffuseColor;
+
+    // byte 32 to 47
+    vec3 emissiveColor;
+    float emissiveStrength;
+
+    // byte 48 to 63
+    float normalMapIntensity;
+    float spare1;
+    float spare2;
+    float spare3;
+
+    // byte 64 to 79
+    vec4 diffuseUVTransform;
+}matUbo;
+
+layout (set = 1, binding = 1) uniform sampler2D diffuseMap;
+
+// packed textures repeat inside their rect, the gradients of the unwrapped UV keep the mip selection smooth
+vec4 SampleDiffuse(vec2 uv) {
+    if(bool(matUbo.features & GLSL_HAS_DIFFUSE_ATLAS)) {
+        vec2 scale = matUbo.diffuseUVTransform.xy;
+        return textureGrad(diffuseMap, fract(uv) * scale + matUbo.diffuseUVTransform.zw, dFdx(uv) * scale, dFdy(uv) * scale);
+    }
+    return texture(diffuseMap, uv);
+}
+
+// same alpha test as simple_shader.frag, only for the meshes that need it
+void main() {
+    float alpha;
+    if(bool(matUbo.features & GLSL_HAS_DIFFUSE_MAP)) {
+        alpha = SampleDiffuse(fragUV).a * matUbo.diffuseColor.a;
+    }else{
+        alpha = fragColor.a;
+    }
+    if(alpha < 0.5) {
+        discard;
+    }
+}
@@ -0,0 +1,45 @@
+#version 450
+#pragma shader_stage(vertex)
+#extension GL_KHR_vulkan_glsl: enable
+
+#include "../SharedDefines.h"
+
+layout(location = 0) in vec3 position;
+layout(location = 1) in vec4 color;
+layout(location = 2) in vec3 normal;
+layout(location = 3) in vec2 uv;
+
+layout(location = 0) out vec4 fragColor;
+layout(location = 1) out vec2 fragUV;
+
+// alpha is stored linear in CompressedVertex, only rgb is gamma encoded
+layout(constant_id = COMPRESSED_VERTEX_CONSTANT_ID) const bool COMPRESSED_VERTEX = false;
+
+struct PointLight {
+  vec4 position; // ignore w
+  vec4 color; // w is intensity
+};
+
+layout(set = 0, binding = 0) uniform GlobalUbo {
+  mat4 projection;
+  mat4 view;
+  mat4 invView;
+  vec4 ambientLightColor; // w is intensity
+  PointLight pointLights[MAX_LIGHTS];
+  int numLights;
+} ubo;
+
+layout(push_constant) uniform Push {
+  mat4 modelMatrix;
+  mat4 normalMatrix;
+} push;
+
+// must match simple_shader.vert bit for bit
+invariant gl_Position;
+
+void main() {
+  vec4 positionWorld = push.modelMatrix * vec4(position, 1.0);
+  gl_Position = ubo.projection * ubo.view * positionWorld;
+  fragColor = COMPRESSED_VERTEX ? vec4(pow(color.rgb, vec3(2.2)), color.a) : color;
+  fragUV = uv;
+}
@@ -11,6 +11,10 @@ layout (location = 3) in vec2 fragUV;
 
 layout (location = 0) out vec4 outColor;
 
+// turned off when a depth prepass already did the alpha test and the main pass uses an EQUAL depth test,
+// without the discard the fragment shader no longer prevents early depth testing
+layout (constant_id = 0) const bool ALPHA_TEST = true;
+
 struct PointLight {
   vec4 position; // ignore w
   vec4 color; // w is intensity
@@ -39,10 +43,25 @@ layout (set = 1, binding = 0) uniform MaterialUbo {
 
     // byte 48 to 63
     float normalMapIntensity;
+    float spare1;
+    float spare2;
+    float spare3;
+
+    // byte 64 to 79
+    vec4 diffuseUVTransform;
 }matUbo;
 
 layout (set = 1, binding = 1) uniform sampler2D diffuseMap;
 
+// packed textures repeat inside their rect, the gradients of the unwrapped UV keep the mip selection smooth
+vec4 SampleDiffuse(vec2 uv) {
+    if(bool(matUbo.features & GLSL_HAS_DIFFUSE_ATLAS)) {
+        vec2 scale = matUbo.diffuseUVTransform.xy;
+        return textureGrad(diffuseMap, fract(uv) * scale + matUbo.diffuseUVTransform.zw, dFdx(uv) * scale, dFdy(uv) * scale);
+    }
+    return texture(diffuseMap, uv);
+}
+
 
 layout(push_constant) uniform Push {
     mat4 modelMatrix;
@@ -59,11 +78,11 @@ void main() {
 
     vec4 textureColor;
     if(bool(matUbo.features & GLSL_HAS_DIFFUSE_MAP)) {
-        textureColor = texture(diffuseMap, fragUV) * matUbo.diffuseColor;
+        textureColor = SampleDiffuse(fragUV) * matUbo.diffuseColor;
     }else{
         textureColor = fragColor;
     }
-    if(textureColor.a < 0.5) {
+    if(ALPHA_TEST && textureColor.a < 0.5) {
         discard;
     }
 
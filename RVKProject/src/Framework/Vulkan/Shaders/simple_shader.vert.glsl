@@ -14,6 +14,12 @@ layout(location = 1) out vec3 fragPosWorld;
 layout(location = 2) out vec3 fragNormalWorld;
 layout(location = 3) out vec2 fragUV;
 
+// CompressedVertex: octahedral normal in normal.xy, gamma encoded color, positions are expanded by the model matrix
+layout(constant_id = COMPRESSED_VERTEX_CONSTANT_ID) const bool COMPRESSED_VERTEX = false;
+
+// the depth prepass has to produce bit identical depth for the EQUAL test
+invariant gl_Position;
+
 struct PointLight {
   vec4 position; // ignore w
   vec4 color; // w is intensity
@@ -33,11 +39,20 @@ layout(push_constant) uniform Push {
   mat4 normalMatrix;
 } push;
 
+vec3 OctahedralDecode(vec2 e) {
+  vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+  if (n.z < 0.0) {
+    n.xy = (1.0 - abs(n.yx)) * vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+  }
+  return normalize(n);
+}
+
 void main() {
   vec4 positionWorld = push.modelMatrix * vec4(position, 1.0);
   gl_Position = ubo.projection * ubo.view * positionWorld;
-  fragNormalWorld = normalize(mat3(push.normalMatrix) * normal);
+  vec3 vertexNormal = COMPRESSED_VERTEX ? OctahedralDecode(normal.xy) : normal;
+  fragNormalWorld = normalize(mat3(push.normalMatrix) * vertexNormal);
   fragPosWorld = positionWorld.xyz;
-  fragColor = color;
+  fragColor = COMPRESSED_VERTEX ? vec4(pow(color.rgb, vec3(2.2)), color.a) : color;
   fragUV = uv;
 }
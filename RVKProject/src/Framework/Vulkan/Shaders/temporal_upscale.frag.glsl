@@ -0,0 +1,62 @@
+#version 450
+#pragma shader_stage(fragment)
+#extension GL_KHR_vulkan_glsl: enable
+
+layout (location = 0) out vec4 outColor;
+layout (location = 1) out vec4 outHistory;
+
+layout(set = 0, binding = 0) uniform TemporalUpscaleUbo {
+  mat4 invViewProjection;
+  mat4 prevViewProjection;
+  vec4 renderSize; // xy rendered size in pixels, zw 1 / scene image size
+  vec4 outputSize; // xy output size in pixels, zw 1 / output size
+  vec4 jitter; // xy jitter in render pixels, z current frame weight, w history valid
+} ubo;
+
+layout(set = 0, binding = 1) uniform sampler2D sceneColor;
+layout(set = 0, binding = 2) uniform sampler2D sceneDepth;
+layout(set = 0, binding = 3) uniform sampler2D historyColor;
+
+void main() {
+  vec2 uv = gl_FragCoord.xy * ubo.outputSize.zw;
+
+  // the scene only covers the top left renderSize pixels of its images and was shifted by the jitter
+  vec2 renderPos = uv * ubo.renderSize.xy + ubo.jitter.xy;
+  renderPos = clamp(renderPos, vec2(0.5), ubo.renderSize.xy - 0.5);
+  vec3 current = texture(sceneColor, renderPos * ubo.renderSize.zw).rgb;
+
+  // color bounds of the neighborhood and the closest depth, which keeps edges from smearing
+  ivec2 center = ivec2(renderPos);
+  ivec2 maxPixel = ivec2(ubo.renderSize.xy) - 1;
+  vec3 minColor = current;
+  vec3 maxColor = current;
+  float closestDepth = 1.0;
+  for (int y = -1; y <= 1; y++) {
+    for (int x = -1; x <= 1; x++) {
+      ivec2 pixel = clamp(center + ivec2(x, y), ivec2(0), maxPixel);
+      vec3 neighbor = texelFetch(sceneColor, pixel, 0).rgb;
+      minColor = min(minColor, neighbor);
+      maxColor = max(maxColor, neighbor);
+      closestDepth = min(closestDepth, texelFetch(sceneDepth, pixel, 0).r);
+    }
+  }
+
+  // camera motion only: rebuild the position and project it with last frame's matrices
+  // (the viewport is flipped, so the top row is NDC y = 1)
+  vec4 ndc = vec4(uv.x * 2.0 - 1.0, 1.0 - uv.y * 2.0, closestDepth, 1.0);
+  vec4 positionWorld = ubo.invViewProjection * ndc;
+  positionWorld /= positionWorld.w;
+  vec4 prevClip = ubo.prevViewProjection * positionWorld;
+  vec2 prevNdc = prevClip.xy / prevClip.w;
+  vec2 prevUV = vec2(prevNdc.x * 0.5 + 0.5, 0.5 - prevNdc.y * 0.5);
+
+  vec3 result = current;
+  bool onScreen = all(greaterThanEqual(prevUV, vec2(0.0))) && all(lessThanEqual(prevUV, vec2(1.0)));
+  if (ubo.jitter.w > 0.0 && onScreen && prevClip.w > 0.0) {
+    vec3 history = clamp(texture(historyColor, prevUV).rgb, minColor, maxColor);
+    result = mix(history, current, ubo.jitter.z);
+  }
+
+  outColor = vec4(result, 1.0);
+  outHistory = vec4(result, 1.0);
+}
@@ -0,0 +1,9 @@
+#version 450
+#pragma shader_stage(vertex)
+#extension GL_KHR_vulkan_glsl: enable
+
+void main() {
+  // one triangle covering the whole target, the fragment shader works from gl_FragCoord
+  vec2 position = vec2((gl_VertexIndex << 1) & 2, gl_VertexIndex & 2);
+  gl_Position = vec4(position * 2.0 - 1.0, 0.0, 1.0);
+}
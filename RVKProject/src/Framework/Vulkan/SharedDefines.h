@@ -3,6 +3,9 @@
 // light
 #define MAX_LIGHTS 128
 
+// vertex input, specialization constant set for CompressedVertex pipelines
+#define COMPRESSED_VERTEX_CONSTANT_ID 1
+
 // material
 #define GLSL_HAS_DIFFUSE_MAP (0x1 << 0x0)
 #define GLSL_HAS_NORMAL_MAP (0x1 << 0x1)
@@ -11,3 +14,5 @@
 #define GLSL_HAS_ROUGHNESS_METALLIC_MAP (0x1 << 0x4)
 #define GLSL_HAS_EMISSIVE_COLOR (0x1 << 0x5)
 #define GLSL_HAS_EMISSIVE_MAP (0x1 << 0x6)
+// the diffuse map is a rect of an atlas page, diffuseUVTransform maps to it
+#define GLSL_HAS_DIFFUSE_ATLAS (0x1 << 0x7)
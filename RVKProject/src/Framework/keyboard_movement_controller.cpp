@@ -17,7 +17,10 @@ namespace RVK {
 		if (glfwGetKey(window, keys.moveDown) == GLFW_PRESS) moveDir -= upDir;
 		if (glfwGetKey(window, keys.moveLeft) == GLFW_PRESS) moveDir -= rightDir;
 		if (glfwGetKey(window, keys.moveRight) == GLFW_PRESS) moveDir += rightDir;
-		if (glfwGetKey(window, GLFW_KEY_LEFT_SHIFT) == GLFW_PRESS) entity.GetComponent<Components::Transform>().scale -= glm::vec3(1.f, 1.f, 1.1f) * dt;
+		if (glfwGetKey(window, GLFW_KEY_LEFT_SHIFT) == GLFW_PRESS) {
+			auto& transform = entity.GetComponent<Components::Transform>();
+			transform.SetScale(transform.GetScale() - glm::vec3(1.f, 1.f, 1.1f) * dt);
+		}
 
 
 		if (glm::dot(moveDir, moveDir) > std::numeric_limits<float>::epsilon()) {
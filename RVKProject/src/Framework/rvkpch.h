@@ -18,6 +18,7 @@
 #include <sstream>
 #include <array>
 #include <vector>
+#include <deque>
 #include <unordered_map>
 #include <unordered_set>
 #include <set>
@@ -1,7 +1,15 @@
 #include "Framework/RVKApp.h"
+#include "Framework/Benchmark.h"
 
-int main() {
+int main(int argc, char** argv) {
 	RVK::Log::Init();
+
+	if (RVK::Benchmark::IsRequested(argc, argv)) {
+		int result = RVK::Benchmark::Run(argc, argv);
+		RVK::Log::Shutdown();
+		return result;
+	}
+
 	RVK::RVKApp app{};
 
 	try {
@@ -36,6 +36,7 @@ project "RVKProject"
 	files{
 		"%{prj.name}/src/**.h",
 		"%{prj.name}/src/**.cpp",
+		"external/ufbx/ufbx.c",
 	}
 	
 	defines{